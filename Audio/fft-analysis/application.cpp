@@ -1,16 +1,25 @@
 /*
- * this example demonstrates how to generate a wavetable oscillator sound with ADSR envelope and reverb.
+ * this example demonstrates how to analyze the spectrum of a signal in the audio thread and draw it.
  */
 
+#include <atomic>
+
 #include "Umfeld.h"
 #include "audio/AudioUtilities.h"
 #include "audio/Wavetable.h"
-#include "audio/FFT.h"
+#include "SpectrumAnalyzer.h"
 
 using namespace umfeld;
 
-Wavetable*                           wavetable_oscillator;
-std::vector<std::pair<float, float>> spectrum;
+Wavetable* wavetable_oscillator;
+/* analyzes in `audioEvent()`, `draw()` reads the latest complete spectrum without locks or copies */
+klangwellen::SpectrumAnalyzer* spectrum_analyzer;
+
+/* written in `draw()`, `audioEvent()` ramps to the new values over one block to avoid zipper noise */
+std::atomic<float> oscillator_frequency{220.0f};
+std::atomic<float> oscillator_amplitude{0.7f};
+float              oscillator_frequency_current = 220.0f; /* audio thread */
+float              oscillator_amplitude_current = 0.7f;   /* audio thread */
 
 void settings() {
     size(1024, 768);
@@ -18,7 +27,10 @@ void settings() {
 }
 
 void setup() {
-    fft_start(audio_buffer_size, audio_sample_rate);
+    /* 2048 samples per analysis every 256 samples, 64 bands between 20Hz and 800Hz */
+    spectrum_analyzer = new klangwellen::SpectrumAnalyzer(2048, 256, 64, audio_sample_rate);
+    spectrum_analyzer->set_window(klangwellen::SpectrumAnalyzer::WINDOW_HANN);
+    spectrum_analyzer->set_frequency_range(20.0f, 800.0f);
 
     wavetable_oscillator = new Wavetable(1024, audio_sample_rate);
     wavetable_oscillator->set_waveform(WAVEFORM_SINE);
@@ -31,31 +43,36 @@ void draw() {
     noFill();
     stroke(1.0f, 0.25f, 0.35f);
 
-    wavetable_oscillator->set_frequency(map(mouseX, 0, width, 20.0f, 800.0f));
-    wavetable_oscillator->set_amplitude(map(mouseY, 0, height, 0.7f, 0.0f));
-
-    if (spectrum.size() > 0) {
-        const float bin_width = width / spectrum.size();
-        noStroke();
-        fill(0.0f, 0.5f, 1.0f);
-        for (const auto& [freq, db]: spectrum) {
-            const float xx = map(freq, 20.0f, 800.0f, 0.0f, width);
-            const float h  = map(db, 0.0f, 50.0f, height, 0.0f);
-            rect(xx - bin_width * 0.5f, h, bin_width, height - h);
-        }
+    oscillator_frequency = map(mouseX, 0, width, 20.0f, 800.0f);
+    oscillator_amplitude = map(mouseY, 0, height, 0.7f, 0.0f);
+
+    const klangwellen::SpectrumAnalyzer::Spectrum& spectrum  = spectrum_analyzer->get_spectrum();
+    const float                                    bin_width = width / static_cast<float>(spectrum.bands.size());
+    noStroke();
+    fill(0.0f, 0.5f, 1.0f);
+    for (uint32_t i = 0; i < spectrum.bands.size(); i++) {
+        const float xx = bin_width * i;
+        const float h  = map(spectrum.bands[i], -60.0f, 0.0f, height, 0.0f);
+        rect(xx, h, bin_width, height - h);
     }
 }
 
 void audioEvent() {
-    float sample_buffer[audio_buffer_size];
+    const float frequency_step = (oscillator_frequency - oscillator_frequency_current) / audio_buffer_size;
+    const float amplitude_step = (oscillator_amplitude - oscillator_amplitude_current) / audio_buffer_size;
+    float       sample_buffer[audio_buffer_size];
     for (int i = 0; i < audio_buffer_size; i++) {
+        oscillator_frequency_current += frequency_step;
+        oscillator_amplitude_current += amplitude_step;
+        wavetable_oscillator->set_frequency(oscillator_frequency_current);
+        wavetable_oscillator->set_amplitude(oscillator_amplitude_current);
         sample_buffer[i] = wavetable_oscillator->process();
     }
-    spectrum = fft_process(sample_buffer, 20.0f, 800.0f);
+    spectrum_analyzer->process(sample_buffer, audio_buffer_size);
     merge_interleaved_stereo(sample_buffer, sample_buffer, audio_output_buffer, audio_buffer_size);
 }
 
 void shutdown() {
     delete wavetable_oscillator;
-    fft_stop();
-}
\ No newline at end of file
+    delete spectrum_analyzer;
+}
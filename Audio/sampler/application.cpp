@@ -3,6 +3,8 @@
  * to it. it also shows how to resample a sample to a different sample rate.
  */
 
+#include <atomic>
+
 #include "Umfeld.h"
 #include "audio/Sampler.h"
 #include "audio/LowPassFilter.h"
@@ -12,6 +14,12 @@ using namespace umfeld;
 Sampler*       sampler;
 LowPassFilter* filter;
 
+/* written in `draw()`, `audioEvent()` ramps to the new values over one block to avoid zipper noise */
+std::atomic<float> filter_frequency{8000.0f};
+std::atomic<float> filter_resonance{0.1f};
+float              filter_frequency_current = 8000.0f; /* audio thread */
+float              filter_resonance_current = 0.1f;    /* audio thread */
+
 void settings() {
     size(1024, 768);
     audio(0, 2);
@@ -40,8 +48,8 @@ void draw() {
     line(x - size, y - size, x + size, y + size);
     line(x - size, y + size, x + size, y - size);
 
-    filter->set_frequency(map(mouseX, 0, width, 20.0f, 8000.0f));
-    filter->set_resonance(map(mouseY, 0, height, 0.1f, 0.9f));
+    filter_frequency = map(mouseX, 0, width, 20.0f, 8000.0f);
+    filter_resonance = map(mouseY, 0, height, 0.1f, 0.9f);
 }
 
 void keyPressed() {
@@ -58,8 +66,14 @@ void keyReleased() {
 }
 
 void audioEvent() {
-    float sample_buffer[audio_buffer_size];
+    const float frequency_step = (filter_frequency - filter_frequency_current) / audio_buffer_size;
+    const float resonance_step = (filter_resonance - filter_resonance_current) / audio_buffer_size;
+    float       sample_buffer[audio_buffer_size];
     for (int i = 0; i < audio_buffer_size; i++) {
+        filter_frequency_current += frequency_step;
+        filter_resonance_current += resonance_step;
+        filter->set_frequency(filter_frequency_current);
+        filter->set_resonance(filter_resonance_current);
         float sample     = sampler->process();
         sample           = filter->process(sample);
         sample_buffer[i] = sample;
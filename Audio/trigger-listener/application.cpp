@@ -1,3 +1,5 @@
+#include <atomic>
+
 #include "Umfeld.h"
 #include "audio/ADSR.h"
 #include "audio/Trigger.h"
@@ -9,17 +11,28 @@ Wavetable* wavetable_oscillator;
 Wavetable* lfo;
 ADSR*      adsr;
 Trigger*   trigger;
-bool       toggle = false;
+
+/* written in `audioEvent()`, read in `draw()` */
+std::atomic<bool> toggle{false};
+/* written in `draw()`, applied at the beginning of each block in `audioEvent()` */
+std::atomic<float> lfo_frequency{1.0f};
+
+/* trigger events of the current block with their sample offset ( audio thread only ) */
+struct TriggerEvent {
+    int  offset;
+    bool rising_edge;
+};
+static constexpr int MAX_TRIGGER_EVENTS = 64;
+TriggerEvent         trigger_events[MAX_TRIGGER_EVENTS];
+int                  num_trigger_events = 0;
+int                  trigger_offset     = 0;
 
 class MyTriggerListener final : public TriggerListener {
 public:
+    /* called from inside `trigger->process()`, only records the event. it is applied while the block is rendered. */
     void trigger(const int event) override {
-        if (event == EVENT_RISING_EDGE) {
-            adsr->start();
-            toggle = true;
-        } else if (event == EVENT_FALLING_EDGE) {
-            adsr->stop();
-            toggle = false;
+        if (num_trigger_events < MAX_TRIGGER_EVENTS) {
+            trigger_events[num_trigger_events++] = {trigger_offset, event == EVENT_RISING_EDGE};
         }
     }
 };
@@ -59,19 +72,36 @@ void draw() {
         circle(width / 2.0f, height / 2.0f, 100);
     }
 
-    lfo->set_frequency(map(mouseY, 0, height, 0.1f, 10.0f));
+    lfo_frequency = map(mouseY, 0, height, 0.1f, 10.0f);
 }
 
 void audioEvent() {
+    lfo->set_frequency(lfo_frequency);
+
+    /* feed lfo to trigger for the whole block first ... */
+    num_trigger_events = 0;
+    for (trigger_offset = 0; trigger_offset < audio_buffer_size; trigger_offset++) {
+        trigger->process(lfo->process());
+    }
+
+    /* ... then process samples and start or stop the envelope at the sample of each event */
     float sample_buffer[audio_buffer_size];
+    int   event = 0;
     for (int i = 0; i < audio_buffer_size; i++) {
-        /* feed lfo to trigger */
-        trigger->process(lfo->process());
-        /* process sample */
+        for (; event < num_trigger_events && trigger_events[event].offset == i; event++) {
+            if (trigger_events[event].rising_edge) {
+                adsr->start();
+            } else {
+                adsr->stop();
+            }
+        }
         float sample     = wavetable_oscillator->process();
         sample           = adsr->process(sample);
         sample_buffer[i] = sample;
     }
+    if (num_trigger_events > 0) {
+        toggle = trigger_events[num_trigger_events - 1].rising_edge;
+    }
     merge_interleaved_stereo(sample_buffer, sample_buffer, audio_output_buffer, audio_buffer_size);
 }
 
@@ -80,4 +110,4 @@ void shutdown() {
     delete lfo;
     delete adsr;
     delete trigger;
-}
\ No newline at end of file
+}
@@ -3,19 +3,26 @@
 /*
  * this example demonstrates how to use the audio file reader and writer.
  * it reads a WAV file, plays it back and writes a sine wave to a new WAV file.
+ *
+ * the WAV file is played with `klangwellen::AudioFileStream`, which memory maps the file ( or decodes it ahead of
+ * time on a prefetch thread ) and loops it without a seek in `audioEvent()`. the output is recorded with
+ * `klangwellen::AudioFileRecorder`, which passes the blocks to a disk-writer thread instead of writing to the file
+ * in `audioEvent()`.
  */
 
 #include "Umfeld.h"
 
 using namespace umfeld;
 
-#include "audio/AudioFileReader.h"
 #include "audio/AudioFileWriter.h"
 #include "PAudio.h"
+#include "AudioFileStream.h"
+#include "AudioFileRecorder.h"
 
-AudioFileReader audio_file_reader;
-PAudio*         second_audio_device = nullptr;
-bool            toggle_pause        = false;
+klangwellen::AudioFileStream   audio_file_stream;
+klangwellen::AudioFileRecorder audio_file_recorder{2, 48000, 24}; // NOTE matches `audio(1, 2)`
+PAudio*                        second_audio_device = nullptr;
+bool                           toggle_pause        = false;
 
 void settings() {
     size(1024, 768);
@@ -73,15 +80,20 @@ void setup() {
     console("audio device name    : ", audio_input_device_name, " / ", audio_output_device_name);
     console("channels             : ", input_channels, " / ", output_channels);
 
-    audio_file_reader.open("../teilchen.wav");
+    audio_file_stream.set_looping(true);
+    audio_file_stream.open("../teilchen.wav");
 
     console("WAV FILE INFO");
-    console("sample_rate          : ", audio_file_reader.sample_rate());
-    console("channels             : ", audio_file_reader.channels());
-    console("length               : ", audio_file_reader.length());
+    console("sample_rate          : ", audio_file_stream.get_sample_rate());
+    console("channels             : ", audio_file_stream.get_channels());
+    console("length               : ", audio_file_stream.get_length());
+    console("memory mapped        : ", audio_file_stream.get_mode() == klangwellen::AudioFileStream::MODE_MEMORY_MAPPED);
 
     write_WAV_file();
 
+    /* records the output until the application is closed */
+    audio_file_recorder.open("../recording.wav");
+
     console("FILE PATH");
     console("SDL_GetBasePath      : ", SDL_GetBasePath());
     console("sketchPath           : ", sketchPath());
@@ -102,7 +114,7 @@ void setup() {
 void draw() {
     background(1);
     const int   mPadding  = 10;
-    const float mProgress = (float) audio_file_reader.current_position() / (float) audio_file_reader.length();
+    const float mProgress = (float) audio_file_stream.get_position() / (float) audio_file_stream.get_length();
     stroke(0.0f);
     noFill();
     rect(mPadding, height * 0.5 - mPadding, width - mPadding * 2, mPadding * 2);
@@ -112,7 +124,10 @@ void draw() {
 }
 
 void finish() {
-    audio_file_reader.close();
+    audio_file_stream.close();
+    audio_file_recorder.close();
+    console("recording            : ", audio_file_recorder.get_recorded_frames(), " frames, ",
+            audio_file_recorder.get_dropped_blocks(), " dropped blocks");
 }
 
 void keyPressed() {
@@ -132,8 +147,19 @@ void keyPressed() {
     }
 }
 
+/* reads the first channel of the WAV file, looping is handled by the stream. the stream is opened in `setup()` while
+ * the audio device is already running, until then this is silence. */
 void read_wav(float* samples, const size_t frames) {
-    audio_file_reader.read(frames, samples, AudioFileReader::ReadStyle::LOOP);
+    std::fill_n(samples, frames, 0.0f);
+    if (!audio_file_stream.is_open()) {
+        return;
+    }
+    const uint16_t channels = audio_file_stream.get_channels();
+    float          interleaved[frames * channels];
+    const uint32_t read = audio_file_stream.read(interleaved, frames);
+    for (size_t i = 0; i < read; i++) {
+        samples[i] = interleaved[i * channels];
+    }
 }
 
 void audioEvent(const PAudio& device) {
@@ -157,6 +183,7 @@ void audioEvent(const PAudio& device) {
             right[i]           = sample;
         }
         merge_interleaved_stereo(left, right, audio_output_buffer, audio_buffer_size);
+        audio_file_recorder.write(audio_output_buffer, audio_buffer_size);
     }
 }
 
@@ -174,4 +201,5 @@ void audioEvent() {
         right[i] = sample;
     }
     merge_interleaved_stereo(left, right, audio_output_buffer, audio_buffer_size);
+    audio_file_recorder.write(audio_output_buffer, audio_buffer_size);
 }
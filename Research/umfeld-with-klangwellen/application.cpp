@@ -7,14 +7,32 @@ using namespace umfeld;
 #define KLANG_SAMPLES_PER_AUDIO_BLOCK DEFAULT_FRAMES_PER_BUFFER
 #define KLANG_SAMPLING_RATE           DEFAULT_AUDIO_SAMPLE_RATE
 
+#include <string>
+
 #include "ADSR.h"
+#include "AudioProfiler.h"
+#include "ParameterAutomation.h"
 #include "Reverb.h"
 #include "Wavetable.h"
 
-PFont*                 mFont{};
-klangwellen::ADSR      fADSR;
-klangwellen::Wavetable fWavetable{1024, klangwellen::KlangWellen::DEFAULT_SAMPLE_RATE};
-klangwellen::Reverb    fReverb;
+PFont*                     mFont{};
+klangwellen::ADSR          fADSR;
+klangwellen::Wavetable     fWavetable{1024, klangwellen::KlangWellen::DEFAULT_SAMPLE_RATE};
+klangwellen::Reverb        fReverb;
+klangwellen::AudioProfiler fProfiler{KLANG_SAMPLING_RATE, KLANG_SAMPLES_PER_AUDIO_BLOCK};
+
+/* mouse events and `draw()` run on the application thread, the parameters are changed in `audioEvent()` */
+klangwellen::ParameterAutomation<> fParameters{KLANG_SAMPLING_RATE};
+int16_t                            GATE;
+int16_t                            FREQUENCY;
+
+void apply_gate(const float gate) {
+    if (gate > 0.5f) {
+        fADSR.start();
+    } else if (!fADSR.is_idle()) {
+        fADSR.stop();
+    }
+}
 
 void settings() {
     size(1024, 768);
@@ -27,7 +45,9 @@ void setup() {
     textFont(mFont);
 
     klangwellen::Wavetable::sawtooth(fWavetable.get_wavetable(), fWavetable.get_wavetable_size());
-    fWavetable.set_frequency(55);
+    GATE = fParameters.add(apply_gate, 0.0f);
+    /* glides to the new frequency in 50ms */
+    FREQUENCY = fParameters.add([](const float frequency) { fWavetable.set_frequency(frequency); }, 55.0f, 50.0f);
     textAlign(CENTER);
 }
 
@@ -36,23 +56,41 @@ void draw() {
     fill(0);
     noStroke();
     text("PRESS", mouseX, mouseY);
+
+    fParameters.set(FREQUENCY, map(mouseX, 0, width, 55.0f, 220.0f));
+
+    /* DSP load of `audioEvent()`, press `t` to write the trace */
+    fProfiler.collect_trace();
+    const klangwellen::AudioProfiler::Statistics mStatistics = fProfiler.get_statistics();
+    text("DSP " + std::to_string(static_cast<int>(mStatistics.load)) + "% / " +
+             std::to_string(mStatistics.overruns) + " OVERRUNS",
+         width / 2.0f, height - 48.0f);
 }
 
 void audioEvent() {
-    for (int i = 0; i < audio_buffer_size; i++) {
-        float mSample = fWavetable.process();
-        mSample       = fADSR.process(mSample);
-        mSample       = fReverb.process(mSample);
-        for (int j = 0; j < output_channels; ++j) {
-            audio_output_buffer[i * output_channels + j] = mSample; // write sample to all channels
+    klangwellen::AudioProfiler::Scope mScope(fProfiler);
+    fParameters.process(audio_buffer_size, [](const uint32_t offset, const uint32_t length) {
+        for (uint32_t i = offset; i < offset + length; i++) {
+            float mSample = fWavetable.process();
+            mSample       = fADSR.process(mSample);
+            mSample       = fReverb.process(mSample);
+            for (int j = 0; j < output_channels; ++j) {
+                audio_output_buffer[i * output_channels + j] = mSample; // write sample to all channels
+            }
         }
-    }
+    });
 }
 
 void mousePressed() {
-    fADSR.start();
+    fParameters.set(GATE, 1.0f);
 }
 
 void mouseReleased() {
-    fADSR.stop();
+    fParameters.set(GATE, 0.0f);
+}
+
+void keyPressed() {
+    if (key == 't') {
+        fProfiler.write_trace("audio-trace.json");
+    }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 // void write_WAV_file(const char* filename, int sampleRate, int numChannels, int bitsPerSample, const int16_t* data, int numSamples);
 // void write_WAV_file(const char* filename, int sampleRate, int numChannels, const float* data, int numSamples);
@@ -47,7 +48,7 @@ void write_WAV_file(const char*  filename,
                     int          numChannels,
                     const float* data,
                     int          numSamples) {
-    int16_t mAudioData[numSamples * numChannels];
+    std::vector<int16_t> mAudioData(numSamples * numChannels); /* a stack array overflows for longer files */
     for (int i = 0; i < numSamples; i++) {
         for (int j = 0; j < numChannels; j++) {
             const int k   = i * numChannels + j;
@@ -59,6 +60,6 @@ void write_WAV_file(const char*  filename,
                    sampleRate,
                    numChannels,
                    16,
-                   mAudioData,
+                   mAudioData.data(),
                    numSamples);
 }
\ No newline at end of file
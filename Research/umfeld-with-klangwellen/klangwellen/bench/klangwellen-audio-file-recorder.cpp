@@ -0,0 +1,273 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * checks and measures `AudioFileRecorder` with 16 channels at 48KHz and 256 samples per block:
+ *
+ * - real time: an audio thread records 5 sec in ( simulated ) real time. no block may be dropped and the file must
+ *   contain exactly the recorded samples.
+ * - 24-bit PCM with RF64 header: the file must be read back as RF64 file with the samples in 24-bit resolution.
+ * - throughput: the audio thread records as fast as it can ( far faster than real time ), so that the writer thread
+ *   falls behind and blocks are dropped. reports the sustained write rate in MB/sec and the dropped blocks, the file
+ *   must contain every block that was not dropped and silence in place of the dropped blocks.
+ * - open and close while recording: the audio thread writes a continuous signal as fast as it can, while the main
+ *   thread opens and closes recordings. every file must contain a gapless part of the signal ( or silence in place of
+ *   dropped blocks ) with the number of frames written while it was open.
+ * - with `--rf64` a recording larger than 4GB is written and read back.
+ *
+ * the files are read back through `WAVDecoder`. build + run with
+ * `cmake -B build ; cmake --build build ; ./build/klangwellen-audio-file-recorder [--rf64]`
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AudioFileRecorder.h"
+#include "AudioFileStream.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t BLOCK_SIZE  = 256;
+static constexpr uint16_t CHANNELS    = 16;
+
+static float expected(const uint64_t frame, const uint16_t channel) {
+    return static_cast<float>((frame * 7 + channel * 13) % 8191) / 8191.0f - 0.5f;
+}
+
+static void fill(float* block, const uint64_t frame) {
+    for (uint32_t i = 0; i < BLOCK_SIZE; i++) {
+        for (uint16_t c = 0; c < CHANNELS; c++) {
+            block[i * CHANNELS + c] = expected(frame + i, c);
+        }
+    }
+}
+
+struct Recording {
+    uint64_t frames     = 0;
+    uint32_t dropped    = 0;
+    uint64_t bytes      = 0;
+    double   seconds    = 0.0;
+    bool     closed     = false;
+    bool     direct_io  = false;
+    uint32_t max_queued = 0;
+};
+
+/* records `blocks` blocks, paced in real time if `paced`. `seconds` includes `close()` */
+static Recording record(AudioFileRecorder& recorder, const std::string& path, const uint64_t blocks, const bool paced) {
+    Recording          mRecording;
+    std::vector<float> mBlock(BLOCK_SIZE * CHANNELS);
+    if (!recorder.open(path)) {
+        return mRecording;
+    }
+    const auto mStart = std::chrono::steady_clock::now();
+    auto       mNext  = mStart;
+    for (uint64_t b = 0; b < blocks; b++) {
+        fill(mBlock.data(), b * BLOCK_SIZE);
+        recorder.write(mBlock.data(), BLOCK_SIZE);
+        if (paced) {
+            mNext += std::chrono::microseconds(1000000 * BLOCK_SIZE / SAMPLE_RATE);
+            std::this_thread::sleep_until(mNext);
+        }
+    }
+    mRecording.frames     = recorder.get_recorded_frames();
+    mRecording.dropped    = recorder.get_dropped_blocks();
+    mRecording.max_queued = recorder.get_max_queued_blocks();
+    mRecording.direct_io  = recorder.is_direct_io();
+    mRecording.closed     = recorder.close();
+    mRecording.seconds    = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+    mRecording.bytes      = recorder.get_written_bytes();
+    return mRecording;
+}
+
+/* every block of the file must be the recorded block or silence ( dropped ), `tolerance` allows for PCM. the
+ * recorder is created with blocks of `BLOCK_SIZE` frames. */
+static bool verify(const std::string& path, const Recording& recording, const float tolerance, uint32_t& silent_blocks) {
+    WAVDecoder mDecoder;
+    if (!mDecoder.open(path) || mDecoder.get_channels() != CHANNELS || mDecoder.get_length() != recording.frames) {
+        return false;
+    }
+    std::vector<float> mBlock(BLOCK_SIZE * CHANNELS);
+    silent_blocks = 0;
+    for (uint64_t mFrame = 0; mFrame < recording.frames; mFrame += BLOCK_SIZE) {
+        mDecoder.decode(mBlock.data(), BLOCK_SIZE);
+        bool mSilent   = true;
+        bool mRecorded = true;
+        for (uint32_t i = 0; i < BLOCK_SIZE && mFrame + i < recording.frames; i++) {
+            for (uint16_t c = 0; c < CHANNELS; c++) {
+                const float mSample = mBlock[i * CHANNELS + c];
+                mSilent &= mSample == 0.0f;
+                mRecorded &= std::fabs(mSample - expected(mFrame + i, c)) <= tolerance;
+            }
+        }
+        if (!mRecorded && !mSilent) {
+            return false;
+        }
+        silent_blocks += mRecorded ? 0 : 1;
+    }
+    return silent_blocks == recording.dropped;
+}
+/* like `verify()` for a recording that starts anywhere in the signal: every block of the file must continue the
+ * signal of the previous recorded block or be silence ( dropped ). */
+static bool verify_continuous(const std::string& path, const Recording& recording) {
+    WAVDecoder mDecoder;
+    if (!mDecoder.open(path) || mDecoder.get_channels() != CHANNELS || mDecoder.get_length() != recording.frames) {
+        return false;
+    }
+    std::vector<uint32_t> mFrameOf(8191); /* `expected()` of channel 0 repeats every 8191 frames */
+    for (uint32_t i = 0; i < 8191; i++) {
+        mFrameOf[i * 7 % 8191] = i;
+    }
+    std::vector<float> mBlock(BLOCK_SIZE * CHANNELS);
+    uint32_t           mSilentBlocks = 0;
+    bool               mStarted      = false;
+    uint64_t           mStart        = 0; /* frame of the signal at the beginning of the file */
+    for (uint64_t mFrame = 0; mFrame < recording.frames; mFrame += BLOCK_SIZE) {
+        mDecoder.decode(mBlock.data(), BLOCK_SIZE);
+        if (std::all_of(mBlock.begin(), mBlock.end(), [](const float sample) { return sample == 0.0f; })) {
+            mSilentBlocks++;
+            continue;
+        }
+        const uint32_t mValue = static_cast<uint32_t>(std::lround((mBlock[0] + 0.5f) * 8191.0f)) % 8191;
+        const uint64_t mBegin = (mFrameOf[mValue] + 8191 - mFrame % 8191) % 8191;
+        if (mStarted && mBegin != mStart) {
+            return false;
+        }
+        mStarted = true;
+        mStart   = mBegin;
+        for (uint32_t i = 0; i < BLOCK_SIZE && mFrame + i < recording.frames; i++) {
+            for (uint16_t c = 0; c < CHANNELS; c++) {
+                if (mBlock[i * CHANNELS + c] != expected(mStart + mFrame + i, c)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return mSilentBlocks == recording.dropped;
+}
+
+static bool is_rf64(const std::string& path) {
+    std::ifstream mFile(path, std::ios::binary);
+    char          mID[4] = {};
+    mFile.read(mID, 4);
+    return memcmp(mID, "RF64", 4) == 0;
+}
+
+static bool fPassed = true;
+
+static void report(const char* name, const Recording& recording, const bool passed) {
+    const double mMegabytes = static_cast<double>(recording.bytes) / 1000000.0;
+    std::cout << (passed ? "    OK     " : "    FAILED ") << name << ": " << recording.frames << " frames, "
+              << recording.dropped << " dropped blocks, max " << recording.max_queued << " queued blocks, "
+              << mMegabytes << " MB in " << recording.seconds << " sec ( " << mMegabytes / recording.seconds << " MB/sec"
+              << (recording.direct_io ? ", direct I/O" : "") << " )" << std::endl;
+    fPassed &= passed;
+}
+
+int main(const int argc, const char* argv[]) {
+    const bool mRF64 = argc > 1 && std::string(argv[1]) == "--rf64";
+    std::cout << std::fixed << std::setprecision(1)
+              << "+++ klangwellen audio file recorder ( " << CHANNELS << " channels, " << SAMPLE_RATE << " Hz, "
+              << BLOCK_SIZE << " samples per block, real time is "
+              << CHANNELS * sizeof(float) * SAMPLE_RATE / 1000000.0 << " MB/sec as float )" << std::endl
+              << std::endl;
+
+    const std::string mPath = (std::filesystem::temp_directory_path() / "klangwellen-audio-file-recorder.wav").string();
+    uint32_t          mSilentBlocks;
+    {
+        AudioFileRecorder mRecorder(CHANNELS, SAMPLE_RATE, 32, BLOCK_SIZE);
+        mRecorder.set_direct_io(true);
+        mRecorder.set_preallocate(SAMPLE_RATE * 5);
+        const Recording mRecording = record(mRecorder, mPath, SAMPLE_RATE * 5 / BLOCK_SIZE, true);
+        report("real time, float", mRecording,
+               mRecording.closed && mRecording.dropped == 0 && verify(mPath, mRecording, 0.0f, mSilentBlocks));
+    }
+    {
+        AudioFileRecorder mRecorder(CHANNELS, SAMPLE_RATE, 24, BLOCK_SIZE);
+        mRecorder.set_rf64(true);
+        const Recording mRecording = record(mRecorder, mPath, SAMPLE_RATE / BLOCK_SIZE, false);
+        report("24-bit PCM, RF64 header", mRecording,
+               mRecording.closed && mRecording.dropped == 0 && is_rf64(mPath) &&
+                   verify(mPath, mRecording, 1.0f / 8388607.0f, mSilentBlocks));
+    }
+    {
+        AudioFileRecorder mRecorder(CHANNELS, SAMPLE_RATE, 32, BLOCK_SIZE);
+        std::atomic<bool> mRunning{true};
+        std::thread       mAudioThread([&mRecorder, &mRunning]() {
+            std::vector<float> mBlock(BLOCK_SIZE * CHANNELS);
+            for (uint64_t b = 0; mRunning.load(std::memory_order_relaxed); b++) {
+                fill(mBlock.data(), b * BLOCK_SIZE);
+                mRecorder.write(mBlock.data(), BLOCK_SIZE);
+            }
+        });
+        constexpr uint32_t RECORDINGS = 20;
+        uint32_t           mVerified  = 0;
+        Recording          mTotal;
+        const auto         mStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < RECORDINGS; i++) {
+            Recording mRecording;
+            mRecording.closed = mRecorder.open(mPath);
+            std::this_thread::sleep_for(std::chrono::milliseconds(i % 5 * 10));
+            mRecording.closed &= mRecorder.close();
+            mRecording.frames  = mRecorder.get_recorded_frames();
+            mRecording.dropped = mRecorder.get_dropped_blocks();
+            mVerified += mRecording.closed && verify_continuous(mPath, mRecording) ? 1 : 0;
+            mTotal.frames += mRecording.frames;
+            mTotal.dropped += mRecording.dropped;
+            mTotal.bytes += mRecorder.get_written_bytes();
+            mTotal.max_queued = std::max(mTotal.max_queued, mRecorder.get_max_queued_blocks());
+        }
+        mTotal.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+        mRunning.store(false, std::memory_order_relaxed);
+        mAudioThread.join();
+        report("open and close while recording", mTotal, mVerified == RECORDINGS);
+    }
+    for (const bool mDirectIO: {false, true}) {
+        AudioFileRecorder mRecorder(CHANNELS, SAMPLE_RATE, 32, BLOCK_SIZE);
+        mRecorder.set_direct_io(mDirectIO);
+        const Recording mRecording = record(mRecorder, mPath, SAMPLE_RATE * 300 / BLOCK_SIZE, false);
+        report(mDirectIO ? "throughput, direct I/O requested" : "throughput, buffered", mRecording,
+               mRecording.closed && verify(mPath, mRecording, 0.0f, mSilentBlocks));
+    }
+    if (mRF64) {
+        AudioFileRecorder mRecorder(CHANNELS, SAMPLE_RATE, 32, BLOCK_SIZE);
+        mRecorder.set_direct_io(true);
+        const uint64_t  mBlocks    = 4500000000ULL / (BLOCK_SIZE * CHANNELS * sizeof(float));
+        const Recording mRecording = record(mRecorder, mPath, mBlocks, false);
+        std::ifstream   mFile(mPath, std::ios::binary);
+        WAV::Format     mFormat;
+        const bool      mHeader = WAV::read_header(mFile, mFormat) && mFormat.frames() == mRecording.frames;
+        mFile.close();
+        report("larger than 4GB", mRecording,
+               mRecording.closed && mHeader && is_rf64(mPath) && verify(mPath, mRecording, 0.0f, mSilentBlocks));
+    }
+    std::filesystem::remove(mPath);
+
+    std::cout << (fPassed ? "OK" : "FAILED") << std::endl;
+    return fPassed ? 0 : 1;
+}
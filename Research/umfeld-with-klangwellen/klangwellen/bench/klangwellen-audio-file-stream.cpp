@@ -0,0 +1,279 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * stress test of `AudioFileStream`. a stereo WAV file of 1.3 sec is looped for 6 sec ( 2 sec with `--short` ) by an
+ * audio thread that runs in ( simulated ) real time at 48KHz with 256 samples per block:
+ *
+ * - memory mapped: the file is evicted from the page cache after it is opened ( linux ). the looped output must be
+ *   the file without gaps and `read()` must not cause a major page fault ( a page fault that waits for the disk ).
+ * - prefetched: the decoder injects artificial I/O latency ( 0 ... 5 ms per chunk, a 100 ms stall every 20 chunks and
+ *   a 30 ms seek on every rewind ). with a ring buffer of 65536 frames there must be no underruns and the looped output
+ *   must be the file without gaps. with a ring buffer of 1024 frames underruns must be detected.
+ * - without looping the stream must end after the last frame without an underrun.
+ * - `open()` and `close()` while an audio thread reads, build with `-DCMAKE_CXX_FLAGS=-fsanitize=thread` to check for
+ *   data races.
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-audio-file-stream [--short]`
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif // __linux__
+
+#include "AudioFileStream.h"
+#include "WAV.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t BLOCK_SIZE  = 256;
+static constexpr uint16_t CHANNELS    = 2;
+static constexpr uint32_t FILE_FRAMES = SAMPLE_RATE * 13 / 10; /* not a multiple of the block size */
+
+static float expected(const uint64_t frame, const uint16_t channel) {
+    return static_cast<float>((frame * 7 + channel * 13) % 10007) / 10007.0f - 0.5f;
+}
+
+/* wraps `WAVDecoder` and sleeps to simulate a slow disk or decoder */
+class SlowDecoder final : public AudioFileDecoder {
+public:
+    explicit SlowDecoder(const std::string& path) {
+        fDecoder.open(path);
+    }
+
+    uint16_t get_channels() const override {
+        return fDecoder.get_channels();
+    }
+
+    uint32_t get_sample_rate() const override {
+        return fDecoder.get_sample_rate();
+    }
+
+    uint64_t get_length() const override {
+        return fDecoder.get_length();
+    }
+
+    uint32_t decode(float* buffer, const uint32_t frames) override {
+        fCalls++;
+        const uint32_t mLatency = fCalls % 20 == 0 ? 100000 : std::uniform_int_distribution<uint32_t>(0, 5000)(fRandom);
+        std::this_thread::sleep_for(std::chrono::microseconds(mLatency));
+        return fDecoder.decode(buffer, frames);
+    }
+
+    bool rewind() override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        return fDecoder.rewind();
+    }
+
+private:
+    WAVDecoder   fDecoder;
+    std::mt19937 fRandom{23};
+    uint32_t     fCalls = 0;
+};
+
+struct Result {
+    uint32_t underruns      = 0;
+    uint64_t wrong          = 0; /* samples that differ from the file */
+    uint64_t frames         = 0; /* frames read from the file */
+    uint32_t min_prefetched = UINT32_MAX;
+    int64_t  page_faults    = 0; /* major page faults in `read()` */
+};
+
+#if defined(__SANITIZE_THREAD__) || defined(__SANITIZE_ADDRESS__)
+#define KLANGWELLEN_BENCH_SANITIZER 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer) || __has_feature(address_sanitizer)
+#define KLANGWELLEN_BENCH_SANITIZER 1
+#endif
+#endif
+
+/* major page faults of the calling thread ( not counted with sanitizers, which fault in their shadow memory ) */
+static int64_t major_page_faults() {
+#if defined(__linux__) && !defined(KLANGWELLEN_BENCH_SANITIZER)
+    rusage mUsage{};
+    getrusage(RUSAGE_THREAD, &mUsage);
+    return mUsage.ru_majflt;
+#else
+    return 0;
+#endif // __linux__
+}
+
+/* drops the pages of the file from the page cache, so that the next access reads from disk */
+static void evict_from_page_cache(const std::string& path) {
+#if defined(__linux__)
+    const int mDescriptor = open(path.c_str(), O_RDONLY);
+    if (mDescriptor >= 0) {
+        fdatasync(mDescriptor);
+        posix_fadvise(mDescriptor, 0, 0, POSIX_FADV_DONTNEED);
+        close(mDescriptor);
+    }
+#else
+    (void) path;
+#endif // __linux__
+}
+
+/* reads `blocks` blocks, paced in real time if `paced` */
+static Result play(AudioFileStream& stream, const uint32_t blocks, const bool paced) {
+    Result mResult;
+    float  mBlock[BLOCK_SIZE * CHANNELS];
+    auto   mNext = std::chrono::steady_clock::now();
+    for (uint32_t b = 0; b < blocks; b++) {
+        if (stream.get_mode() == AudioFileStream::MODE_PREFETCH) {
+            mResult.min_prefetched = std::min(mResult.min_prefetched, stream.get_prefetched_frames());
+        }
+        const int64_t  mPageFaults = major_page_faults();
+        const uint32_t mFrames     = stream.read(mBlock, BLOCK_SIZE);
+        mResult.page_faults += major_page_faults() - mPageFaults;
+        for (uint32_t i = 0; i < mFrames; i++) {
+            for (uint16_t c = 0; c < CHANNELS; c++) {
+                mResult.wrong += mBlock[i * CHANNELS + c] != expected((mResult.frames + i) % FILE_FRAMES, c) ? 1 : 0;
+            }
+        }
+        for (uint32_t i = mFrames * CHANNELS; i < BLOCK_SIZE * CHANNELS; i++) {
+            mResult.wrong += mBlock[i] != 0.0f ? 1 : 0;
+        }
+        mResult.frames += mFrames;
+        if (paced) {
+            mNext += std::chrono::microseconds(1000000 * BLOCK_SIZE / SAMPLE_RATE);
+            std::this_thread::sleep_until(mNext);
+        }
+    }
+    mResult.underruns = stream.get_underruns();
+    return mResult;
+}
+
+static bool fPassed = true;
+
+static void report(const char* name, const Result& result, const bool passed) {
+    std::cout << (passed ? "    OK     " : "    FAILED ") << name << ": " << result.frames << " frames ( "
+              << static_cast<float>(result.frames) / FILE_FRAMES << " loops ), " << result.wrong << " wrong samples, "
+              << result.underruns << " underruns";
+    if (result.min_prefetched != UINT32_MAX) {
+        std::cout << ", at least " << result.min_prefetched << " frames prefetched";
+    }
+    std::cout << ", " << result.page_faults << " major page faults";
+    std::cout << std::endl;
+    fPassed &= passed;
+}
+
+int main(const int argc, const char* argv[]) {
+    const bool mShort = argc > 1 && std::string(argv[1]) == "--short";
+    std::cout << "+++ klangwellen audio file stream ( " << SAMPLE_RATE << " Hz, " << BLOCK_SIZE << " samples per block )" << std::endl
+              << std::endl;
+
+    const std::string  mPath = (std::filesystem::temp_directory_path() / "klangwellen-audio-file-stream.wav").string();
+    std::vector<float> mSamples(FILE_FRAMES * CHANNELS);
+    for (uint32_t i = 0; i < FILE_FRAMES; i++) {
+        for (uint16_t c = 0; c < CHANNELS; c++) {
+            mSamples[i * CHANNELS + c] = expected(i, c);
+        }
+    }
+    WAV::write(mPath, mSamples.data(), FILE_FRAMES, CHANNELS, SAMPLE_RATE);
+
+    const uint32_t mBlocks = SAMPLE_RATE * (mShort ? 2 : 6) / BLOCK_SIZE;
+    {
+        /* runs the code once, so that only page faults of the mapped file are counted */
+        AudioFileStream mWarmUp;
+        mWarmUp.open(mPath, true);
+        play(mWarmUp, 1, false);
+        mWarmUp.close();
+
+        AudioFileStream mStream;
+        mStream.set_looping(true);
+        const bool mOpened = mStream.open(mPath, true) && mStream.get_mode() == AudioFileStream::MODE_MEMORY_MAPPED;
+        evict_from_page_cache(mPath); /* locked pages stay in memory */
+        const Result mResult = play(mStream, mBlocks, true);
+        report(mStream.is_memory_locked() ? "memory mapped ( locked ), looping" : "memory mapped ( not locked ), looping", mResult,
+               mOpened && mResult.wrong == 0 && mResult.page_faults == 0 && mResult.frames == mBlocks * BLOCK_SIZE);
+    }
+    {
+        SlowDecoder     mDecoder(mPath);
+        AudioFileStream mStream(65536);
+        mStream.set_looping(true);
+        const bool mOpened = mStream.open(&mDecoder);
+        std::this_thread::sleep_for(std::chrono::milliseconds(500)); /* prefetch before playback starts */
+        const Result mResult = play(mStream, mBlocks, true);
+        report("prefetched with I/O latency, looping", mResult,
+               mOpened && mResult.underruns == 0 && mResult.wrong == 0 && mResult.frames == mBlocks * BLOCK_SIZE);
+    }
+    {
+        SlowDecoder     mDecoder(mPath);
+        AudioFileStream mStream(1024);
+        mStream.set_looping(true);
+        const bool   mOpened = mStream.open(&mDecoder);
+        const Result mResult = play(mStream, SAMPLE_RATE * 2 / BLOCK_SIZE, true);
+        report("prefetched with I/O latency, ring too small ( underruns expected )", mResult,
+               mOpened && mResult.underruns > 0 && mResult.wrong == 0);
+    }
+    {
+        AudioFileStream mStream;
+        const bool      mOpened = mStream.open(mPath) && mStream.get_mode() == AudioFileStream::MODE_PREFETCH;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const Result mResult = play(mStream, mBlocks, true);
+        report("prefetched, not looping", mResult,
+               mOpened && mResult.underruns == 0 && mResult.wrong == 0 && mResult.frames == FILE_FRAMES && mStream.is_done());
+    }
+    {
+        AudioFileStream   mStream;
+        std::atomic<bool> mRunning{true};
+        uint64_t          mFrames = 0;
+        uint64_t          mWrong  = 0;
+        std::thread       mAudio([&] {
+            float mBlock[BLOCK_SIZE * CHANNELS];
+            while (mRunning.load()) {
+                const uint32_t mRead = mStream.read(mBlock, BLOCK_SIZE);
+                /* every file starts at frame 0, a block is either from the file or not read at all */
+                for (uint32_t i = 0; i < mRead * CHANNELS; i++) {
+                    mWrong += mBlock[i] == 0.0f || std::abs(mBlock[i]) > 0.5f ? 1 : 0;
+                }
+                mFrames += mRead;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+        for (uint32_t i = 0; i < 40; i++) {
+            mStream.set_looping(i % 3 == 0);
+            mStream.open(mPath, i % 2 == 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            mStream.close();
+        }
+        mRunning.store(false);
+        mAudio.join();
+        Result mResult;
+        mResult.frames = mFrames;
+        mResult.wrong  = mWrong;
+        report("open and close while reading", mResult, mFrames > 0 && mWrong == 0);
+    }
+    std::filesystem::remove(mPath);
+
+    std::cout << (fPassed ? "OK" : "FAILED") << std::endl;
+    return fPassed ? 0 : 1;
+}
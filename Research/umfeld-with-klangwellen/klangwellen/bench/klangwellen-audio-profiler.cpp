@@ -0,0 +1,173 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * checks `AudioProfiler`:
+ *
+ * - callbacks with known durations and start times ( 48KHz, 256 samples per block ) must show up in the statistics,
+ *   the histogram and the percentiles, including overruns and late callbacks.
+ * - the overhead of `begin()` and `end()` per callback.
+ * - an audio thread that runs in ( simulated ) real time is profiled while a UI thread queries the statistics and
+ *   collects the trace, the trace is written as JSON. build with `-DCMAKE_CXX_FLAGS=-fsanitize=thread` to check for
+ *   data races.
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-audio-profiler`
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "AudioProfiler.h"
+
+using namespace klangwellen;
+using Clock = AudioProfiler::Clock;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t BLOCK_SIZE  = 256;
+
+static bool fPassed = true;
+
+static void check(const char* name, const bool condition) {
+    std::cout << (condition ? "    OK     " : "    FAILED ") << name << std::endl;
+    fPassed &= condition;
+}
+
+static Clock::duration period_fraction(const AudioProfiler& profiler, const double fraction) {
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(profiler.get_period() * fraction));
+}
+
+/* 1000 callbacks: 900 at 52% load, 90 at 92%, 10 at 150% ( overruns ), three start two periods after the previous one */
+static void check_statistics() {
+    std::cout << "statistics" << std::endl;
+    AudioProfiler     mProfiler(SAMPLE_RATE, BLOCK_SIZE);
+    Clock::time_point mStart = Clock::now();
+    for (uint32_t i = 0; i < 1000; i++) {
+        const double mLoad = i % 100 == 99 ? 1.5 : i % 10 == 9 ? 0.92 : 0.52;
+        mProfiler.record(mStart, mStart + period_fraction(mProfiler, mLoad));
+        mStart += period_fraction(mProfiler, i == 100 || i == 200 || i == 300 ? 2.0 : 1.0);
+    }
+
+    const AudioProfiler::Statistics mStatistics = mProfiler.get_statistics();
+    uint64_t                        mHistogram  = 0;
+    for (uint32_t i = 0; i < AudioProfiler::HISTOGRAM_BINS; i++) {
+        mHistogram += mProfiler.get_histogram(i);
+    }
+    const float mExpectedMean = (900 * 52.0f + 90 * 92.0f + 10 * 150.0f) / 1000.0f;
+    check("1000 callbacks", mStatistics.callbacks == 1000 && mHistogram == 1000);
+    check("10 overruns", mStatistics.overruns == 10);
+    check("3 late callbacks", mStatistics.late_callbacks == 3);
+    check("mean load 56.6%", std::fabs(mStatistics.mean_load - mExpectedMean) < 0.1f);
+    check("max load 150%", std::fabs(mStatistics.max_load - 150.0f) < 0.1f);
+    check("900 callbacks at 50 ... 55%", mProfiler.get_histogram(10) == 900);
+    check("50th percentile 55%", std::fabs(mProfiler.get_percentile(50.0f) - 55.0f) < 0.01f);
+    check("99th percentile 95%", std::fabs(mProfiler.get_percentile(99.0f) - 95.0f) < 0.01f);
+    check("100th percentile in the last bin", mProfiler.get_percentile(100.0f) >= 150.0f);
+
+    mProfiler.reset();
+    mProfiler.record(mStart, mStart + period_fraction(mProfiler, 0.25));
+    const AudioProfiler::Statistics mReset = mProfiler.get_statistics();
+    check("reset with the next callback", mReset.callbacks == 1 && mReset.overruns == 0 && std::fabs(mReset.max_load - 25.0f) < 0.1f);
+}
+
+static void check_overhead() {
+    std::cout << "overhead" << std::endl;
+    static constexpr uint32_t ITERATIONS = 1000000;
+    AudioProfiler             mProfiler(SAMPLE_RATE, BLOCK_SIZE);
+    mProfiler.enable_trace(false);
+    const auto mStart = Clock::now();
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        AudioProfiler::Scope mScope(mProfiler);
+    }
+    const double mNanos = std::chrono::duration<double, std::nano>(Clock::now() - mStart).count() / ITERATIONS;
+    std::cout << std::fixed << std::setprecision(3) << "    " << mNanos << " ns per callback ( "
+              << 100.0 * mNanos / (mProfiler.get_period() * 1000000000.0) << "% of the period of " << BLOCK_SIZE << " samples, "
+              << 100.0 * mNanos / (64.0 / SAMPLE_RATE * 1000000000.0) << "% of the period of 64 samples )" << std::endl;
+    check("below 1% of 64 samples at 48KHz", mNanos < 0.01 * 64.0 / SAMPLE_RATE * 1000000000.0);
+}
+
+static void check_threads() {
+    std::cout << "audio and UI thread" << std::endl;
+    AudioProfiler     mProfiler(SAMPLE_RATE, BLOCK_SIZE);
+    std::atomic<bool> mRunning{true};
+    uint64_t          mCollected = 0;
+    float             mMaxLoad   = 0.0f;
+    std::thread       mUI([&] {
+        while (mRunning.load()) {
+            mMaxLoad = std::max(mMaxLoad, mProfiler.get_statistics().load);
+            mCollected += mProfiler.collect_trace();
+            std::this_thread::sleep_for(std::chrono::milliseconds(16)); /* ~60 FPS */
+        }
+    });
+
+    /* ~1 sec of callbacks that spin for ~20% of the period */
+    const uint32_t mCallbacks = SAMPLE_RATE / BLOCK_SIZE;
+    auto           mNext      = Clock::now();
+    for (uint32_t i = 0; i < mCallbacks; i++) {
+        {
+            AudioProfiler::Scope mScope(mProfiler);
+            const auto           mEnd = Clock::now() + period_fraction(mProfiler, 0.2);
+            while (Clock::now() < mEnd) {}
+        }
+        mNext += period_fraction(mProfiler, 1.0);
+        std::this_thread::sleep_until(mNext);
+    }
+    mRunning.store(false);
+    mUI.join();
+
+    const std::string mPath = (std::filesystem::temp_directory_path() / "klangwellen-audio-profiler.json").string();
+    const bool        mWritten = mProfiler.write_trace(mPath);
+    std::ifstream     mFile(mPath);
+    std::stringstream mJSON;
+    mJSON << mFile.rdbuf();
+    const std::string mTrace = mJSON.str();
+    uint32_t          mEvents = 0;
+    for (size_t p = mTrace.find("\"ph\":\"X\""); p != std::string::npos; p = mTrace.find("\"ph\":\"X\"", p + 1)) {
+        mEvents++;
+    }
+    std::filesystem::remove(mPath);
+
+    const AudioProfiler::Statistics mStatistics = mProfiler.get_statistics();
+    std::cout << std::fixed << std::setprecision(1)
+              << "    " << mStatistics.callbacks << " callbacks, load " << mStatistics.mean_load << "% ( max " << mStatistics.max_load
+              << "%, 99th percentile " << mProfiler.get_percentile(99.0f) << "% ), " << mStatistics.overruns << " overruns, "
+              << mStatistics.late_callbacks << " late callbacks, " << mEvents << " callbacks in the trace" << std::endl;
+    check("all callbacks counted", mStatistics.callbacks == mCallbacks);
+    check("load seen by the UI thread", mMaxLoad > 0.0f);
+    check("mean load of at least 20%", mStatistics.mean_load >= 20.0f);
+    check("all callbacks in the trace", mWritten && mEvents == mCallbacks && mCollected <= mCallbacks);
+    check("trace is complete JSON", mTrace.rfind("]}\n") == mTrace.size() - 3);
+}
+
+int main() {
+    std::cout << "+++ klangwellen audio profiler ( " << SAMPLE_RATE << " Hz, " << BLOCK_SIZE << " samples per block )" << std::endl
+              << std::endl;
+    check_statistics();
+    check_overhead();
+    check_threads();
+    std::cout << (fPassed ? "OK" : "FAILED") << std::endl;
+    return fPassed ? 0 : 1;
+}
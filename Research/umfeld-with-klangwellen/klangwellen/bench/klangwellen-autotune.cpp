@@ -0,0 +1,129 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * measures `Autotune` with and without formant correction against the real-time budget of a block of 256 samples at
+ * 44.1, 48 and 96KHz. the input is a detuned A ( 450Hz ), the benchmark checks that the detected frequency is 450Hz and that the output is corrected to
+ * 440Hz ( within the resolution of the pitch detection ). blocks are timed in CPU time, so that preemption of the
+ * benchmark by other processes does not count against the budget.
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-autotune`
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Autotune.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t BLOCK_SIZE       = 256;
+static constexpr float    DURATION         = 10.0f;
+static constexpr float    INPUT_FREQUENCY  = 450.0f;
+static constexpr float    TARGET_FREQUENCY = 440.0f;
+static constexpr float    TOLERANCE        = 20.0f; /* in cents */
+
+static float cents(const float frequency, const float reference) {
+    return 1200.0f * std::fabs(log2f(frequency / reference));
+}
+
+/* frequency from the interpolated rising zero crossings of `signal` */
+static float frequency(const float* signal, const uint32_t length, const uint32_t sample_rate) {
+    float    mFirst     = -1.0f;
+    float    mLast      = -1.0f;
+    uint32_t mCrossings = 0;
+    for (uint32_t i = 1; i < length; i++) {
+        if (signal[i - 1] < 0.0f && signal[i] >= 0.0f) {
+            const float mPosition = static_cast<float>(i - 1) + signal[i - 1] / (signal[i - 1] - signal[i]);
+            if (mFirst < 0.0f) {
+                mFirst = mPosition;
+            } else {
+                mCrossings++;
+            }
+            mLast = mPosition;
+        }
+    }
+    return mCrossings > 0 ? static_cast<float>(mCrossings) * static_cast<float>(sample_rate) / (mLast - mFirst) : 0.0f;
+}
+
+int main() {
+    std::cout << std::fixed << std::setprecision(3)
+              << "+++ klangwellen autotune ( " << BLOCK_SIZE << " samples per block, " << DURATION << " sec )" << std::endl
+              << std::endl
+              << "sample rate  formant  budget (µs)  mean (µs)  p99 (µs)  max (µs)  CPU (%)  detected (Hz)  output (Hz)" << std::endl;
+
+    bool mPassed = true;
+    for (const uint32_t mSampleRate: {44100u, 48000u, 96000u}) {
+        for (const bool mFormantCorrection: {false, true}) {
+            Autotune mAutotune(mSampleRate);
+            mAutotune.set_formant_correction(mFormantCorrection);
+
+            const uint32_t     mBlocks = static_cast<uint32_t>(DURATION * static_cast<float>(mSampleRate)) / BLOCK_SIZE;
+            std::vector<float> mOutput(mBlocks * BLOCK_SIZE);
+            std::vector<float> mTimes(mBlocks);
+            const double       mIncrement = TWO_PI * INPUT_FREQUENCY / mSampleRate;
+            for (uint32_t i = 0; i < mOutput.size(); i++) {
+                mOutput[i] = 0.5f * static_cast<float>(sin(mIncrement * i));
+            }
+
+            for (uint32_t b = 0; b < mBlocks; b++) {
+                const std::clock_t mStart = std::clock();
+                mAutotune.process(mOutput.data() + b * BLOCK_SIZE, BLOCK_SIZE);
+                mTimes[b] = static_cast<float>(std::clock() - mStart) * 1000000.0f / CLOCKS_PER_SEC;
+            }
+
+            /* the first second settles */
+            const uint32_t mSettled   = mSampleRate;
+            const float    mDetected  = mAutotune.get_frequency();
+            const float    mCorrected = frequency(mOutput.data() + mSettled, mOutput.size() - mSettled, mSampleRate);
+
+            const float mBudget = 1000000.0f * BLOCK_SIZE / static_cast<float>(mSampleRate);
+            float       mMean   = 0.0f;
+            for (const float mTime: mTimes) {
+                mMean += mTime;
+            }
+            mMean /= static_cast<float>(mBlocks);
+            std::sort(mTimes.begin(), mTimes.end());
+            const float mP99 = mTimes[mBlocks * 99 / 100];
+            const float mMax = mTimes.back();
+
+            std::cout << std::setw(11) << mSampleRate
+                      << std::setw(9) << (mFormantCorrection ? "yes" : "no")
+                      << std::setw(13) << mBudget
+                      << std::setw(11) << mMean
+                      << std::setw(10) << mP99
+                      << std::setw(10) << mMax
+                      << std::setw(9) << 100.0f * mMean / mBudget
+                      << std::setw(15) << mDetected
+                      << std::setw(13) << mCorrected << std::endl;
+
+            mPassed &= cents(mDetected, INPUT_FREQUENCY) < TOLERANCE;
+            mPassed &= cents(mCorrected, TARGET_FREQUENCY) < TOLERANCE;
+            mPassed &= mP99 < mBudget;
+        }
+    }
+
+    std::cout << std::endl
+              << (mPassed ? "OK" : "FAILED") << std::endl;
+    return mPassed ? 0 : 1;
+}
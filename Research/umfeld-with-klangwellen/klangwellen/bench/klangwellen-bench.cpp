@@ -0,0 +1,506 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BeatDSP.h"
+#include "Delay.h"
+#include "Envelope.h"
+#include "Filter.h"
+#include "Gain.h"
+#include "KlangWellen.h"
+#include "Noise.h"
+#include "Reverb.h"
+#include "ReverbReference.h"
+#include "Sampler.h"
+#include "Stream.h"
+#include "Vocoder.h"
+#include "VocoderReference.h"
+#include "Wavetable.h"
+#include "WavetableBank.h"
+
+using namespace klangwellen;
+
+/**
+ * measures ns/sample of the per-sample `process()` against the block `process(float*, uint32_t)` of
+ * each processor at different block sizes and checks that both produce the same samples ( or match
+ * within a tolerance if the compiler contracts floating-point operations differently ).
+ *
+ * the `Vocoder` is measured against `VocoderReference` ( the scalar implementation ) for mono and
+ * stereo carriers at different numbers of bands. the `Reverb` is measured against `ReverbReference` ( the
+ * generated code that processes one comb filter at a time ) for the stereo block and the per-sample
+ * `AudioSignal` variant.
+ *
+ * polyphonic `Wavetable` oscillators are measured with a private table per voice against references
+ * to a shared `WavetableBank`, reporting memory, cost per voice and aliasing.
+ */
+
+static constexpr uint32_t SAMPLE_RATE   = KlangWellen::DEFAULT_SAMPLE_RATE;
+static constexpr uint32_t NUM_SAMPLES   = 1 << 20;
+static constexpr uint32_t BLOCK_SIZES[] = {64, 256, 1024};
+static constexpr uint32_t RANDOM_SEED   = 23;
+
+static constexpr uint32_t VOCODER_NUM_SAMPLES = 1 << 17;
+static constexpr uint32_t VOCODER_BLOCK_SIZE  = 256;
+static constexpr uint8_t  VOCODER_BANDS[]     = {16, 24, 64};
+
+static constexpr uint32_t REVERB_NUM_SAMPLES = 1 << 18;
+static constexpr uint32_t REVERB_BLOCK_SIZE  = 256;
+
+static constexpr uint32_t VOICES[]           = {64, 256};
+static constexpr uint32_t VOICES_NUM_SAMPLES = SAMPLE_RATE / 4;
+static constexpr uint32_t VOICES_BLOCK_SIZE  = 256;
+static constexpr uint32_t VOICES_TABLE_SIZE  = 2048;
+
+using Run = std::function<void(float* buffer, uint32_t length)>;
+
+/* creates a fresh processor and returns one function that renders a block sample by sample and one
+ * that renders it with the block function */
+using Setup = std::function<void(Run& per_sample, Run& block)>;
+
+class SineProvider final : public StreamDataProvider {
+public:
+    void fill_buffer(float* buffer, const uint32_t length) override {
+        for (uint32_t i = 0; i < length; i++) {
+            buffer[i] = sinf(static_cast<float>(fPosition++) * 0.01f);
+        }
+    }
+
+private:
+    uint64_t fPosition = 0;
+};
+
+class BeatCounter final : public BeatListener {
+public:
+    void beat(const uint32_t beat_counter) override {
+        fBeats++;
+        (void) beat_counter;
+    }
+
+    uint32_t fBeats = 0;
+};
+
+/* with floating-point contraction ( e.g FMA ) enabled, the compiler may round differently in the two paths */
+static constexpr float TOLERANCE = 1e-4f;
+
+static const char* compare(const std::vector<float>& reference, const std::vector<float>& output, bool& passed) {
+    if (reference == output) {
+        return "identical";
+    }
+    float mPeak       = 1.0f;
+    float mDifference = 0.0f;
+    for (size_t i = 0; i < reference.size(); i++) {
+        mPeak       = std::max(mPeak, std::fabs(reference[i]));
+        mDifference = std::max(mDifference, std::fabs(reference[i] - output[i]));
+    }
+    if (reference.size() == output.size() && mDifference <= TOLERANCE * mPeak) {
+        return "matches";
+    }
+    passed = false;
+    return "DIFFERS";
+}
+
+static const std::vector<float>& input() {
+    static std::vector<float> mInput;
+    if (mInput.empty()) {
+        mInput.resize(NUM_SAMPLES);
+        for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+            mInput[i] = 0.5f * sinf(static_cast<float>(i) * 0.03f);
+        }
+    }
+    return mInput;
+}
+
+static double render(const Run& run, const uint32_t block_size, std::vector<float>& output) {
+    srand(RANDOM_SEED);
+    KlangWellen::x32Seed = RANDOM_SEED;
+    output            = input();
+    const auto mStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < NUM_SAMPLES; i += block_size) {
+        run(output.data() + i, block_size);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+}
+
+static bool bench(const char* name, const Setup& setup) {
+    bool        mPassed = true;
+    const char* mResult = "identical";
+    std::cout << std::left << std::setw(18) << name << std::right;
+    for (const uint32_t mBlockSize: BLOCK_SIZES) {
+        std::vector<float> mOutputPerSample;
+        std::vector<float> mOutputBlock;
+        Run                mPerSample;
+        Run                mBlock;
+        setup(mPerSample, mBlock);
+        const double mSecondsPerSample = render(mPerSample, mBlockSize, mOutputPerSample);
+        setup(mPerSample, mBlock);
+        const double mSecondsBlock = render(mBlock, mBlockSize, mOutputBlock);
+        const char*  mCompare      = compare(mOutputPerSample, mOutputBlock, mPassed);
+        if (strcmp(mResult, "identical") == 0 || strcmp(mCompare, "DIFFERS") == 0) {
+            mResult = mCompare;
+        }
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << mSecondsPerSample * 1e9 / NUM_SAMPLES
+                  << std::setw(8) << mSecondsBlock * 1e9 / NUM_SAMPLES << " |";
+    }
+    std::cout << "  " << mResult << std::endl;
+    return mPassed;
+}
+
+template<class VOCODER>
+static double render_vocoder(VOCODER&                  vocoder,
+                             const bool                stereo,
+                             const std::vector<float>& carrier_left,
+                             const std::vector<float>& carrier_right,
+                             const std::vector<float>& modulator,
+                             std::vector<float>&       output_left,
+                             std::vector<float>&       output_right) {
+    std::vector<float> mCarrierLeft  = carrier_left;
+    std::vector<float> mCarrierRight = carrier_right;
+    std::vector<float> mModulator    = modulator;
+    output_left.assign(VOCODER_NUM_SAMPLES, 0.0f);
+    output_right.assign(VOCODER_NUM_SAMPLES, 0.0f);
+    const auto mStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < VOCODER_NUM_SAMPLES; i += VOCODER_BLOCK_SIZE) {
+        if (stereo) {
+            vocoder.process(mCarrierLeft.data() + i, mCarrierRight.data() + i, mModulator.data() + i,
+                            output_left.data() + i, output_right.data() + i, VOCODER_BLOCK_SIZE);
+        } else {
+            vocoder.process(mCarrierLeft.data() + i, mModulator.data() + i, output_left.data() + i, VOCODER_BLOCK_SIZE);
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+}
+
+static bool bench_vocoder(const uint8_t bands, const bool stereo) {
+    std::vector<float> mCarrierLeft(VOCODER_NUM_SAMPLES);
+    std::vector<float> mCarrierRight(VOCODER_NUM_SAMPLES);
+    std::vector<float> mModulator(VOCODER_NUM_SAMPLES);
+    for (uint32_t i = 0; i < VOCODER_NUM_SAMPLES; i++) {
+        mCarrierLeft[i]  = KlangWellen::mod(static_cast<float>(i) * 0.0123f, 2.0f) - 1.0f;
+        mCarrierRight[i] = KlangWellen::mod(static_cast<float>(i) * 0.0171f, 2.0f) - 1.0f;
+        mModulator[i]    = sinf(static_cast<float>(i) * 0.05f) * (0.5f + 0.5f * sinf(static_cast<float>(i) * 0.0007f));
+    }
+
+    std::vector<float> mReferenceLeft, mReferenceRight, mOutputLeft, mOutputRight;
+    auto               mReference       = std::make_unique<VocoderReference>(bands, 4, SAMPLE_RATE);
+    const double       mSecondsScalar   = render_vocoder(*mReference, stereo, mCarrierLeft, mCarrierRight, mModulator, mReferenceLeft, mReferenceRight);
+    auto               mVocoder         = std::make_unique<Vocoder>(bands, 4, SAMPLE_RATE);
+    const double       mSecondsParallel = render_vocoder(*mVocoder, stereo, mCarrierLeft, mCarrierRight, mModulator, mOutputLeft, mOutputRight);
+
+    bool        mPassed = true;
+    const char* mResult = compare(mReferenceLeft, mOutputLeft, mPassed);
+    if (stereo && strcmp(compare(mReferenceRight, mOutputRight, mPassed), "identical") != 0) {
+        mResult = mPassed ? "matches" : "DIFFERS";
+    }
+    std::cout << std::left << std::setw(18) << (std::string("Vocoder ") + (stereo ? "stereo " : "mono ") + std::to_string(bands)) << std::right
+              << std::fixed << std::setprecision(2)
+              << std::setw(8) << mSecondsScalar * 1e9 / VOCODER_NUM_SAMPLES
+              << std::setw(8) << mSecondsParallel * 1e9 / VOCODER_NUM_SAMPLES << " |"
+              << std::setw(7) << mSecondsScalar / mSecondsParallel << "x"
+              << "  " << mResult << std::endl;
+    return mPassed;
+}
+
+template<class REVERB>
+static double render_reverb(REVERB& reverb, const bool block, std::vector<float>& output_left, std::vector<float>& output_right) {
+    output_left.resize(REVERB_NUM_SAMPLES);
+    output_right.resize(REVERB_NUM_SAMPLES);
+    for (uint32_t i = 0; i < REVERB_NUM_SAMPLES; i++) {
+        output_left[i]  = KlangWellen::mod(static_cast<float>(i) * 0.0123f, 2.0f) - 1.0f;
+        output_right[i] = sinf(static_cast<float>(i) * 0.05f) * (i % 20000 < 4000 ? 1.0f : 0.0f);
+    }
+    reverb.set_roomsize(0.9f);
+    reverb.set_damp(0.3f);
+    reverb.set_wet(0.6f);
+    const auto mStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < REVERB_NUM_SAMPLES; i += REVERB_BLOCK_SIZE) {
+        if (block) {
+            reverb.process(output_left.data() + i, output_right.data() + i, REVERB_BLOCK_SIZE);
+        } else {
+            for (uint32_t j = i; j < i + REVERB_BLOCK_SIZE; j++) {
+                AudioSignal mSignal;
+                mSignal.left  = output_left[j];
+                mSignal.right = output_right[j];
+                reverb.process(mSignal);
+                output_left[j]  = mSignal.left;
+                output_right[j] = mSignal.right;
+            }
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+}
+
+static bool bench_reverb(const bool block) {
+    std::vector<float> mReferenceLeft, mReferenceRight, mOutputLeft, mOutputRight;
+    auto               mReference       = std::make_unique<ReverbReference>();
+    const double       mSecondsScalar   = render_reverb(*mReference, block, mReferenceLeft, mReferenceRight);
+    auto               mReverb          = std::make_unique<Reverb>();
+    const double       mSecondsParallel = render_reverb(*mReverb, block, mOutputLeft, mOutputRight);
+
+    bool        mPassed = true;
+    const char* mResult = compare(mReferenceLeft, mOutputLeft, mPassed);
+    if (strcmp(compare(mReferenceRight, mOutputRight, mPassed), "identical") != 0) {
+        mResult = mPassed ? "matches" : "DIFFERS";
+    }
+    std::cout << std::left << std::setw(18) << (block ? "Reverb block" : "Reverb AudioSignal") << std::right
+              << std::fixed << std::setprecision(2)
+              << std::setw(8) << mSecondsScalar * 1e9 / REVERB_NUM_SAMPLES
+              << std::setw(8) << mSecondsParallel * 1e9 / REVERB_NUM_SAMPLES << " |"
+              << std::setw(7) << mSecondsScalar / mSecondsParallel << "x"
+              << "  " << mResult << std::endl;
+    return mPassed;
+}
+
+/* ratio of the energy outside the harmonics of `frequency` to the total energy in dB ( one second of a sawtooth ) */
+static float aliasing(Wavetable& oscillator, const float frequency) {
+    std::vector<float> mSignal(SAMPLE_RATE);
+    oscillator.set_frequency(frequency);
+    oscillator.set_amplitude(1.0f);
+    oscillator.process(mSignal.data(), SAMPLE_RATE);
+    double mTotal = 0.0;
+    for (const float mSample: mSignal) {
+        mTotal += mSample * mSample;
+    }
+    /* goertzel at each harmonic, bins are 1 Hz apart */
+    double mHarmonic = 0.0;
+    for (float f = frequency; f < SAMPLE_RATE * 0.5f; f += frequency) {
+        const double mCoefficient = 2.0 * cos(2.0 * M_PI * f / SAMPLE_RATE);
+        double       s1 = 0.0, s2 = 0.0;
+        for (const float mSample: mSignal) {
+            const double s0 = mSample + mCoefficient * s1 - s2;
+            s2              = s1;
+            s1              = s0;
+        }
+        mHarmonic += 2.0 * (s1 * s1 + s2 * s2 - mCoefficient * s1 * s2) / SAMPLE_RATE;
+    }
+    return static_cast<float>(10.0 * log10(std::max(mTotal - mHarmonic, 1e-12) / mTotal));
+}
+
+static void bench_voices(const uint32_t num_voices, const bool shared_bank) {
+    std::vector<std::unique_ptr<Wavetable>> mVoices;
+    size_t                                  mBytes = 0;
+    std::shared_ptr<const WavetableBank>    mBank;
+    if (shared_bank) {
+        mBank  = WavetableBank::shared(KlangWellen::WAVEFORM_SAWTOOTH, VOICES_TABLE_SIZE, SAMPLE_RATE);
+        mBytes = mBank->get_memory_size();
+    }
+    for (uint32_t i = 0; i < num_voices; i++) {
+        if (shared_bank) {
+            mVoices.emplace_back(new Wavetable(mBank, SAMPLE_RATE));
+        } else {
+            mVoices.emplace_back(new Wavetable(VOICES_TABLE_SIZE, SAMPLE_RATE));
+            mVoices.back()->set_waveform(KlangWellen::WAVEFORM_SAWTOOTH);
+            mBytes += VOICES_TABLE_SIZE * sizeof(float);
+        }
+        mBytes += sizeof(Wavetable);
+        mVoices.back()->set_interpolation(KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR);
+        mVoices.back()->set_frequency(KlangWellen::midi_note_to_frequency(36 + i % 60));
+    }
+
+    float      mBlock[VOICES_BLOCK_SIZE];
+    float      mMix[VOICES_BLOCK_SIZE];
+    const auto mStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < VOICES_NUM_SAMPLES; i += VOICES_BLOCK_SIZE) {
+        std::fill_n(mMix, VOICES_BLOCK_SIZE, 0.0f);
+        for (auto& mVoice: mVoices) {
+            mVoice->process(mBlock, VOICES_BLOCK_SIZE);
+            for (uint32_t j = 0; j < VOICES_BLOCK_SIZE; j++) {
+                mMix[j] += mBlock[j];
+            }
+        }
+    }
+    const double mSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+
+    Wavetable mProbe = shared_bank ? Wavetable(mBank, SAMPLE_RATE) : Wavetable(VOICES_TABLE_SIZE, SAMPLE_RATE);
+    if (!shared_bank) {
+        mProbe.set_waveform(KlangWellen::WAVEFORM_SAWTOOTH);
+    }
+    mProbe.set_interpolation(KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR);
+    std::cout << std::left << std::setw(18) << ((shared_bank ? "bank " : "private ") + std::to_string(num_voices)) << std::right
+              << std::fixed << std::setprecision(1)
+              << std::setw(10) << mBytes / 1024.0 << " KB"
+              << std::setw(10) << std::setprecision(2) << mSeconds * 1e9 / (VOICES_NUM_SAMPLES * num_voices) << " ns"
+              << std::setw(10) << std::setprecision(1) << aliasing(mProbe, 3100.0f) << " dB" << std::endl;
+}
+
+template<class T>
+static void bind_processor(const std::shared_ptr<T>& processor, Run& per_sample, Run& block) {
+    per_sample = [processor](float* buffer, const uint32_t length) {
+        for (uint32_t i = 0; i < length; i++) {
+            buffer[i] = processor->process(buffer[i]);
+        }
+    };
+    block = [processor](float* buffer, const uint32_t length) {
+        processor->process(buffer, length);
+    };
+}
+
+template<class T>
+static void bind_generator(const std::shared_ptr<T>& processor, Run& per_sample, Run& block) {
+    per_sample = [processor](float* buffer, const uint32_t length) {
+        for (uint32_t i = 0; i < length; i++) {
+            buffer[i] = processor->process();
+        }
+    };
+    block = [processor](float* buffer, const uint32_t length) {
+        processor->process(buffer, length);
+    };
+}
+
+static Setup wavetable(const uint8_t interpolation) {
+    return [interpolation](Run& per_sample, Run& block) {
+        auto mWavetable = std::make_shared<Wavetable>(KlangWellen::DEFAULT_WAVETABLE_SIZE, SAMPLE_RATE);
+        Wavetable::fill(mWavetable->get_wavetable(), mWavetable->get_wavetable_size(), KlangWellen::WAVEFORM_SINE);
+        mWavetable->set_interpolation(interpolation);
+        mWavetable->set_frequency(441.3f);
+        mWavetable->set_amplitude(0.5f, 300);
+        bind_generator(mWavetable, per_sample, block);
+    };
+}
+
+static Setup noise(const uint8_t type) {
+    return [type](Run& per_sample, Run& block) {
+        auto mNoise = std::make_shared<Noise>();
+        mNoise->set_type(type);
+        mNoise->set_amplitude(0.25f);
+        bind_generator(mNoise, per_sample, block);
+    };
+}
+
+int main() {
+    std::cout << "+++ klangwellen benchmark ( ns/sample, per-sample vs block )" << std::endl
+              << std::endl
+              << "samples     : " << NUM_SAMPLES << std::endl
+              << "sample rate : " << SAMPLE_RATE << std::endl
+              << std::endl
+              << std::left << std::setw(18) << "block size" << std::right;
+    for (const uint32_t mBlockSize: BLOCK_SIZES) {
+        std::cout << std::setw(16) << mBlockSize << " |";
+    }
+    std::cout << std::endl;
+
+    bool mPassed = true;
+
+    mPassed &= bench("Gain", [](Run& per_sample, Run& block) {
+        auto mGain = std::make_shared<Gain>();
+        mGain->set_gain(0.7f);
+        bind_processor(mGain, per_sample, block);
+    });
+
+    mPassed &= bench("Filter", [](Run& per_sample, Run& block) {
+        auto mFilter = std::make_shared<Filter>(Filter::LPF, 0.0f, 800.0f, 1.0f, false, SAMPLE_RATE);
+        bind_processor(mFilter, per_sample, block);
+    });
+
+    mPassed &= bench("Delay", [](Run& per_sample, Run& block) {
+        auto mDelay = std::make_shared<Delay>(0.0117f, 0.6f, 0.5f, SAMPLE_RATE);
+        bind_processor(mDelay, per_sample, block);
+    });
+
+    mPassed &= bench("Delay cubic", [](Run& per_sample, Run& block) {
+        auto mDelay = std::make_shared<Delay>(0.01234f, 0.6f, 0.5f, SAMPLE_RATE);
+        mDelay->set_interpolation(Delay::INTERPOLATE_CUBIC);
+        bind_processor(mDelay, per_sample, block);
+    });
+
+    mPassed &= bench("Delay modulated", [](Run& per_sample, Run& block) {
+        auto mDelay = std::make_shared<Delay>(0.007f, 0.3f, 0.5f, SAMPLE_RATE, 0.01f);
+        mDelay->set_modulation(0.002f, 0.5f);
+        bind_processor(mDelay, per_sample, block);
+    });
+
+    mPassed &= bench("Reverb", [](Run& per_sample, Run& block) {
+        auto mReverb = std::make_shared<Reverb>();
+        bind_processor(mReverb, per_sample, block);
+    });
+
+    mPassed &= bench("Wavetable", wavetable(KlangWellen::WAVESHAPE_INTERPOLATE_NONE));
+    mPassed &= bench("Wavetable linear", wavetable(KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR));
+    mPassed &= bench("Wavetable cubic", wavetable(KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC));
+
+    mPassed &= bench("Sampler", [](Run& per_sample, Run& block) {
+        auto mSampler = std::make_shared<Sampler>(SAMPLE_RATE / 10, SAMPLE_RATE);
+        for (int32_t i = 0; i < mSampler->get_buffer_length(); i++) {
+            mSampler->get_buffer()[i] = sinf(static_cast<float>(i) * 0.05f);
+        }
+        mSampler->interpolate_samples(true);
+        mSampler->set_speed(1.37f);
+        mSampler->set_loop_all();
+        mSampler->play();
+        bind_generator(mSampler, per_sample, block);
+    });
+
+    mPassed &= bench("Stream", [](Run& per_sample, Run& block) {
+        auto mProvider = std::make_shared<SineProvider>();
+        auto mStream   = std::shared_ptr<Stream>(new Stream(mProvider.get(), 8192), [mProvider](const Stream* s) { delete s; });
+        mStream->set_speed(1.21f);
+        bind_generator(mStream, per_sample, block);
+    });
+
+    mPassed &= bench("Noise white", noise(KlangWellen::NOISE_WHITE));
+    mPassed &= bench("Noise pink", noise(KlangWellen::NOISE_PINK));
+    mPassed &= bench("Noise simplex", noise(KlangWellen::NOISE_SIMPLEX));
+
+    mPassed &= bench("Envelope", [](Run& per_sample, Run& block) {
+        auto mEnvelope = std::make_shared<Envelope>(SAMPLE_RATE);
+        mEnvelope->add_stage(0.0f, 0.013f);
+        mEnvelope->add_stage(1.0f, 0.021f);
+        mEnvelope->add_stage(0.3f, 0.005f);
+        mEnvelope->add_stage(0.0f);
+        mEnvelope->enable_loop(true);
+        mEnvelope->start();
+        bind_generator(mEnvelope, per_sample, block);
+    });
+
+    mPassed &= bench("BeatDSP", [](Run& per_sample, Run& block) {
+        auto mCounter = std::make_shared<BeatCounter>();
+        auto mBeat    = std::shared_ptr<BeatDSP>(new BeatDSP(SAMPLE_RATE), [mCounter](const BeatDSP* b) { delete b; });
+        mBeat->add_listener(mCounter.get());
+        mBeat->set_bpm(173.0f);
+        /* report the number of beats so far as output */
+        per_sample = [mBeat, mCounter](float* buffer, const uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) {
+                mBeat->process();
+            }
+            buffer[0] = static_cast<float>(mCounter->fBeats);
+        };
+        block = [mBeat, mCounter](float* buffer, const uint32_t length) {
+            mBeat->process(buffer, length);
+            buffer[0] = static_cast<float>(mCounter->fBeats);
+        };
+    });
+
+    std::cout << std::endl
+              << std::left << std::setw(18) << "bands" << std::right
+              << std::setw(16) << "scalar  lanes" << " |" << std::setw(8) << "speedup" << std::endl;
+    for (const bool mStereo: {false, true}) {
+        for (const uint8_t mBands: VOCODER_BANDS) {
+            mPassed &= bench_vocoder(mBands, mStereo);
+        }
+    }
+
+    std::cout << std::endl
+              << std::left << std::setw(18) << "reverb" << std::right
+              << std::setw(16) << "scalar  lanes" << " |" << std::setw(8) << "speedup" << std::endl;
+    for (const bool mBlock: {true, false}) {
+        mPassed &= bench_reverb(mBlock);
+    }
+
+    std::cout << std::endl
+              << std::left << std::setw(18) << "voices ( saw )" << std::right
+              << std::setw(13) << "memory" << std::setw(13) << "per voice" << std::setw(13) << "aliasing" << std::endl;
+    for (const uint32_t mVoices: VOICES) {
+        bench_voices(mVoices, false);
+        bench_voices(mVoices, true);
+    }
+
+    return mPassed ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * checks `EventQueue` against synchronous listeners:
+ *
+ * - a `Trigger` fed by an LFO retriggers an `ADSR`. the listener version calls `start()` and `stop()` from inside
+ *   `Trigger::process()` sample by sample, the queue version processes the trigger block by block and applies the
+ *   events at the end of the trigger block at their sample offset. both must render identical samples.
+ * - `BeatDSP` and `Sampler` events must carry the frames at which the listeners were called.
+ * - a UI thread drains events of a `BeatDSP` that runs in ( simulated ) real time, no events may be dropped or
+ *   reordered. build with `-DCMAKE_CXX_FLAGS=-fsanitize=thread` to check for data races.
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-event-queue`
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "ADSR.h"
+#include "BeatDSP.h"
+#include "EventQueue.h"
+#include "Sampler.h"
+#include "Trigger.h"
+#include "Wavetable.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t BLOCK_SIZE  = 256;
+static constexpr uint32_t BLOCKS      = SAMPLE_RATE / BLOCK_SIZE * 10; // ~10 sec
+
+static void setup(Wavetable& lfo, Wavetable& oscillator) {
+    Wavetable::fill(lfo.get_wavetable(), lfo.get_wavetable_size(), KlangWellen::WAVEFORM_SINE);
+    lfo.set_frequency(7.3f);
+    Wavetable::fill(oscillator.get_wavetable(), oscillator.get_wavetable_size(), KlangWellen::WAVEFORM_SAWTOOTH);
+    oscillator.set_frequency(110.0f);
+}
+
+/* reference: the listener is called from inside `Trigger::process()` */
+static std::vector<float> render_with_listener() {
+    struct Listener final : TriggerListener {
+        ADSR* adsr = nullptr;
+        void  trigger(const uint8_t event) override {
+            if (event == Trigger::EVENT_RISING_EDGE) {
+                adsr->start();
+            } else {
+                adsr->stop();
+            }
+        }
+    };
+
+    Wavetable mLFO(2048, SAMPLE_RATE);
+    Wavetable mOscillator(1024, SAMPLE_RATE);
+    ADSR      mADSR(SAMPLE_RATE);
+    Trigger   mTrigger;
+    Listener  mListener;
+    setup(mLFO, mOscillator);
+    mListener.adsr = &mADSR;
+    mTrigger.add_listener(&mListener);
+
+    std::vector<float> mOutput(BLOCKS * BLOCK_SIZE);
+    for (float& mSample: mOutput) {
+        mTrigger.process(mLFO.process());
+        mSample = mADSR.process(mOscillator.process());
+    }
+    return mOutput;
+}
+
+/* the trigger runs a block ahead of the oscillator, events are applied at their sample offset */
+static std::vector<float> render_with_queue() {
+    Wavetable  mLFO(2048, SAMPLE_RATE);
+    Wavetable  mOscillator(1024, SAMPLE_RATE);
+    ADSR       mADSR(SAMPLE_RATE);
+    Trigger    mTrigger;
+    EventQueue mEvents;
+    setup(mLFO, mOscillator);
+    mTrigger.set_event_queue(&mEvents);
+
+    std::vector<float> mOutput(BLOCKS * BLOCK_SIZE);
+    float              mControl[BLOCK_SIZE];
+    for (uint32_t b = 0; b < BLOCKS; b++) {
+        float* mBlock = mOutput.data() + b * BLOCK_SIZE;
+        mOscillator.process(mBlock, BLOCK_SIZE);
+
+        const uint64_t mBlockStart = mTrigger.get_frame();
+        mLFO.process(mControl, BLOCK_SIZE);
+        mTrigger.process(mControl, BLOCK_SIZE);
+
+        uint32_t mOffset = 0;
+        mEvents.drain([&](const Event& e) {
+            const uint32_t mEventOffset = static_cast<uint32_t>(e.frame - mBlockStart);
+            mADSR.process(mBlock + mOffset, mEventOffset - mOffset);
+            mOffset = mEventOffset;
+            if (e.type == Trigger::EVENT_RISING_EDGE) {
+                mADSR.start();
+            } else {
+                mADSR.stop();
+            }
+        });
+        mADSR.process(mBlock + mOffset, BLOCK_SIZE - mOffset);
+    }
+    return mOutput;
+}
+
+static bool check_beat_frames() {
+    struct Listener final : BeatListener {
+        const uint64_t*       frame = nullptr;
+        std::vector<uint64_t> frames;
+        void                  beat(const uint32_t beat_counter) override {
+            (void) beat_counter;
+            frames.push_back(*frame);
+        }
+    };
+
+    BeatDSP  mReference(SAMPLE_RATE);
+    Listener mListener;
+    uint64_t mFrame = 0;
+    mReference.set_interval(441.7f);
+    mListener.frame = &mFrame;
+    mReference.add_listener(&mListener);
+    for (; mFrame < BLOCKS * BLOCK_SIZE; mFrame++) {
+        mReference.process();
+    }
+
+    BeatDSP    mBeat(SAMPLE_RATE);
+    EventQueue mEvents;
+    mBeat.set_interval(441.7f);
+    mBeat.set_event_queue(&mEvents, 3);
+    bool     mMatches = true;
+    uint32_t mCount   = 0;
+    for (uint32_t b = 0; b < BLOCKS; b++) {
+        mBeat.process(nullptr, BLOCK_SIZE);
+        mEvents.drain([&](const Event& e) {
+            mMatches &= mCount < mListener.frames.size() && e.frame == mListener.frames[mCount];
+            mMatches &= e.type == BeatDSP::EVENT_BEAT && e.value == static_cast<int32_t>(mCount) && e.source == 3;
+            mCount++;
+        });
+    }
+    mMatches &= mCount == mListener.frames.size() && mCount > 0;
+    std::cout << "BeatDSP events             : " << mCount << " ( " << (mMatches ? "at the listener frames" : "MISMATCH") << " )" << std::endl;
+    return mMatches;
+}
+
+static bool check_sampler_frames() {
+    struct Listener final : SamplerListener {
+        const Sampler*        sampler = nullptr;
+        std::vector<uint64_t> frames;
+        void                  is_done() override {
+            frames.push_back(sampler->get_frame());
+        }
+    };
+
+    Sampler  mSampler(1000, SAMPLE_RATE);
+    Listener mListener;
+    for (int32_t i = 0; i < mSampler.get_buffer_length(); i++) {
+        mSampler.get_buffer()[i] = 0.5f;
+    }
+    mListener.sampler = &mSampler;
+    mSampler.add_listener(&mListener);
+    EventQueue mEvents;
+    mSampler.set_event_queue(&mEvents);
+
+    /* plays the sample four times, listeners are notified once per end */
+    float              mBlock[BLOCK_SIZE];
+    std::vector<Event> mReceived;
+    for (uint32_t b = 0; b < 64; b++) {
+        if (b % 16 == 0) {
+            mSampler.rewind();
+            mSampler.play();
+        }
+        mSampler.process(mBlock, BLOCK_SIZE);
+        mEvents.drain([&](const Event& e) { mReceived.push_back(e); });
+    }
+    bool mMatches = mReceived.size() == mListener.frames.size() && mReceived.size() == 4;
+    for (size_t i = 0; mMatches && i < mReceived.size(); i++) {
+        mMatches &= mReceived[i].frame == mListener.frames[i] && mReceived[i].type == Sampler::EVENT_DONE;
+    }
+    std::cout << "Sampler events             : " << mReceived.size() << " ( " << (mMatches ? "at the listener frames" : "MISMATCH") << " )" << std::endl;
+    return mMatches;
+}
+
+static bool check_ui_thread() {
+    BeatDSP    mBeat(SAMPLE_RATE);
+    EventQueue mEvents;
+    mBeat.set_interval(64.0f); /* 750 events per second */
+    mBeat.set_event_queue(&mEvents);
+
+    std::atomic<bool> mRunning{true};
+    uint32_t          mReceived = 0;
+    bool              mOrdered  = true;
+    std::thread       mUI([&] {
+        int32_t mLastBeat = -1;
+        while (mRunning.load()) {
+            mEvents.drain([&](const Event& e) {
+                mOrdered &= e.value == mLastBeat + 1;
+                mLastBeat = e.value;
+                mReceived++;
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(16)); /* ~60 FPS */
+        }
+        mReceived += mEvents.drain([&](const Event& e) { mOrdered &= e.value == ++mLastBeat; });
+    });
+
+    const uint32_t mBlocks = SAMPLE_RATE / BLOCK_SIZE; // ~1 sec
+    auto           mNext   = std::chrono::steady_clock::now();
+    for (uint32_t b = 0; b < mBlocks; b++) {
+        mBeat.process(nullptr, BLOCK_SIZE);
+        mNext += std::chrono::microseconds(1000000 * BLOCK_SIZE / SAMPLE_RATE);
+        std::this_thread::sleep_until(mNext);
+    }
+    mRunning.store(false);
+    mUI.join();
+
+    const uint32_t mBeats  = static_cast<uint32_t>(mBeat.get_beat_count() + 1);
+    const bool     mPassed = mOrdered && mReceived == mBeats && mEvents.get_dropped() == 0;
+    std::cout << "UI thread events           : " << mReceived << " of " << mBeats << " ( " << mEvents.get_dropped() << " dropped"
+              << (mOrdered ? "" : ", REORDERED") << " )" << std::endl;
+    return mPassed;
+}
+
+int main() {
+    std::cout << "+++ klangwellen event queue" << std::endl
+              << std::endl;
+
+    const std::vector<float> mListener = render_with_listener();
+    const std::vector<float> mQueue    = render_with_queue();
+    uint32_t                 mDiffers  = 0;
+    for (size_t i = 0; i < mListener.size(); i++) {
+        mDiffers += mListener[i] != mQueue[i] ? 1 : 0;
+    }
+    std::cout << "Trigger + ADSR retriggering: " << mDiffers << " of " << mListener.size() << " samples differ from the listener" << std::endl;
+
+    bool mPassed = mDiffers == 0;
+    mPassed &= check_beat_frames();
+    mPassed &= check_sampler_frames();
+    mPassed &= check_ui_thread();
+
+    std::cout << (mPassed ? "OK" : "FAILED") << std::endl;
+    return mPassed ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * renders an audio graph ( noise and an oscillator through a filter and a reverb, mixed with the input ) with
+ * `OfflineAudioDriver` faster than real time and checks that
+ *
+ * - two renders with the same seed are identical and a render with another seed differs,
+ * - an output written to a WAV file and read back as input passes through unchanged,
+ * - 16-bit PCM input is converted to float.
+ *
+ * it reports callbacks per second, the mean and worst callback duration and the real-time factor.
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-offline` or `ctest --test-dir build`
+ */
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Filter.h"
+#include "Noise.h"
+#include "OfflineAudioDriver.h"
+#include "Reverb.h"
+#include "Wavetable.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t BUFFER_SIZE = 256;
+static constexpr uint64_t FRAMES      = SAMPLE_RATE * 60; // 1 min
+
+/* the graph is created anew for every render, like an application that is started */
+static const OfflineAudioDriver::Statistics& render(OfflineAudioDriver& driver) {
+    WhiteNoiseFast mWhiteNoise;
+    PinkNoise      mPinkNoise;
+    Wavetable      mOscillator(1024, SAMPLE_RATE);
+    Filter         mFilter(Filter::LPF, 0.0f, 2000.0f, 1.0f, true, SAMPLE_RATE);
+    Reverb         mReverb;
+    Wavetable::fill(mOscillator.get_wavetable(), mOscillator.get_wavetable_size(), KlangWellen::WAVEFORM_SAWTOOTH);
+    mOscillator.set_frequency(110.0f);
+    mOscillator.set_amplitude(0.25f);
+
+    float mMono[BUFFER_SIZE];
+    return driver.render(FRAMES, [&](const float* input, float* output, const uint32_t frames) {
+        for (uint32_t i = 0; i < frames; i++) {
+            mMono[i] = mFilter.process(0.1f * mWhiteNoise.process() + 0.05f * mPinkNoise.process()) + mOscillator.process();
+        }
+        mReverb.process(mMono, frames);
+        const uint16_t mInputChannels = driver.get_input_channels();
+        for (uint32_t i = 0; i < frames; i++) {
+            const float mInput = mInputChannels > 0 ? input[i * mInputChannels] : 0.0f;
+            output[i * 2 + 0]  = mMono[i] + mInput;
+            output[i * 2 + 1]  = mMono[i] - mInput;
+        }
+    });
+}
+
+static void print(const char* name, const OfflineAudioDriver::Statistics& statistics) {
+    std::cout << std::setw(18) << name
+              << std::setw(11) << statistics.callbacks
+              << std::setw(13) << statistics.callbacks_per_second
+              << std::setw(12) << statistics.mean_callback_duration * 1000000.0
+              << std::setw(11) << statistics.max_callback_duration * 1000000.0
+              << std::setw(16) << statistics.realtime_factor << std::endl;
+}
+
+/* a 16-bit PCM WAV file of a ramp from -32768 to 32767 in steps of 256 */
+static bool write_pcm16(const std::string& path, std::vector<float>& expected) {
+    std::vector<int16_t> mSamples;
+    for (int32_t i = -32768; i < 32768; i += 256) {
+        mSamples.push_back(static_cast<int16_t>(i));
+        expected.push_back(static_cast<float>(i) / 32768.0f);
+    }
+    const uint32_t mDataSize = static_cast<uint32_t>(mSamples.size() * sizeof(int16_t));
+    const uint32_t mHeader[] = {36 + mDataSize, 0x45564157 /* WAVE */, 0x20746d66 /* fmt  */, 16,
+                                1 | 1 << 16 /* PCM, mono */, SAMPLE_RATE, SAMPLE_RATE * 2, 2 | 16 << 16, 0x61746164 /* data */, mDataSize};
+    std::ofstream  mFile(path, std::ios::binary);
+    mFile.write("RIFF", 4);
+    mFile.write(reinterpret_cast<const char*>(mHeader), sizeof(mHeader));
+    mFile.write(reinterpret_cast<const char*>(mSamples.data()), mDataSize);
+    return mFile.good();
+}
+
+int main() {
+    std::cout << std::fixed << std::setprecision(2)
+              << "+++ klangwellen offline audio driver ( " << SAMPLE_RATE << " Hz, " << BUFFER_SIZE << " frames per callback, "
+              << FRAMES / SAMPLE_RATE << " sec )" << std::endl
+              << std::endl
+              << "            render  callbacks  callbacks/s  mean (µs)  max (µs)  real-time factor" << std::endl;
+
+    const std::filesystem::path mDirectory = std::filesystem::temp_directory_path();
+    const std::string           mWAVFile   = (mDirectory / "klangwellen-offline.wav").string();
+    const std::string           mPCMFile   = (mDirectory / "klangwellen-offline-pcm16.wav").string();
+
+    OfflineAudioDriver mDriver(SAMPLE_RATE, 0, 2, BUFFER_SIZE);
+    print("seed 23", render(mDriver));
+    const std::vector<float> mReference = mDriver.get_output();
+    bool                     mPassed    = mDriver.write_output(mWAVFile);
+
+    print("seed 23 again", render(mDriver));
+    const bool mIdentical = mDriver.get_output() == mReference;
+
+    mDriver.set_seed(42);
+    print("seed 42", render(mDriver));
+    const bool mDiffers = mDriver.get_output() != mReference;
+
+    /* the output of the first render as input: the left channel is `graph + input` */
+    OfflineAudioDriver mInputDriver(SAMPLE_RATE, 1, 2, BUFFER_SIZE);
+    const bool         mInputRead = mInputDriver.set_input(mWAVFile);
+    print("seed 23 + input", render(mInputDriver));
+    bool mPassesThrough = mInputRead;
+    for (uint64_t i = 0; mPassesThrough && i < FRAMES; i++) {
+        mPassesThrough &= mInputDriver.get_output()[i * 2] == mReference[i * 2] + mReference[i * 2];
+    }
+
+    /* 16-bit PCM input */
+    std::vector<float> mExpected;
+    OfflineAudioDriver mPCMDriver(SAMPLE_RATE, 1, 1, BUFFER_SIZE);
+    bool               mPCM = write_pcm16(mPCMFile, mExpected) && mPCMDriver.set_input(mPCMFile);
+    mPCMDriver.render(mExpected.size() + BUFFER_SIZE, [](const float* input, float* output, const uint32_t frames) {
+        std::memcpy(output, input, frames * sizeof(float));
+    });
+    for (size_t i = 0; mPCM && i < mExpected.size(); i++) {
+        mPCM &= mPCMDriver.get_output()[i] == mExpected[i];
+    }
+    mPCM &= mPCMDriver.get_output()[mExpected.size()] == 0.0f; /* silence after the end of the file */
+
+    std::filesystem::remove(mWAVFile);
+    std::filesystem::remove(mPCMFile);
+
+    std::cout << std::endl
+              << "same seed            : " << (mIdentical ? "identical" : "DIFFERS") << std::endl
+              << "other seed           : " << (mDiffers ? "differs" : "IDENTICAL") << std::endl
+              << "WAV input            : " << (mPassesThrough ? "passes through" : "CHANGED") << std::endl
+              << "16-bit PCM input     : " << (mPCM ? "converted" : "WRONG") << std::endl;
+
+    mPassed &= mIdentical && mDiffers && mPassesThrough && mPCM;
+    std::cout << (mPassed ? "OK" : "FAILED") << std::endl;
+    return mPassed ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * stress test for `ParameterAutomation`. a control thread changes parameters of `Wavetable`, `Filter`, `Reverb`,
+ * `Delay` and `Sampler` every 100 µs while the audio thread renders blocks of 256 samples in ( simulated ) real time. two probe parameters
+ * check that scheduled changes are applied at the requested frame and that smoothed changes do not jump. build with
+ * `-DCMAKE_CXX_FLAGS=-fsanitize=thread` to check for data races.
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-parameter-stress`
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Delay.h"
+#include "Filter.h"
+#include "ParameterAutomation.h"
+#include "Reverb.h"
+#include "Sampler.h"
+#include "Wavetable.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE  = 48000;
+static constexpr uint32_t BLOCK_SIZE   = 256;
+static constexpr uint32_t BLOCKS       = SAMPLE_RATE / BLOCK_SIZE * 2; // ~2 sec
+static constexpr float    SMOOTHING_MS = 10.0f;
+
+int main() {
+    Wavetable mWavetable(WavetableBank::shared(KlangWellen::WAVEFORM_SAWTOOTH), SAMPLE_RATE);
+    Filter    mFilter;
+    Reverb    mReverb;
+    Delay     mDelay(0.25f, 0.5f, 0.3f, SAMPLE_RATE);
+    Sampler   mSampler(SAMPLE_RATE / 4);
+    for (int32_t i = 0; i < mSampler.get_buffer_length(); i++) {
+        mSampler.get_buffer()[i] = sinf(static_cast<float>(i) * 0.05f);
+    }
+    mSampler.set_loop_all();
+    mSampler.play();
+
+    /* probes record the value that is applied and are checked in the render callback */
+    float mScheduled = -1.0f;
+    float mSmoothed  = 0.0f;
+
+    ParameterAutomation<16, 1024> mParameters(SAMPLE_RATE);
+    const int16_t                 FREQUENCY = mParameters.add([&](const float v) { mWavetable.set_frequency(v); }, 220.0f, 20.0f);
+    const int16_t                 AMPLITUDE = mParameters.add([&](const float v) { mWavetable.set_amplitude(v); }, 0.5f, 10.0f);
+    const int16_t                 CUTOFF    = mParameters.add([&](const float v) { mFilter.set(Filter::LPF, 0.0f, v, 1.0f, SAMPLE_RATE); }, 1000.0f, 20.0f);
+    const int16_t                 ROOMSIZE  = mParameters.add([&](const float v) { mReverb.set_roomsize(v); }, 0.5f, 50.0f);
+    const int16_t                 WET       = mParameters.add([&](const float v) { mReverb.set_wet(v); }, 0.3f, 20.0f);
+    const int16_t                 DECAY     = mParameters.add([&](const float v) { mDelay.set_decay_rate(v); }, 0.5f, 20.0f);
+    const int16_t                 SPEED     = mParameters.add([&](const float v) { mSampler.set_speed(v); }, 1.0f, 20.0f);
+    const int16_t                 SCHEDULED = mParameters.add([&](const float v) { mScheduled = v; }, -1.0f);
+    const int16_t                 SMOOTHED  = mParameters.add([&](const float v) { mSmoothed = v; }, 0.0f, SMOOTHING_MS);
+
+    std::atomic<bool> mRunning{true};
+    uint32_t          mDropped   = 0;
+    uint32_t          mChanges   = 0;
+    std::thread       mControl([&] {
+        std::mt19937                          mRandom(42);
+        std::uniform_real_distribution<float> mUnit(0.0f, 1.0f);
+        uint64_t                              mLastScheduled = 0;
+        while (mRunning.load()) {
+            bool mQueued = true;
+            mQueued &= mParameters.set(FREQUENCY, 55.0f + mUnit(mRandom) * 880.0f);
+            mQueued &= mParameters.set(AMPLITUDE, mUnit(mRandom));
+            mQueued &= mParameters.set(CUTOFF, 100.0f + mUnit(mRandom) * 8000.0f);
+            mQueued &= mParameters.set(ROOMSIZE, mUnit(mRandom));
+            mQueued &= mParameters.set(WET, mUnit(mRandom));
+            mQueued &= mParameters.set(DECAY, mUnit(mRandom) * 0.9f);
+            mQueued &= mParameters.set(SPEED, 0.5f + mUnit(mRandom));
+            mQueued &= mParameters.set(SMOOTHED, mUnit(mRandom) > 0.5f ? 1.0f : 0.0f);
+            /* schedules a change for a frame ahead, the value is the frame it is expected at */
+            const uint64_t mFrame = mParameters.get_frame() + static_cast<uint64_t>(mUnit(mRandom) * 4 * BLOCK_SIZE);
+            if (mFrame > mLastScheduled) {
+                mQueued &= mParameters.set_at(SCHEDULED, static_cast<float>(mFrame), mFrame);
+                mLastScheduled = mFrame;
+            }
+            mChanges += 9;
+            mDropped += mQueued ? 0 : 1;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    uint32_t mScheduledChecked = 0;
+    uint32_t mScheduledMissed  = 0;
+    uint32_t mScheduledLate    = 0; /* requested for a frame that was already processed */
+    float    mMaxSmoothedStep  = 0.0f;
+    bool     mFinite           = true;
+    float    mBlock[BLOCK_SIZE];
+    float    mSamplerBlock[BLOCK_SIZE];
+    auto     mNext = std::chrono::steady_clock::now();
+    for (uint32_t b = 0; b < BLOCKS; b++) {
+        const uint64_t mBlockFrame = static_cast<uint64_t>(b) * BLOCK_SIZE;
+        float          mLastScheduled = mScheduled;
+        float          mLastSmoothed  = mSmoothed;
+        mParameters.process(BLOCK_SIZE, [&](const uint32_t offset, const uint32_t length) {
+            if (mScheduled != mLastScheduled) {
+                const bool mLate  = mScheduled < static_cast<float>(mBlockFrame);
+                const auto mFrame = static_cast<float>(mLate ? mBlockFrame : mBlockFrame + offset);
+                mScheduledChecked++;
+                mScheduledLate += mLate ? 1 : 0;
+                mScheduledMissed += (mLate && offset != 0) || (!mLate && mFrame != mScheduled) ? 1 : 0;
+                mLastScheduled = mScheduled;
+            }
+            mMaxSmoothedStep = std::max(mMaxSmoothedStep, std::fabs(mSmoothed - mLastSmoothed));
+            mLastSmoothed    = mSmoothed;
+
+            float* mOutput = mBlock + offset;
+            mWavetable.process(mOutput, length);
+            mFilter.process(mOutput, length);
+            mSampler.process(mSamplerBlock, length);
+            for (uint32_t i = 0; i < length; i++) {
+                mOutput[i] = mDelay.process(mOutput[i] + mSamplerBlock[i]);
+            }
+            mReverb.process(mOutput, length);
+        });
+        for (const float mSample: mBlock) {
+            mFinite &= std::isfinite(mSample);
+        }
+        mNext += std::chrono::microseconds(1000000 * BLOCK_SIZE / SAMPLE_RATE);
+        std::this_thread::sleep_until(mNext);
+    }
+    mRunning.store(false);
+    mControl.join();
+
+    /* a ramp of SMOOTHING_MS moves at most one control block per part */
+    const float mMaxStep = static_cast<float>(ParameterAutomation<>::CONTROL_BLOCK_SIZE) / (SMOOTHING_MS * 0.001f * SAMPLE_RATE);
+
+    std::cout << "+++ klangwellen parameter automation stress test" << std::endl
+              << std::endl
+              << "changes            : " << mChanges << " ( " << mDropped << " rounds with dropped changes )" << std::endl
+              << "scheduled changes  : " << mScheduledChecked << " ( " << mScheduledLate << " late, " << mScheduledMissed << " at the wrong frame )" << std::endl
+              << "max smoothed step  : " << mMaxSmoothedStep << " ( limit " << mMaxStep << " )" << std::endl;
+
+    const bool mPassed = mFinite && mScheduledChecked > 0 && mScheduledMissed == 0 && mMaxSmoothedStep <= mMaxStep + 1e-5f;
+    std::cout << (mPassed ? "OK" : "FAILED") << std::endl;
+    return mPassed ? 0 : 1;
+}
@@ -0,0 +1,414 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * offline render harness and golden-output regression test. every processor renders a test signal in blocks of 256
+ * samples ( as fast as possible ) into preallocated memory. the beginning of each render is compared against a golden
+ * file ( 32-bit float WAV ) in `bench/golden/` within a tolerance, the time it took is reported as ns/sample and as
+ * factor of real time:
+ *
+ * ```
+ * klangwellen-render [--update] [--output <directory>] [--timings <file.csv>] [<golden directory>]
+ * ```
+ *
+ * - `--update`  rewrites the golden files ( after an intended change of the output )
+ * - `--output`  writes the rendered signals as WAV files for listening
+ * - `--timings` compares ns/sample against the values stored in the file ( if it exists ) and stores the new values
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-render` or `ctest --test-dir build`
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ADSR.h"
+#include "Autotune.h"
+#include "Clamp.h"
+#include "Delay.h"
+#include "Envelope.h"
+#include "EnvelopeFollower.h"
+#include "FMSynthesis.h"
+#include "Filter.h"
+#include "FilterLowPassMoogLadder.h"
+#include "FilterVowelFormant.h"
+#include "Gain.h"
+#include "KlangWellen.h"
+#include "Noise.h"
+#include "Ramp.h"
+#include "Resonator.h"
+#include "Reverb.h"
+#include "RootMeanSquare.h"
+#include "SAM.h"
+#include "Sampler.h"
+#include "ScaleCollection.h"
+#include "Vocoder.h"
+#include "WAV.h"
+#include "Waveshaper.h"
+#include "Wavetable.h"
+#include "WavetableBank.h"
+
+using namespace klangwellen;
+
+#ifndef KLANGWELLEN_GOLDEN_DIRECTORY
+#define KLANGWELLEN_GOLDEN_DIRECTORY "bench/golden"
+#endif
+
+static constexpr uint32_t SAMPLE_RATE   = 48000;
+static constexpr uint32_t BLOCK_SIZE    = 256;
+static constexpr uint32_t RENDER_LENGTH = SAMPLE_RATE / BLOCK_SIZE * BLOCK_SIZE * 4; // ~4 sec
+static constexpr uint32_t GOLDEN_LENGTH = SAMPLE_RATE / 4;                          // compared and stored
+static constexpr uint32_t RANDOM_SEED   = 23;
+
+/* golden files may be rendered with a different compiler or floating-point contraction ( e.g FMA ) */
+static constexpr float TOLERANCE = 1e-3f;
+
+/* renders `length` samples in place, the buffer holds the test signal for processors */
+using Render = std::function<void(float* buffer, uint32_t length)>;
+
+struct Processor {
+    const char*             name;
+    std::function<Render()> create;
+};
+
+template<class T>
+static Render processor(const std::shared_ptr<T>& processor) {
+    return [processor](float* buffer, const uint32_t length) {
+        processor->process(buffer, length);
+    };
+}
+
+template<class T>
+static Render per_sample(const std::shared_ptr<T>& processor) {
+    return [processor](float* buffer, const uint32_t length) {
+        for (uint32_t i = 0; i < length; i++) {
+            buffer[i] = processor->process(buffer[i]);
+        }
+    };
+}
+
+/* a chirp from 50 Hz to 5 kHz, gated on for 150 ms every 250 ms */
+static const std::vector<float>& test_signal() {
+    static std::vector<float> mSignal;
+    if (mSignal.empty()) {
+        mSignal.resize(RENDER_LENGTH);
+        double mPhase = 0.0;
+        for (uint32_t i = 0; i < RENDER_LENGTH; i++) {
+            const double mFrequency = 50.0 * pow(100.0, static_cast<double>(i) / RENDER_LENGTH);
+            mPhase += mFrequency / SAMPLE_RATE;
+            mPhase -= floor(mPhase);
+            const bool mGate = i % (SAMPLE_RATE / 4) < SAMPLE_RATE * 3 / 20;
+            mSignal[i]       = mGate ? static_cast<float>(0.5 * sin(TWO_PI * mPhase)) : 0.0f;
+        }
+    }
+    return mSignal;
+}
+
+static std::vector<Processor> processors() {
+    return {
+        {"gain", [] {
+             auto mGain = std::make_shared<Gain>();
+             mGain->set_gain(0.7f);
+             return processor(mGain);
+         }},
+        {"filter-lpf", [] {
+             return processor(std::make_shared<Filter>(Filter::LPF, 0.0f, 800.0f, 1.0f, false, SAMPLE_RATE));
+         }},
+        {"filter-bpf", [] {
+             return processor(std::make_shared<Filter>(Filter::BPF, 0.0f, 1200.0f, 0.5f, false, SAMPLE_RATE));
+         }},
+        {"filter-moog-ladder", [] {
+             auto mFilter = std::make_shared<FilterLowPassMoogLadder>(SAMPLE_RATE);
+             mFilter->set_frequency(600.0f);
+             mFilter->set_resonance(0.6f);
+             return processor(mFilter);
+         }},
+        {"filter-vowel-formant", [] {
+             auto mFilter = std::make_shared<FilterVowelFormant>();
+             mFilter->set_vowel(FilterVowelFormant::VOWEL_O);
+             return processor(mFilter);
+         }},
+        {"resonator", [] {
+             return per_sample(std::make_shared<Resonator>(440.0f, SAMPLE_RATE, 20.0f));
+         }},
+        {"delay", [] {
+             return processor(std::make_shared<Delay>(0.0117f, 0.6f, 0.5f, SAMPLE_RATE));
+         }},
+        {"delay-modulated", [] {
+             auto mDelay = std::make_shared<Delay>(0.007f, 0.3f, 0.5f, SAMPLE_RATE, 0.01f);
+             mDelay->set_interpolation(Delay::INTERPOLATE_CUBIC);
+             mDelay->set_modulation(0.002f, 0.5f);
+             return processor(mDelay);
+         }},
+        {"reverb", [] {
+             return processor(std::make_shared<Reverb>());
+         }},
+        {"waveshaper", [] {
+             auto mWaveshaper = std::make_shared<Waveshaper>();
+             mWaveshaper->set_type(Waveshaper::ATAN);
+             mWaveshaper->set_amount(8.0f);
+             return processor(mWaveshaper);
+         }},
+        {"clamp", [] {
+             auto mClamp = std::make_shared<Clamp>();
+             mClamp->set_min(-0.2f);
+             mClamp->set_max(0.3f);
+             return processor(mClamp);
+         }},
+        {"envelope-follower", [] {
+             return per_sample(std::make_shared<EnvelopeFollower>(0.005f, 0.05f, SAMPLE_RATE));
+         }},
+        {"root-mean-square", [] {
+             return per_sample(std::make_shared<RootMeanSquare>(64));
+         }},
+        {"vocoder", [] {
+             auto mVocoder = std::make_shared<Vocoder>(24, 4, SAMPLE_RATE);
+             auto mCarrier = std::make_shared<Wavetable>(WavetableBank::shared(KlangWellen::WAVEFORM_SAWTOOTH), SAMPLE_RATE);
+             auto mBuffer  = std::make_shared<std::vector<float>>(BLOCK_SIZE);
+             mCarrier->set_frequency(110.0f);
+             return Render([mVocoder, mCarrier, mBuffer](float* buffer, const uint32_t length) {
+                 mCarrier->process(mBuffer->data(), length);
+                 mVocoder->process(mBuffer->data(), buffer, buffer, length);
+             });
+         }},
+        {"autotune", [] {
+             auto mAutotune = std::make_shared<Autotune>(SAMPLE_RATE);
+             mAutotune->set_scale(ScaleCollection::MAJOR, Note::C4);
+             mAutotune->set_formant_correction(true);
+             return processor(mAutotune);
+         }},
+        {"wavetable", [] {
+             auto mWavetable = std::make_shared<Wavetable>(KlangWellen::DEFAULT_WAVETABLE_SIZE, SAMPLE_RATE);
+             Wavetable::fill(mWavetable->get_wavetable(), mWavetable->get_wavetable_size(), KlangWellen::WAVEFORM_SINE);
+             mWavetable->set_interpolation(KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR);
+             mWavetable->set_frequency(441.3f);
+             return processor(mWavetable);
+         }},
+        {"wavetable-bank", [] {
+             auto mWavetable = std::make_shared<Wavetable>(WavetableBank::shared(KlangWellen::WAVEFORM_SAWTOOTH), SAMPLE_RATE);
+             mWavetable->set_frequency(1661.2f);
+             return processor(mWavetable);
+         }},
+        {"fm-synthesis", [] {
+             auto mFM = std::make_shared<FMSynthesis>(KlangWellen::DEFAULT_WAVETABLE_SIZE, SAMPLE_RATE);
+             mFM->get_carrier()->set_frequency(220.0f);
+             mFM->get_modulator()->set_frequency(330.0f);
+             mFM->set_modulation_depth(0.4f);
+             return processor(mFM);
+         }},
+        {"sampler", [] {
+             auto mSampler = std::make_shared<Sampler>(SAMPLE_RATE / 10, SAMPLE_RATE);
+             for (int32_t i = 0; i < mSampler->get_buffer_length(); i++) {
+                 mSampler->get_buffer()[i] = sinf(static_cast<float>(i) * 0.05f);
+             }
+             mSampler->interpolate_samples(true);
+             mSampler->set_speed(1.37f);
+             mSampler->set_loop_all();
+             mSampler->play();
+             return processor(mSampler);
+         }},
+        {"noise-white", [] {
+             auto mNoise = std::make_shared<Noise>();
+             mNoise->set_type(KlangWellen::NOISE_WHITE);
+             return processor(mNoise);
+         }},
+        {"noise-pink", [] {
+             auto mNoise = std::make_shared<Noise>();
+             mNoise->set_type(KlangWellen::NOISE_PINK);
+             return processor(mNoise);
+         }},
+        {"noise-simplex", [] {
+             auto mNoise = std::make_shared<Noise>();
+             mNoise->set_type(KlangWellen::NOISE_SIMPLEX);
+             return processor(mNoise);
+         }},
+        {"adsr", [] {
+             auto mADSR   = std::make_shared<ADSR>(SAMPLE_RATE);
+             auto mFrames = std::make_shared<uint32_t>(0);
+             mADSR->set_adsr(0.01f, 0.05f, 0.5f, 0.1f);
+             /* gates the test signal, retriggered every 250 ms */
+             return Render([mADSR, mFrames](float* buffer, const uint32_t length) {
+                 const uint32_t mPosition = *mFrames % (SAMPLE_RATE / 4);
+                 if (mPosition < length) {
+                     mADSR->start();
+                 } else if (mPosition >= SAMPLE_RATE * 3 / 20 && mPosition < SAMPLE_RATE * 3 / 20 + length) {
+                     mADSR->stop();
+                 }
+                 mADSR->process(buffer, length);
+                 *mFrames += length;
+             });
+         }},
+        {"envelope", [] {
+             auto mEnvelope = std::make_shared<Envelope>(SAMPLE_RATE);
+             mEnvelope->add_stage(0.0f, 0.013f);
+             mEnvelope->add_stage(1.0f, 0.021f);
+             mEnvelope->add_stage(0.3f, 0.005f);
+             mEnvelope->add_stage(0.0f);
+             mEnvelope->enable_loop(true);
+             mEnvelope->start();
+             return processor(mEnvelope);
+         }},
+        {"ramp", [] {
+             auto mRamp = std::make_shared<Ramp>(SAMPLE_RATE);
+             mRamp->set_start(-1.0f);
+             mRamp->set_end(1.0f);
+             mRamp->set_duration(0.2f);
+             mRamp->start();
+             return processor(mRamp);
+         }},
+        {"sam", [] {
+             auto mSAM = std::make_shared<SAM>();
+             mSAM->speak("klang wellen");
+             return processor(mSAM);
+         }},
+    };
+}
+
+struct Result {
+    double ns_per_sample;
+    float  difference; /* maximum difference to the golden file relative to its peak, negative if there is none */
+    bool   passed;
+};
+
+static float difference(const std::vector<float>& golden, const float* output) {
+    float mPeak       = 1.0f;
+    float mDifference = 0.0f;
+    for (uint32_t i = 0; i < GOLDEN_LENGTH; i++) {
+        mPeak       = std::max(mPeak, std::fabs(golden[i]));
+        mDifference = std::max(mDifference, std::fabs(golden[i] - output[i]));
+    }
+    return mDifference / mPeak;
+}
+
+static std::map<std::string, double> read_timings(const std::string& path) {
+    std::map<std::string, double> mTimings;
+    std::ifstream                 mFile(path);
+    std::string                   mLine;
+    while (std::getline(mFile, mLine)) {
+        const size_t mComma = mLine.find(',');
+        if (mComma != std::string::npos) {
+            mTimings[mLine.substr(0, mComma)] = atof(mLine.c_str() + mComma + 1);
+        }
+    }
+    return mTimings;
+}
+
+int main(const int argc, char* argv[]) {
+    bool        mUpdate = false;
+    std::string mGoldenDirectory(KLANGWELLEN_GOLDEN_DIRECTORY);
+    std::string mOutputDirectory;
+    std::string mTimingsFile;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            mUpdate = true;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            mOutputDirectory = argv[++i];
+        } else if (strcmp(argv[i], "--timings") == 0 && i + 1 < argc) {
+            mTimingsFile = argv[++i];
+        } else {
+            mGoldenDirectory = argv[i];
+        }
+    }
+
+    const std::map<std::string, double> mPreviousTimings = mTimingsFile.empty() ? std::map<std::string, double>() : read_timings(mTimingsFile);
+    std::ostringstream                  mTimings;
+
+    std::cout << "+++ klangwellen render ( " << RENDER_LENGTH << " samples at " << SAMPLE_RATE << " Hz in blocks of "
+              << BLOCK_SIZE << ", golden files in '" << mGoldenDirectory << "' )" << std::endl
+              << std::endl
+              << std::left << std::setw(22) << "processor" << std::right
+              << std::setw(12) << "ns/sample" << std::setw(12) << "previous"
+              << std::setw(12) << "real time" << std::setw(12) << "difference" << std::endl;
+
+    /* rendered into preallocated memory, no allocations or I/O while the time is measured */
+    std::vector<float> mBuffer(RENDER_LENGTH);
+    std::vector<float> mGolden;
+    bool               mPassed = true;
+    for (const Processor& mProcessor: processors()) {
+        const Render mRender = mProcessor.create();
+        /* seeded after creation, `PinkNoise` seeds `rand()` with the time */
+        srand(RANDOM_SEED);
+        KlangWellen::x32Seed = RANDOM_SEED;
+        std::copy(test_signal().begin(), test_signal().end(), mBuffer.begin());
+
+        const auto mStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < RENDER_LENGTH; i += BLOCK_SIZE) {
+            mRender(mBuffer.data() + i, BLOCK_SIZE);
+        }
+        const double mSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+
+        Result mResult{mSeconds * 1e9 / RENDER_LENGTH, -1.0f, true};
+        for (uint32_t i = 0; i < RENDER_LENGTH; i++) {
+            mResult.passed &= std::isfinite(mBuffer[i]);
+        }
+
+        const std::string mGoldenFile = mGoldenDirectory + "/" + mProcessor.name + ".wav";
+        if (mUpdate) {
+            mResult.passed &= WAV::write(mGoldenFile, mBuffer.data(), GOLDEN_LENGTH, 1, SAMPLE_RATE);
+        } else {
+            uint16_t mChannels   = 0;
+            uint32_t mSampleRate = 0;
+            if (WAV::read(mGoldenFile, mGolden, mChannels, mSampleRate) && mChannels == 1 && mGolden.size() == GOLDEN_LENGTH) {
+                mResult.difference = difference(mGolden, mBuffer.data());
+                mResult.passed &= mResult.difference <= TOLERANCE;
+            } else {
+                mResult.passed = false;
+            }
+        }
+        if (!mOutputDirectory.empty()) {
+            WAV::write(mOutputDirectory + "/" + mProcessor.name + ".wav", mBuffer.data(), RENDER_LENGTH, 1, SAMPLE_RATE);
+        }
+
+        const auto mPrevious = mPreviousTimings.find(mProcessor.name);
+        std::cout << std::left << std::setw(22) << mProcessor.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << mResult.ns_per_sample;
+        if (mPrevious != mPreviousTimings.end()) {
+            std::cout << std::setw(12) << mPrevious->second;
+        } else {
+            std::cout << std::setw(12) << "-";
+        }
+        std::cout << std::setw(11) << std::setprecision(0) << RENDER_LENGTH / (mSeconds * SAMPLE_RATE) << "x";
+        if (mUpdate) {
+            std::cout << std::setw(12) << "updated";
+        } else if (mResult.difference < 0.0f) {
+            std::cout << std::setw(12) << "missing";
+        } else {
+            std::cout << std::setw(12) << std::scientific << std::setprecision(1) << mResult.difference;
+        }
+        std::cout << (mResult.passed ? "  OK" : "  FAILED") << std::defaultfloat << std::endl;
+        mTimings << mProcessor.name << "," << mResult.ns_per_sample << std::endl;
+        mPassed &= mResult.passed;
+    }
+
+    if (!mTimingsFile.empty()) {
+        std::ofstream(mTimingsFile) << mTimings.str();
+    }
+    return mPassed ? 0 : 1;
+}
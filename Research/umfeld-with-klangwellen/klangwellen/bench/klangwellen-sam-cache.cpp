@@ -0,0 +1,200 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * measures the latency of `SAM::speak()` ( synchronous rendering ) against `SAMCache` for cold ( uncached ) and warm
+ * ( cached ) utterances: the time the calling thread is blocked and the time until the first samples and all samples
+ * are available for playback. checks that cached utterances play the same samples as `SAM::speak()` and that
+ * `SAMCache::speak()` can be called from another thread while `SAM::process()` runs ( build with
+ * `-fsanitize=thread` to check the handover for data races ).
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-sam-cache`
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "SAMCache.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t BLOCK_SIZE = 256;
+
+using Clock = std::chrono::steady_clock;
+
+static const char* PHRASES[] = {
+    "hello world",
+    "klang wellen",
+    "the quick brown fox jumps over the lazy dog",
+    "i am a speech synthesizer from nineteen eighty two",
+};
+static constexpr size_t NUM_PHRASES = sizeof(PHRASES) / sizeof(PHRASES[0]);
+
+static float elapsed_ms(const Clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+/* plays `sam` until it is done speaking */
+static std::vector<float> play(SAM& sam) {
+    std::vector<float> mOutput;
+    float              mBlock[BLOCK_SIZE];
+    uint32_t           mSilentBlocks = 0;
+    while (mSilentBlocks < 64) {
+        sam.process(mBlock, BLOCK_SIZE);
+        bool mSilent = true;
+        for (const float mSample: mBlock) {
+            mSilent &= mSample == 0.0f;
+        }
+        mSilentBlocks = mSilent ? mSilentBlocks + 1 : 0;
+        mOutput.insert(mOutput.end(), mBlock, mBlock + BLOCK_SIZE);
+    }
+    return mOutput;
+}
+
+int main() {
+    bool mPassed = true;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "+++ klangwellen SAM cache" << std::endl
+              << std::endl;
+
+    /* synchronous: every call renders the complete utterance */
+    std::cout << "SAM::speak() ( blocking )" << std::endl;
+    {
+        SAM mSAM;
+        for (size_t i = 0; i < NUM_PHRASES; i++) {
+            const Clock::time_point mStart = Clock::now();
+            mSAM.speak(PHRASES[i]);
+            std::cout << "    " << std::setw(8) << elapsed_ms(mStart) << " ms blocked  : " << PHRASES[i] << std::endl;
+        }
+    }
+
+    SAMCache mCache;
+    SAM      mSAM;
+
+    std::cout << "SAMCache cold ( blocked / first samples / complete )" << std::endl;
+    for (size_t i = 0; i < NUM_PHRASES; i++) {
+        const Clock::time_point             mStart     = Clock::now();
+        std::shared_ptr<const SAMUtterance> mUtterance = mCache.request(PHRASES[i], mSAM.get_pitch(), mSAM.get_speed(), mSAM.get_mouth(), mSAM.get_throat());
+        const float                         mBlocked   = elapsed_ms(mStart);
+        while (mUtterance->length.load() == 0 && !mUtterance->finished.load()) {
+            std::this_thread::yield();
+        }
+        const float mFirst = elapsed_ms(mStart);
+        while (!mUtterance->finished.load()) {
+            std::this_thread::yield();
+        }
+        const float mComplete = elapsed_ms(mStart);
+        std::cout << "    " << std::setw(8) << mBlocked << " / " << std::setw(8) << mFirst << " / " << std::setw(8) << mComplete
+                  << " ms : " << PHRASES[i] << std::endl;
+    }
+
+    std::cout << "SAMCache warm ( blocked )" << std::endl;
+    for (size_t i = 0; i < NUM_PHRASES; i++) {
+        const Clock::time_point mStart = Clock::now();
+        mCache.speak(mSAM, PHRASES[i]);
+        std::cout << "    " << std::setw(8) << elapsed_ms(mStart) << " ms blocked  : " << PHRASES[i] << std::endl;
+    }
+
+    std::cout << "checks" << std::endl;
+    {
+        const bool mHits = mCache.get_hits() == NUM_PHRASES && mCache.get_misses() == NUM_PHRASES;
+        std::cout << (mHits ? "    OK     " : "    FAILED ") << "hits and misses" << std::endl;
+        mPassed &= mHits;
+
+        bool mSame = true;
+        for (size_t i = 0; i < NUM_PHRASES; i++) {
+            SAM mReference;
+            mReference.speak(PHRASES[i]);
+            SAM mCached;
+            mCache.speak(mCached, PHRASES[i]);
+            mSame &= play(mReference) == play(mCached);
+        }
+        std::cout << (mSame ? "    OK     " : "    FAILED ") << "cached utterances sound the same as SAM::speak()" << std::endl;
+        mPassed &= mSame;
+
+        SAMCache mSmallCache(2);
+        mSmallCache.prefetch(mSAM, PHRASES[0]);
+        mSmallCache.prefetch(mSAM, PHRASES[1]);
+        mSmallCache.prefetch(mSAM, PHRASES[0]);
+        mSmallCache.prefetch(mSAM, PHRASES[2]); // evicts PHRASES[1]
+        mSmallCache.prefetch(mSAM, PHRASES[0]);
+        const bool mEvicted = mSmallCache.get_num_utterances() == 2 && mSmallCache.get_hits() == 2;
+        std::cout << (mEvicted ? "    OK     " : "    FAILED ") << "least recently used utterance evicted" << std::endl;
+        mPassed &= mEvicted;
+
+        /* the application thread speaks while the audio thread plays. the small cache evicts the utterances while
+         * they are played, so the audio thread may hold the last reference to an utterance */
+        SAMCache          mSharedCache(2);
+        SAM               mSharedSAM;
+        std::atomic<bool> mPlaying{true};
+        std::atomic<bool> mStopped{false};
+        bool              mValid = true;
+        std::atomic<bool> mAudible{false};
+        std::atomic<bool> mSilent{false};
+        std::thread       mAudioThread([&] {
+            float    mBlock[BLOCK_SIZE];
+            uint32_t mSilentBlocks = 0;
+            while (mPlaying.load()) {
+                const bool mStoppedBefore = mStopped.load();
+                mSharedSAM.process(mBlock, BLOCK_SIZE);
+                bool mBlockSilent = true;
+                for (const float mSample: mBlock) {
+                    mValid &= std::isfinite(mSample) && mSample >= -1.0f && mSample <= 1.0f;
+                    mBlockSilent &= mSample == 0.0f;
+                }
+                if (!mBlockSilent) {
+                    mAudible.store(true);
+                }
+                mSilentBlocks = mStoppedBefore && mBlockSilent ? mSilentBlocks + 1 : 0;
+                if (mSilentBlocks >= 16) {
+                    mSilent.store(true);
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+        for (uint32_t i = 0; i < 64; i++) {
+            mSharedCache.speak(mSharedSAM, PHRASES[i % NUM_PHRASES]);
+            std::this_thread::sleep_for(std::chrono::microseconds(500 + (i % 7) * 300));
+        }
+        /* renders slowly under sanitizers, wait until playback was audible before stopping */
+        const Clock::time_point mLastSpeak = Clock::now();
+        while (!mAudible.load() && elapsed_ms(mLastSpeak) < 2000.0f) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        mSharedSAM.stop();
+        mStopped.store(true);
+        const Clock::time_point mStopTime = Clock::now();
+        while (!mSilent.load() && elapsed_ms(mStopTime) < 2000.0f) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        mPlaying.store(false);
+        mAudioThread.join();
+        const bool mConcurrent = mValid && mAudible && mSilent;
+        std::cout << (mConcurrent ? "    OK     " : "    FAILED ") << "speak() from the application thread while process() runs" << std::endl;
+        mPassed &= mConcurrent;
+    }
+
+    return mPassed ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * checks that recording into a preallocated buffer ( append, ring and overdub mode ) and `end_recording()` do not
+ * allocate on the audio thread, and that the recordings contain the expected samples. allocations are counted by
+ * replacing the global `operator new`. the growing vector recording is measured for comparison.
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-sampler-record`
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "Sampler.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t BLOCK_SIZE = 256;
+static constexpr int32_t  CAPACITY   = 48000;
+
+static size_t fAllocations = 0;
+
+void* operator new(const size_t size) {
+    fAllocations++;
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](const size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+static bool fPassed = true;
+
+static void check(const char* name, const bool condition) {
+    std::cout << (condition ? "    OK     " : "    FAILED ") << name << std::endl;
+    fPassed &= condition;
+}
+
+/* records `num_samples` of a running counter ( starting at `offset` ) in blocks */
+static void record(Sampler& sampler, const int32_t num_samples, const float offset = 0.0f) {
+    float mBlock[BLOCK_SIZE];
+    for (int32_t i = 0; i < num_samples; i += BLOCK_SIZE) {
+        const int32_t mLength = std::min(static_cast<int32_t>(BLOCK_SIZE), num_samples - i);
+        for (int32_t j = 0; j < mLength; j++) {
+            mBlock[j] = offset + static_cast<float>(i + j);
+        }
+        sampler.record(mBlock, mLength);
+    }
+}
+
+static bool is_ramp(const float* buffer, const int32_t length, const float start) {
+    for (int32_t i = 0; i < length; i++) {
+        if (buffer[i] != start + static_cast<float>(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "+++ klangwellen sampler recording" << std::endl
+              << std::endl;
+
+    {
+        std::cout << "append" << std::endl;
+        Sampler mSampler;
+        mSampler.allocate_recording_buffer(CAPACITY);
+        const size_t mAllocations = fAllocations;
+        mSampler.start_recording();
+        record(mSampler, CAPACITY + 1000);
+        const uint32_t mLength = mSampler.end_recording();
+        check("no allocations", fAllocations == mAllocations);
+        check("stops when full", mLength == CAPACITY && mSampler.get_buffer_length() == CAPACITY);
+        check("recording adopted", is_ramp(mSampler.get_buffer(), CAPACITY, 0.0f));
+    }
+
+    {
+        std::cout << "ring" << std::endl;
+        Sampler mSampler(CAPACITY);
+        mSampler.allocate_recording_buffer(CAPACITY);
+        mSampler.set_recording_mode(Sampler::RECORD_RING);
+        const size_t mAllocations = fAllocations;
+        mSampler.start_recording();
+        record(mSampler, CAPACITY * 2 + 123);
+        const uint32_t mLength = mSampler.end_recording();
+        check("no allocations", fAllocations == mAllocations);
+        check("keeps the most recent samples", mLength == CAPACITY && is_ramp(mSampler.get_buffer(), CAPACITY, CAPACITY + 123));
+        check("previous buffer reused", mSampler.get_recording_capacity() == CAPACITY);
+
+        mSampler.start_recording();
+        record(mSampler, 1000, 7.0f);
+        check("second take", mSampler.end_recording() == 1000 && is_ramp(mSampler.get_buffer(), 1000, 7.0f));
+        check("no allocations", fAllocations == mAllocations);
+    }
+
+    {
+        std::cout << "caller-owned playback buffer" << std::endl;
+        float   mBuffer[1000] = {};
+        Sampler mSampler(mBuffer, 1000);
+        mSampler.allocate_recording_buffer(CAPACITY);
+        mSampler.start_recording();
+        record(mSampler, 2000);
+        check("first take", mSampler.end_recording() == 2000 && is_ramp(mSampler.get_buffer(), 2000, 0.0f));
+        /* the caller-owned buffer is not reused, the second take records into a vector */
+        mSampler.start_recording();
+        record(mSampler, 1000, 7.0f);
+        check("second take", mSampler.end_recording() == 1000 && is_ramp(mSampler.get_buffer(), 1000, 7.0f));
+    }
+
+    {
+        std::cout << "overdub" << std::endl;
+        float   mBuffer[1000] = {};
+        Sampler mSampler(mBuffer, 1000);
+        mSampler.set_loop_all();
+        mSampler.set_recording_mode(Sampler::RECORD_OVERDUB);
+        mSampler.set_overdub_feedback(0.5f);
+        mSampler.play();
+        const size_t mAllocations = fAllocations;
+        mSampler.start_recording();
+        record(mSampler, 1000);
+        record(mSampler, 1000);
+        mSampler.end_recording();
+        check("no allocations", fAllocations == mAllocations);
+        bool mMixed = true;
+        for (int32_t i = 0; i < 1000; i++) {
+            mMixed &= mBuffer[i] == static_cast<float>(i) * 1.5f;
+        }
+        check("layers mixed with feedback", mMixed);
+    }
+
+    {
+        std::cout << "vector ( for comparison )" << std::endl;
+        Sampler      mSampler;
+        const size_t mAllocations = fAllocations;
+        mSampler.start_recording();
+        record(mSampler, CAPACITY);
+        mSampler.end_recording();
+        std::cout << "    " << fAllocations - mAllocations << " allocations" << std::endl;
+        check("recording adopted", is_ramp(mSampler.get_buffer(), CAPACITY, 0.0f));
+    }
+
+    return fPassed ? 0 : 1;
+}
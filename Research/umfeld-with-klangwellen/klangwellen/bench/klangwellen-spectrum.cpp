@@ -0,0 +1,226 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * runs `SpectrumAnalyzer` at 48KHz with 64 samples per block while a UI thread reads the spectra, and checks that
+ * neither thread allocates ( allocations are counted by replacing the global `operator new` ), for every window and for
+ * hop sizes from 64 to 1024 samples. the analyzed sine must peak at its frequency and level. a second test writes
+ * frames with a running counter into a `TripleBuffer` and checks that the reader never sees a torn frame. build with
+ * `-DCMAKE_CXX_FLAGS=-fsanitize=thread` to check for data races.
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-spectrum`
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "SpectrumAnalyzer.h"
+#include "TripleBuffer.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t BLOCK_SIZE  = 64;
+static constexpr uint32_t BLOCKS      = SAMPLE_RATE / BLOCK_SIZE * 2; // ~2 sec
+static constexpr float    FREQUENCY   = 22.0f * SAMPLE_RATE / 1024.0f; /* 1031.25Hz, the center of bin 22 */
+static constexpr float    AMPLITUDE   = 0.5f; /* -6.02dB */
+
+static std::atomic<size_t> fAllocations{0};
+
+void* operator new(const size_t size) {
+    fAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](const size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+static const char* window_name(const uint8_t window) {
+    switch (window) {
+        case SpectrumAnalyzer::WINDOW_HANN:
+            return "hann";
+        case SpectrumAnalyzer::WINDOW_HAMMING:
+            return "hamming";
+        case SpectrumAnalyzer::WINDOW_BLACKMAN:
+            return "blackman";
+        default:
+            return "rectangular";
+    }
+}
+
+static bool analyze(const uint8_t window, const uint32_t hop_size) {
+    SpectrumAnalyzer mAnalyzer(1024, hop_size, 48, SAMPLE_RATE);
+    mAnalyzer.set_window(window);
+    mAnalyzer.set_frequency_range(20.0f, 20000.0f);
+
+    /* UI thread: reads the latest spectrum until the audio thread is done */
+    std::atomic<bool> mRunning{true};
+    uint32_t          mReads   = 0;
+    bool              mOrdered = true;
+    std::thread       mUI([&] {
+        uint64_t mLastFrame = 0;
+        while (mRunning.load()) {
+            const SpectrumAnalyzer::Spectrum& mSpectrum = mAnalyzer.get_spectrum();
+            mOrdered &= mSpectrum.frame >= mLastFrame && mSpectrum.frame % hop_size == 0;
+            mLastFrame = mSpectrum.frame;
+            mReads++;
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    });
+
+    const size_t       mAllocations = fAllocations.load();
+    const std::clock_t mStart       = std::clock();
+    float              mBlock[BLOCK_SIZE];
+    for (uint32_t b = 0; b < BLOCKS; b++) {
+        for (uint32_t i = 0; i < BLOCK_SIZE; i++) {
+            mBlock[i] = AMPLITUDE * sinf(static_cast<float>(TWO_PI * FREQUENCY * (b * BLOCK_SIZE + i) / SAMPLE_RATE));
+        }
+        mAnalyzer.process(mBlock, BLOCK_SIZE);
+    }
+    const float mMicrosPerBlock = static_cast<float>(std::clock() - mStart) * 1000000.0f / CLOCKS_PER_SEC / BLOCKS;
+    mRunning.store(false);
+    mUI.join();
+    const size_t mAllocated = fAllocations.load() - mAllocations;
+
+    /* loudest bin and band of the last spectrum */
+    const SpectrumAnalyzer::Spectrum& mSpectrum = mAnalyzer.get_spectrum();
+    uint32_t                          mPeakBin  = 0;
+    for (uint32_t k = 0; k < mSpectrum.bins.size(); k++) {
+        mPeakBin = mSpectrum.bins[k] > mSpectrum.bins[mPeakBin] ? k : mPeakBin;
+    }
+    uint32_t mPeakBand = 0;
+    for (uint32_t b = 0; b < mSpectrum.bands.size(); b++) {
+        mPeakBand = mSpectrum.bands[b] > mSpectrum.bands[mPeakBand] ? b : mPeakBand;
+    }
+    const float mBandRatio     = powf(1000.0f, 1.0f / 48.0f); /* 20Hz to 20KHz in 48 bands */
+    const float mBandFrequency = mAnalyzer.get_band_frequency(mPeakBand);
+    const float mLevel         = mSpectrum.bins[mPeakBin];
+
+    /* the sine is centered on a bin, so the level is exact for every window */
+    bool mPassed = mAllocated == 0 && mOrdered && mReads > 0;
+    mPassed &= mAnalyzer.get_bin_frequency(mPeakBin) == FREQUENCY;
+    mPassed &= FREQUENCY >= mBandFrequency / sqrtf(mBandRatio) && FREQUENCY < mBandFrequency * sqrtf(mBandRatio);
+    mPassed &= std::fabs(mLevel - 20.0f * log10f(AMPLITUDE)) < 0.1f;
+    mPassed &= std::fabs(mSpectrum.bands[mPeakBand] - mLevel) < 0.01f;
+
+    std::cout << std::setw(11) << window_name(window)
+              << std::setw(5) << hop_size
+              << std::setw(12) << mAllocated
+              << std::setw(7) << mReads
+              << std::setw(12) << mAnalyzer.get_bin_frequency(mPeakBin)
+              << std::setw(11) << mLevel
+              << std::setw(11) << mBandFrequency
+              << std::setw(16) << mMicrosPerBlock
+              << (mPassed ? "" : "  FAILED") << std::endl;
+    return mPassed;
+}
+
+/* every frame holds a running counter in all elements, a torn frame holds two different counters */
+static bool check_torn_frames() {
+    struct Frame {
+        explicit Frame(const size_t size) : values(size, 0) {}
+        std::vector<uint64_t> values;
+    };
+    TripleBuffer<Frame> mFrames(4096);
+
+    static constexpr uint64_t FRAMES = 200000;
+    std::atomic<bool>         mRunning{true};
+    uint64_t                  mTorn    = 0;
+    uint64_t                  mReads   = 0;
+    bool                      mOrdered = true;
+    std::thread               mReader([&] {
+        uint64_t mLast = 0;
+        while (mRunning.load()) {
+            if (!mFrames.update()) {
+                continue;
+            }
+            const Frame& mFrame = mFrames.get_read_buffer();
+            for (const uint64_t mValue: mFrame.values) {
+                mTorn += mValue != mFrame.values[0] ? 1 : 0;
+            }
+            mOrdered &= mFrame.values[0] > mLast;
+            mLast = mFrame.values[0];
+            mReads++;
+        }
+    });
+    for (uint64_t i = 1; i <= FRAMES; i++) {
+        Frame& mFrame = mFrames.get_write_buffer();
+        for (uint64_t& mValue: mFrame.values) {
+            mValue = i;
+        }
+        mFrames.publish();
+    }
+    mRunning.store(false);
+    mReader.join();
+    mFrames.update();
+    const bool mPassed = mTorn == 0 && mOrdered && mFrames.get_read_buffer().values[0] == FRAMES;
+    std::cout << "TripleBuffer: " << mReads << " of " << FRAMES << " frames read, " << mTorn << " torn values"
+              << (mOrdered ? "" : ", REORDERED") << std::endl;
+    return mPassed;
+}
+
+int main() {
+    std::cout << std::fixed << std::setprecision(2)
+              << "+++ klangwellen spectrum ( " << SAMPLE_RATE << " Hz, " << BLOCK_SIZE << " samples per block, FFT size 1024, "
+              << FREQUENCY << " Hz sine at " << 20.0f * log10f(AMPLITUDE) << " dB )" << std::endl
+              << std::endl
+              << "     window  hop  allocations  reads  peak (Hz)  peak (dB)  band (Hz)  CPU (µs/block)" << std::endl;
+
+    bool mPassed = true;
+    for (const uint8_t mWindow: {SpectrumAnalyzer::WINDOW_RECTANGULAR, SpectrumAnalyzer::WINDOW_HANN,
+                                 SpectrumAnalyzer::WINDOW_HAMMING, SpectrumAnalyzer::WINDOW_BLACKMAN}) {
+        for (const uint32_t mHopSize: {64u, 256u, 1024u}) {
+            mPassed &= analyze(mWindow, mHopSize);
+        }
+    }
+    std::cout << std::endl;
+    mPassed &= check_torn_frames();
+
+    std::cout << (mPassed ? "OK" : "FAILED") << std::endl;
+    return mPassed ? 0 : 1;
+}
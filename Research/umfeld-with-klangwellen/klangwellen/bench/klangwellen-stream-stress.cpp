@@ -0,0 +1,223 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * stress test for `Stream` with a slow `StreamDataProvider`. simulates an audio callback of 256 samples at 48 kHz
+ * ( i.e. a callback every 5.3 ms ) and reports the longest callback for the synchronous stream and the prefetch
+ * statistics for the asynchronous stream. the provider writes a running counter so that the asynchronous stream
+ * can be checked for gaps. finally the prefetch is toggled from a control thread while the stream is processed ( build
+ * with `-fsanitize=thread` to check the handover for data races ).
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-stream-stress`
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Stream.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE  = 48000;
+static constexpr uint32_t BLOCK_SIZE   = 256;
+static constexpr uint32_t STREAM_SIZE  = 8192;
+static constexpr uint8_t  DIVISION     = 4;
+static constexpr uint32_t BLOCKS       = SAMPLE_RATE / BLOCK_SIZE; // ~1 sec
+static constexpr float    CALLBACK_MS  = 1000.0f * BLOCK_SIZE / SAMPLE_RATE;
+static constexpr float    SEGMENT_MS   = 1000.0f * STREAM_SIZE / DIVISION / SAMPLE_RATE;
+
+using Clock = std::chrono::steady_clock;
+
+/* writes a running counter and blocks for `latency_ms` to simulate disk or network I/O */
+class SlowProvider : public StreamDataProvider {
+public:
+    explicit SlowProvider(const float latency_ms) : fLatency(latency_ms) {}
+
+    void fill_buffer(float* buffer, const uint32_t length) override {
+        std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(fLatency));
+        for (uint32_t i = 0; i < length; i++) {
+            buffer[i] = static_cast<float>(fCounter++);
+        }
+    }
+
+    float fLatency;
+
+private:
+    uint32_t fCounter = 0;
+};
+
+/* counts calls of `fill_buffer()` that overlap, i.e. calls from the audio thread and the I/O thread at the same time */
+class ExclusiveProvider : public StreamDataProvider {
+public:
+    void fill_buffer(float* buffer, const uint32_t length) override {
+        if (fFilling.exchange(true)) {
+            fOverlaps++;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        std::fill_n(buffer, length, 1.0f);
+        fFilling.store(false);
+    }
+
+    std::atomic<uint32_t> fOverlaps{0};
+
+private:
+    std::atomic<bool> fFilling{false};
+};
+
+struct Result {
+    float    max_callback_ms = 0;
+    uint32_t gaps            = 0;
+};
+
+/* runs the stream in real time and counts discontinuities in the counter ( ignoring silence from underruns ) */
+static Result run(Stream& stream) {
+    Result             mResult;
+    std::vector<float> mBlock(BLOCK_SIZE);
+    float              mPrevious = 0.0f;
+    bool               mStarted  = false;
+    const auto         mPeriod   = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(CALLBACK_MS));
+    Clock::time_point  mNext     = Clock::now();
+    for (uint32_t b = 0; b < BLOCKS; b++) {
+        const Clock::time_point mStart = Clock::now();
+        stream.process(mBlock.data(), BLOCK_SIZE);
+        const float mMs         = std::chrono::duration<float, std::milli>(Clock::now() - mStart).count();
+        mResult.max_callback_ms = std::max(mResult.max_callback_ms, mMs);
+
+        for (const float mSample: mBlock) {
+            if (mSample == 0.0f) {
+                continue;
+            }
+            if (mStarted && mSample != mPrevious + 1.0f) {
+                mResult.gaps++;
+            }
+            mPrevious = mSample;
+            mStarted  = true;
+        }
+
+        mNext += mPeriod;
+        std::this_thread::sleep_until(mNext);
+    }
+    return mResult;
+}
+
+static Stream* create_stream(SlowProvider& provider) {
+    Stream* mStream = new Stream(&provider, STREAM_SIZE, DIVISION, 1, SAMPLE_RATE);
+    mStream->interpolate_samples(false);
+    return mStream;
+}
+
+static void print_statistics(const StreamPrefetchStatistics& statistics) {
+    std::cout << "    requests     : " << statistics.requests << std::endl
+              << "    underruns    : " << statistics.underruns << std::endl
+              << "    dropped      : " << statistics.dropped << std::endl
+              << "    late         : " << statistics.late << std::endl
+              << "    max fill     : " << statistics.max_fill_ms << " ms" << std::endl
+              << "    min slack    : " << statistics.min_slack_ms << " ms" << std::endl;
+}
+
+int main() {
+    bool mPassed = true;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "+++ klangwellen stream stress test" << std::endl
+              << std::endl
+              << "callback     : " << BLOCK_SIZE << " samples ( " << CALLBACK_MS << " ms )" << std::endl
+              << "segment      : " << STREAM_SIZE / DIVISION << " samples ( " << SEGMENT_MS << " ms )" << std::endl
+              << std::endl;
+
+    /* synchronous: the provider latency ends up in the audio callback */
+    {
+        SlowProvider mProvider(8.0f);
+        Stream*      mStream = create_stream(mProvider);
+        const Result mResult = run(*mStream);
+        std::cout << "sync  ( provider " << mProvider.fLatency << " ms )" << std::endl
+                  << "    max callback : " << mResult.max_callback_ms << " ms"
+                  << (mResult.max_callback_ms > CALLBACK_MS ? "  ( exceeds callback period )" : "") << std::endl;
+        delete mStream;
+    }
+
+    /* asynchronous, provider slower than a callback but faster than the deadline: no underruns, no gaps */
+    {
+        SlowProvider mProvider(8.0f);
+        Stream*      mStream = create_stream(mProvider);
+        mStream->enable_prefetch(true);
+        const Result                   mResult     = run(*mStream);
+        const StreamPrefetchStatistics mStatistics = mStream->get_prefetch_statistics();
+        std::cout << "async ( provider " << mProvider.fLatency << " ms )" << std::endl
+                  << "    max callback : " << mResult.max_callback_ms << " ms" << std::endl
+                  << "    gaps         : " << mResult.gaps << std::endl;
+        print_statistics(mStatistics);
+        const bool mOK = mStatistics.underruns == 0 && mResult.gaps == 0 && mStatistics.requests > 0;
+        std::cout << "    " << (mOK ? "OK" : "FAILED") << std::endl;
+        mPassed &= mOK;
+        delete mStream;
+    }
+
+    /* asynchronous, provider slower than the deadline: underruns are counted, callback stays short */
+    {
+        SlowProvider mProvider(SEGMENT_MS * (DIVISION - 1) * 1.5f);
+        Stream*      mStream = create_stream(mProvider);
+        mStream->enable_prefetch(true);
+        const Result                   mResult     = run(*mStream);
+        const StreamPrefetchStatistics mStatistics = mStream->get_prefetch_statistics();
+        std::cout << "async ( provider " << mProvider.fLatency << " ms )" << std::endl
+                  << "    max callback : " << mResult.max_callback_ms << " ms" << std::endl;
+        print_statistics(mStatistics);
+        const bool mOK = mStatistics.underruns > 0 && mStatistics.late > 0;
+        std::cout << "    " << (mOK ? "OK" : "FAILED") << std::endl;
+        mPassed &= mOK;
+        delete mStream;
+    }
+
+    /* the prefetch is enabled and disabled while another thread processes the stream */
+    {
+        ExclusiveProvider mProvider;
+        Stream            mStream(&mProvider, 1024, DIVISION, 1, SAMPLE_RATE);
+        std::atomic<bool> mRunning{true};
+        bool              mValid = true;
+        std::thread       mAudioThread([&] {
+            std::vector<float> mBlock(BLOCK_SIZE);
+            while (mRunning.load()) {
+                mStream.process(mBlock.data(), BLOCK_SIZE);
+                for (const float mSample: mBlock) {
+                    mValid &= mSample == 0.0f || mSample == 1.0f;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        });
+        for (uint32_t i = 0; i < 200; i++) {
+            mStream.enable_prefetch(i % 2 == 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        mStream.enable_prefetch(false);
+        mRunning.store(false);
+        mAudioThread.join();
+        const bool mOK = mValid && mProvider.fOverlaps.load() == 0;
+        std::cout << "toggle prefetch while processing" << std::endl
+                  << "    overlapping fills : " << mProvider.fOverlaps.load() << std::endl
+                  << "    " << (mOK ? "OK" : "FAILED") << std::endl;
+        mPassed &= mOK;
+    }
+
+    return mPassed ? 0 : 1;
+}
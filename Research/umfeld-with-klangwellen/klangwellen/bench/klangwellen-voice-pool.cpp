@@ -0,0 +1,213 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * checks voice allocation, stealing and MIDI handling of `VoicePool` and measures the maximum number of
+ * `WavetableVoice`s that can be rendered at 48 kHz with a block size of 256 samples before a block takes longer than
+ * the callback period ( 5.3 ms ). a voice count misses the deadline if a single block of the measurement takes longer
+ * than the period, the reported maximum rendered every block in time. the search is repeated with worker threads if
+ * the machine has more than one core.
+ *
+ * build + run with `cmake -B build ; cmake --build build ; ./build/klangwellen-voice-pool`
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "VoicePool.h"
+#include "WavetableVoice.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t BLOCK_SIZE  = 256;
+static constexpr uint32_t BLOCKS      = SAMPLE_RATE / BLOCK_SIZE * 2; // ~2 sec
+static constexpr float    CALLBACK_MS = 1000.0f * BLOCK_SIZE / SAMPLE_RATE;
+static constexpr size_t   MAX_VOICES  = 8192;
+
+using Clock     = std::chrono::steady_clock;
+using LargePool = VoicePool<WavetableVoice, MAX_VOICES>;
+
+static bool fPassed = true;
+
+static void check(const char* name, const bool condition) {
+    std::cout << (condition ? "    OK     " : "    FAILED ") << name << std::endl;
+    fPassed &= condition;
+}
+
+template<typename POOL>
+static void render(POOL& pool, const uint32_t blocks) {
+    float mBlock[BLOCK_SIZE];
+    for (uint32_t b = 0; b < blocks; b++) {
+        pool.process(mBlock, BLOCK_SIZE);
+    }
+}
+
+static void check_allocation() {
+    std::cout << "allocation" << std::endl;
+    VoicePool<WavetableVoice, 4> mPool;
+    bool                         mFree = true;
+    for (uint8_t i = 0; i < 4; i++) {
+        mFree &= mPool.note_on(60 + i, 100) == i;
+    }
+    check("free voices first", mFree);
+    render(mPool, 4);
+    check("steals oldest", mPool.note_on(70, 100) == 0);
+    mPool.note_off(62);
+    check("steals released before held", mPool.note_on(71, 100) == 2);
+
+    mPool.set_voice_stealing(LargePool::STEAL_QUIETEST);
+    mPool.get_voice(3).get_oscillator().set_amplitude(0.1f);
+    render(mPool, 1);
+    check("steals quietest", mPool.note_on(72, 100) == 3);
+
+    mPool.midi(0x90, 70, 0);
+    mPool.midi(0x81, 71, 0);
+    mPool.midi(0xB0, 123, 0);
+    render(mPool, BLOCKS);
+    check("note off and all notes off release voices", mPool.get_num_active_voices() == 0);
+}
+
+static void check_threads() {
+    const uint8_t mThreads = static_cast<uint8_t>(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    std::cout << "threads ( " << static_cast<int>(mThreads) << " workers )" << std::endl;
+    std::unique_ptr<VoicePool<WavetableVoice, 256>> mSerial(new VoicePool<WavetableVoice, 256>());
+    std::unique_ptr<VoicePool<WavetableVoice, 256>> mParallel(new VoicePool<WavetableVoice, 256>());
+    mParallel->set_num_threads(mThreads);
+    for (uint8_t i = 0; i < 200; i++) {
+        mSerial->note_on(24 + i % 96, 100);
+        mParallel->note_on(24 + i % 96, 100);
+    }
+    float mSerialBlock[BLOCK_SIZE];
+    float mParallelBlock[BLOCK_SIZE];
+    float mMaxDifference = 0.0f;
+    for (uint32_t b = 0; b < 64; b++) {
+        mSerial->process(mSerialBlock, BLOCK_SIZE);
+        mParallel->process(mParallelBlock, BLOCK_SIZE);
+        for (uint32_t i = 0; i < BLOCK_SIZE; i++) {
+            mMaxDifference = std::max(mMaxDifference, std::fabs(mSerialBlock[i] - mParallelBlock[i]));
+        }
+    }
+    /* partitions are summed in a different order */
+    check("same output as single thread", mMaxDifference < 1e-4f);
+}
+
+struct Measurement {
+    float    mean_ms  = 0.0f;
+    float    p99_ms   = 0.0f;
+    float    worst_ms = 0.0f;
+    uint32_t misses   = 0; /* blocks that took longer than the callback period */
+
+    bool misses_deadline() const {
+        return misses > 0;
+    }
+};
+
+static Measurement measure(const size_t voices, const uint8_t threads) {
+    std::unique_ptr<LargePool> mPool(new LargePool());
+    mPool->set_num_threads(threads);
+    for (size_t i = 0; i < voices; i++) {
+        mPool->note_on(static_cast<uint8_t>(24 + i % 96), 100);
+    }
+    render(*mPool, 4);
+
+    Measurement        mMeasurement;
+    std::vector<float> mTimes(BLOCKS);
+    float              mBlock[BLOCK_SIZE];
+    for (uint32_t b = 0; b < BLOCKS; b++) {
+        const Clock::time_point mStart = Clock::now();
+        mPool->process(mBlock, BLOCK_SIZE);
+        mTimes[b] = std::chrono::duration<float, std::milli>(Clock::now() - mStart).count();
+        mMeasurement.mean_ms += mTimes[b] / BLOCKS;
+        mMeasurement.misses += mTimes[b] > CALLBACK_MS ? 1 : 0;
+    }
+    std::sort(mTimes.begin(), mTimes.end());
+    mMeasurement.p99_ms   = mTimes[BLOCKS * 99 / 100];
+    mMeasurement.worst_ms = mTimes.back();
+    return mMeasurement;
+}
+
+static void print(const size_t voices, const Measurement& measurement) {
+    std::cout << "    " << std::setw(5) << voices << " voices : "
+              << std::setw(6) << measurement.mean_ms << " ms mean, "
+              << std::setw(6) << measurement.p99_ms << " ms p99, "
+              << std::setw(6) << measurement.worst_ms << " ms worst, "
+              << measurement.misses << " misses" << std::endl;
+}
+
+/* doubles the number of voices until a block misses the deadline, then narrows down by bisection */
+static void find_max_voices(const uint8_t threads) {
+    std::cout << "max voices ( " << static_cast<int>(threads) << " worker threads )" << std::endl;
+    size_t mLow  = 0;
+    size_t mHigh = 64;
+    while (mHigh <= MAX_VOICES) {
+        const Measurement mMeasurement = measure(mHigh, threads);
+        print(mHigh, mMeasurement);
+        if (mMeasurement.misses_deadline()) {
+            break;
+        }
+        mLow = mHigh;
+        mHigh *= 2;
+    }
+    if (mHigh > MAX_VOICES) {
+        std::cout << "    more than " << MAX_VOICES << " voices" << std::endl;
+        return;
+    }
+    while (mHigh - mLow > std::max<size_t>(mLow / 32, 1)) {
+        const size_t      mVoices      = (mLow + mHigh) / 2;
+        const Measurement mMeasurement = measure(mVoices, threads);
+        print(mVoices, mMeasurement);
+        (mMeasurement.misses_deadline() ? mHigh : mLow) = mVoices;
+    }
+    std::cout << "    max voices : " << mLow << std::endl;
+}
+
+int main() {
+    std::cout << std::fixed << std::setprecision(3)
+              << "+++ klangwellen voice pool" << std::endl
+              << std::endl
+              << "callback     : " << BLOCK_SIZE << " samples ( " << CALLBACK_MS << " ms )" << std::endl
+              << std::endl;
+
+    check_allocation();
+    check_threads();
+
+    /* inactive voices are skipped, only their state is checked */
+    {
+        const Measurement mMeasurement = measure(0, 0);
+        std::cout << "idle pool ( " << MAX_VOICES << " voices )" << std::endl
+                  << "    " << mMeasurement.mean_ms << " ms mean" << std::endl;
+    }
+
+    find_max_voices(0);
+    const unsigned mCores = std::thread::hardware_concurrency();
+    if (mCores > 1) {
+        find_max_voices(static_cast<uint8_t>(std::min(mCores - 1, 255u)));
+    } else {
+        std::cout << "max voices with worker threads skipped ( single core )" << std::endl;
+    }
+
+    return fPassed ? 0 : 1;
+}
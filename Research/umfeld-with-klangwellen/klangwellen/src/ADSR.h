@@ -104,6 +104,20 @@ namespace klangwellen {
             check_scheduled_release_state();
         }
 
+        /**
+         * @return current amplitude of the envelope
+         */
+        float current() const {
+            return fAmp;
+        }
+
+        /**
+         * @return true if the envelope has not been started or has finished its release
+         */
+        bool is_idle() const {
+            return fState == ENVELOPE_STATE::IDLE;
+        }
+
         float get_attack() const {
             return fAttack;
         }
@@ -0,0 +1,534 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef KLANGWELLEN_AUDIO_FILE_RECORDER_POSIX
+#if defined(__unix__) || defined(__APPLE__)
+#define KLANGWELLEN_AUDIO_FILE_RECORDER_POSIX 1
+#else
+#define KLANGWELLEN_AUDIO_FILE_RECORDER_POSIX 0
+#endif
+#endif
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if KLANGWELLEN_AUDIO_FILE_RECORDER_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif // KLANGWELLEN_AUDIO_FILE_RECORDER_POSIX
+
+#include "KlangWellen.h"
+#include "WAV.h"
+
+namespace klangwellen {
+    /**
+     * records the audio thread to a WAV file without file I/O in `write()`:
+     *
+     * ```
+     * AudioFileRecorder fRecorder(16, 48000);
+     * fRecorder.open("session.wav");
+     *
+     * void audioEvent() {
+     *     fRecorder.write(audio_input_buffer, audio_buffer_size);
+     * }
+     * ```
+     *
+     * `write()` copies the interleaved frames into blocks of a queue that is allocated in the constructor and passes
+     * full blocks to a disk-writer thread ( lock-free, single producer and single consumer ). the writer thread converts
+     * the blocks to the sample format of the file and collects them in an aligned buffer, which is written in one
+     * piece at an aligned offset once it is full ( `set_write_size()` ). the samples start at `HEADER_SIZE`.
+     *
+     * if the writer thread falls behind and the queue is full, the block is dropped and counted
+     * ( `get_dropped_blocks()` ). dropped blocks are written as silence, so that the recording keeps its length and
+     * stays in sync with other recordings.
+     *
+     * the file is a WAV file while it is smaller than 4GB and is turned into an RF64 file ( EBU TECH 3306 ) by
+     * `close()` if it is larger. with `set_direct_io()` the file is opened with `O_DIRECT` ( bypassing the page cache,
+     * where supported ), `set_preallocate()` reserves the expected length of the recording on disk. `open()` and
+     * `close()` may be called while the audio thread writes: `write()` ignores the frames until `open()` has reset the
+     * recorder and `close()` waits until a running `write()` has returned before it takes over the last block.
+     */
+    class AudioFileRecorder {
+    public:
+        static constexpr uint32_t ALIGNMENT   = 4096;
+        static constexpr uint32_t HEADER_SIZE = ALIGNMENT;
+
+        /**
+         * @param bits_per_sample 32 ( float ), 24 or 16 ( PCM )
+         * @param block_frames    frames per block of the queue
+         * @param queue_blocks    capacity of the queue in blocks, it needs to cover the longest time the disk may stall
+         */
+        AudioFileRecorder(const uint16_t channels        = 2,
+                          const uint32_t sample_rate     = KlangWellen::DEFAULT_SAMPLE_RATE,
+                          const uint16_t bits_per_sample = 32,
+                          const uint32_t block_frames    = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE,
+                          const uint32_t queue_blocks    = 512)
+            : fChannels(std::max<uint16_t>(channels, 1)),
+              fBlockFrames(std::max(block_frames, 1u)),
+              fQueueBlocks(std::max(queue_blocks, 2u)),
+              fBlocks(fQueueBlocks),
+              fSamples(static_cast<size_t>(fQueueBlocks) * fBlockFrames * fChannels, 0.0f) {
+            fFormat.format_tag      = bits_per_sample == 32 ? KlangWellen::WAV_FORMAT_IEEE_FLOAT_32BIT : KlangWellen::WAV_FORMAT_PCM;
+            fFormat.channels        = fChannels;
+            fFormat.sample_rate     = sample_rate;
+            fFormat.bits_per_sample = bits_per_sample == 16 || bits_per_sample == 24 ? bits_per_sample : 32;
+            fFormat.data_offset     = HEADER_SIZE;
+            fConverted.resize(static_cast<size_t>(fBlockFrames) * fFormat.bytes_per_frame());
+            set_write_size(1 << 20);
+        }
+
+        ~AudioFileRecorder() {
+            close();
+        }
+
+        AudioFileRecorder(const AudioFileRecorder&)            = delete;
+        AudioFileRecorder& operator=(const AudioFileRecorder&) = delete;
+
+        /**
+         * size of the writes to disk in bytes, rounded up to `ALIGNMENT` ( default 1MB ). called before `open()`.
+         */
+        void set_write_size(const uint32_t bytes) {
+            fWriteSize = std::max((bytes + ALIGNMENT - 1) / ALIGNMENT, 1u) * ALIGNMENT;
+            fWriteMemory.reset(new uint8_t[fWriteSize + ALIGNMENT]);
+            fWriteBuffer = fWriteMemory.get() + (ALIGNMENT - reinterpret_cast<uintptr_t>(fWriteMemory.get()) % ALIGNMENT) % ALIGNMENT;
+        }
+
+        uint32_t get_write_size() const {
+            return fWriteSize;
+        }
+
+        /**
+         * opens the file with `O_DIRECT` ( linux ) or `F_NOCACHE` ( macOS ), so that long recordings do not fill the page
+         * cache. if the file system does not support it, the file is opened without. called before `open()`.
+         */
+        void set_direct_io(const bool direct_io) {
+            fDirectIORequested = direct_io;
+        }
+
+        /**
+         * @return true if the open file is written with direct I/O
+         */
+        bool is_direct_io() const {
+            return fDirectIO;
+        }
+
+        /**
+         * reserves disk space for `frames` frames when the file is opened ( linux ), so that the file system does not
+         * need to allocate blocks while recording. the file is truncated to the recorded length by `close()`. called
+         * before `open()`.
+         */
+        void set_preallocate(const uint64_t frames) {
+            fPreallocateFrames = frames;
+        }
+
+        /**
+         * writes an RF64 header even if the file is smaller than 4GB. called before `close()`.
+         */
+        void set_rf64(const bool always) {
+            fAlwaysRF64 = always;
+        }
+
+        uint16_t get_channels() const {
+            return fChannels;
+        }
+
+        uint32_t get_sample_rate() const {
+            return fFormat.sample_rate;
+        }
+
+        /**
+         * creates the file, writes a preliminary header and starts the writer thread
+         *
+         * @return false if the file cannot be created
+         */
+        bool open(const std::string& path) {
+            close();
+            if (!open_file(path)) {
+                return false;
+            }
+            fBlockFill    = 0;
+            fDropping     = false;
+            fGap          = 0;
+            fWriteFill    = 0;
+            fFileOffset   = HEADER_SIZE;
+            fDataSize     = 0;
+            fWriteBlocks  = 0;
+            fReadBlocks.store(0);
+            fPublished.store(0);
+            fRecordedFrames.store(0);
+            fDroppedBlocks.store(0);
+            fMaxQueuedBlocks.store(0);
+            fWrittenBytes.store(0);
+            fError.store(false);
+
+            fFormat.data_size = 0;
+            WAV::write_header(fWriteBuffer, fFormat, false);
+            if (!write_file(0, fWriteBuffer, HEADER_SIZE)) {
+                close_file();
+                return false;
+            }
+            fWriterRun.store(true);
+            fWriterThread = std::thread(&AudioFileRecorder::writer, this);
+            fOpen.store(true);
+            return true;
+        }
+
+        /**
+         * passes the last block to the writer thread, waits until everything is written and completes the header.
+         *
+         * @return false if a write failed ( e.g the disk is full ) or no file is open
+         */
+        bool close() {
+            if (!fOpen.load()) {
+                return false;
+            }
+            /* stops the audio thread before the state of the audio thread is touched */
+            fOpen.store(false);
+            while (fWriting.load()) {
+                std::this_thread::yield();
+            }
+            if (fBlockFill > 0) {
+                publish_block();
+            }
+            fWriterRun.store(false, std::memory_order_release);
+            fWriterThread.join();
+
+            /* a block dropped at the very end is silence as well */
+            append_zeros(static_cast<uint64_t>(fGap) * fFormat.bytes_per_frame());
+            fDataSize += static_cast<uint64_t>(fGap) * fFormat.bytes_per_frame();
+            fGap = 0;
+            if (fDataSize & 1) {
+                append_zeros(1); /* chunks are padded to an even size */
+            }
+            const uint64_t mFileSize = fFileOffset + fWriteFill;
+            if (fWriteFill > 0) {
+                const uint32_t mSize = fDirectIO ? (fWriteFill + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT : fWriteFill;
+                std::fill(fWriteBuffer + fWriteFill, fWriteBuffer + mSize, 0);
+                if (!write_file(fFileOffset, fWriteBuffer, mSize)) {
+                    fError.store(true);
+                }
+            }
+            fFormat.data_size = fDataSize;
+            WAV::write_header(fWriteBuffer, fFormat, fAlwaysRF64 || HEADER_SIZE - 8 + fDataSize + (fDataSize & 1) > 0xFFFFFFFF);
+            if (!write_file(0, fWriteBuffer, HEADER_SIZE) || !close_file(mFileSize)) {
+                fError.store(true);
+            }
+            return !fError.load();
+        }
+
+        bool is_open() const {
+            return fOpen.load(std::memory_order_acquire);
+        }
+
+        /**
+         * audio thread: records `frames` interleaved frames ( `frames * get_channels()` samples ).
+         *
+         * @return number of frames queued, frames of a dropped block are not queued
+         */
+        uint32_t write(const float* buffer, const uint32_t frames) {
+            fWriting.store(true);
+            const uint32_t mQueued = fOpen.load() ? write_blocks(buffer, frames) : 0;
+            fWriting.store(false, std::memory_order_release);
+            return mQueued;
+        }
+
+        /**
+         * @return number of frames passed to `write()` ( including dropped frames ). thread safe.
+         */
+        uint64_t get_recorded_frames() const {
+            return fRecordedFrames.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return number of blocks dropped because the queue was full. thread safe.
+         */
+        uint32_t get_dropped_blocks() const {
+            return fDroppedBlocks.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return highest number of blocks waiting for the writer thread since `open()`. thread safe.
+         */
+        uint32_t get_max_queued_blocks() const {
+            return fMaxQueuedBlocks.load(std::memory_order_relaxed);
+        }
+
+        uint32_t get_queue_blocks() const {
+            return fQueueBlocks;
+        }
+
+        /**
+         * @return number of bytes written to disk by the writer thread. thread safe.
+         */
+        uint64_t get_written_bytes() const {
+            return fWrittenBytes.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return true if a write to disk failed since `open()`. thread safe.
+         */
+        bool has_error() const {
+            return fError.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Block {
+            uint32_t frames = 0;
+            uint32_t gap    = 0; /* frames of dropped blocks before this block */
+        };
+
+        const uint16_t             fChannels;
+        const uint32_t             fBlockFrames;
+        const uint32_t             fQueueBlocks;
+        std::vector<Block>         fBlocks;
+        std::vector<float>         fSamples;
+        WAV::Format                fFormat;
+        uint32_t                   fWriteSize = 0;
+        std::unique_ptr<uint8_t[]> fWriteMemory;
+        uint8_t*                   fWriteBuffer       = nullptr; /* `fWriteSize` bytes, aligned to `ALIGNMENT` */
+        bool                       fDirectIORequested = false;
+        bool                       fDirectIO          = false;
+        uint64_t                   fPreallocateFrames = 0;
+        bool                       fAlwaysRF64        = false;
+        std::atomic<bool>          fOpen{false};
+        std::atomic<bool>          fWriting{false}; /* the audio thread is in `write()` */
+
+        /* audio thread */
+        uint64_t fWriteBlocks = 0; /* blocks published */
+        uint32_t fBlockFill   = 0; /* frames in the current block */
+        bool     fDropping    = false;
+        uint32_t fGap         = 0; /* frames of dropped blocks since the last published block */
+
+        alignas(64) std::atomic<uint64_t> fPublished{0};  /* blocks, written by the audio thread */
+        alignas(64) std::atomic<uint64_t> fReadBlocks{0}; /* blocks, written by the writer thread */
+        std::atomic<uint64_t>             fRecordedFrames{0};
+        std::atomic<uint32_t>             fDroppedBlocks{0};
+        std::atomic<uint32_t>             fMaxQueuedBlocks{0};
+        std::atomic<uint64_t>             fWrittenBytes{0};
+        std::atomic<bool>                 fError{false};
+        std::atomic<bool>                 fWriterRun{false};
+        std::thread                       fWriterThread;
+
+        /* writer thread */
+        std::vector<uint8_t> fConverted;
+        uint32_t             fWriteFill  = 0; /* bytes in `fWriteBuffer` */
+        uint64_t             fFileOffset = 0; /* of `fWriteBuffer` in the file */
+        uint64_t             fDataSize   = 0;
+
+#if KLANGWELLEN_AUDIO_FILE_RECORDER_POSIX
+        int fDescriptor = -1;
+#else
+        std::fstream fFile;
+#endif // KLANGWELLEN_AUDIO_FILE_RECORDER_POSIX
+
+        float* block_samples(const uint64_t block) {
+            return fSamples.data() + (block % fQueueBlocks) * fBlockFrames * fChannels;
+        }
+
+        /* audio thread: `write()` while open */
+        uint32_t write_blocks(const float* buffer, const uint32_t frames) {
+            uint32_t mQueued = 0;
+            uint32_t mDone   = 0;
+            while (mDone < frames) {
+                if (fBlockFill == 0) {
+                    /* a block is dropped as a whole if the queue is full when it begins */
+                    fDropping = fWriteBlocks - fReadBlocks.load(std::memory_order_acquire) == fQueueBlocks;
+                }
+                const uint32_t mFrames = std::min(frames - mDone, fBlockFrames - fBlockFill);
+                if (!fDropping) {
+                    std::copy(buffer + static_cast<size_t>(mDone) * fChannels,
+                              buffer + static_cast<size_t>(mDone + mFrames) * fChannels,
+                              block_samples(fWriteBlocks) + static_cast<size_t>(fBlockFill) * fChannels);
+                    mQueued += mFrames;
+                }
+                fBlockFill += mFrames;
+                mDone += mFrames;
+                if (fBlockFill == fBlockFrames) {
+                    publish_block();
+                }
+            }
+            fRecordedFrames.store(fRecordedFrames.load(std::memory_order_relaxed) + frames, std::memory_order_relaxed);
+            return mQueued;
+        }
+
+        void publish_block() {
+            if (fDropping) {
+                fGap += fBlockFill;
+                fDroppedBlocks.store(fDroppedBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            } else {
+                Block& mBlock = fBlocks[fWriteBlocks % fQueueBlocks];
+                mBlock.frames = fBlockFill;
+                mBlock.gap    = fGap;
+                fGap          = 0;
+                fWriteBlocks++;
+                fPublished.store(fWriteBlocks, std::memory_order_release);
+                const uint32_t mQueued = static_cast<uint32_t>(fWriteBlocks - fReadBlocks.load(std::memory_order_relaxed));
+                if (mQueued > fMaxQueuedBlocks.load(std::memory_order_relaxed)) {
+                    fMaxQueuedBlocks.store(mQueued, std::memory_order_relaxed);
+                }
+            }
+            fBlockFill = 0;
+            fDropping  = false;
+        }
+
+        /* writes all published blocks, polls while the queue is empty. the blocks published before `close()` are written
+         * before the thread ends. */
+        void writer() {
+            const auto mPollInterval = std::chrono::microseconds(std::clamp<int64_t>(
+                62500LL * fBlockFrames * fQueueBlocks / std::max(fFormat.sample_rate, 1u), 1000, 20000));
+            while (true) {
+                const bool     mRun       = fWriterRun.load(std::memory_order_acquire);
+                const uint64_t mPublished = fPublished.load(std::memory_order_acquire);
+                for (uint64_t b = fReadBlocks.load(std::memory_order_relaxed); b < mPublished; b++) {
+                    const Block&   mBlock = fBlocks[b % fQueueBlocks];
+                    const uint64_t mGap   = static_cast<uint64_t>(mBlock.gap) * fFormat.bytes_per_frame();
+                    const uint32_t mBytes = mBlock.frames * fFormat.bytes_per_frame();
+                    WAV::convert(block_samples(b), fConverted.data(), static_cast<size_t>(mBlock.frames) * fChannels, fFormat);
+                    fReadBlocks.store(b + 1, std::memory_order_release);
+                    append_zeros(mGap);
+                    append(fConverted.data(), mBytes);
+                    fDataSize += mGap + mBytes;
+                }
+                if (!mRun) {
+                    break;
+                }
+                std::this_thread::sleep_for(mPollInterval);
+            }
+        }
+
+        void append(const uint8_t* data, uint32_t size) {
+            while (size > 0) {
+                const uint32_t mBytes = std::min(size, fWriteSize - fWriteFill);
+                memcpy(fWriteBuffer + fWriteFill, data, mBytes);
+                fWriteFill += mBytes;
+                data += mBytes;
+                size -= mBytes;
+                flush_if_full();
+            }
+        }
+
+        void append_zeros(uint64_t size) {
+            while (size > 0) {
+                const uint32_t mBytes = static_cast<uint32_t>(std::min<uint64_t>(size, fWriteSize - fWriteFill));
+                memset(fWriteBuffer + fWriteFill, 0, mBytes);
+                fWriteFill += mBytes;
+                size -= mBytes;
+                flush_if_full();
+            }
+        }
+
+        void flush_if_full() {
+            if (fWriteFill < fWriteSize) {
+                return;
+            }
+            if (!write_file(fFileOffset, fWriteBuffer, fWriteSize)) {
+                fError.store(true, std::memory_order_relaxed);
+            }
+            fFileOffset += fWriteSize;
+            fWriteFill = 0;
+        }
+
+#if KLANGWELLEN_AUDIO_FILE_RECORDER_POSIX
+        bool open_file(const std::string& path) {
+            fDirectIO = false;
+#ifdef O_DIRECT
+            if (fDirectIORequested) {
+                fDescriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+                fDirectIO   = fDescriptor >= 0;
+            }
+#endif // O_DIRECT
+            if (fDescriptor < 0) {
+                fDescriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            }
+            if (fDescriptor < 0) {
+                return false;
+            }
+#if defined(__APPLE__)
+            if (fDirectIORequested) {
+                fDirectIO = fcntl(fDescriptor, F_NOCACHE, 1) == 0;
+            }
+#endif // __APPLE__
+#if defined(__linux__)
+            if (fPreallocateFrames > 0) {
+                posix_fallocate(fDescriptor, 0, static_cast<off_t>(HEADER_SIZE + fPreallocateFrames * fFormat.bytes_per_frame()));
+            }
+#endif // __linux__
+            return true;
+        }
+
+        bool write_file(uint64_t offset, const uint8_t* data, size_t size) {
+            while (size > 0) {
+                const ssize_t mWritten = pwrite(fDescriptor, data, size, static_cast<off_t>(offset));
+                if (mWritten <= 0) {
+                    return false;
+                }
+                offset += static_cast<uint64_t>(mWritten);
+                data += mWritten;
+                size -= static_cast<size_t>(mWritten);
+                fWrittenBytes.store(fWrittenBytes.load(std::memory_order_relaxed) + static_cast<uint64_t>(mWritten), std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        /* truncates the padding of the last direct write and the preallocated space */
+        bool close_file(const uint64_t size = 0) {
+            if (fDescriptor < 0) {
+                return false;
+            }
+            bool mSuccess = size == 0 || ftruncate(fDescriptor, static_cast<off_t>(size)) == 0;
+            mSuccess &= ::close(fDescriptor) == 0;
+            fDescriptor = -1;
+            return mSuccess;
+        }
+#else
+        bool open_file(const std::string& path) {
+            fDirectIO = false;
+            fFile.open(path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+            return fFile.is_open();
+        }
+
+        bool write_file(const uint64_t offset, const uint8_t* data, const size_t size) {
+            fFile.seekp(static_cast<std::streamoff>(offset));
+            fFile.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+            if (!fFile.good()) {
+                return false;
+            }
+            fWrittenBytes.store(fWrittenBytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+            return true;
+        }
+
+        bool close_file(const uint64_t size = 0) {
+            (void) size;
+            fFile.close();
+            return !fFile.fail();
+        }
+#endif // KLANGWELLEN_AUDIO_FILE_RECORDER_POSIX
+    };
+} // namespace klangwellen
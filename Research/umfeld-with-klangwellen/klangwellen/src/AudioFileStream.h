@@ -0,0 +1,524 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+#define KLANGWELLEN_AUDIO_FILE_STREAM_MMAP 1
+#else
+#define KLANGWELLEN_AUDIO_FILE_STREAM_MMAP 0
+#endif
+#endif
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+
+#include "WAV.h"
+
+namespace klangwellen {
+    /**
+     * decodes an audio file for the prefetch thread of `AudioFileStream`. implement it for compressed formats ( e.g MP3 ),
+     * `WAVDecoder` reads WAV files.
+     */
+    class AudioFileDecoder {
+    public:
+        virtual ~AudioFileDecoder() = default;
+
+        virtual uint16_t get_channels() const = 0;
+
+        virtual uint32_t get_sample_rate() const = 0;
+
+        /**
+         * @return length in frames ( 0 if unknown )
+         */
+        virtual uint64_t get_length() const {
+            return 0;
+        }
+
+        /**
+         * prefetch thread: decodes up to `frames` interleaved frames into `buffer`
+         *
+         * @return number of frames decoded, less than `frames` only at the end of the file
+         */
+        virtual uint32_t decode(float* buffer, uint32_t frames) = 0;
+
+        /**
+         * prefetch thread: starts decoding from the beginning of the file again
+         *
+         * @return false if the decoder cannot start over
+         */
+        virtual bool rewind() = 0;
+    };
+
+    /**
+     * reads 32-bit float and 16-, 24- and 32-bit PCM WAV files in chunks.
+     */
+    class WAVDecoder final : public AudioFileDecoder {
+    public:
+        /**
+         * @return false if the file cannot be opened or has an unsupported format
+         */
+        bool open(const std::string& path) {
+            fFile.open(path, std::ios::binary);
+            return fFile.is_open() && WAV::read_header(fFile, fFormat);
+        }
+
+        uint16_t get_channels() const override {
+            return fFormat.channels;
+        }
+
+        uint32_t get_sample_rate() const override {
+            return fFormat.sample_rate;
+        }
+
+        uint64_t get_length() const override {
+            return fFormat.frames();
+        }
+
+        uint32_t decode(float* buffer, const uint32_t frames) override {
+            const uint32_t mFrames = static_cast<uint32_t>(std::min<uint64_t>(frames, fFormat.frames() - fFrame));
+            fBytes.resize(static_cast<size_t>(mFrames) * fFormat.bytes_per_frame());
+            if (!fFile.read(reinterpret_cast<char*>(fBytes.data()), fBytes.size())) {
+                return 0;
+            }
+            WAV::convert(fBytes.data(), buffer, static_cast<size_t>(mFrames) * fFormat.channels, fFormat);
+            fFrame += mFrames;
+            return mFrames;
+        }
+
+        bool rewind() override {
+            fFile.clear();
+            fFile.seekg(fFormat.data_offset);
+            fFrame = 0;
+            return fFile.good();
+        }
+
+    private:
+        std::ifstream        fFile;
+        WAV::Format          fFormat;
+        uint64_t             fFrame = 0;
+        std::vector<uint8_t> fBytes;
+    };
+
+    /**
+     * streams an audio file to the audio thread without file I/O in `read()`:
+     *
+     * - files are decoded by an `AudioFileDecoder` ( `WAVDecoder` for WAV files ) on a prefetch thread into a lock-free
+     *   ring buffer ( `MODE_PREFETCH`, the default ). `read()` only copies from the ring. if the ring runs empty the
+     *   missing frames are silence and counted as underrun.
+     * - uncompressed WAV files can be memory mapped instead ( `MODE_MEMORY_MAPPED`, where `mmap` is available ).
+     *   `read()` converts the samples from the mapped pages. `open()` locks the pages in memory ( `mlock` ) and reads
+     *   them once, so that `read()` does not wait for the disk. if the pages cannot be locked ( e.g the file exceeds
+     *   `RLIMIT_MEMLOCK`, see `is_memory_locked()` ) they may be evicted under memory pressure and a page fault in
+     *   `read()` may wait for the disk.
+     *
+     * looping is gapless in both modes: the end of the file is followed by its beginning without a seek in `read()`
+     * ( the prefetch thread rewinds the decoder ahead of the read position ). `open()` and `close()` may be called while
+     * the audio thread reads ( e.g from `setup()` and `finish()` ): `read()` returns 0 while no file is open and
+     * `close()` waits until a `read()` in progress has returned.
+     */
+    class AudioFileStream {
+    public:
+        static constexpr uint8_t MODE_CLOSED        = 0;
+        static constexpr uint8_t MODE_MEMORY_MAPPED = 1;
+        static constexpr uint8_t MODE_PREFETCH      = 2;
+
+        /**
+         * @param prefetch_frames capacity of the ring buffer in frames ( `MODE_PREFETCH` ), it needs to cover the longest
+         *                        time the decoder may stall
+         */
+        explicit AudioFileStream(const uint32_t prefetch_frames = 65536) : fPrefetchFrames(std::max(prefetch_frames, 64u)) {}
+
+        ~AudioFileStream() {
+            close();
+        }
+
+        AudioFileStream(const AudioFileStream&)            = delete;
+        AudioFileStream& operator=(const AudioFileStream&) = delete;
+
+        /**
+         * opens a WAV file, decoded by the prefetch thread or memory mapped if `memory_map` is true and `mmap` is
+         * available.
+         *
+         * @return false if the file cannot be opened or has an unsupported format
+         */
+        bool open(const std::string& path, const bool memory_map = false) {
+            close();
+#if KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+            if (memory_map) {
+                return open_memory_mapped(path);
+            }
+#else
+            (void) memory_map;
+#endif // KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+            std::unique_ptr<WAVDecoder> mDecoder(new WAVDecoder());
+            if (!mDecoder->open(path)) {
+                return false;
+            }
+            fOwnedDecoder = std::move(mDecoder);
+            return open(fOwnedDecoder.get());
+        }
+
+        /**
+         * streams the output of `decoder` through the prefetch thread. the decoder is not owned and has to outlive the
+         * stream ( or the next `close()` ).
+         */
+        bool open(AudioFileDecoder* decoder) {
+            if (decoder == nullptr || decoder->get_channels() == 0) {
+                return false;
+            }
+            if (decoder != fOwnedDecoder.get()) {
+                close();
+            }
+            fDecoder    = decoder;
+            fChannels   = decoder->get_channels();
+            fSampleRate = decoder->get_sample_rate();
+            fLength     = decoder->get_length();
+            fRingSize   = static_cast<uint64_t>(fPrefetchFrames) * fChannels;
+            fRing.reset(new float[fRingSize]);
+            fChunkFrames = std::max(fPrefetchFrames / 8, 1u);
+            fChunk.resize(static_cast<size_t>(fChunkFrames) * fChannels);
+            reset_state();
+            fMode = MODE_PREFETCH;
+            fPrefetchRun.store(true);
+            fPrefetchThread = std::thread(&AudioFileStream::prefetch, this);
+            fOpen.store(true);
+            return true;
+        }
+
+        void close() {
+            fOpen.store(false);
+            while (fReading.load()) {
+                std::this_thread::yield();
+            }
+            if (fPrefetchThread.joinable()) {
+                fPrefetchRun.store(false);
+                fPrefetchThread.join();
+            }
+#if KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+            if (fMappedFile != nullptr) {
+                munmap(fMappedFile, fMappedSize);
+                fMappedFile   = nullptr;
+                fMemoryLocked = false;
+            }
+#endif // KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+            fOwnedDecoder.reset();
+            fDecoder = nullptr;
+            fMode    = MODE_CLOSED;
+        }
+
+        /**
+         * @return true once `open()` succeeded until `close()`. thread safe.
+         */
+        bool is_open() const {
+            return fOpen.load(std::memory_order_acquire);
+        }
+
+        uint8_t get_mode() const {
+            return fMode;
+        }
+
+        /**
+         * @return true if the pages of a memory mapped file are locked in memory
+         */
+        bool is_memory_locked() const {
+            return fMemoryLocked;
+        }
+
+        uint16_t get_channels() const {
+            return fChannels;
+        }
+
+        uint32_t get_sample_rate() const {
+            return fSampleRate;
+        }
+
+        /**
+         * @return length in frames ( 0 if unknown )
+         */
+        uint64_t get_length() const {
+            return fLength;
+        }
+
+        /**
+         * the prefetch thread reads the flag when it reaches the end of the file. thread safe.
+         */
+        void set_looping(const bool looping) {
+            fLooping.store(looping, std::memory_order_relaxed);
+        }
+
+        bool is_looping() const {
+            return fLooping.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return position of the next frame `read()` returns in frames. thread safe.
+         */
+        uint64_t get_position() const {
+            return fPosition.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return true if the stream does not loop and all frames were read. thread safe.
+         */
+        bool is_done() const {
+            return fDone.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return number of `read()` calls that could not be filled because the prefetch thread fell behind. thread safe.
+         */
+        uint32_t get_underruns() const {
+            return fUnderruns.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return number of frames decoded ahead of the read position ( `MODE_PREFETCH` ). thread safe.
+         */
+        uint32_t get_prefetched_frames() const {
+            if (!is_open() || fMode != MODE_PREFETCH) {
+                return 0;
+            }
+            return static_cast<uint32_t>((fWritten.load(std::memory_order_acquire) - fRead.load(std::memory_order_acquire)) / fChannels);
+        }
+
+        /**
+         * audio thread: reads `frames` interleaved frames ( `frames * get_channels()` samples ). frames after the end of
+         * the file ( without looping ) or missing because of an underrun are silence.
+         *
+         * @return number of frames read from the file, 0 without touching `buffer` if no file is open
+         */
+        uint32_t read(float* buffer, const uint32_t frames) {
+            /* announces the read before checking `fOpen`, so that `close()` either sees it or this sees the stream closed */
+            fReading.store(true);
+            uint32_t mFrames = 0;
+            if (fOpen.load()) {
+#if KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+                mFrames = fMode == MODE_PREFETCH ? read_prefetched(buffer, frames) : read_memory_mapped(buffer, frames);
+#else
+                mFrames = read_prefetched(buffer, frames);
+#endif // KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+            }
+            fReading.store(false, std::memory_order_release);
+            return mFrames;
+        }
+
+    private:
+        const uint32_t                    fPrefetchFrames;
+        uint8_t                           fMode       = MODE_CLOSED;
+        uint16_t                          fChannels   = 1;
+        uint32_t                          fSampleRate = 0;
+        uint64_t                          fLength     = 0;
+        std::atomic<bool>                 fLooping{false};
+        std::atomic<uint64_t>             fPosition{0};
+        std::atomic<bool>                 fDone{false};
+        std::atomic<uint32_t>             fUnderruns{0};
+        std::atomic<bool>                 fOpen{false};
+        std::atomic<bool>                 fReading{false}; /* the audio thread is in `read()` */
+        bool                              fMemoryLocked = false;
+
+        /* MODE_PREFETCH */
+        AudioFileDecoder*                 fDecoder = nullptr;
+        std::unique_ptr<AudioFileDecoder> fOwnedDecoder;
+        std::unique_ptr<float[]>          fRing;
+        uint64_t                          fRingSize    = 0; /* in samples */
+        uint32_t                          fChunkFrames = 0;
+        std::vector<float>                fChunk; /* prefetch thread only */
+        alignas(64) std::atomic<uint64_t> fWritten{0};       /* samples, written by the prefetch thread */
+        alignas(64) std::atomic<uint64_t> fRead{0};          /* samples, written by the audio thread */
+        std::atomic<bool>                 fEndOfFile{false}; /* all samples of a stream that does not loop are in the ring */
+        std::atomic<bool>                 fPrefetchRun{false};
+        std::thread                       fPrefetchThread;
+
+#if KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+        /* MODE_MEMORY_MAPPED */
+        void*          fMappedFile = nullptr;
+        size_t         fMappedSize = 0;
+        const uint8_t* fMappedData = nullptr;
+        WAV::Format    fMappedFormat;
+        uint64_t       fMappedPosition = 0; /* audio thread only */
+
+        bool open_memory_mapped(const std::string& path) {
+            std::ifstream mFile(path, std::ios::binary);
+            WAV::Format   mFormat;
+            if (!WAV::read_header(mFile, mFormat)) {
+                return false;
+            }
+            mFile.close();
+
+            const int mDescriptor = ::open(path.c_str(), O_RDONLY);
+            if (mDescriptor < 0) {
+                return false;
+            }
+            struct stat mStat{};
+            if (fstat(mDescriptor, &mStat) != 0 || static_cast<uint64_t>(mStat.st_size) < mFormat.data_offset + mFormat.data_size) {
+                ::close(mDescriptor);
+                return false;
+            }
+            void* mMapped = mmap(nullptr, static_cast<size_t>(mStat.st_size), PROT_READ, MAP_PRIVATE, mDescriptor, 0);
+            ::close(mDescriptor);
+            if (mMapped == MAP_FAILED) {
+                return false;
+            }
+            /* keeps the pages in memory or at least reads them now instead of in `read()` */
+            fMemoryLocked = mlock(mMapped, static_cast<size_t>(mStat.st_size)) == 0;
+            if (!fMemoryLocked) {
+                madvise(mMapped, static_cast<size_t>(mStat.st_size), MADV_WILLNEED);
+                const long       mPageSize = sysconf(_SC_PAGESIZE);
+                volatile uint8_t mTouch    = 0;
+                for (size_t i = 0; i < static_cast<size_t>(mStat.st_size); i += static_cast<size_t>(mPageSize)) {
+                    mTouch = mTouch + static_cast<const uint8_t*>(mMapped)[i];
+                }
+            }
+
+            fMappedFile     = mMapped;
+            fMappedSize     = static_cast<size_t>(mStat.st_size);
+            fMappedData     = static_cast<const uint8_t*>(mMapped) + mFormat.data_offset;
+            fMappedFormat   = mFormat;
+            fMappedPosition = 0;
+            fChannels       = mFormat.channels;
+            fSampleRate     = mFormat.sample_rate;
+            fLength         = mFormat.frames();
+            reset_state();
+            fMode = MODE_MEMORY_MAPPED;
+            fOpen.store(true);
+            return true;
+        }
+
+        uint32_t read_memory_mapped(float* buffer, const uint32_t frames) {
+            const uint32_t mBytesPerFrame = fMappedFormat.bytes_per_frame();
+            uint32_t       mRead          = 0;
+            while (mRead < frames) {
+                if (fMappedPosition == fLength) {
+                    if (!fLooping.load(std::memory_order_relaxed) || fLength == 0) {
+                        break;
+                    }
+                    fMappedPosition = 0;
+                }
+                const uint32_t mFrames = static_cast<uint32_t>(std::min<uint64_t>(frames - mRead, fLength - fMappedPosition));
+                WAV::convert(fMappedData + fMappedPosition * mBytesPerFrame,
+                             buffer + static_cast<size_t>(mRead) * fChannels,
+                             static_cast<size_t>(mFrames) * fChannels,
+                             fMappedFormat);
+                mRead += mFrames;
+                fMappedPosition += mFrames;
+            }
+            std::fill(buffer + static_cast<size_t>(mRead) * fChannels, buffer + static_cast<size_t>(frames) * fChannels, 0.0f);
+            fPosition.store(fMappedPosition, std::memory_order_relaxed);
+            fDone.store(mRead < frames, std::memory_order_relaxed);
+            return mRead;
+        }
+#endif // KLANGWELLEN_AUDIO_FILE_STREAM_MMAP
+
+        void reset_state() {
+            fWritten.store(0);
+            fRead.store(0);
+            fEndOfFile.store(false);
+            fPosition.store(0);
+            fDone.store(false);
+            fUnderruns.store(0);
+        }
+
+        uint32_t read_prefetched(float* buffer, const uint32_t frames) {
+            const uint64_t mRead      = fRead.load(std::memory_order_relaxed);
+            const uint64_t mWanted    = static_cast<uint64_t>(frames) * fChannels;
+            const uint64_t mAvailable = fWritten.load(std::memory_order_acquire) - mRead;
+            const uint64_t mSamples   = std::min(mWanted, mAvailable);
+
+            const uint64_t mStart = mRead % fRingSize;
+            const uint64_t mFirst = std::min(mSamples, fRingSize - mStart);
+            std::copy(fRing.get() + mStart, fRing.get() + mStart + mFirst, buffer);
+            std::copy(fRing.get(), fRing.get() + (mSamples - mFirst), buffer + mFirst);
+            std::fill(buffer + mSamples, buffer + mWanted, 0.0f);
+            fRead.store(mRead + mSamples, std::memory_order_release);
+
+            if (mSamples < mWanted) {
+                /* the end of the file is no underrun */
+                const bool mEndOfFile = fEndOfFile.load(std::memory_order_acquire) &&
+                                        fWritten.load(std::memory_order_acquire) == mRead + mSamples;
+                if (mEndOfFile) {
+                    fDone.store(true, std::memory_order_relaxed);
+                } else {
+                    fUnderruns.store(fUnderruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                }
+            }
+            const uint64_t mFrames = (mRead + mSamples) / fChannels;
+            fPosition.store(fLength > 0 && fLooping.load(std::memory_order_relaxed) ? mFrames % fLength : mFrames, std::memory_order_relaxed);
+            return static_cast<uint32_t>(mSamples / fChannels);
+        }
+
+        /* decodes a chunk whenever there is room for it, rewinds the decoder at the end of the file when looping */
+        void prefetch() {
+            const auto mPollInterval = std::chrono::microseconds(
+                std::max<int64_t>(1000, 500000LL * fChunkFrames / std::max(fSampleRate, 1u)));
+            const uint64_t mChunkSamples = static_cast<uint64_t>(fChunkFrames) * fChannels;
+            while (fPrefetchRun.load(std::memory_order_relaxed)) {
+                const uint64_t mWritten = fWritten.load(std::memory_order_relaxed);
+                const uint64_t mFree    = fRingSize - (mWritten - fRead.load(std::memory_order_acquire));
+                if (fEndOfFile.load(std::memory_order_relaxed) || mFree < mChunkSamples) {
+                    std::this_thread::sleep_for(mPollInterval);
+                    continue;
+                }
+
+                uint32_t mFrames    = 0;
+                bool     mEndOfFile = false;
+                bool     mRewound   = false;
+                while (mFrames < fChunkFrames) {
+                    const uint32_t mDecoded = fDecoder->decode(fChunk.data() + static_cast<size_t>(mFrames) * fChannels, fChunkFrames - mFrames);
+                    mFrames += mDecoded;
+                    if (mFrames == fChunkFrames) {
+                        break;
+                    }
+                    /* a decoder that returns nothing right after a rewind ( e.g an empty file ) would loop forever */
+                    if (!fLooping.load(std::memory_order_relaxed) || (mDecoded == 0 && mRewound) || !fDecoder->rewind()) {
+                        mEndOfFile = true;
+                        break;
+                    }
+                    mRewound = true;
+                }
+
+                const uint64_t mSamples = static_cast<uint64_t>(mFrames) * fChannels;
+                const uint64_t mStart   = mWritten % fRingSize;
+                const uint64_t mFirst   = std::min(mSamples, fRingSize - mStart);
+                std::copy(fChunk.data(), fChunk.data() + mFirst, fRing.get() + mStart);
+                std::copy(fChunk.data() + mFirst, fChunk.data() + mSamples, fRing.get());
+                fWritten.store(mWritten + mSamples, std::memory_order_release);
+                if (mEndOfFile) {
+                    fEndOfFile.store(true, std::memory_order_release);
+                }
+            }
+        }
+    };
+} // namespace klangwellen
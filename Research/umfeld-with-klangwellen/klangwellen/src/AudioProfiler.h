@@ -0,0 +1,351 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef KLANGWELLEN_AUDIO_PROFILER_HISTOGRAM_BINS
+#define KLANGWELLEN_AUDIO_PROFILER_HISTOGRAM_BINS 40 /* bins of 5% of the buffer period, the last bin collects the rest */
+#endif
+
+#ifndef KLANGWELLEN_AUDIO_PROFILER_TRACE_QUEUE_SIZE
+#define KLANGWELLEN_AUDIO_PROFILER_TRACE_QUEUE_SIZE 1024 /* callbacks between two `collect_trace()` ( power of two ) */
+#endif
+
+#ifndef KLANGWELLEN_AUDIO_PROFILER_TRACE_SIZE
+#define KLANGWELLEN_AUDIO_PROFILER_TRACE_SIZE 65536 /* callbacks kept for `write_trace()` */
+#endif
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "SPSCQueue.h"
+
+namespace klangwellen {
+    /**
+     * measures how close the audio callback gets to its deadline. the audio thread wraps the callback in `begin()` and
+     * `end()` ( or a `Scope` ), which costs two clock reads and a few relaxed atomic stores:
+     *
+     * ```
+     * void audioEvent() {
+     *     AudioProfiler::Scope mScope(fProfiler);
+     *     // ...
+     * }
+     * ```
+     *
+     * any other thread ( e.g `draw()` ) can query the DSP load ( callback duration relative to the buffer period ), the
+     * number of overruns ( callbacks longer than the buffer period ) and late callbacks ( callbacks that started more
+     * than 1.5 buffer periods after the previous one, e.g because the device dropped a buffer ) and a histogram of the
+     * callback durations. none of it locks or allocates in the audio thread.
+     * <p>
+     * the last callbacks are kept for a trace in the Chrome trace event format ( JSON, opens in https://ui.perfetto.dev
+     * or `chrome://tracing` ). timestamps are microseconds of `std::chrono::steady_clock`, traces recorded with the same
+     * clock ( e.g from the render thread ) line up when they are loaded together. `collect_trace()` needs to be called
+     * at least every `KLANGWELLEN_AUDIO_PROFILER_TRACE_QUEUE_SIZE` callbacks ( e.g once per frame ), callbacks that do
+     * not fit are missing from the trace.
+     */
+    class AudioProfiler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr uint32_t HISTOGRAM_BINS      = KLANGWELLEN_AUDIO_PROFILER_HISTOGRAM_BINS;
+        static constexpr float    HISTOGRAM_BIN_WIDTH = 0.05f; /* in buffer periods */
+
+        struct Statistics {
+            uint64_t callbacks      = 0;
+            uint64_t overruns       = 0;    /* callbacks that took longer than the buffer period */
+            uint64_t late_callbacks = 0;    /* callbacks that started more than 1.5 buffer periods after the previous one */
+            float    load           = 0.0f; /* smoothed DSP load in percent of the buffer period */
+            float    mean_load      = 0.0f; /* in percent */
+            float    max_load       = 0.0f; /* in percent */
+        };
+
+        /**
+         * RAII wrapper for `begin()` and `end()`
+         */
+        class Scope {
+        public:
+            explicit Scope(AudioProfiler& profiler) : fProfiler(profiler) {
+                fProfiler.begin();
+            }
+
+            ~Scope() {
+                fProfiler.end();
+            }
+
+            Scope(const Scope&)            = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            AudioProfiler& fProfiler;
+        };
+
+        /**
+         * @param sample_rate sample rate of the callback in Hz
+         * @param buffer_size frames per callback
+         */
+        AudioProfiler(const uint32_t sample_rate, const uint32_t buffer_size)
+            : fPeriod(static_cast<int64_t>(1000000000.0 * buffer_size / sample_rate)) {
+            fTrace.reserve(KLANGWELLEN_AUDIO_PROFILER_TRACE_SIZE);
+        }
+
+        AudioProfiler(const AudioProfiler&)            = delete;
+        AudioProfiler& operator=(const AudioProfiler&) = delete;
+
+        /**
+         * @return buffer period in seconds
+         */
+        double get_period() const {
+            return static_cast<double>(fPeriod) / 1000000000.0;
+        }
+
+        /**
+         * smoothing of the load returned in `Statistics::load` ( 0.0 ... 1.0, default 0.05 ). audio thread or before
+         * the first callback.
+         */
+        void set_smoothing(const float smoothing) {
+            fSmoothing = std::clamp(smoothing, 0.0f, 1.0f);
+        }
+
+        /**
+         * audio thread: at the beginning of the callback
+         */
+        void begin() {
+            fBegin = Clock::now();
+        }
+
+        /**
+         * audio thread: at the end of the callback
+         */
+        void end() {
+            record(fBegin, Clock::now());
+        }
+
+        /**
+         * audio thread: records a callback that ran from `start` to `end`
+         */
+        void record(const Clock::time_point start, const Clock::time_point end) {
+            const int64_t mStart    = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+            const int64_t mDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+            if (fResetRequested.exchange(false, std::memory_order_acquire)) {
+                apply_reset();
+            }
+
+            const float mLoad = static_cast<float>(mDuration) / static_cast<float>(fPeriod);
+            fSmoothedLoad += (mLoad - fSmoothedLoad) * (fCallbacks.load(std::memory_order_relaxed) == 0 ? 1.0f : fSmoothing);
+            fTotalDuration += mDuration;
+
+            const uint32_t mBin = std::min(static_cast<uint32_t>(mLoad / HISTOGRAM_BIN_WIDTH), HISTOGRAM_BINS - 1);
+            increment(fHistogram[mBin]);
+            if (mDuration > fPeriod) {
+                increment(fOverruns);
+            }
+            if (fLastStart != 0 && (mStart - fLastStart) * 2 > fPeriod * 3) {
+                increment(fLateCallbacks);
+            }
+            fLastStart = mStart;
+            if (mLoad > fMaxLoad.load(std::memory_order_relaxed)) {
+                fMaxLoad.store(mLoad, std::memory_order_relaxed);
+            }
+            fLoad.store(fSmoothedLoad, std::memory_order_relaxed);
+            fMeanLoad.store(static_cast<float>(static_cast<double>(fTotalDuration) /
+                                               static_cast<double>(fPeriod * static_cast<int64_t>(fCallbacks.load(std::memory_order_relaxed) + 1))),
+                            std::memory_order_relaxed);
+            increment(fCallbacks);
+
+            if (fTraceEnabled.load(std::memory_order_relaxed)) {
+                fTraceQueue.push({mStart, mDuration});
+            }
+        }
+
+        /**
+         * thread safe, the counters are read one by one ( not as a consistent snapshot )
+         */
+        Statistics get_statistics() const {
+            Statistics mStatistics;
+            mStatistics.callbacks      = fCallbacks.load(std::memory_order_relaxed);
+            mStatistics.overruns       = fOverruns.load(std::memory_order_relaxed);
+            mStatistics.late_callbacks = fLateCallbacks.load(std::memory_order_relaxed);
+            mStatistics.load           = fLoad.load(std::memory_order_relaxed) * 100.0f;
+            mStatistics.mean_load      = fMeanLoad.load(std::memory_order_relaxed) * 100.0f;
+            mStatistics.max_load       = fMaxLoad.load(std::memory_order_relaxed) * 100.0f;
+            return mStatistics;
+        }
+
+        /**
+         * thread safe
+         *
+         * @return number of callbacks with a load between `bin * HISTOGRAM_BIN_WIDTH` and `( bin + 1 ) *
+         * HISTOGRAM_BIN_WIDTH` ( the last bin counts all callbacks above )
+         */
+        uint64_t get_histogram(const uint32_t bin) const {
+            return bin < HISTOGRAM_BINS ? fHistogram[bin].load(std::memory_order_relaxed) : 0;
+        }
+
+        /**
+         * thread safe
+         *
+         * @param percentile 0.0 ... 100.0
+         * @return the load in percent that `percentile` percent of the callbacks stayed below ( upper edge of the
+         * histogram bin )
+         */
+        float get_percentile(const float percentile) const {
+            uint64_t mCounts[HISTOGRAM_BINS];
+            uint64_t mTotal = 0;
+            for (uint32_t i = 0; i < HISTOGRAM_BINS; i++) {
+                mCounts[i] = fHistogram[i].load(std::memory_order_relaxed);
+                mTotal += mCounts[i];
+            }
+            const double mThreshold = static_cast<double>(mTotal) * std::clamp(percentile, 0.0f, 100.0f) / 100.0;
+            uint64_t     mCount     = 0;
+            for (uint32_t i = 0; i < HISTOGRAM_BINS; i++) {
+                mCount += mCounts[i];
+                if (mTotal > 0 && static_cast<double>(mCount) >= mThreshold) {
+                    return static_cast<float>(i + 1) * HISTOGRAM_BIN_WIDTH * 100.0f;
+                }
+            }
+            return 0.0f;
+        }
+
+        /**
+         * resets all statistics and the histogram with the next callback. thread safe.
+         */
+        void reset() {
+            fResetRequested.store(true, std::memory_order_release);
+        }
+
+        /**
+         * enables or disables recording callbacks for the trace ( enabled by default ). thread safe.
+         */
+        void enable_trace(const bool enable) {
+            fTraceEnabled.store(enable, std::memory_order_relaxed);
+        }
+
+        /**
+         * consumer thread: moves the callbacks recorded since the last call into the trace. the trace keeps the last
+         * `KLANGWELLEN_AUDIO_PROFILER_TRACE_SIZE` callbacks.
+         *
+         * @return number of callbacks moved
+         */
+        uint32_t collect_trace() {
+            uint32_t   mCollected = 0;
+            TraceEvent mEvent;
+            while (fTraceQueue.pop(mEvent)) {
+                if (fTrace.size() < KLANGWELLEN_AUDIO_PROFILER_TRACE_SIZE) {
+                    fTrace.push_back(mEvent);
+                } else {
+                    fTrace[fTraceHead] = mEvent;
+                    fTraceHead         = (fTraceHead + 1) % KLANGWELLEN_AUDIO_PROFILER_TRACE_SIZE;
+                }
+                mCollected++;
+            }
+            return mCollected;
+        }
+
+        /**
+         * consumer thread: collects and writes the trace as JSON in the Chrome trace event format. each callback is a
+         * complete event ( `"ph":"X"` ) named `name` on thread `tid` of process `pid`, overruns are marked with an
+         * instant event and the load is written as counter.
+         *
+         * @return false if the file cannot be written
+         */
+        bool write_trace(const std::string& path, const char* name = "audioEvent", const uint32_t pid = 1, const uint32_t tid = 2) {
+            collect_trace();
+            std::ofstream mFile(path);
+            if (!mFile.is_open()) {
+                return false;
+            }
+            mFile << std::fixed
+                  << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                  << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"args\":{\"name\":\"audio\"}}";
+            for (size_t i = 0; i < fTrace.size(); i++) {
+                const TraceEvent& mEvent = fTrace[(fTraceHead + i) % fTrace.size()];
+                const double      mStart = static_cast<double>(mEvent.start) / 1000.0;
+                const double      mLoad  = 100.0 * static_cast<double>(mEvent.duration) / static_cast<double>(fPeriod);
+                mFile << ",\n{\"name\":\"" << name << "\",\"cat\":\"audio\",\"ph\":\"X\",\"ts\":" << mStart
+                      << ",\"dur\":" << static_cast<double>(mEvent.duration) / 1000.0
+                      << ",\"pid\":" << pid << ",\"tid\":" << tid << "}"
+                      << ",\n{\"name\":\"DSP load (%)\",\"ph\":\"C\",\"ts\":" << mStart
+                      << ",\"pid\":" << pid << ",\"args\":{\"load\":" << mLoad << "}}";
+                if (mEvent.duration > fPeriod) {
+                    mFile << ",\n{\"name\":\"overrun\",\"cat\":\"audio\",\"ph\":\"i\",\"s\":\"t\",\"ts\":"
+                          << static_cast<double>(mEvent.start + mEvent.duration) / 1000.0
+                          << ",\"pid\":" << pid << ",\"tid\":" << tid << "}";
+                }
+            }
+            mFile << "\n]}\n";
+            return mFile.good();
+        }
+
+    private:
+        struct TraceEvent {
+            int64_t start;    /* in nanoseconds of `Clock` */
+            int64_t duration; /* in nanoseconds */
+        };
+
+        const int64_t fPeriod; /* in nanoseconds */
+        float         fSmoothing = 0.05f;
+
+        /* audio thread only */
+        Clock::time_point fBegin;
+        int64_t           fLastStart     = 0;
+        int64_t           fTotalDuration = 0;
+        float             fSmoothedLoad  = 0.0f;
+
+        /* written by the audio thread, read by any thread */
+        std::atomic<uint64_t> fCallbacks{0};
+        std::atomic<uint64_t> fOverruns{0};
+        std::atomic<uint64_t> fLateCallbacks{0};
+        std::atomic<float>    fLoad{0.0f};
+        std::atomic<float>    fMeanLoad{0.0f};
+        std::atomic<float>    fMaxLoad{0.0f};
+        std::atomic<uint64_t> fHistogram[HISTOGRAM_BINS]{};
+        std::atomic<bool>     fResetRequested{false};
+        std::atomic<bool>     fTraceEnabled{true};
+
+        SPSCQueue<TraceEvent, KLANGWELLEN_AUDIO_PROFILER_TRACE_QUEUE_SIZE> fTraceQueue;
+        std::vector<TraceEvent>                                            fTrace; /* consumer thread only */
+        size_t                                                             fTraceHead = 0;
+
+        /* single writer, no read-modify-write needed */
+        static void increment(std::atomic<uint64_t>& counter) {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        void apply_reset() {
+            fLastStart     = 0;
+            fTotalDuration = 0;
+            fSmoothedLoad  = 0.0f;
+            fCallbacks.store(0, std::memory_order_relaxed);
+            fOverruns.store(0, std::memory_order_relaxed);
+            fLateCallbacks.store(0, std::memory_order_relaxed);
+            fLoad.store(0.0f, std::memory_order_relaxed);
+            fMeanLoad.store(0.0f, std::memory_order_relaxed);
+            fMaxLoad.store(0.0f, std::memory_order_relaxed);
+            for (std::atomic<uint64_t>& mBin: fHistogram) {
+                mBin.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+} // namespace klangwellen
@@ -0,0 +1,658 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [x] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t)
+ * - [ ] void process(float*, float*, uint32_t)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "FFT.h"
+#include "KlangWellen.h"
+#include "Note.h"
+#include "Scale.h"
+
+namespace klangwellen {
+    /**
+     * pitch correction ( "autotune" ) of a monophonic signal ( e.g a voice ). the pitch is detected every `N / 4` samples
+     * from the autocorrelation of the input, snapped to the notes of a scale and the signal is shifted to the corrected
+     * pitch with a pitch synchronous overlap-add. an optional formant corrector keeps the timbre of the voice when it is
+     * shifted.
+     * <p>
+     * the algorithm is *Autotalent* by Thomas A. Baran ( http://web.mit.edu/tbaran/www/autotalent.html, GPLv2 or later )
+     * in the version modified by Ethan Chen ( http://github.com/intervigilium/autotalent-harness ). the port uses the
+     * kissfft backend of `FFT` and allocates all buffers in the constructor, `process()` does not allocate.
+     * <p>
+     * `N` is 2048 samples ( 4096 at 88.2KHz and above ), the output is delayed by `get_latency()` samples.
+     */
+    class Autotune {
+    public:
+        /**
+         * @param sample_rate the sample rate in Hz.
+         */
+        explicit Autotune(const uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE)
+            : fSampleRate(sample_rate),
+              N(sample_rate >= 88200 ? 4096 : 2048),
+              fMask(N - 1),
+              fFFT(N) {
+            fNumBins   = N / 2 + 1;
+            fMinPeriod = static_cast<uint32_t>(static_cast<float>(fSampleRate) / 700.0f);
+            fMaxPeriod = std::min(static_cast<uint32_t>(static_cast<float>(fSampleRate) / 70.0f), fNumBins);
+
+            fInput.resize(N, 0.0f);
+            fFormantInput.resize(N, 0.0f);
+            fOutput.resize(N, 0.0f);
+            fFragment.resize(N, 0.0f);
+            fTime.resize(N, 0.0f);
+            fSpectrum.resize(fNumBins);
+            fHannWindow.resize(N, 0.0f);
+            fWindow.resize(N, 0.0f);
+            fWindowCorrelation.resize(N, 0.0f);
+            fFormantCoefficients.resize(FORMANT_ORDER * N, 0.0f);
+
+            /* raised cosine of length N and a single raised cosine from N / 4 to 3N / 4 */
+            for (uint32_t i = 0; i < N; i++) {
+                fHannWindow[i] = -0.5f * cosf(TWO_PI * i / N) + 0.5f;
+            }
+            for (uint32_t i = 0; i < N / 2; i++) {
+                fWindow[i + N / 4] = -0.5f * cosf(2 * TWO_PI * i / (N - 1)) + 0.5f;
+            }
+
+            /* inverse of the autocorrelation of the window, unbiases the confidence of the pitch estimate */
+            autocorrelation(fWindow.data());
+            for (uint32_t i = 1; i < N; i++) {
+                const float mCorrelation = fTime[i] / fTime[0];
+                fWindowCorrelation[i]    = mCorrelation > 0.000001f ? 1.0f / mCorrelation : 0.0f;
+            }
+            fWindowCorrelation[0] = 1.0f;
+
+            const float mSampleRate = static_cast<float>(fSampleRate);
+            fFormantAlpha           = powf(0.001f, 80.0f / mSampleRate);
+            fFormantLambda          = -(0.8517f * sqrtf(atanf(0.06583f * mSampleRate)) - 0.1916f);
+            fFormantLowPassAlpha    = powf(0.001f, 10.0f / mSampleRate);
+            fFormantMuteAlpha       = powf(0.001f, 1.0f / mSampleRate);
+
+            fInputPhaseIncrement  = 1.0 / (DEFAULT_PERIOD * mSampleRate);
+            fOutputPhaseIncrement = fInputPhaseIncrement;
+
+            set_scale_rotate(0);
+            set_formant_warp(0.0f);
+            set_lfo(0.0f, 5.0f);
+        }
+
+        Autotune(const Autotune&)            = delete;
+        Autotune& operator=(const Autotune&) = delete;
+
+        /**
+         * @param frequency frequency of A in Hz ( default 440Hz )
+         */
+        void set_concert_a(const float frequency) {
+            fConcertA = frequency;
+        }
+
+        /**
+         * snaps the pitch to the notes of `scale`. the default is the chromatic scale.
+         *
+         * @param scale     scale e.g `ScaleCollection::MAJOR`
+         * @param root_note root of the scale as a note e.g `Note::C4` ( only the pitch class is used )
+         */
+        void set_scale(const Scale& scale, const uint8_t root_note = Note::C4) {
+            for (int8_t& mNote: fNotes) {
+                mNote = -1;
+            }
+            for (uint8_t i = 0; i < scale.length; i++) {
+                /* notes are counted from A */
+                fNotes[(root_note + scale.notes[i] + 3) % 12] = 1;
+            }
+            update_scale();
+        }
+
+        /**
+         * @param steps rotates the notes of the output scale by a number of scale steps ( e.g turns major into minor )
+         */
+        void set_scale_rotate(const int8_t steps) {
+            fScaleRotateSteps = steps;
+            update_scale();
+        }
+
+        /**
+         * @param semitones pitch to pull to in semitones relative to A
+         */
+        void set_fixed_pitch(const float semitones) {
+            fFixedPitch = semitones;
+        }
+
+        /**
+         * @param pull amount of pull towards the fixed pitch, a value between 0 ( default, no pull ) and 1
+         */
+        void set_fixed_pull(const float pull) {
+            fFixedPull = pull;
+        }
+
+        /**
+         * @param strength amount of correction, a value between 0 ( no correction ) and 1 ( default, hard snapping )
+         */
+        void set_correction_strength(const float strength) {
+            fCorrectionStrength = strength;
+        }
+
+        /**
+         * @param smooth duration of transitions between notes, a value between 0 ( default, immediate ) and 1
+         */
+        void set_correction_smooth(const float smooth) {
+            fCorrectionSmooth = std::max(smooth * 0.8f, 0.001f);
+        }
+
+        /**
+         * @param steps shifts the output pitch by a number of scale steps
+         */
+        void set_pitch_shift(const float steps) {
+            fPitchShift = steps;
+        }
+
+        /**
+         * modulates the output pitch with an LFO.
+         *
+         * @param depth    depth in semitones / 2 ( 0 disables the LFO )
+         * @param rate     frequency in Hz
+         * @param shape    a value between -1 ( square ) over 0 ( triangle ) to 1 ( sine )
+         * @param symmetry a value between -1 and 1 ( 0 is symmetric )
+         * @param quantize snaps the modulated pitch to the scale
+         */
+        void set_lfo(const float depth,
+                     const float rate,
+                     const float shape    = 0.0f,
+                     const float symmetry = 0.0f,
+                     const bool  quantize = false) {
+            fLFODepth     = depth;
+            fLFOIncrement = std::min(rate * static_cast<float>(N) / static_cast<float>(OVERLAP * fSampleRate), 1.0f);
+            fLFOShape     = shape;
+            fLFOSymmetry  = (symmetry + 1.0f) / 2.0f;
+            fLFOQuantize  = quantize;
+        }
+
+        /**
+         * @param formant_correction preserves the formants of the input when the pitch is shifted ( default false )
+         */
+        void set_formant_correction(const bool formant_correction) {
+            fFormantCorrection = formant_correction;
+        }
+
+        /**
+         * @param warp shifts the formants, a value between -1 and 1 ( default 0 ). requires formant correction.
+         */
+        void set_formant_warp(const float warp) {
+            const float mWarp  = powf(2.0f, warp / 2.0f) * (1.0f + fFormantLambda) / (1.0f - fFormantLambda);
+            fFormantWarpLambda = (mWarp - 1.0f) / (mWarp + 1.0f);
+        }
+
+        /**
+         * @param mix mix between the ( delayed ) input at 0 and the corrected signal at 1 ( default )
+         */
+        void set_mix(const float mix) {
+            fMix = mix;
+        }
+
+        /**
+         * @return detected pitch in semitones relative to A ( the last voiced estimate )
+         */
+        float get_pitch() const {
+            return fInputPitch;
+        }
+
+        /**
+         * @return detected frequency in Hz ( the last voiced estimate )
+         */
+        float get_frequency() const {
+            return fConcertA * powf(2.0f, fInputPitch / 12.0f);
+        }
+
+        /**
+         * @return corrected pitch in semitones relative to A
+         */
+        float get_corrected_pitch() const {
+            return fOutputPitch;
+        }
+
+        /**
+         * @return confidence of the last pitch estimate, signals above 0.7 are considered voiced
+         */
+        float get_confidence() const {
+            return fConfidence;
+        }
+
+        /**
+         * @return delay of the output in samples
+         */
+        uint32_t get_latency() const {
+            return N - 1;
+        }
+
+        float process(float signal) {
+            fInput[fWrite] = signal;
+            if (fFormantCorrection) {
+                fFormantInput[fWrite] = formant_prefilter(signal, fWrite);
+            } else {
+                fFormantInput[fWrite] = signal;
+            }
+            fWrite = (fWrite + 1) & fMask;
+
+            /* low-rate section */
+            if ((fWrite & (N / OVERLAP - 1)) == 0) {
+                detect_pitch();
+                correct_pitch();
+                fInputPhaseIncrement  = fConcertA * pow(2.0, fInputPitch / 12.0) / fSampleRate;
+                fOutputPhaseIncrement = fConcertA * pow(2.0, fOutputPitch / 12.0) / fSampleRate;
+                fPhaseIncrementFactor = fOutputPhaseIncrement / fInputPhaseIncrement;
+            }
+
+            /* pitch shifter ( a pitch synchronous version of Fairbanks' technique ), the pitch estimate is N / 2 samples old */
+            fInputPhase += fInputPhaseIncrement;
+            fOutputPhase += fOutputPhaseIncrement;
+            if (fInputPhase >= 1) {
+                /* take a fragment from N / 2 samples in the past */
+                fInputPhase -= 1;
+                const uint32_t mStart = fWrite - N / 2;
+                for (uint32_t i = 0; i < N; i++) {
+                    fFragment[i] = fFormantInput[(i + mStart) & fMask];
+                }
+            }
+            if (fOutputPhase >= 1) {
+                /* put the resampled fragment N / 2 samples in the future */
+                fOutputPhase -= 1;
+                fFragmentSize = std::min(fFragmentSize * 2, N);
+                const int32_t mCenter = static_cast<int32_t>(fRead + N / 2);
+                const int32_t mLength = std::min(static_cast<int32_t>(static_cast<float>(fFragmentSize) / fPhaseIncrementFactor),
+                                                 static_cast<int32_t>(N / 2 - 1));
+                for (int32_t i = -mLength / 2; i < mLength / 2; i++) {
+                    const float mWindow = fHannWindow[N / 2 + i * static_cast<int32_t>(N) / mLength];
+                    fOutput[(i + mCenter) & fMask] += interpolate(static_cast<float>(fPhaseIncrementFactor * i)) * mWindow;
+                }
+                fFragmentSize = 0;
+            }
+            fFragmentSize++;
+
+            float mOutput  = fOutput[fRead];
+            fOutput[fRead] = 0.0f;
+            fRead          = (fRead + 1) & fMask;
+
+            const uint32_t mDelayed = (fWrite + 2) & fMask;
+            if (fFormantCorrection) {
+                mOutput = formant_postfilter(mOutput, mDelayed);
+            } else {
+                fFormantMute = 0.0f;
+            }
+            return fMix * mOutput + (1.0f - fMix) * fInput[mDelayed];
+        }
+
+        void process(float* signal_buffer, const uint32_t buffer_length) {
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] = process(signal_buffer[i]);
+            }
+        }
+
+    private:
+        static constexpr uint32_t OVERLAP          = 4;
+        static constexpr uint8_t  FORMANT_ORDER    = 7;
+        static constexpr float    VOICED_THRESHOLD = 0.7f;
+        static constexpr float    DEFAULT_PERIOD   = 0.01f;
+        static constexpr float    MAX_REFLECTION   = 0.95f;
+
+        const uint32_t fSampleRate;
+        const uint32_t N;
+        const uint32_t fMask;
+        const FFT      fFFT;
+        uint32_t       fNumBins;
+        uint32_t       fMinPeriod;
+        uint32_t       fMaxPeriod;
+
+        std::vector<float>               fInput;        /* circular input buffer */
+        std::vector<float>               fFormantInput; /* circular input buffer with formants removed */
+        std::vector<float>               fOutput;       /* circular output buffer */
+        std::vector<float>               fFragment;     /* fragment of the input taken at each input period */
+        std::vector<float>               fTime;
+        std::vector<std::complex<float>> fSpectrum;
+        std::vector<float>               fHannWindow;
+        std::vector<float>               fWindow;
+        std::vector<float>               fWindowCorrelation;
+        uint32_t                         fWrite = 0;
+        uint32_t                         fRead  = 0;
+
+        /* parameters */
+        float  fConcertA           = 440.0f;
+        int8_t fNotes[12]          = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}; /* from A, 1 is in the scale, -1 is not */
+        int8_t fPitchToNote[12]    = {};
+        int8_t fNoteToPitch[12]    = {};
+        int8_t fNumNotes           = 12;
+        int8_t fScaleRotateSteps   = 0;
+        int8_t fScaleRotate        = 0;
+        float  fFixedPitch         = 0.0f;
+        float  fFixedPull          = 0.0f;
+        float  fCorrectionStrength = 1.0f;
+        float  fCorrectionSmooth   = 0.001f;
+        float  fPitchShift         = 0.0f;
+        float  fLFODepth           = 0.0f;
+        float  fLFOIncrement       = 0.0f;
+        float  fLFOShape           = 0.0f;
+        float  fLFOSymmetry        = 0.5f;
+        bool   fLFOQuantize        = false;
+        bool   fFormantCorrection  = false;
+        float  fMix                = 1.0f;
+
+        /* low-rate section */
+        float fInputPitch  = 0.0f; /* semitones relative to A */
+        float fOutputPitch = 0.0f;
+        float fConfidence  = 0.0f;
+        float fLFOPhase    = 0.0f;
+
+        /* pitch shifter */
+        double   fInputPhaseIncrement  = 0.0;
+        double   fOutputPhaseIncrement = 0.0;
+        double   fPhaseIncrementFactor = 1.0;
+        double   fInputPhase           = 0.0;
+        double   fOutputPhase          = 0.0;
+        uint32_t fFragmentSize         = 0;
+
+        /* formant corrector */
+        float              fFormantAlpha;
+        float              fFormantLambda;
+        float              fFormantWarpLambda = 0.0f;
+        float              fFormantLowPassAlpha;
+        float              fFormantMuteAlpha;
+        float              fFormantK[FORMANT_ORDER]      = {};
+        float              fFormantB[FORMANT_ORDER]      = {};
+        float              fFormantC[FORMANT_ORDER]      = {};
+        float              fFormantRB[FORMANT_ORDER]     = {};
+        float              fFormantRC[FORMANT_ORDER]     = {};
+        float              fFormantSignal[FORMANT_ORDER] = {};
+        float              fFormantSmooth[FORMANT_ORDER] = {};
+        float              fFormantTemp[FORMANT_ORDER]   = {};
+        std::vector<float> fFormantCoefficients; /* circular buffer of N sets of FORMANT_ORDER coefficients */
+        float              fFormantHighPass = 0.0f;
+        float              fFormantLowPass  = 0.0f;
+        float              fFormantMute     = 1.0f;
+        float              fFormantNoise    = 1e-15f;
+
+        void update_scale() {
+            int8_t mNumNotes = 0;
+            for (int8_t i = 0; i < 12; i++) {
+                if (fNotes[i] >= 0) {
+                    fPitchToNote[i]         = mNumNotes;
+                    fNoteToPitch[mNumNotes] = i;
+                    mNumNotes++;
+                } else {
+                    fPitchToNote[i] = -1;
+                }
+            }
+            for (int8_t i = mNumNotes; i < 12; i++) {
+                fNoteToPitch[i] = -1;
+            }
+            if (mNumNotes == 0) {
+                /* snap to all notes if the scale is empty */
+                for (int8_t i = 0; i < 12; i++) {
+                    fNotes[i]       = 1;
+                    fPitchToNote[i] = i;
+                    fNoteToPitch[i] = i;
+                }
+                mNumNotes = 12;
+            }
+            fNumNotes    = mNumNotes;
+            fScaleRotate = static_cast<int8_t>(((fScaleRotateSteps % mNumNotes) + mNumNotes) % mNumNotes);
+        }
+
+        /* writes the normalized autocorrelation of `signal` to `fTime` */
+        void autocorrelation(const float* signal) {
+            fFFT.forward(signal, fSpectrum.data());
+            fSpectrum[0] = 0.0f;
+            for (uint32_t i = 1; i < fNumBins; i++) {
+                fSpectrum[i] = std::norm(fSpectrum[i]);
+            }
+            fFFT.inverse(fSpectrum.data(), fTime.data());
+            const float mNormalize = 1.0f / fTime[0];
+            for (uint32_t i = 1; i < N; i++) {
+                fTime[i] *= mNormalize;
+            }
+            fTime[0] = 1.0f;
+        }
+
+        void detect_pitch() {
+            for (uint32_t i = 0; i < N; i++) {
+                fTime[i] = fInput[(fWrite - i) & fMask] * fWindow[i];
+            }
+            autocorrelation(fTime.data());
+
+            /* the period is the location of the maximum ( biased ) peak, the confidence is its unbiased height */
+            float    mPeak   = 0.0f;
+            uint32_t mPeriod = 0;
+            for (uint32_t i = fMinPeriod; i < fMaxPeriod; i++) {
+                const float mValue = fTime[i];
+                if (mValue > fTime[i - 1] && mValue >= fTime[std::min(i + 1, fNumBins)] && mValue > mPeak) {
+                    mPeak   = mValue;
+                    mPeriod = i;
+                }
+            }
+            if (mPeak > 0.0f) {
+                fConfidence = mPeak * fWindowCorrelation[mPeriod];
+                /* center of mass around the peak */
+                const float mCenter = (fTime[mPeriod - 1] * (mPeriod - 1) + fTime[mPeriod] * mPeriod + fTime[mPeriod + 1] * (mPeriod + 1)) /
+                                      (fTime[mPeriod - 1] + fTime[mPeriod] + fTime[mPeriod + 1]);
+                if (fConfidence >= VOICED_THRESHOLD) {
+                    /* update the pitch only if voiced */
+                    fInputPitch = -12.0f * log2f(fConcertA * mCenter / static_cast<float>(fSampleRate));
+                }
+            }
+        }
+
+        void correct_pitch() {
+            /* pull to fixed pitch */
+            float mPitch = (1.0f - fFixedPull) * fInputPitch + fFixedPull * fFixedPitch;
+
+            /* convert from semitones to scale notes */
+            int32_t mOctave   = static_cast<int32_t>(mPitch / 12.0f + 32.0f) - 32;
+            float   mSemitone = mPitch - static_cast<float>(mOctave * 12);
+            int32_t mLower    = static_cast<int32_t>(mSemitone);
+            int32_t mUpper    = mLower + 1;
+            /* snap only if between two notes of the scale that are not more than a semitone apart */
+            bool mSnapLower = true;
+            bool mSnapUpper = true;
+            if (fNotes[mLower % 12] >= 0 && fNotes[mUpper % 12] >= 0) {
+                mSnapLower = fNotes[mLower % 12] == 1;
+                mSnapUpper = fNotes[mUpper % 12] == 1;
+            }
+            while (fNotes[(mLower + 12) % 12] < 0) {
+                mLower--;
+            }
+            while (fNotes[mUpper % 12] < 0) {
+                mUpper++;
+            }
+            float mNote = (mSemitone - static_cast<float>(mLower)) / static_cast<float>(mUpper - mLower) + fPitchToNote[(mLower + 12) % 12];
+            if (mLower < 0) {
+                mNote -= fNumNotes;
+            }
+            mPitch = mNote + static_cast<float>(fNumNotes * mOctave);
+
+            /* the actual pitch correction, jumps between notes with a horizontally scaled sine segment */
+            const int32_t mNoteIndex = static_cast<int32_t>(mPitch + 128.0f) - 128;
+            const float   mFraction  = mPitch - static_cast<float>(mNoteIndex) - 0.5f;
+            const int32_t mDistance  = mUpper - mLower;
+            /* notes more than 2 semitones apart get a 2-semitone-like transition halfway between */
+            const float mTransition = mDistance > 2 ? static_cast<float>(mDistance) / 2.0f : 1.0f;
+            float       mSnapped    = std::clamp(mFraction * mTransition / fCorrectionSmooth, -0.5f, 0.5f);
+            mSnapped                = 0.5f * sinf(PI * mSnapped) + 0.5f + static_cast<float>(mNoteIndex);
+            if ((mFraction < 0.5f && mSnapLower) || (mFraction >= 0.5f && mSnapUpper)) {
+                mPitch = fCorrectionStrength * mSnapped + (1.0f - fCorrectionStrength) * mPitch;
+            }
+
+            mPitch += fPitchShift;
+
+            const float mLFO = lfo();
+            if (fLFOQuantize) {
+                mPitch += static_cast<float>(static_cast<int32_t>(fNumNotes * mLFO + fNumNotes + 0.5f) - fNumNotes);
+            }
+
+            /* convert back from scale notes to semitones, rotates the output scale */
+            mPitch += fScaleRotate;
+            mOctave                = static_cast<int32_t>(mPitch / fNumNotes + 32.0f) - 32;
+            mNote                  = mPitch - static_cast<float>(mOctave * fNumNotes);
+            const int32_t mNoteLow = static_cast<int32_t>(mNote);
+            const int32_t mNoteUp  = mNoteLow + 1;
+            mPitch                 = static_cast<float>(fNoteToPitch[mNoteUp % fNumNotes] - fNoteToPitch[mNoteLow]);
+            if (mNoteUp >= fNumNotes) {
+                mPitch += 12.0f;
+            }
+            mPitch = mPitch * (mNote - static_cast<float>(mNoteLow)) + fNoteToPitch[mNoteLow];
+            mPitch += static_cast<float>(12 * mOctave);
+            mPitch -= static_cast<float>(fNoteToPitch[fScaleRotate] - fNoteToPitch[0]);
+
+            if (!fLFOQuantize) {
+                mPitch += mLFO * 2.0f;
+            }
+
+            if (mPitch < -36.0f) {
+                mPitch = -48.0f;
+            }
+            fOutputPitch = std::min(mPitch, 24.0f);
+        }
+
+        float lfo() {
+            fLFOPhase += fLFOIncrement;
+            if (fLFOPhase > 1.0f) {
+                fLFOPhase -= 1.0f;
+            }
+            float mValue = fLFOPhase;
+            if (fLFOSymmetry <= 0.0f || fLFOSymmetry >= 1.0f) {
+                if (fLFOSymmetry <= 0.0f) {
+                    mValue = 1.0f - mValue;
+                }
+            } else if (mValue <= fLFOSymmetry) {
+                mValue = mValue / fLFOSymmetry;
+            } else {
+                mValue = 1.0f - (mValue - fLFOSymmetry) / (1.0f - fLFOSymmetry);
+            }
+            if (fLFOShape >= 0.0f) {
+                /* linear combination of cosine and line */
+                mValue = (0.5f - 0.5f * cosf(mValue * PI)) * fLFOShape + mValue * (1.0f - fLFOShape);
+                return fLFODepth * (mValue * 2.0f - 1.0f);
+            }
+            /* squash the sine horizontally until it is squarish */
+            mValue = std::clamp((mValue - 0.5f) * 2.0f / std::max(1.0f + fLFOShape, 0.001f), -1.0f, 1.0f);
+            return fLFODepth * sinf(mValue * HALF_PI);
+        }
+
+        /* 3rd degree polynomial interpolation of the fragment ( after Hal Chamberlin ) */
+        float interpolate(const float position) const {
+            const int32_t i1 = static_cast<int32_t>(position);
+            const int32_t i0 = i1 - 1;
+            const int32_t i2 = i1 + 1;
+            const int32_t i3 = i1 + 2;
+            const float   d0 = position - static_cast<float>(i0);
+            const float   d1 = position - static_cast<float>(i1);
+            const float   d2 = position - static_cast<float>(i2);
+            const float   d3 = position - static_cast<float>(i3);
+            return -0.166666666667f * fFragment[i0 & fMask] * d1 * d2 * d3 +
+                   0.5f * fFragment[i1 & fMask] * d0 * d2 * d3 -
+                   0.5f * fFragment[i2 & fMask] * d0 * d1 * d3 +
+                   0.166666666667f * fFragment[i3 & fMask] * d0 * d1 * d2;
+        }
+
+        /* removes the formants with an adaptive lattice filter, the coefficients are kept for the post-filter */
+        float formant_prefilter(const float signal, const uint32_t position) {
+            /* an inaudible signal at the nyquist frequency keeps the filters from decaying into denormals in silence */
+            const float mSignal        = signal + fFormantNoise;
+            fFormantNoise              = -fFormantNoise;
+            const float mOneMinusAlpha = 1.0f - fFormantAlpha;
+            float       a              = mSignal - fFormantHighPass; /* highpass pre-emphasis */
+            fFormantHighPass           = mSignal;
+            float b                    = a;
+            for (uint8_t i = 0; i < FORMANT_ORDER; i++) {
+                fFormantSignal[i] = a * a * mOneMinusAlpha + fFormantSignal[i] * fFormantAlpha;
+                const float c     = (b - fFormantC[i]) * fFormantLambda + fFormantB[i];
+                fFormantC[i]      = c;
+                fFormantB[i]      = b;
+                fFormantK[i]      = a * c * mOneMinusAlpha + fFormantK[i] * fFormantAlpha;
+                /* limiting the coefficients keeps the post-filter stable for ( almost ) pure tones */
+                float k           = std::clamp(fFormantK[i] / (fFormantSignal[i] + 0.000001f), -MAX_REFLECTION, MAX_REFLECTION);
+                k                 = k * mOneMinusAlpha + fFormantSmooth[i] * fFormantAlpha;
+                fFormantSmooth[i] = k;
+                b                 = c - k * a;
+                a                 = a - k * c;
+                fFormantCoefficients[position * FORMANT_ORDER + i] = k;
+            }
+            return a;
+        }
+
+        /* response of the post-filter to `input` without updating its state */
+        float formant_response(const float input, const uint32_t position) {
+            float a = input;
+            float b = a;
+            for (uint8_t i = 0; i < FORMANT_ORDER; i++) {
+                const float c   = (b - fFormantRC[i]) * fFormantWarpLambda + fFormantRB[i];
+                const float k   = fFormantCoefficients[position * FORMANT_ORDER + i];
+                b               = c - k * a;
+                fFormantTemp[i] = k * c;
+                a               = a - fFormantTemp[i];
+            }
+            float mResponse = -a;
+            for (int8_t i = FORMANT_ORDER - 1; i >= 0; i--) {
+                mResponse += fFormantTemp[i];
+            }
+            return mResponse;
+        }
+
+        /* re-applies the formants, results in the original signal if the pitch is not changed */
+        float formant_postfilter(const float signal, const uint32_t position) {
+            /* solves the delay free loop from the responses to 0 and 1 */
+            const float mResponse0   = formant_response(0.0f, position);
+            const float mResponse1   = formant_response(1.0f, position);
+            const float mDenominator = 1.0f - mResponse1 + mResponse0;
+            const float mOutput      = mDenominator != 0.0f ? (2.0f * signal + mResponse0) / mDenominator : 0.0f;
+
+            /* update the state */
+            float a = mOutput;
+            float b = a;
+            for (uint8_t i = 0; i < FORMANT_ORDER; i++) {
+                const float c = (b - fFormantRC[i]) * fFormantWarpLambda + fFormantRB[i];
+                fFormantRC[i] = c;
+                fFormantRB[i] = b;
+                const float k = fFormantCoefficients[position * FORMANT_ORDER + i];
+                b             = c - k * a;
+                a             = a - k * c;
+            }
+
+            /* lowpass post-emphasis, fades in when formant correction is enabled */
+            float mSignal   = mOutput + fFormantLowPassAlpha * fFormantLowPass;
+            fFormantLowPass = mSignal;
+            mSignal         = fFormantMute > 0.5f ? mSignal * (fFormantMute - 0.5f) * 2.0f : 0.0f;
+            fFormantMute    = (1.0f - fFormantMuteAlpha) + fFormantMuteAlpha * fFormantMute;
+            return mSignal;
+        }
+    };
+} // namespace klangwellen
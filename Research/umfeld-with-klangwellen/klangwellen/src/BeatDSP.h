@@ -33,12 +33,17 @@
 
 #include <vector>
 
+#include "EventQueue.h"
 #include "KlangWellen.h"
 
 /**
  * similar to {@link wellen.Beat} with the exception that events are triggered from {@link DSP}.
  */
 namespace klangwellen {
+    /**
+     * called from inside `process()` ( i.e the audio thread ), see `BeatDSP::set_event_queue()` to handle events
+     * elsewhere.
+     */
     class BeatListener {
     public:
         virtual void beat(uint32_t beat_counter) = 0;
@@ -46,6 +51,8 @@ namespace klangwellen {
 
     class BeatDSP {
     public:
+        static constexpr uint8_t EVENT_BEAT = 0;
+
         BeatDSP(uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE) : fSampleRate(sample_rate), fBeat(-1) {
             set_bpm(120);
         }
@@ -64,6 +71,25 @@ namespace klangwellen {
             return false;
         }
 
+        /**
+         * pushes an `EVENT_BEAT` event with the beat counter as value into `queue` for every beat ( in addition to
+         * calling the listeners and the callback ), see `EventQueue`.
+         *
+         * @param queue  queue or `nullptr` to stop pushing events
+         * @param source id of the beat in the events
+         */
+        void set_event_queue(EventQueue* queue, const uint8_t source = 0) {
+            fEventQueue  = queue;
+            fEventSource = source;
+        }
+
+        /**
+         * @return number of samples processed so far
+         */
+        uint64_t get_frame() const {
+            return fFrame;
+        }
+
         void set_bpm(float BPM) {
             const float mPeriod = 60.0f / BPM;
             fTickInterval       = fSampleRate * mPeriod;
@@ -97,13 +123,25 @@ namespace klangwellen {
                 fireEvent();
                 fTickCounter -= fTickInterval;
             }
+            fFrame++;
             return 0.0;
         }
 
         void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
             (void) signal_buffer;
-            for (uint16_t i = 0; i < buffer_length; i++) {
+            /* jump from beat to beat instead of counting every sample */
+            uint32_t mRemaining = buffer_length;
+            while (mRemaining > 0) {
+                if (fTickCounter + mRemaining < fTickInterval) {
+                    fTickCounter += mRemaining;
+                    fFrame += mRemaining;
+                    return;
+                }
+                const uint32_t mTicks = ticks_to_next_beat(mRemaining);
+                fTickCounter += mTicks - 1;
+                fFrame += mTicks - 1;
                 process();
+                mRemaining -= mTicks;
             }
         }
 
@@ -126,8 +164,24 @@ namespace klangwellen {
         const uint32_t             fSampleRate;
         int                        fBeat;
         std::vector<BeatListener*> fListeners;
-        uint32_t                   fTickCounter;
+        uint32_t                   fTickCounter = 0;
         float                      fTickInterval;
+        EventQueue*                fEventQueue  = nullptr;
+        uint8_t                    fEventSource = 0;
+        uint64_t                   fFrame       = 0;
+
+        /* number of `process()` calls up to and including the next beat, at most `max_ticks` */
+        uint32_t ticks_to_next_beat(const uint32_t max_ticks) const {
+            uint32_t mTicks = fTickCounter < fTickInterval ? static_cast<uint32_t>(fTickInterval - fTickCounter) : 1;
+            mTicks          = KlangWellen::clamp(mTicks, static_cast<uint32_t>(1), max_ticks);
+            while (mTicks > 1 && fTickCounter + mTicks - 1 >= fTickInterval) {
+                mTicks--;
+            }
+            while (mTicks < max_ticks && fTickCounter + mTicks < fTickInterval) {
+                mTicks++;
+            }
+            return mTicks;
+        }
 
         void call_beat(const uint32_t beat_counter) {
             if (fCallbackEvent) {
@@ -141,6 +195,9 @@ namespace klangwellen {
                 l->beat(fBeat);
             }
             call_beat(fBeat);
+            if (fEventQueue != nullptr) {
+                fEventQueue->push(fFrame, EVENT_BEAT, fBeat, fEventSource);
+            }
         }
     };
 } // namespace klangwellen
\ No newline at end of file
@@ -33,6 +33,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <algorithm>
 
 #include "KlangWellen.h"
 #include "AudioSignal.h"
@@ -40,27 +41,117 @@
 namespace klangwellen {
 
     /**
-     * a delay line.
+     * a delay line with a fractional, modulated delay. the buffer is allocated once in the constructor for the maximum echo
+     * length, changing the echo length never allocates and glides to the new length over the smoothing time. an optional
+     * sine LFO modulates the echo length ( e.g for chorus or flanger effects ).
+     *
+     * note that `set_echo_length()` used to reallocate the buffer in `process()` and change the echo length at once. it
+     * now clamps the echo length to the maximum echo length set in the constructor ( twice the initial echo length by
+     * default ) and glides to it over `DEFAULT_SMOOTHING` ( 0.05 seconds ). pass a larger `max_echo_length` to the
+     * constructor to allow longer echoes, and call `set_smoothing(0)` to change the echo length immediately.
      */
     class Delay {
     public:
+        static constexpr uint8_t INTERPOLATE_NONE    = KlangWellen::WAVESHAPE_INTERPOLATE_NONE;
+        static constexpr uint8_t INTERPOLATE_LINEAR  = KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR;
+        static constexpr uint8_t INTERPOLATE_CUBIC   = KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC;
+        static constexpr uint8_t INTERPOLATE_ALLPASS = 3;
+        static constexpr float   DEFAULT_SMOOTHING   = 0.05f;
+        static constexpr float   DEFAULT_MAX_ECHO    = 2.0f; /* default maximum echo length relative to the initial one */
+
         /**
-         * @param echo_length in seconds
-         * @param sample_rate the sample rate in Hz.
-         * @param decay_rate  the decay of the echo, a value between 0 and 1. 1 meaning no decay, 0 means immediate decay
+         * @param echo_length     in seconds
+         * @param decay_rate      the decay of the echo, a value between 0 and 1. 1 meaning no decay, 0 means immediate decay
+         * @param wet             mix of the echo, a value between 0 and 1
+         * @param sample_rate     the sample rate in Hz.
+         * @param max_echo_length in seconds, defaults to twice `echo_length`. the echo length ( including modulation ) is clamped to it
          */
-        Delay(float echo_length = 0.5, float decay_rate = 0.75, float wet = 0.8, uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE) : fSampleRate(sample_rate) {
+        Delay(float    echo_length     = 0.5,
+              float    decay_rate      = 0.75,
+              float    wet             = 0.8,
+              uint32_t sample_rate     = KlangWellen::DEFAULT_SAMPLE_RATE,
+              float    max_echo_length = 0) : fSampleRate(sample_rate) {
+            const float    mMaxEcho  = max_echo_length > 0 ? std::max(max_echo_length, echo_length) : echo_length * DEFAULT_MAX_ECHO;
+            const uint32_t mMaxDelay = static_cast<uint32_t>(static_cast<float>(fSampleRate) * mMaxEcho);
+            /* power of two with room for the interpolation taps, so positions wrap with a mask */
+            fBufferLength = 4;
+            while (fBufferLength < mMaxDelay + 4) {
+                fBufferLength <<= 1;
+            }
+            fBufferMask = fBufferLength - 1;
+            fMaxDelay   = static_cast<float>(std::max<uint32_t>(mMaxDelay, MIN_DELAY));
+            fBuffer     = new float[fBufferLength]{0};
             set_decay_rate(decay_rate);
-            set_echo_length(echo_length);
             set_wet(wet);
-            adaptEchoLength();
+            set_smoothing(DEFAULT_SMOOTHING);
+            fDelay = fDelayTarget = clamp_delay(static_cast<float>(fSampleRate) * echo_length);
+        }
+
+        ~Delay() {
+            delete[] fBuffer;
         }
 
+        Delay(const Delay&)            = delete;
+        Delay& operator=(const Delay&) = delete;
+
         /**
-         * @param echo_length new echo buffer length in seconds.
+         * glides to the new echo length over the smoothing time ( default 0.05 seconds, see `set_smoothing()` ). does not
+         * allocate.
+         *
+         * @param echo_length new echo length in seconds, clamped to the maximum echo length ( see `get_max_echo_length()` ).
          */
         void set_echo_length(float echo_length) {
-            fNewEchoLength = echo_length;
+            fDelayTarget = clamp_delay(static_cast<float>(fSampleRate) * echo_length);
+            fDelaySteps  = fSmoothing;
+            if (fDelaySteps == 0) {
+                fDelay = fDelayTarget;
+            } else {
+                fDelayIncrement = (fDelayTarget - fDelay) / static_cast<float>(fDelaySteps);
+            }
+        }
+
+        /**
+         * @return echo length in seconds ( target of a glide, without modulation )
+         */
+        float get_echo_length() const {
+            return fDelayTarget / static_cast<float>(fSampleRate);
+        }
+
+        float get_max_echo_length() const {
+            return fMaxDelay / static_cast<float>(fSampleRate);
+        }
+
+        /**
+         * @param smoothing duration of a glide to a new echo length in seconds ( default 50ms, 0 changes the echo length
+         *                  immediately )
+         */
+        void set_smoothing(float smoothing) {
+            fSmoothing = static_cast<uint32_t>(std::max(smoothing, 0.0f) * static_cast<float>(fSampleRate));
+        }
+
+        /**
+         * @param interpolation one of `INTERPOLATE_NONE`, `INTERPOLATE_LINEAR` ( default ), `INTERPOLATE_CUBIC` or
+         *                      `INTERPOLATE_ALLPASS`. allpass interpolation has a flat frequency response but is meant for
+         *                      constant or slowly changing echo lengths.
+         */
+        void set_interpolation(uint8_t interpolation) {
+            fInterpolation = interpolation;
+            fAllpass       = 0;
+        }
+
+        uint8_t get_interpolation() const {
+            return fInterpolation;
+        }
+
+        /**
+         * modulates the echo length with a sine LFO.
+         *
+         * @param depth     in seconds, 0 disables the modulation
+         * @param frequency in Hz
+         */
+        void set_modulation(float depth, float frequency) {
+            fModulationDepth     = std::max(depth, 0.0f) * static_cast<float>(fSampleRate);
+            fModulationIncrement = frequency / static_cast<float>(fSampleRate);
         }
 
         /**
@@ -85,59 +176,157 @@ namespace klangwellen {
         }
 
         float process(float signal) {
-            adaptEchoLength();
-
-            if (fBufferPosition >= fBufferLength) {
-                fBufferPosition = 0;
-            }
-            const float mDry         = 1.0 - fWet;
-            const float mEcho        = fBuffer[fBufferPosition] * fDecayRate;
-            signal                   = signal * mDry + mEcho * fWet;
-            fBuffer[fBufferPosition] = signal;
-            fBufferPosition++;
-
+            const float mDry        = 1.0 - fWet;
+            const float mEcho       = read(next_delay()) * fDecayRate;
+            signal                  = signal * mDry + mEcho * fWet;
+            fBuffer[fWritePosition] = signal;
+            fWritePosition          = (fWritePosition + 1) & fBufferMask;
             return signal;
         }
 
+        /**
+         * a constant echo length is processed in contiguous runs of the delay buffer, gliding or modulated echo lengths
+         * and allpass interpolation are processed per sample.
+         */
         void process(float*         signal_buffer,
                      const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
+            uint32_t i = 0;
+            if (fModulationDepth > 0 || fInterpolation == INTERPOLATE_ALLPASS) {
+                for (; i < length; i++) {
+                    signal_buffer[i] = process(signal_buffer[i]);
+                }
+                return;
+            }
+            while (i < length && fDelaySteps > 0) {
                 signal_buffer[i] = process(signal_buffer[i]);
+                i++;
+            }
+
+            const float   mDry      = 1.0 - fWet;
+            const float   mWet      = fWet * fDecayRate;
+            const int32_t mDelay    = static_cast<int32_t>(fDelay);
+            const float   mFraction = fDelay - static_cast<float>(mDelay);
+            while (i < length) {
+                const uint32_t mRead = (fWritePosition - mDelay) & fBufferMask;
+                /* the taps `mRead - 2` to `mRead + 1` must not wrap during the run */
+                if (mRead < 2 || mRead >= fBufferMask) {
+                    signal_buffer[i] = process(signal_buffer[i]);
+                    i++;
+                    continue;
+                }
+                const uint32_t mRun = std::min({length - i, fBufferLength - fWritePosition, fBufferLength - 1 - mRead});
+                switch (fInterpolation) {
+                    case INTERPOLATE_NONE:
+                        run<INTERPOLATE_NONE>(signal_buffer + i, fBuffer + mRead, fBuffer + fWritePosition, mRun, mFraction, mDry, mWet);
+                        break;
+                    case INTERPOLATE_CUBIC:
+                        run<INTERPOLATE_CUBIC>(signal_buffer + i, fBuffer + mRead, fBuffer + fWritePosition, mRun, mFraction, mDry, mWet);
+                        break;
+                    default:
+                        run<INTERPOLATE_LINEAR>(signal_buffer + i, fBuffer + mRead, fBuffer + fWritePosition, mRun, mFraction, mDry, mWet);
+                        break;
+                }
+                fWritePosition = (fWritePosition + mRun) & fBufferMask;
+                i += mRun;
             }
         }
 
     private:
-        int32_t  fBufferPosition  = 0;
-        float    fDecayRate       = 0;
-        float    fWet             = 0;
-        float*   fBuffer          = nullptr;
-        bool     fAllocatedBuffer = false;
-        int32_t  fBufferLength    = 0;
-        float    fNewEchoLength   = 0;
+        static constexpr uint32_t MIN_DELAY = 2; /* cubic interpolation reads one sample newer than the delay */
+
+        float*   fBuffer;
+        uint32_t fBufferLength;
+        uint32_t fBufferMask;
+        uint32_t fWritePosition       = 0;
+        float    fMaxDelay;
+        float    fDelay; /* in samples */
+        float    fDelayTarget;
+        float    fDelayIncrement      = 0;
+        uint32_t fDelaySteps          = 0;
+        uint32_t fSmoothing           = 0;
+        float    fModulationDepth     = 0; /* in samples */
+        float    fModulationIncrement = 0;
+        float    fModulationPhase     = 0;
+        uint8_t  fInterpolation       = INTERPOLATE_LINEAR;
+        float    fAllpass             = 0;
+        float    fDecayRate           = 0;
+        float    fWet                 = 0;
         uint32_t fSampleRate;
 
-        void adaptEchoLength() {
-            if (fNewEchoLength > 0) {
-                const uint32_t mNewBufferLength = (uint32_t) (fSampleRate * fNewEchoLength);
-                float*         mNewBuffer       = new float[mNewBufferLength]{0};
-                if (fBuffer != nullptr) {
-                    for (uint32_t i = 0; i < mNewBufferLength; i++) {
-                        if (fBufferPosition >= fBufferLength) {
-                            fBufferPosition = 0;
-                        }
-                        mNewBuffer[i] = fBuffer[fBufferPosition];
-                        fBufferPosition++;
+        float clamp_delay(const float delay) const {
+            return KlangWellen::clamp(delay, static_cast<float>(MIN_DELAY), fMaxDelay);
+        }
+
+        /* advances glide and modulation by one sample, returns the delay of this sample */
+        float next_delay() {
+            if (fDelaySteps > 0) {
+                fDelaySteps--;
+                fDelay = fDelaySteps == 0 ? fDelayTarget : fDelay + fDelayIncrement;
+            }
+            if (fModulationDepth <= 0) {
+                return fDelay;
+            }
+            const float mModulation = fModulationDepth * KlangWellen::sin(static_cast<float>(TWO_PI) * fModulationPhase);
+            fModulationPhase += fModulationIncrement;
+            fModulationPhase -= floorf(fModulationPhase);
+            return clamp_delay(fDelay + mModulation);
+        }
+
+        /* reads the buffer `delay` samples before the write position */
+        float read(const float delay) {
+            int32_t        mDelay    = static_cast<int32_t>(delay);
+            float          mFraction = delay - static_cast<float>(mDelay);
+            const uint32_t mRead     = (fWritePosition - mDelay) & fBufferMask;
+            switch (fInterpolation) {
+                case INTERPOLATE_NONE:
+                    return fBuffer[mRead];
+                case INTERPOLATE_CUBIC:
+                    return KlangWellen::cubic_interpolate(fBuffer[(mRead + 1) & fBufferMask],
+                                                          fBuffer[mRead],
+                                                          fBuffer[(mRead - 1) & fBufferMask],
+                                                          fBuffer[(mRead - 2) & fBufferMask],
+                                                          mFraction);
+                case INTERPOLATE_ALLPASS: {
+                    /* keeps the allpass coefficient away from -1 ( ref: J.O. Smith, "Physical Audio Signal Processing" ) */
+                    if (mFraction < 0.1f && mDelay > 1) {
+                        mDelay--;
+                        mFraction += 1.0f;
                     }
-                    fBufferPosition = 0;
+                    const uint32_t mTap         = (fWritePosition - mDelay) & fBufferMask;
+                    const float    mCoefficient = (1.0f - mFraction) / (1.0f + mFraction);
+                    fAllpass                    = mCoefficient * (fBuffer[mTap] - fAllpass) + fBuffer[(mTap - 1) & fBufferMask];
+                    return fAllpass;
                 }
-                if (fAllocatedBuffer && fBuffer != nullptr) {
-                    delete[] fBuffer;
+                default:
+                    return fBuffer[mRead] + (fBuffer[(mRead - 1) & fBufferMask] - fBuffer[mRead]) * mFraction;
+            }
+        }
+
+        /* `read` points to the sample `delay` samples before `write`, neither wraps during `length` samples */
+        template<uint8_t INTERPOLATION>
+        static void run(float*         signal,
+                        const float*   read,
+                        float*         write,
+                        const uint32_t length,
+                        const float    fraction,
+                        const float    dry,
+                        const float    wet) {
+            const float* mNewer  = read + 1;
+            const float* mOlder  = read - 1;
+            const float* mOldest = read - 2;
+            for (uint32_t j = 0; j < length; j++) {
+                float mEcho;
+                if (INTERPOLATION == INTERPOLATE_NONE) {
+                    mEcho = read[j];
+                } else if (INTERPOLATION == INTERPOLATE_CUBIC) {
+                    mEcho = KlangWellen::cubic_interpolate(mNewer[j], read[j], mOlder[j], mOldest[j], fraction);
+                } else {
+                    mEcho = read[j] + (mOlder[j] - read[j]) * fraction;
                 }
-                fAllocatedBuffer = true;
-                fBuffer          = mNewBuffer;
-                fBufferLength    = mNewBufferLength;
+                const float mOut = signal[j] * dry + mEcho * wet;
+                write[j]         = mOut;
+                signal[j]        = mOut;
             }
-            fNewEchoLength = -1;
         }
     };
-} // namespace klangwellen
\ No newline at end of file
+} // namespace klangwellen
@@ -68,6 +68,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <algorithm>
 #include <vector>
 
 #include "KlangWellen.h"
@@ -154,8 +155,50 @@ namespace klangwellen {
 
         void process(float*         signal_buffer,
                      const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                signal_buffer[i] = process();
+            uint32_t i = 0;
+            while (i < length) {
+                if (fEnvelopeStages.empty()) {
+                    fEnvelopeDone = true;
+                    std::fill_n(signal_buffer + i, length - i, 0.0f);
+                    return;
+                }
+                if (fEnvelopeDone || fEnvStage >= static_cast<int>(fEnvelopeStages.size())) {
+                    std::fill_n(signal_buffer + i, length - i, fValue);
+                    return;
+                }
+
+                /* within a stage value and duration advance by a constant step */
+                const float mValueStep     = fTimeScale * fDelta;
+                const float mDurationStep  = fTimeScale * 1.0f / fSampleRate;
+                const float mStageDuration = fEnvelopeStages[fEnvStage].duration;
+                float       mValue         = fValue;
+                float       mDuration      = fStageDuration;
+                bool        mStageFinished = false;
+                while (i < length) {
+                    mValue += mValueStep;
+                    mDuration += mDurationStep;
+                    signal_buffer[i++] = mValue;
+                    if (mDuration > mStageDuration) {
+                        mStageFinished = true;
+                        break;
+                    }
+                }
+                fValue         = mValue;
+                fStageDuration = mDuration;
+
+                if (mStageFinished) {
+                    const int   mNumberOfStages = fEnvelopeStages.size();
+                    const float mRemainder      = fStageDuration - mStageDuration;
+                    finished_stage(fEnvStage);
+                    fEnvStage++;
+                    if (fEnvStage < mNumberOfStages - 1) {
+                        prepareNextStage(fEnvStage, mRemainder);
+                    } else {
+                        stop();
+                        finished_envelope();
+                    }
+                    signal_buffer[i - 1] = fValue;
+                }
             }
         }
 
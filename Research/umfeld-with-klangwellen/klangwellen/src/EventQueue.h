@@ -0,0 +1,119 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef KLANGWELLEN_EVENT_QUEUE_SIZE
+#define KLANGWELLEN_EVENT_QUEUE_SIZE 256
+#endif
+
+#include <stdint.h>
+#include <atomic>
+
+#include "SPSCQueue.h"
+
+namespace klangwellen {
+    /**
+     * an event emitted by a processor ( e.g `Trigger`, `BeatDSP` or `Sampler` ).
+     */
+    struct Event {
+        uint64_t frame;  /* number of samples the processor had processed before the sample that caused the event */
+        int32_t  value;  /* e.g the beat counter of `BeatDSP` */
+        uint8_t  type;   /* e.g `Trigger::EVENT_RISING_EDGE` */
+        uint8_t  source; /* id passed to `set_event_queue()` */
+    };
+
+    /**
+     * passes events from the audio thread to a listener without calling it from inside the processor. processors push
+     * events while they process a block, the listener drains them either at the end of the block ( in the audio
+     * thread, e.g to retrigger an envelope ) or in `draw()` ( e.g to update the UI ):
+     *
+     * ```
+     * EventQueue fEvents;
+     * fTrigger.set_event_queue(&fEvents);
+     *
+     * void audioEvent() {
+     *     const uint64_t mBlockStart = fTrigger.get_frame();
+     *     fTrigger.process(lfo_buffer, audio_buffer_size);
+     *     fEvents.drain([&](const Event& e) {
+     *         const uint32_t mOffset = e.frame - mBlockStart; // sample offset in this block
+     *     });
+     * }
+     * ```
+     *
+     * events are pushed by one thread ( the audio thread, several processors may share a queue ) and drained by one
+     * thread. neither locks nor allocates. the capacity is `KLANGWELLEN_EVENT_QUEUE_SIZE` ( power of two ), events
+     * that do not fit are dropped and counted.
+     */
+    class EventQueue {
+    public:
+        /**
+         * producer thread
+         *
+         * @return false if the queue is full ( the event is dropped )
+         */
+        bool push(const uint64_t frame, const uint8_t type, const int32_t value = 0, const uint8_t source = 0) {
+            if (fQueue.push({frame, value, type, source})) {
+                return true;
+            }
+            fDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        /**
+         * consumer thread
+         *
+         * @return false if the queue is empty
+         */
+        bool pop(Event& event) {
+            return fQueue.pop(event);
+        }
+
+        /**
+         * consumer thread: calls `listener(const Event&)` for every queued event in the order they were pushed.
+         *
+         * @return number of events
+         */
+        template<typename LISTENER>
+        uint32_t drain(LISTENER&& listener) {
+            uint32_t mEvents = 0;
+            Event    mEvent;
+            while (fQueue.pop(mEvent)) {
+                listener(mEvent);
+                mEvents++;
+            }
+            return mEvents;
+        }
+
+        bool empty() const {
+            return fQueue.empty();
+        }
+
+        /**
+         * @return number of events dropped because the queue was full ( thread safe )
+         */
+        uint32_t get_dropped() const {
+            return fDropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        SPSCQueue<Event, KLANGWELLEN_EVENT_QUEUE_SIZE> fQueue;
+        std::atomic<uint32_t>                          fDropped{0};
+    };
+} // namespace klangwellen
@@ -0,0 +1,83 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <complex>
+
+#include "kiss_fftr.h"
+
+namespace klangwellen {
+    /**
+     * real FFT of a fixed size backed by kissfft ( the same version PaulStretch uses ). the plans are allocated in the
+     * constructor, `forward()` and `inverse()` neither allocate nor lock. spectra have `get_num_bins()` ( `size / 2 + 1` )
+     * bins, `inverse()` is not normalized ( the signal is scaled by `size` ).
+     *
+     * unlike the rest of *KlangWellen* the FFT is not header-only: it uses the kissfft sources of PaulStretch
+     * ( `paulstretch/contrib` ), which are compiled by the `klangwellen` CMake target. other build systems need to add
+     * `kiss_fft.c` and `kiss_fftr.c` and the folder to the include path.
+     */
+    class FFT {
+    public:
+        /**
+         * @param size number of samples, must be even ( sizes with small prime factors, e.g powers of two, are fastest )
+         */
+        explicit FFT(const uint32_t size) : fSize(size),
+                                            fForward(kiss_fftr_alloc(static_cast<int>(size), 0, nullptr, nullptr)),
+                                            fInverse(kiss_fftr_alloc(static_cast<int>(size), 1, nullptr, nullptr)) {}
+
+        ~FFT() {
+            kiss_fftr_free(fForward);
+            kiss_fftr_free(fInverse);
+        }
+
+        FFT(const FFT&)            = delete;
+        FFT& operator=(const FFT&) = delete;
+
+        uint32_t get_size() const {
+            return fSize;
+        }
+
+        uint32_t get_num_bins() const {
+            return fSize / 2 + 1;
+        }
+
+        /**
+         * @param signal   `get_size()` samples
+         * @param spectrum `get_num_bins()` bins
+         */
+        void forward(const float* signal, std::complex<float>* spectrum) const {
+            kiss_fftr(fForward, signal, reinterpret_cast<kiss_fft_cpx*>(spectrum));
+        }
+
+        /**
+         * @param spectrum `get_num_bins()` bins
+         * @param signal   `get_size()` samples, scaled by `get_size()`
+         */
+        void inverse(const std::complex<float>* spectrum, float* signal) const {
+            kiss_fftri(fInverse, reinterpret_cast<const kiss_fft_cpx*>(spectrum), signal);
+        }
+
+    private:
+        const uint32_t      fSize;
+        const kiss_fftr_cfg fForward;
+        const kiss_fftr_cfg fInverse;
+    };
+} // namespace klangwellen
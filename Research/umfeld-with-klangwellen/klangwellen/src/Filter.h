@@ -37,14 +37,14 @@ namespace klangwellen {
     class Filter {
     public:
         /* filter types. */
-        static const uint8_t LPF              = 0; /* low pass filter */
-        static const uint8_t HPF              = 1; /* High pass filter */
-        static const uint8_t BPF              = 2; /* band pass filter */
-        static const uint8_t NOTCH            = 3; /* Notch Filter */
-        static const uint8_t PEQ              = 4; /* Peaking band EQ filter */
-        static const uint8_t LSH              = 5; /* Low shelf filter */
-        static const uint8_t HSH              = 6; /* High shelf filter */
-        static const uint8_t NUM_FILTER_TYPES = 7;
+        static constexpr uint8_t LPF              = 0; /* low pass filter */
+        static constexpr uint8_t HPF              = 1; /* High pass filter */
+        static constexpr uint8_t BPF              = 2; /* band pass filter */
+        static constexpr uint8_t NOTCH            = 3; /* Notch Filter */
+        static constexpr uint8_t PEQ              = 4; /* Peaking band EQ filter */
+        static constexpr uint8_t LSH              = 5; /* Low shelf filter */
+        static constexpr uint8_t HSH              = 6; /* High shelf filter */
+        static constexpr uint8_t NUM_FILTER_TYPES = 7;
 
         Filter(bool use_fast_math = true) : __USE_FAST_TRIG(use_fast_math) {
             set(LPF, 0.0, 1000, 100, KlangWellen::DEFAULT_SAMPLE_RATE);
@@ -82,9 +82,29 @@ namespace klangwellen {
 
         void process(float*         signal_buffer,
                      const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            /* keep coefficients and state in registers for the whole block */
+            const float a0 = biquad_a0;
+            const float a1 = biquad_a1;
+            const float a2 = biquad_a2;
+            const float a3 = biquad_a3;
+            const float a4 = biquad_a4;
+            float       x1 = biquad_x1;
+            float       x2 = biquad_x2;
+            float       y1 = biquad_y1;
+            float       y2 = biquad_y2;
             for (uint32_t i = 0; i < length; i++) {
-                signal_buffer[i] = process(signal_buffer[i]);
+                const float sample = signal_buffer[i];
+                const float result = (a0 * sample + a1 * x1) + (a2 * x2 - a3 * y1 - a4 * y2);
+                x2                 = x1;
+                x1                 = sample;
+                y2                 = y1;
+                y1                 = result;
+                signal_buffer[i]   = result;
             }
+            biquad_x1 = x1;
+            biquad_x2 = x2;
+            biquad_y1 = y1;
+            biquad_y2 = y2;
         }
 
         void set(uint8_t type,
@@ -189,8 +209,8 @@ namespace klangwellen {
     private:
         static constexpr float FILTER_LN2 = 0.69314718055994530942;
         static constexpr float FILTER_PI  = 3.14159265358979323846;
-        float                  biquad_a0, biquad_a1, biquad_a2, biquad_a3, biquad_a4 = 0;
-        float                  biquad_x1, biquad_x2, biquad_y1, biquad_y2 = 0;
+        float                  biquad_a0 = 0, biquad_a1 = 0, biquad_a2 = 0, biquad_a3 = 0, biquad_a4 = 0;
+        float                  biquad_x1 = 0, biquad_x2 = 0, biquad_y1 = 0, biquad_y2 = 0;
         const bool             __USE_FAST_TRIG;
     };
 
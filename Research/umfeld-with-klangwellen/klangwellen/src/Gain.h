@@ -61,16 +61,20 @@ namespace klangwellen {
         void process(float*         signal_buffer_left,
                      float*         signal_buffer_right,
                      const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (int i = 0; i < buffer_length; i++) {
-                signal_buffer_left[i] *= mGain;
-                signal_buffer_right[i] *= mGain;
+            const float gain = mGain;
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer_left[i] *= gain;
+            }
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer_right[i] *= gain;
             }
         }
 
         void process(float*         signal_buffer,
                      const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (int i = 0; i < buffer_length; i++) {
-                signal_buffer[i] *= mGain;
+            const float gain = mGain;
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] *= gain;
             }
         }
     };
@@ -34,6 +34,7 @@
 #include <cmath>
 #include <math.h>
 #include <assert.h>
+#include <time.h>
 
 #include <algorithm>
 #include <random>
@@ -407,6 +408,44 @@ namespace klangwellen {
             return mSignal * fAmplitude;
         }
 
+        void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            /* select the generator once per block */
+            switch (fType) {
+                case KlangWellen::NOISE_GAUSSIAN_WHITE_FAST:
+                    for (uint32_t i = 0; i < buffer_length; i++) {
+                        signal_buffer[i] = getGaussianWhiteNoiseFast();
+                    }
+                    break;
+                case KlangWellen::NOISE_GAUSSIAN_WHITE:
+                    for (uint32_t i = 0; i < buffer_length; i++) {
+                        signal_buffer[i] = mGaussianWhiteNoise.process();
+                    }
+                    break;
+                case KlangWellen::NOISE_PINK:
+                    for (uint32_t i = 0; i < buffer_length; i++) {
+                        signal_buffer[i] = mPinkNoise.process();
+                    }
+                    break;
+                case KlangWellen::NOISE_SIMPLEX:
+                    for (uint32_t i = 0; i < buffer_length; i++) {
+                        signal_buffer[i] = mSimplexNoise.process();
+                    }
+                    break;
+                case KlangWellen::NOISE_WHITE_FAST:
+                case KlangWellen::NOISE_WHITE:
+                default:
+                    for (uint32_t i = 0; i < buffer_length; i++) {
+                        signal_buffer[i] = getWhiteNoise();
+                    }
+                    break;
+            }
+            /* scale in a separate pass so that it vectorizes */
+            const float mAmplitude = fAmplitude;
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] *= mAmplitude;
+            }
+        }
+
         static float getGaussianWhiteNoiseFast() {
             // from [Gaussian White Noise](https://www.musicdsp.org/en/latest/Synthesis/113-gaussian-white-noise.html)
             const float R1 = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
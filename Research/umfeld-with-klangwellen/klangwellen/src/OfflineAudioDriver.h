@@ -0,0 +1,222 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "KlangWellen.h"
+#include "WAV.h"
+
+namespace klangwellen {
+    /**
+     * drives an audio callback from a virtual clock instead of an audio device, as fast as the CPU allows. the input is
+     * read from a WAV file ( or is silence ), the output is collected in memory and can be written to a WAV file. with
+     * the same seed, the same callback and the same input the output is identical on every run, which makes it
+     * usable for golden-file tests and for benchmarking audio graphs on machines without sound hardware:
+     *
+     * ```
+     * OfflineAudioDriver mDriver(48000, 1, 2, 256);
+     * mDriver.set_input("input.wav");
+     * mDriver.render(48000 * 60, [&](const float* input, float* output, const uint32_t frames) {
+     *     // same as `audioEvent()`: interleaved buffers of `frames` frames
+     * });
+     * mDriver.write_output("output.wav");
+     * const OfflineAudioDriver::Statistics& mStatistics = mDriver.get_statistics();
+     * ```
+     *
+     * `render()` seeds the random generators of *KlangWellen* ( `KlangWellen::random()` ) and of the C library
+     * ( `rand()` ) with `set_seed()` before the first callback.
+     */
+    class OfflineAudioDriver {
+    public:
+        struct Statistics {
+            uint64_t callbacks              = 0;
+            uint64_t frames                 = 0;
+            double   seconds                = 0.0; /* time spent in the callback */
+            double   mean_callback_duration = 0.0; /* in seconds */
+            double   max_callback_duration  = 0.0; /* in seconds */
+            double   callbacks_per_second   = 0.0;
+            double   realtime_factor        = 0.0; /* rendered time divided by the time it took */
+        };
+
+        OfflineAudioDriver(const uint32_t sample_rate     = KlangWellen::DEFAULT_SAMPLE_RATE,
+                           const uint16_t input_channels  = 0,
+                           const uint16_t output_channels = 2,
+                           const uint32_t buffer_size     = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE)
+            : fSampleRate(sample_rate),
+              fInputChannels(input_channels),
+              fOutputChannels(output_channels),
+              fBufferSize(buffer_size),
+              fInputBuffer(buffer_size * input_channels, 0.0f) {}
+
+        uint32_t get_sample_rate() const {
+            return fSampleRate;
+        }
+
+        uint16_t get_input_channels() const {
+            return fInputChannels;
+        }
+
+        uint16_t get_output_channels() const {
+            return fOutputChannels;
+        }
+
+        uint32_t get_buffer_size() const {
+            return fBufferSize;
+        }
+
+        /**
+         * reads the input from a WAV file. channels the file does not have repeat its last channel, samples after the end
+         * of the file are silence.
+         *
+         * @return false if the file cannot be read or its sample rate differs from the sample rate of the driver
+         */
+        bool set_input(const std::string& path) {
+            std::vector<float> mSamples;
+            uint16_t           mChannels   = 0;
+            uint32_t           mSampleRate = 0;
+            if (!WAV::read(path, mSamples, mChannels, mSampleRate) || mChannels == 0 || mSampleRate != fSampleRate) {
+                return false;
+            }
+            fInput        = std::move(mSamples);
+            fFileChannels = mChannels;
+            return true;
+        }
+
+        /**
+         * the input is silence ( default )
+         */
+        void set_input_silence() {
+            fInput.clear();
+            fFileChannels = 0;
+        }
+
+        void set_seed(const uint32_t seed) {
+            fSeed = seed;
+        }
+
+        uint32_t get_seed() const {
+            return fSeed;
+        }
+
+        /**
+         * @return number of frames rendered since the last `render()` started ( the virtual clock, advances after each
+         * callback )
+         */
+        uint64_t get_frame() const {
+            return fFrame;
+        }
+
+        /**
+         * @return time of the virtual clock in seconds
+         */
+        double get_time() const {
+            return static_cast<double>(fFrame) / static_cast<double>(fSampleRate);
+        }
+
+        /**
+         * renders `frames` frames ( rounded up to full buffers ) by calling `audio_event(const float* input, float*
+         * output, uint32_t frames)` with interleaved buffers. the output buffer is cleared before each callback. the
+         * output of the previous render is discarded.
+         */
+        template<typename CALLBACK>
+        const Statistics& render(const uint64_t frames, CALLBACK&& audio_event) {
+            const uint64_t mCallbacks = (frames + fBufferSize - 1) / fBufferSize;
+            fOutput.assign(mCallbacks * fBufferSize * fOutputChannels, 0.0f);
+            fStatistics = Statistics();
+            fFrame      = 0;
+            srand(fSeed);
+            KlangWellen::x32Seed = fSeed == 0 ? 1 : fSeed; /* xorshift32 gets stuck at 0 */
+
+            for (uint64_t c = 0; c < mCallbacks; c++) {
+                fill_input();
+                float*     mOutput = fOutput.data() + c * fBufferSize * fOutputChannels;
+                const auto mStart  = std::chrono::steady_clock::now();
+                audio_event(static_cast<const float*>(fInputBuffer.data()), mOutput, fBufferSize);
+                const double mDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+                fStatistics.seconds += mDuration;
+                fStatistics.max_callback_duration = std::max(fStatistics.max_callback_duration, mDuration);
+                fFrame += fBufferSize;
+            }
+
+            fStatistics.callbacks = mCallbacks;
+            fStatistics.frames    = fFrame;
+            if (mCallbacks > 0) {
+                fStatistics.mean_callback_duration = fStatistics.seconds / static_cast<double>(mCallbacks);
+            }
+            if (fStatistics.seconds > 0.0) {
+                fStatistics.callbacks_per_second = static_cast<double>(mCallbacks) / fStatistics.seconds;
+                fStatistics.realtime_factor      = get_time() / fStatistics.seconds;
+            }
+            return fStatistics;
+        }
+
+        const Statistics& get_statistics() const {
+            return fStatistics;
+        }
+
+        /**
+         * @return interleaved output of the last `render()`
+         */
+        const std::vector<float>& get_output() const {
+            return fOutput;
+        }
+
+        /**
+         * writes the output of the last `render()` as 32-bit float WAV file
+         */
+        bool write_output(const std::string& path) const {
+            return WAV::write(path, fOutput.data(), static_cast<uint32_t>(fFrame), fOutputChannels, fSampleRate);
+        }
+
+    private:
+        const uint32_t     fSampleRate;
+        const uint16_t     fInputChannels;
+        const uint16_t     fOutputChannels;
+        const uint32_t     fBufferSize;
+        std::vector<float> fInputBuffer;
+        std::vector<float> fInput;            /* interleaved samples of the input file */
+        uint16_t           fFileChannels = 0; /* channels of the input file */
+        std::vector<float> fOutput;
+        uint32_t           fSeed  = 23;
+        uint64_t           fFrame = 0;
+        Statistics         fStatistics;
+
+        void fill_input() {
+            if (fInputChannels == 0) {
+                return;
+            }
+            const uint64_t mInputFrames = fFileChannels > 0 ? fInput.size() / fFileChannels : 0;
+            for (uint32_t i = 0; i < fBufferSize; i++) {
+                const uint64_t mFrame = fFrame + i;
+                for (uint16_t j = 0; j < fInputChannels; j++) {
+                    fInputBuffer[i * fInputChannels + j] = mFrame < mInputFrames
+                                                               ? fInput[mFrame * fFileChannels + std::min<uint16_t>(j, fFileChannels - 1)]
+                                                               : 0.0f;
+                }
+            }
+        }
+    };
+} // namespace klangwellen
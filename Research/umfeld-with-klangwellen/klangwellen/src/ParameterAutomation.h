@@ -0,0 +1,251 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef KLANGWELLEN_PARAMETER_CONTROL_BLOCK_SIZE
+#define KLANGWELLEN_PARAMETER_CONTROL_BLOCK_SIZE 32
+#endif
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+#include "KlangWellen.h"
+#include "SPSCQueue.h"
+
+namespace klangwellen {
+    /**
+     * passes parameter changes from a control thread ( e.g `draw()` ) to the audio thread without locks and without
+     * calling setters of processors while they are being processed. changes are queued by the control thread and applied
+     * by the audio thread in `process()`, which splits the block at the frame of each change ( sample accurate ) and
+     * ramps every parameter linearly to its new value over its smoothing time ( updated every
+     * `KLANGWELLEN_PARAMETER_CONTROL_BLOCK_SIZE` samples ) to avoid zipper noise:
+     *
+     * ```
+     * ParameterAutomation<> fParameters;
+     * const int16_t         FREQUENCY = fParameters.add([](const float f) { fWavetable.set_frequency(f); }, 220.0f, 20.0f);
+     *
+     * void draw() {
+     *     fParameters.set(FREQUENCY, mouseX);
+     * }
+     *
+     * void audioEvent() {
+     *     fParameters.process(audio_buffer_size, [](const uint32_t offset, const uint32_t length) {
+     *         fWavetable.process(buffer + offset, length);
+     *     });
+     * }
+     * ```
+     *
+     * parameters are added before audio processing starts. `set()` and `set_at()` may only be called from one thread.
+     *
+     * @tparam NUMBER_OF_PARAMETERS maximum number of parameters
+     * @tparam QUEUE_SIZE           maximum number of changes queued between two blocks ( power of two )
+     */
+    template<uint8_t NUMBER_OF_PARAMETERS = 16, uint32_t QUEUE_SIZE = 256>
+    class ParameterAutomation {
+    public:
+        static constexpr uint32_t CONTROL_BLOCK_SIZE = KLANGWELLEN_PARAMETER_CONTROL_BLOCK_SIZE;
+
+        explicit ParameterAutomation(const uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE) : fSampleRate(sample_rate) {
+            for (std::atomic<float>& mValue: fValues) {
+                mValue.store(0.0f);
+            }
+        }
+
+        /**
+         * adds a parameter and applies `value`. must not be called while `process()` is running.
+         *
+         * @param apply        called from the audio thread with the new value ( e.g a lambda calling a setter )
+         * @param value        initial value
+         * @param smoothing_ms duration of the ramp to a new value in milliseconds ( 0 applies changes immediately )
+         * @return id of the parameter or -1 if all parameters are in use
+         */
+        int16_t add(std::function<void(float)> apply, const float value, const float smoothing_ms = 0.0f) {
+            if (fNumParameters >= NUMBER_OF_PARAMETERS) {
+                return -1;
+            }
+            const uint8_t mID = fNumParameters++;
+            parameter&    p   = fParameters[mID];
+            p.apply           = std::move(apply);
+            p.value           = value;
+            p.target          = value;
+            p.increment       = 0.0f;
+            p.ramp            = 0;
+            p.applied         = true;
+            set_smoothing(mID, smoothing_ms);
+            p.apply(value);
+            fValues[mID].store(value);
+            return mID;
+        }
+
+        /**
+         * must not be called while `process()` is running.
+         */
+        void set_smoothing(const uint8_t parameter, const float smoothing_ms) {
+            fParameters[parameter].smoothing = static_cast<uint32_t>(std::max(smoothing_ms, 0.0f) * 0.001f * fSampleRate);
+        }
+
+        /**
+         * control thread: changes `parameter` at the beginning of the next block.
+         *
+         * @return false if the queue is full ( the change is dropped )
+         */
+        bool set(const uint8_t parameter, const float value) {
+            return set_at(parameter, value, 0);
+        }
+
+        /**
+         * control thread: changes `parameter` at `frame` ( see `get_frame()` ). changes for frames that have already been
+         * processed are applied at the beginning of the next block.
+         *
+         * @return false if the queue is full ( the change is dropped )
+         */
+        bool set_at(const uint8_t parameter, const float value, const uint64_t frame) {
+            if (parameter >= fNumParameters) {
+                return false;
+            }
+            return fQueue.push({frame, value, parameter});
+        }
+
+        /**
+         * @return value of `parameter` at the end of the last processed block ( thread safe )
+         */
+        float get(const uint8_t parameter) const {
+            return fValues[parameter].load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return number of frames processed so far, i.e the frame of the first sample of the next block ( thread safe )
+         */
+        uint64_t get_frame() const {
+            return fSharedFrame.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * audio thread: applies queued changes and calls `render(offset, length)` for consecutive parts of a block of
+         * `length` samples. parameter values are constant during each part.
+         */
+        template<typename RENDER>
+        void process(const uint32_t length, RENDER&& render) {
+            event mEvent;
+            while (fNumPending < QUEUE_SIZE && fQueue.pop(mEvent)) {
+                fPending[fNumPending++] = mEvent;
+            }
+
+            uint32_t mOffset = 0;
+            while (mOffset < length) {
+                const uint64_t mFrame  = fFrame + mOffset;
+                uint32_t       mLength = length - mOffset;
+
+                /* start due changes in the order they were queued, end the part at the next change */
+                uint32_t mRemaining = 0;
+                for (uint32_t i = 0; i < fNumPending; i++) {
+                    const event& e = fPending[i];
+                    if (e.frame <= mFrame) {
+                        change(e.parameter, e.value);
+                    } else {
+                        mLength                = static_cast<uint32_t>(std::min<uint64_t>(mLength, e.frame - mFrame));
+                        fPending[mRemaining++] = e;
+                    }
+                }
+                fNumPending = mRemaining;
+
+                bool mRamping = false;
+                for (uint8_t i = 0; i < fNumParameters; i++) {
+                    parameter& p = fParameters[i];
+                    if (!p.applied) {
+                        p.apply(p.value);
+                        p.applied = true;
+                    }
+                    mRamping |= p.ramp > 0;
+                }
+                if (mRamping) {
+                    mLength = std::min(mLength, CONTROL_BLOCK_SIZE);
+                }
+
+                render(mOffset, mLength);
+
+                if (mRamping) {
+                    for (uint8_t i = 0; i < fNumParameters; i++) {
+                        advance(fParameters[i], mLength);
+                    }
+                }
+                mOffset += mLength;
+            }
+
+            fFrame += length;
+            fSharedFrame.store(fFrame, std::memory_order_relaxed);
+            for (uint8_t i = 0; i < fNumParameters; i++) {
+                fValues[i].store(fParameters[i].value, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        struct parameter {
+            std::function<void(float)> apply;
+            float                      value;     /* value passed to `apply` */
+            float                      target;    /* value at the end of the ramp */
+            float                      increment; /* per sample */
+            uint32_t                   ramp;      /* remaining samples of the ramp */
+            uint32_t                   smoothing; /* duration of a ramp in samples */
+            bool                       applied;
+        };
+
+        struct event {
+            uint64_t frame;
+            float    value;
+            uint8_t  parameter;
+        };
+
+        const uint32_t               fSampleRate;
+        parameter                    fParameters[NUMBER_OF_PARAMETERS];
+        uint8_t                      fNumParameters = 0;
+        SPSCQueue<event, QUEUE_SIZE> fQueue;
+        event                        fPending[QUEUE_SIZE]; /* dequeued changes for later frames ( audio thread ) */
+        uint32_t                     fNumPending = 0;
+        uint64_t                     fFrame      = 0;
+        std::atomic<uint64_t>        fSharedFrame{0};
+        std::atomic<float>           fValues[NUMBER_OF_PARAMETERS];
+
+        void change(const uint8_t id, const float value) {
+            parameter& p = fParameters[id];
+            p.target     = value;
+            if (p.smoothing == 0) {
+                p.value   = value;
+                p.ramp    = 0;
+                p.applied = false;
+            } else {
+                p.ramp      = p.smoothing;
+                p.increment = (value - p.value) / static_cast<float>(p.smoothing);
+            }
+        }
+
+        static void advance(parameter& p, const uint32_t length) {
+            if (p.ramp == 0) {
+                return;
+            }
+            const uint32_t mSteps = std::min(p.ramp, length);
+            p.ramp                = p.ramp - mSteps;
+            p.value               = p.ramp == 0 ? p.target : p.value + p.increment * static_cast<float>(mSteps);
+            p.applied             = false;
+        }
+    };
+} // namespace klangwellen
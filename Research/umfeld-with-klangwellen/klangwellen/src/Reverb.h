@@ -23,13 +23,26 @@
  * - [ ] float process()
  * - [x] float process(float)
  * - [x] void process(AudioSignal&)
- * - [ ] void process(float*, uint32_t)
+ * - [x] void process(float*, uint32_t)
  * - [x] void process(float*, float*, uint32_t)
  */
 
 #pragma once
 
+#ifndef KLANGWELLEN_REVERB_SIMD
+#if defined(__GNUC__) || defined(__clang__)
+#define KLANGWELLEN_REVERB_SIMD 1
+#else
+#define KLANGWELLEN_REVERB_SIMD 0
+#endif
+#endif
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
+
 #include "AudioSignal.h"
+#include "KlangWellen.h"
 
 /**
  * applies reverb to a signal. {@link Reverb} uses an implementation of freeverb.
@@ -103,6 +116,16 @@ namespace klangwellen {
         // Code generated with Faust 0.9.9.5b2 (http://faust.grame.fr)
         //-----------------------------------------------------
 
+        /*
+         * the eight lowpass-feedback comb filters of each channel have identical structure and are processed as eight
+         * lanes of one comb bank. the state of the bank is stored lane by lane ( SoA ) and processed with the vector
+         * extensions of GCC and Clang, which map the eight lanes onto one AVX or two SSE/NEON registers. with
+         * `KLANGWELLEN_REVERB_SIMD` set to 0 ( the default for other compilers ) the lanes are processed in a scalar loop.
+         * each comb writes its input `COMB_DELAY` rows ahead into a shared line, so that all eight combs read their
+         * output from the same row. the single-sample `process` methods update the state in place, one comb after the
+         * other, loading the bank into registers does not pay off for one sample.
+         */
+
     public:
         Reverb() {
             damp.set_now(0.5f);
@@ -148,488 +171,211 @@ namespace klangwellen {
                      float*         input_signal_left,
                      float*         input_signal_right,
                      const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            fslider0 = damp.get();
-            fslider1 = roomSize.get();
-            fslider2 = wet.get();
-
-            const float fSlow0 = (0.4f * fslider0);
-            const float fSlow1 = (1 - fSlow0);
-            const float fSlow2 = (0.7f + (0.28f * fslider1));
-            const float fSlow3 = fslider2;
-            const float fSlow4 = (1 - fSlow3);
-            const int   count  = buffer_length;
-            for (int i = 0; i < count; i++) {
-                fRec9_0                = ((fSlow1 * fRec8_1) + (fSlow0 * fRec9_1));
-                const float fTemp0     = input_signal_right[i];
-                const float fTemp1     = input_signal_left[i];
-                const float fTemp2     = (1.500000e-02f * (fTemp1 + fTemp0));
-                const int   p          = IOTA & 2047;
-                fVec0[p]               = (fTemp2 + (fSlow2 * fRec9_0));
-                fRec8_0                = fVec0[(IOTA - 1617) & 2047];
-                fRec11_0               = ((fSlow1 * fRec10_1) + (fSlow0 * fRec11_1));
-                fVec1[p]               = (fTemp2 + (fSlow2 * fRec11_0));
-                fRec10_0               = fVec1[(IOTA - 1557) & 2047];
-                fRec13_0               = ((fSlow1 * fRec12_1) + (fSlow0 * fRec13_1));
-                fVec2[p]               = (fTemp2 + (fSlow2 * fRec13_0));
-                fRec12_0               = fVec2[(IOTA - 1491) & 2047];
-                fRec15_0               = ((fSlow1 * fRec14_1) + (fSlow0 * fRec15_1));
-                fVec3[p]               = (fTemp2 + (fSlow2 * fRec15_0));
-                fRec14_0               = fVec3[(IOTA - 1422) & 2047];
-                fRec17_0               = ((fSlow1 * fRec16_1) + (fSlow0 * fRec17_1));
-                fVec4[p]               = (fTemp2 + (fSlow2 * fRec17_0));
-                fRec16_0               = fVec4[(IOTA - 1356) & 2047];
-                fRec19_0               = ((fSlow1 * fRec18_1) + (fSlow0 * fRec19_1));
-                fVec5[p]               = (fTemp2 + (fSlow2 * fRec19_0));
-                fRec18_0               = fVec5[(IOTA - 1277) & 2047];
-                fRec21_0               = ((fSlow1 * fRec20_1) + (fSlow0 * fRec21_1));
-                fVec6[p]               = (fTemp2 + (fSlow2 * fRec21_0));
-                fRec20_0               = fVec6[(IOTA - 1188) & 2047];
-                fRec23_0               = ((fSlow1 * fRec22_1) + (fSlow0 * fRec23_1));
-                fVec7[p]               = (fTemp2 + (fSlow2 * fRec23_0));
-                fRec22_0               = fVec7[(IOTA - 1116) & 2047];
-                const float fTemp3     = (((((((fRec22_0 + fRec20_0) + fRec18_0) + fRec16_0) + fRec14_0) + fRec12_0) + fRec10_0) + fRec8_0);
-                fVec8[IOTA & 1023]     = (fTemp3 + (0.5f * fRec6_1));
-                fRec6_0                = fVec8[(IOTA - 556) & 1023];
-                const float fRec7      = (0 - (fTemp3 - fRec6_1));
-                fVec9[IOTA & 511]      = (fRec7 + (0.5f * fRec4_1));
-                fRec4_0                = fVec9[(IOTA - 441) & 511];
-                const float fRec5      = (fRec4_1 - fRec7);
-                fVec10[IOTA & 511]     = (fRec5 + (0.5f * fRec2_1));
-                fRec2_0                = fVec10[(IOTA - 341) & 511];
-                const float fRec3      = (fRec2_1 - fRec5);
-                fVec11[IOTA & 255]     = (fRec3 + (0.5f * fRec0_1));
-                fRec0_0                = fVec11[(IOTA - 225) & 255];
-                const float fRec1      = (fRec0_1 - fRec3);
-                output_signal_left[i]  = ((fSlow4 * fTemp1) + (fSlow3 * fRec1));
-                fRec33_0               = ((fSlow1 * fRec32_1) + (fSlow0 * fRec33_1));
-                fVec12[p]              = (fTemp2 + (fSlow2 * fRec33_0));
-                fRec32_0               = fVec12[(IOTA - 1640) & 2047];
-                fRec35_0               = ((fSlow1 * fRec34_1) + (fSlow0 * fRec35_1));
-                fVec13[p]              = (fTemp2 + (fSlow2 * fRec35_0));
-                fRec34_0               = fVec13[(IOTA - 1580) & 2047];
-                fRec37_0               = ((fSlow1 * fRec36_1) + (fSlow0 * fRec37_1));
-                fVec14[p]              = (fTemp2 + (fSlow2 * fRec37_0));
-                fRec36_0               = fVec14[(IOTA - 1514) & 2047];
-                fRec39_0               = ((fSlow1 * fRec38_1) + (fSlow0 * fRec39_1));
-                fVec15[p]              = (fTemp2 + (fSlow2 * fRec39_0));
-                fRec38_0               = fVec15[(IOTA - 1445) & 2047];
-                fRec41_0               = ((fSlow1 * fRec40_1) + (fSlow0 * fRec41_1));
-                fVec16[p]              = (fTemp2 + (fSlow2 * fRec41_0));
-                fRec40_0               = fVec16[(IOTA - 1379) & 2047];
-                fRec43_0               = ((fSlow1 * fRec42_1) + (fSlow0 * fRec43_1));
-                fVec17[p]              = (fTemp2 + (fSlow2 * fRec43_0));
-                fRec42_0               = fVec17[(IOTA - 1300) & 2047];
-                fRec45_0               = ((fSlow1 * fRec44_1) + (fSlow0 * fRec45_1));
-                fVec18[p]              = (fTemp2 + (fSlow2 * fRec45_0));
-                fRec44_0               = fVec18[(IOTA - 1211) & 2047];
-                fRec47_0               = ((fSlow1 * fRec46_1) + (fSlow0 * fRec47_1));
-                fVec19[p]              = (fTemp2 + (fSlow2 * fRec47_0));
-                fRec46_0               = fVec19[(IOTA - 1139) & 2047];
-                const float fTemp4     = (((((((fRec46_0 + fRec44_0) + fRec42_0) + fRec40_0) + fRec38_0) + fRec36_0) + fRec34_0) + fRec32_0);
-                fVec20[IOTA & 1023]    = (fTemp4 + (0.5f * fRec30_1));
-                fRec30_0               = fVec20[(IOTA - 579) & 1023];
-                const float fRec31     = (0 - (fTemp4 - fRec30_1));
-                fVec21[IOTA & 511]     = (fRec31 + (0.5f * fRec28_1));
-                fRec28_0               = fVec21[(IOTA - 464) & 511];
-                const float fRec29     = (fRec28_1 - fRec31);
-                fVec22[IOTA & 511]     = (fRec29 + (0.5f * fRec26_1));
-                fRec26_0               = fVec22[(IOTA - 364) & 511];
-                const float fRec27     = (fRec26_1 - fRec29);
-                fVec23[IOTA & 255]     = (fRec27 + (0.5f * fRec24_1));
-                fRec24_0               = fVec23[(IOTA - 248) & 255];
-                const float fRec25     = (fRec24_1 - fRec27);
-                output_signal_right[i] = ((fSlow4 * fTemp0) + (fSlow3 * fRec25));
-                // post processing
-                fRec24_1 = fRec24_0;
-                fRec26_1 = fRec26_0;
-                fRec28_1 = fRec28_0;
-                fRec30_1 = fRec30_0;
-                fRec46_1 = fRec46_0;
-                fRec47_1 = fRec47_0;
-                fRec44_1 = fRec44_0;
-                fRec45_1 = fRec45_0;
-                fRec42_1 = fRec42_0;
-                fRec43_1 = fRec43_0;
-                fRec40_1 = fRec40_0;
-                fRec41_1 = fRec41_0;
-                fRec38_1 = fRec38_0;
-                fRec39_1 = fRec39_0;
-                fRec36_1 = fRec36_0;
-                fRec37_1 = fRec37_0;
-                fRec34_1 = fRec34_0;
-                fRec35_1 = fRec35_0;
-                fRec32_1 = fRec32_0;
-                fRec33_1 = fRec33_0;
-                fRec0_1  = fRec0_0;
-                fRec2_1  = fRec2_0;
-                fRec4_1  = fRec4_0;
-                fRec6_1  = fRec6_0;
-                fRec22_1 = fRec22_0;
-                fRec23_1 = fRec23_0;
-                fRec20_1 = fRec20_0;
-                fRec21_1 = fRec21_0;
-                fRec18_1 = fRec18_0;
-                fRec19_1 = fRec19_0;
-                fRec16_1 = fRec16_0;
-                fRec17_1 = fRec17_0;
-                fRec14_1 = fRec14_0;
-                fRec15_1 = fRec15_0;
-                fRec12_1 = fRec12_0;
-                fRec13_1 = fRec13_0;
-                fRec10_1 = fRec10_0;
-                fRec11_1 = fRec11_0;
-                fRec8_1  = fRec8_0;
-                IOTA     = IOTA + 1;
-                fRec9_1  = fRec9_0;
+            const parameters mParameters = update_parameters();
+            float            mInput[CHUNK_SIZE];
+            for (uint32_t j = 0; j < buffer_length; j += CHUNK_SIZE) {
+                const uint32_t mLength = std::min(CHUNK_SIZE, buffer_length - j);
+                for (uint32_t i = 0; i < mLength; i++) {
+                    mInput[i] = (1.500000e-02f * (input_signal_left[j + i] + input_signal_right[j + i]));
+                }
+                process_channel<0>(mParameters, mInput, input_signal_left + j, output_signal_left + j, mLength);
+                process_channel<1>(mParameters, mInput, input_signal_right + j, output_signal_right + j, mLength);
+                IOTA = (IOTA + mLength) & COMB_MASK;
+            }
+        }
+
+        void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            const parameters mParameters = update_parameters();
+            float            mInput[CHUNK_SIZE];
+            for (uint32_t j = 0; j < buffer_length; j += CHUNK_SIZE) {
+                const uint32_t mLength = std::min(CHUNK_SIZE, buffer_length - j);
+                for (uint32_t i = 0; i < mLength; i++) {
+                    mInput[i] = (1.500000e-02f * (signal_buffer[j + i] + signal_buffer[j + i]));
+                }
+                process_channel<0>(mParameters, mInput, signal_buffer + j, signal_buffer + j, mLength);
+                IOTA = (IOTA + mLength) & COMB_MASK;
             }
         }
 
         void process(AudioSignal& signal) {
-            fslider0 = damp.get();
-            fslider1 = roomSize.get();
-            fslider2 = wet.get();
-
-            const float fSlow0 = (0.4f * fslider0);
-            const float fSlow1 = (1 - fSlow0);
-            const float fSlow2 = (0.7f + (0.28f * fslider1));
-            const float fSlow3 = fslider2;
-            const float fSlow4 = (1 - fSlow3);
-
-            fRec9_0             = ((fSlow1 * fRec8_1) + (fSlow0 * fRec9_1));
-            const float fTemp0  = signal.right;
-            const float fTemp1  = signal.left;
-            const float fTemp2  = (1.500000e-02f * (fTemp1 + fTemp0));
-            const int   p       = IOTA & 2047;
-            fVec0[p]            = (fTemp2 + (fSlow2 * fRec9_0));
-            fRec8_0             = fVec0[(IOTA - 1617) & 2047];
-            fRec11_0            = ((fSlow1 * fRec10_1) + (fSlow0 * fRec11_1));
-            fVec1[p]            = (fTemp2 + (fSlow2 * fRec11_0));
-            fRec10_0            = fVec1[(IOTA - 1557) & 2047];
-            fRec13_0            = ((fSlow1 * fRec12_1) + (fSlow0 * fRec13_1));
-            fVec2[p]            = (fTemp2 + (fSlow2 * fRec13_0));
-            fRec12_0            = fVec2[(IOTA - 1491) & 2047];
-            fRec15_0            = ((fSlow1 * fRec14_1) + (fSlow0 * fRec15_1));
-            fVec3[p]            = (fTemp2 + (fSlow2 * fRec15_0));
-            fRec14_0            = fVec3[(IOTA - 1422) & 2047];
-            fRec17_0            = ((fSlow1 * fRec16_1) + (fSlow0 * fRec17_1));
-            fVec4[p]            = (fTemp2 + (fSlow2 * fRec17_0));
-            fRec16_0            = fVec4[(IOTA - 1356) & 2047];
-            fRec19_0            = ((fSlow1 * fRec18_1) + (fSlow0 * fRec19_1));
-            fVec5[p]            = (fTemp2 + (fSlow2 * fRec19_0));
-            fRec18_0            = fVec5[(IOTA - 1277) & 2047];
-            fRec21_0            = ((fSlow1 * fRec20_1) + (fSlow0 * fRec21_1));
-            fVec6[p]            = (fTemp2 + (fSlow2 * fRec21_0));
-            fRec20_0            = fVec6[(IOTA - 1188) & 2047];
-            fRec23_0            = ((fSlow1 * fRec22_1) + (fSlow0 * fRec23_1));
-            fVec7[p]            = (fTemp2 + (fSlow2 * fRec23_0));
-            fRec22_0            = fVec7[(IOTA - 1116) & 2047];
-            const float fTemp3  = (((((((fRec22_0 + fRec20_0) + fRec18_0) + fRec16_0) + fRec14_0) + fRec12_0) + fRec10_0) + fRec8_0);
-            fVec8[IOTA & 1023]  = (fTemp3 + (0.5f * fRec6_1));
-            fRec6_0             = fVec8[(IOTA - 556) & 1023];
-            const float fRec7   = (0 - (fTemp3 - fRec6_1));
-            fVec9[IOTA & 511]   = (fRec7 + (0.5f * fRec4_1));
-            fRec4_0             = fVec9[(IOTA - 441) & 511];
-            const float fRec5   = (fRec4_1 - fRec7);
-            fVec10[IOTA & 511]  = (fRec5 + (0.5f * fRec2_1));
-            fRec2_0             = fVec10[(IOTA - 341) & 511];
-            const float fRec3   = (fRec2_1 - fRec5);
-            fVec11[IOTA & 255]  = (fRec3 + (0.5f * fRec0_1));
-            fRec0_0             = fVec11[(IOTA - 225) & 255];
-            const float fRec1   = (fRec0_1 - fRec3);
-            signal.left         = ((fSlow4 * fTemp1) + (fSlow3 * fRec1));
-            fRec33_0            = ((fSlow1 * fRec32_1) + (fSlow0 * fRec33_1));
-            fVec12[p]           = (fTemp2 + (fSlow2 * fRec33_0));
-            fRec32_0            = fVec12[(IOTA - 1640) & 2047];
-            fRec35_0            = ((fSlow1 * fRec34_1) + (fSlow0 * fRec35_1));
-            fVec13[p]           = (fTemp2 + (fSlow2 * fRec35_0));
-            fRec34_0            = fVec13[(IOTA - 1580) & 2047];
-            fRec37_0            = ((fSlow1 * fRec36_1) + (fSlow0 * fRec37_1));
-            fVec14[p]           = (fTemp2 + (fSlow2 * fRec37_0));
-            fRec36_0            = fVec14[(IOTA - 1514) & 2047];
-            fRec39_0            = ((fSlow1 * fRec38_1) + (fSlow0 * fRec39_1));
-            fVec15[p]           = (fTemp2 + (fSlow2 * fRec39_0));
-            fRec38_0            = fVec15[(IOTA - 1445) & 2047];
-            fRec41_0            = ((fSlow1 * fRec40_1) + (fSlow0 * fRec41_1));
-            fVec16[p]           = (fTemp2 + (fSlow2 * fRec41_0));
-            fRec40_0            = fVec16[(IOTA - 1379) & 2047];
-            fRec43_0            = ((fSlow1 * fRec42_1) + (fSlow0 * fRec43_1));
-            fVec17[p]           = (fTemp2 + (fSlow2 * fRec43_0));
-            fRec42_0            = fVec17[(IOTA - 1300) & 2047];
-            fRec45_0            = ((fSlow1 * fRec44_1) + (fSlow0 * fRec45_1));
-            fVec18[p]           = (fTemp2 + (fSlow2 * fRec45_0));
-            fRec44_0            = fVec18[(IOTA - 1211) & 2047];
-            fRec47_0            = ((fSlow1 * fRec46_1) + (fSlow0 * fRec47_1));
-            fVec19[p]           = (fTemp2 + (fSlow2 * fRec47_0));
-            fRec46_0            = fVec19[(IOTA - 1139) & 2047];
-            const float fTemp4  = (((((((fRec46_0 + fRec44_0) + fRec42_0) + fRec40_0) + fRec38_0) + fRec36_0) + fRec34_0) + fRec32_0);
-            fVec20[IOTA & 1023] = (fTemp4 + (0.5f * fRec30_1));
-            fRec30_0            = fVec20[(IOTA - 579) & 1023];
-            const float fRec31  = (0 - (fTemp4 - fRec30_1));
-            fVec21[IOTA & 511]  = (fRec31 + (0.5f * fRec28_1));
-            fRec28_0            = fVec21[(IOTA - 464) & 511];
-            const float fRec29  = (fRec28_1 - fRec31);
-            fVec22[IOTA & 511]  = (fRec29 + (0.5f * fRec26_1));
-            fRec26_0            = fVec22[(IOTA - 364) & 511];
-            const float fRec27  = (fRec26_1 - fRec29);
-            fVec23[IOTA & 255]  = (fRec27 + (0.5f * fRec24_1));
-            fRec24_0            = fVec23[(IOTA - 248) & 255];
-            const float fRec25  = (fRec24_1 - fRec27);
-            signal.right        = ((fSlow4 * fTemp0) + (fSlow3 * fRec25));
-            // post processing
-            fRec24_1 = fRec24_0;
-            fRec26_1 = fRec26_0;
-            fRec28_1 = fRec28_0;
-            fRec30_1 = fRec30_0;
-            fRec46_1 = fRec46_0;
-            fRec47_1 = fRec47_0;
-            fRec44_1 = fRec44_0;
-            fRec45_1 = fRec45_0;
-            fRec42_1 = fRec42_0;
-            fRec43_1 = fRec43_0;
-            fRec40_1 = fRec40_0;
-            fRec41_1 = fRec41_0;
-            fRec38_1 = fRec38_0;
-            fRec39_1 = fRec39_0;
-            fRec36_1 = fRec36_0;
-            fRec37_1 = fRec37_0;
-            fRec34_1 = fRec34_0;
-            fRec35_1 = fRec35_0;
-            fRec32_1 = fRec32_0;
-            fRec33_1 = fRec33_0;
-            fRec0_1  = fRec0_0;
-            fRec2_1  = fRec2_0;
-            fRec4_1  = fRec4_0;
-            fRec6_1  = fRec6_0;
-            fRec22_1 = fRec22_0;
-            fRec23_1 = fRec23_0;
-            fRec20_1 = fRec20_0;
-            fRec21_1 = fRec21_0;
-            fRec18_1 = fRec18_0;
-            fRec19_1 = fRec19_0;
-            fRec16_1 = fRec16_0;
-            fRec17_1 = fRec17_0;
-            fRec14_1 = fRec14_0;
-            fRec15_1 = fRec15_0;
-            fRec12_1 = fRec12_0;
-            fRec13_1 = fRec13_0;
-            fRec10_1 = fRec10_0;
-            fRec11_1 = fRec11_0;
-            fRec8_1  = fRec8_0;
-            IOTA     = IOTA + 1;
-            fRec9_1  = fRec9_0;
+            const parameters mParameters = update_parameters();
+            const float      mInput      = (1.500000e-02f * (signal.left + signal.right));
+            signal.left                  = process_sample<0>(mParameters, mInput, signal.left);
+            signal.right                 = process_sample<1>(mParameters, mInput, signal.right);
+            IOTA                         = (IOTA + 1) & COMB_MASK;
         }
 
         float process(const float input) {
-            float mOutput;
-            fslider0 = damp.get();
-            fslider1 = roomSize.get();
-            fslider2 = wet.get();
-
-            const float fSlow0 = (0.4f * fslider0);
-            const float fSlow1 = (1 - fSlow0);
-            const float fSlow2 = (0.7f + (0.28f * fslider1));
-            const float fSlow3 = fslider2;
-            const float fSlow4 = (1 - fSlow3);
-
-            fRec9_0            = ((fSlow1 * fRec8_1) + (fSlow0 * fRec9_1));
-            const float fTemp1 = input;
-            const float fTemp2 = (1.500000e-02f * (fTemp1 + fTemp1));
-            const int   p      = IOTA & 2047;
-            fVec0[p]           = (fTemp2 + (fSlow2 * fRec9_0));
-            fRec8_0            = fVec0[(IOTA - 1617) & 2047];
-            fRec11_0           = ((fSlow1 * fRec10_1) + (fSlow0 * fRec11_1));
-            fVec1[p]           = (fTemp2 + (fSlow2 * fRec11_0));
-            fRec10_0           = fVec1[(IOTA - 1557) & 2047];
-            fRec13_0           = ((fSlow1 * fRec12_1) + (fSlow0 * fRec13_1));
-            fVec2[p]           = (fTemp2 + (fSlow2 * fRec13_0));
-            fRec12_0           = fVec2[(IOTA - 1491) & 2047];
-            fRec15_0           = ((fSlow1 * fRec14_1) + (fSlow0 * fRec15_1));
-            fVec3[p]           = (fTemp2 + (fSlow2 * fRec15_0));
-            fRec14_0           = fVec3[(IOTA - 1422) & 2047];
-            fRec17_0           = ((fSlow1 * fRec16_1) + (fSlow0 * fRec17_1));
-            fVec4[p]           = (fTemp2 + (fSlow2 * fRec17_0));
-            fRec16_0           = fVec4[(IOTA - 1356) & 2047];
-            fRec19_0           = ((fSlow1 * fRec18_1) + (fSlow0 * fRec19_1));
-            fVec5[p]           = (fTemp2 + (fSlow2 * fRec19_0));
-            fRec18_0           = fVec5[(IOTA - 1277) & 2047];
-            fRec21_0           = ((fSlow1 * fRec20_1) + (fSlow0 * fRec21_1));
-            fVec6[p]           = (fTemp2 + (fSlow2 * fRec21_0));
-            fRec20_0           = fVec6[(IOTA - 1188) & 2047];
-            fRec23_0           = ((fSlow1 * fRec22_1) + (fSlow0 * fRec23_1));
-            fVec7[p]           = (fTemp2 + (fSlow2 * fRec23_0));
-            const float fTemp3 = (((((((fRec22_0 + fRec20_0) + fRec18_0) + fRec16_0) + fRec14_0) + fRec12_0) + fRec10_0) + fRec8_0);
-            fVec8[IOTA & 1023] = (fTemp3 + (0.5f * fRec6_1));
-            fRec6_0            = fVec8[(IOTA - 556) & 1023];
-            const float fRec7  = (0 - (fTemp3 - fRec6_1));
-            fVec9[IOTA & 511]  = (fRec7 + (0.5f * fRec4_1));
-            fRec4_0            = fVec9[(IOTA - 441) & 511];
-            const float fRec5  = (fRec4_1 - fRec7);
-            fVec10[IOTA & 511] = (fRec5 + (0.5f * fRec2_1));
-            fRec2_0            = fVec10[(IOTA - 341) & 511];
-            const float fRec3  = (fRec2_1 - fRec5);
-            fVec11[IOTA & 255] = (fRec3 + (0.5f * fRec0_1));
-            fRec0_0            = fVec11[(IOTA - 225) & 255];
-            const float fRec1  = (fRec0_1 - fRec3);
-            mOutput            = ((fSlow4 * fTemp1) + (fSlow3 * fRec1));
-
-            // post processing
-            fRec24_1 = fRec24_0;
-            fRec26_1 = fRec26_0;
-            fRec28_1 = fRec28_0;
-            fRec30_1 = fRec30_0;
-            fRec46_1 = fRec46_0;
-            fRec47_1 = fRec47_0;
-            fRec44_1 = fRec44_0;
-            fRec45_1 = fRec45_0;
-            fRec42_1 = fRec42_0;
-            fRec43_1 = fRec43_0;
-            fRec40_1 = fRec40_0;
-            fRec41_1 = fRec41_0;
-            fRec38_1 = fRec38_0;
-            fRec39_1 = fRec39_0;
-            fRec36_1 = fRec36_0;
-            fRec37_1 = fRec37_0;
-            fRec34_1 = fRec34_0;
-            fRec35_1 = fRec35_0;
-            fRec32_1 = fRec32_0;
-            fRec33_1 = fRec33_0;
-            fRec0_1  = fRec0_0;
-            fRec2_1  = fRec2_0;
-            fRec4_1  = fRec4_0;
-            fRec6_1  = fRec6_0;
-            fRec22_1 = fRec22_0;
-            fRec23_1 = fRec23_0;
-            fRec20_1 = fRec20_0;
-            fRec21_1 = fRec21_0;
-            fRec18_1 = fRec18_0;
-            fRec19_1 = fRec19_0;
-            fRec16_1 = fRec16_0;
-            fRec17_1 = fRec17_0;
-            fRec14_1 = fRec14_0;
-            fRec15_1 = fRec15_0;
-            fRec12_1 = fRec12_0;
-            fRec13_1 = fRec13_0;
-            fRec10_1 = fRec10_0;
-            fRec11_1 = fRec11_0;
-            fRec8_1  = fRec8_0;
-            IOTA     = IOTA + 1;
-            fRec9_1  = fRec9_0;
-
+            const parameters mParameters = update_parameters();
+            const float      mInput      = (1.500000e-02f * (input + input));
+            const float      mOutput     = process_sample<0>(mParameters, mInput, input);
+            IOTA                         = (IOTA + 1) & COMB_MASK;
             return mOutput;
         }
 
     private:
+        static constexpr uint8_t  NUM_CHANNELS   = 2;
+        static constexpr uint8_t  COMB_LANES     = 8;
+        static constexpr uint32_t COMB_LENGTH    = 2048;
+        static constexpr uint32_t COMB_MASK      = COMB_LENGTH - 1;
+        static constexpr uint8_t  ALLPASS_STAGES = 4;
+        static constexpr uint32_t ALLPASS_LENGTH = 1024;
+        static constexpr uint32_t CHUNK_SIZE     = 256; /* samples per pass through a channel */
+
+        static constexpr uint16_t COMB_DELAY[NUM_CHANNELS][COMB_LANES] = {
+            {1617, 1557, 1491, 1422, 1356, 1277, 1188, 1116},
+            {1640, 1580, 1514, 1445, 1379, 1300, 1211, 1139}};
+        static constexpr uint16_t ALLPASS_DELAY[NUM_CHANNELS][ALLPASS_STAGES] = {
+            {556, 441, 341, 225},
+            {579, 464, 364, 248}};
+        static constexpr uint32_t ALLPASS_MASK[ALLPASS_STAGES] = {1023, 511, 511, 255};
+
+#if KLANGWELLEN_REVERB_SIMD
+        /* one AVX register or two SSE/NEON registers */
+        typedef float comb_lanes __attribute__((vector_size(COMB_LANES * sizeof(float))));
+#endif // KLANGWELLEN_REVERB_SIMD
+
+        struct parameters {
+            float fSlow0; /* damping */
+            float fSlow1; /* 1 - damping */
+            float fSlow2; /* comb feedback */
+            float fSlow3; /* wet */
+            float fSlow4; /* dry */
+        };
+
+        struct channel {
+            alignas(32) float comb_line[COMB_LENGTH][COMB_LANES] = {};
+            alignas(32) float comb_filter[COMB_LANES]            = {}; /* lowpass in the feedback path */
+            alignas(32) float comb_output[COMB_LANES]            = {};
+            float allpass_line[ALLPASS_STAGES][ALLPASS_LENGTH]   = {};
+            float allpass_output[ALLPASS_STAGES]                 = {};
+        };
+
         static constexpr float largest_diff = 0.01f;
         GlideVar               damp{0.5f, largest_diff};
         GlideVar               roomSize{0.5f, largest_diff};
         GlideVar               wet{0.3333f, largest_diff};
-        int                    IOTA;
-        float                  fRec0_0;
-        float                  fRec0_1;
-        float                  fRec10_0;
-        float                  fRec10_1;
-        float                  fRec11_0;
-        float                  fRec11_1;
-        float                  fRec12_0;
-        float                  fRec12_1;
-        float                  fRec13_0;
-        float                  fRec13_1;
-        float                  fRec14_0;
-        float                  fRec14_1;
-        float                  fRec15_0;
-        float                  fRec15_1;
-        float                  fRec16_0;
-        float                  fRec16_1;
-        float                  fRec17_0;
-        float                  fRec17_1;
-        float                  fRec18_0;
-        float                  fRec18_1;
-        float                  fRec19_0;
-        float                  fRec19_1;
-        float                  fRec20_0;
-        float                  fRec20_1;
-        float                  fRec21_0;
-        float                  fRec21_1;
-        float                  fRec22_0;
-        float                  fRec22_1;
-        float                  fRec23_0;
-        float                  fRec23_1;
-        float                  fRec24_0;
-        float                  fRec24_1;
-        float                  fRec26_0;
-        float                  fRec26_1;
-        float                  fRec28_0;
-        float                  fRec28_1;
-        float                  fRec2_0;
-        float                  fRec2_1;
-        float                  fRec30_0;
-        float                  fRec30_1;
-        float                  fRec32_0;
-        float                  fRec32_1;
-        float                  fRec33_0;
-        float                  fRec33_1;
-        float                  fRec34_0;
-        float                  fRec34_1;
-        float                  fRec35_0;
-        float                  fRec35_1;
-        float                  fRec36_0;
-        float                  fRec36_1;
-        float                  fRec37_0;
-        float                  fRec37_1;
-        float                  fRec38_0;
-        float                  fRec38_1;
-        float                  fRec39_0;
-        float                  fRec39_1;
-        float                  fRec40_0;
-        float                  fRec40_1;
-        float                  fRec41_0;
-        float                  fRec41_1;
-        float                  fRec42_0;
-        float                  fRec42_1;
-        float                  fRec43_0;
-        float                  fRec43_1;
-        float                  fRec44_0;
-        float                  fRec44_1;
-        float                  fRec45_0;
-        float                  fRec45_1;
-        float                  fRec46_0;
-        float                  fRec46_1;
-        float                  fRec47_0;
-        float                  fRec47_1;
-        float                  fRec4_0;
-        float                  fRec4_1;
-        float                  fRec6_0;
-        float                  fRec6_1;
-        float                  fRec8_0;
-        float                  fRec8_1;
-        float                  fRec9_0;
-        float                  fRec9_1;
-        float                  fVec0[2048];
-        float                  fVec1[2048];
-        float                  fVec10[512];
-        float                  fVec11[256];
-        float                  fVec12[2048];
-        float                  fVec13[2048];
-        float                  fVec14[2048];
-        float                  fVec15[2048];
-        float                  fVec16[2048];
-        float                  fVec17[2048];
-        float                  fVec18[2048];
-        float                  fVec19[2048];
-        float                  fVec2[2048];
-        float                  fVec20[1024];
-        float                  fVec21[512];
-        float                  fVec22[512];
-        float                  fVec23[256];
-        float                  fVec3[2048];
-        float                  fVec4[2048];
-        float                  fVec5[2048];
-        float                  fVec6[2048];
-        float                  fVec7[2048];
-        float                  fVec8[1024];
-        float                  fVec9[512];
-        float                  fslider0;
-        float                  fslider1;
-        float                  fslider2;
+        uint32_t               IOTA;
+        channel                fChannels[NUM_CHANNELS];
+
+        parameters update_parameters() {
+            const float fslider0 = damp.get();
+            const float fslider1 = roomSize.get();
+            const float fslider2 = wet.get();
+            parameters  mParameters;
+            mParameters.fSlow0 = (0.4f * fslider0);
+            mParameters.fSlow1 = (1 - mParameters.fSlow0);
+            mParameters.fSlow2 = (0.7f + (0.28f * fslider1));
+            mParameters.fSlow3 = fslider2;
+            mParameters.fSlow4 = (1 - mParameters.fSlow3);
+            return mParameters;
+        }
+
+        /* processes one sample of one channel at `IOTA` with the same arithmetic as `process_channel()` */
+        template<uint8_t C>
+        float process_sample(const parameters& p, const float input, const float dry) {
+            channel&     c    = fChannels[C];
+            const float* mRow = c.comb_line[IOTA];
+
+            /* summed in the order of the generated code */
+            float mSignal = mRow[COMB_LANES - 1];
+            for (int8_t k = COMB_LANES - 2; k >= 0; k--) {
+                mSignal += mRow[k];
+            }
+            for (uint8_t k = 0; k < COMB_LANES; k++) {
+                c.comb_filter[k]                                      = ((p.fSlow1 * c.comb_output[k]) + (p.fSlow0 * c.comb_filter[k]));
+                c.comb_output[k]                                      = mRow[k];
+                c.comb_line[(IOTA + COMB_DELAY[C][k]) & COMB_MASK][k] = (input + (p.fSlow2 * c.comb_filter[k]));
+            }
+
+            for (uint8_t j = 0; j < ALLPASS_STAGES; j++) {
+                float* mLine                  = c.allpass_line[j];
+                mLine[IOTA & ALLPASS_MASK[j]] = (mSignal + (0.5f * c.allpass_output[j]));
+                const float mDelayed          = mLine[(IOTA - ALLPASS_DELAY[C][j]) & ALLPASS_MASK[j]];
+                mSignal                       = (c.allpass_output[j] - mSignal);
+                c.allpass_output[j]           = mDelayed;
+            }
+            return ((p.fSlow4 * dry) + (p.fSlow3 * mSignal));
+        }
+
+        /* processes at most `CHUNK_SIZE` samples of one channel starting at `IOTA`. `input` is the mono comb input,
+         * `dry` may be the same buffer as `output`. */
+        template<uint8_t C>
+        void process_channel(const parameters& p,
+                             const float*      input,
+                             const float*      dry,
+                             float*            output,
+                             const uint32_t    length) {
+            channel&    c      = fChannels[C];
+            const float fSlow0 = p.fSlow0;
+            const float fSlow1 = p.fSlow1;
+            const float fSlow2 = p.fSlow2;
+
+#if KLANGWELLEN_REVERB_SIMD
+            comb_lanes mFilter;
+            comb_lanes mOutput;
+            std::memcpy(&mFilter, c.comb_filter, sizeof(comb_lanes));
+            std::memcpy(&mOutput, c.comb_output, sizeof(comb_lanes));
+#else
+            float mFilter[COMB_LANES];
+            float mOutput[COMB_LANES];
+            std::copy_n(c.comb_filter, COMB_LANES, mFilter);
+            std::copy_n(c.comb_output, COMB_LANES, mOutput);
+#endif // KLANGWELLEN_REVERB_SIMD
+            float mAllpass[ALLPASS_STAGES];
+            std::copy_n(c.allpass_output, ALLPASS_STAGES, mAllpass);
+
+            float mSum[CHUNK_SIZE];
+            for (uint32_t i = 0; i < length; i++) {
+                const uint32_t mIota = IOTA + i;
+                const float*   mRow  = c.comb_line[mIota & COMB_MASK];
+#if KLANGWELLEN_REVERB_SIMD
+                comb_lanes mRead;
+                std::memcpy(&mRead, mRow, sizeof(comb_lanes));
+                mFilter                 = ((fSlow1 * mOutput) + (fSlow0 * mFilter));
+                const comb_lanes mWrite = (input[i] + (fSlow2 * mFilter));
+                mOutput                 = mRead;
+#else
+                float mWrite[COMB_LANES];
+                for (uint8_t k = 0; k < COMB_LANES; k++) {
+                    mFilter[k] = ((fSlow1 * mOutput[k]) + (fSlow0 * mFilter[k]));
+                    mWrite[k]  = (input[i] + (fSlow2 * mFilter[k]));
+                    mOutput[k] = mRow[k];
+                }
+#endif // KLANGWELLEN_REVERB_SIMD
+                /* summed in the order of the generated code */
+                float mSignal = mRow[COMB_LANES - 1];
+                for (int8_t k = COMB_LANES - 2; k >= 0; k--) {
+                    mSignal += mRow[k];
+                }
+                mSum[i] = mSignal;
+                for (uint8_t k = 0; k < COMB_LANES; k++) {
+                    c.comb_line[(mIota + COMB_DELAY[C][k]) & COMB_MASK][k] = mWrite[k];
+                }
+            }
+
+            /* allpass filters in series */
+            for (uint32_t i = 0; i < length; i++) {
+                const uint32_t mIota   = IOTA + i;
+                float          mSignal = mSum[i];
+                for (uint8_t j = 0; j < ALLPASS_STAGES; j++) {
+                    float* mLine                   = c.allpass_line[j];
+                    mLine[mIota & ALLPASS_MASK[j]] = (mSignal + (0.5f * mAllpass[j]));
+                    const float mDelayed           = mLine[(mIota - ALLPASS_DELAY[C][j]) & ALLPASS_MASK[j]];
+                    mSignal                        = (mAllpass[j] - mSignal);
+                    mAllpass[j]                    = mDelayed;
+                }
+                output[i] = ((p.fSlow4 * dry[i]) + (p.fSlow3 * mSignal));
+            }
+
+#if KLANGWELLEN_REVERB_SIMD
+            std::memcpy(c.comb_filter, &mFilter, sizeof(comb_lanes));
+            std::memcpy(c.comb_output, &mOutput, sizeof(comb_lanes));
+#else
+            std::copy_n(mFilter, COMB_LANES, c.comb_filter);
+            std::copy_n(mOutput, COMB_LANES, c.comb_output);
+#endif // KLANGWELLEN_REVERB_SIMD
+            std::copy_n(mAllpass, ALLPASS_STAGES, c.allpass_output);
+        }
     };
 } // namespace klangwellen
@@ -29,20 +29,33 @@
 
 #pragma once
 
+#include <ctype.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
 #include <iostream>
-#include <sstream>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "KlangWellen.h"
 
 using namespace std;
 
 namespace klangwellen {
+    /**
+     * samples of an utterance rendered by `SAMCache`. `length` grows while the utterance is rendered on a background
+     * thread, samples below `length` do not change anymore. `finished` is set once rendering is complete.
+     */
+    struct SAMUtterance {
+        std::vector<int8_t>   samples;
+        std::atomic<uint32_t> length{0};
+        std::atomic<bool>     finished{false};
+    };
+
     class SAM {
     private:
         // tab40672
@@ -1971,6 +1984,7 @@ namespace klangwellen {
                     SAM_buffer[pos] = ary[k];
                 }
             }
+            publish_render_progress();
         }
         void Output8Bit(int index, uint8_t A) {
             uint8_t ary[5] = {A, A, A, A, A};
@@ -2793,6 +2807,7 @@ namespace klangwellen {
                         if (pos < SAM_buffer_max_length) {
                             SAM_buffer[pos] = (X & 15) * 16;
                         }
+                        publish_render_progress();
                     } else {
                         // mem[54296] = 6;
                         X = 6;
@@ -2801,6 +2816,7 @@ namespace klangwellen {
                         if (pos < SAM_buffer_max_length) {
                             SAM_buffer[pos] = (X & 15) * 16;
                         }
+                        publish_render_progress();
                     }
 
                     for (X = wait2; X > 0; X--)
@@ -4379,6 +4395,8 @@ namespace klangwellen {
             SAM_buffer            = new int8_t[pBufferLength];
             SAM_buffer_max_length = pBufferLength;
             fAllocatedBuffer      = true;
+            /* rendering does not write every sample ( e.g the first ), so start from silence */
+            memset(SAM_buffer, SILENCE, pBufferLength);
             setDefaults();
         }
 
@@ -4390,11 +4408,17 @@ namespace klangwellen {
         }
 
         ~SAM() {
+            release_utterances();
+            delete fNextUtterance.load();
+            delete fUtterance;
             if (fAllocatedBuffer) {
                 delete[] SAM_buffer;
             }
         }
 
+        SAM(const SAM&)            = delete;
+        SAM& operator=(const SAM&) = delete;
+
         void set_buffer(int8_t* pBuffer, uint32_t pBufferLength) {
             SAM_buffer            = pBuffer;
             SAM_buffer_max_length = pBufferLength;
@@ -4429,64 +4453,64 @@ namespace klangwellen {
         }
 
         void speak(string pText, bool pUsePhonemes = false) {
-            char input[256];
-            if (pUsePhonemes) {
-                pText.length() < 255 ? strcpy(input, pText.c_str()) : strncpy(input, pText.c_str(), 255);
-                // strcpy(input, pText.c_str());
-            } else {
-                char mText[256];
-                pText.length() < 254 ? strcpy(mText, pText.c_str()) : strncpy(mText, pText.c_str(), 254);
-                strcpy(mText, pText.c_str());
-                for (uint8_t i = 0; i < 255; i++) input[i] = 0;
-                strncat(input, mText, 255);
-                strncat(input, "[", 255);
-                TextToPhonemes(input);
-                // std::cout << "TextToPhonemes: " << input << std::endl;
-            }
-            SetInput(input);
-            SAMMain();
-            mDoneSpeaking = false;
-            mCounter      = 0;
+            render_text(pText, pUsePhonemes);
+            post_utterance(nullptr, 0, false);
         }
 
         void speak_ascii(int pASCIIValue) {
-            stringstream ss;
-            ss << (char) pASCIIValue;
-            string s;
-            ss >> s;
-            speak(s);
+            /* whitespace is spoken as an empty string */
+            const char mCharacter = static_cast<char>(pASCIIValue);
+            speak(isspace(static_cast<unsigned char>(mCharacter)) ? string() : string(1, mCharacter));
+        }
+
+        /**
+         * plays an utterance rendered by `SAMCache`. playback may start while the utterance is still being rendered,
+         * if playback catches up with rendering it outputs silence until more samples are available.
+         *
+         * may be called from the application thread while `process()` runs in the audio thread: the utterance is
+         * handed over without locks and playback starts with the next call to `process()`. the previously played
+         * utterance is released on the calling thread ( at the latest with the next call to `speak()` or `stop()` ),
+         * so the audio thread never frees an utterance evicted from the cache.
+         */
+        void speak(std::shared_ptr<const SAMUtterance> pUtterance) {
+            post_utterance(std::move(pUtterance), 0, false);
         }
 
         void speak_from_buffer() {
-            mDoneSpeaking = false;
-            mCounter      = 0;
+            post_utterance(nullptr, 0, false);
         }
 
         /**
          * renders text into buffer but does not play it immediately
          */
         void speak_to_buffer(string pText, bool pUsePhonemes = false) {
-            speak(pText, pUsePhonemes);
-            mDoneSpeaking = true;
-            mCounter      = get_used_buffer_length() - 1;
+            render_text(pText, pUsePhonemes);
+            post_utterance(nullptr, get_used_buffer_length() - 1, true);
         }
 
         void stop() {
-            mDoneSpeaking = true;
-            mCounter      = get_used_buffer_length() - 1;
+            post_utterance(nullptr, get_used_buffer_length() - 1, true);
         }
 
         uint32_t get_used_buffer_length() {
-            return GetBufferLength() / 50;
+            /* rendering stops writing at the end of the buffer but continues counting */
+            const uint32_t mLength = GetBufferLength() / 50;
+            return mLength < SAM_buffer_max_length ? mLength : SAM_buffer_max_length;
         }
 
         void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            adopt_utterance();
+            if (fUtterance != nullptr) {
+                process_utterance(signal_buffer, buffer_length);
+                return;
+            }
+            const float*   mSampleTable  = get_sample_table();
             uint8_t*       mBuffer       = (uint8_t*) GetBuffer();
             const uint32_t mBufferLength = get_used_buffer_length();
             for (uint32_t i = 0; i < buffer_length; i += 2) {
                 float mSample = 0.0;
                 if (!mDoneSpeaking && mBufferLength > 0) {
-                    mSample = mBuffer[mCounter] / 255.0 * 2.0 - 1.0;
+                    mSample = mSampleTable[mBuffer[mCounter]];
                     mCounter++;
                     if (mCounter >= mBufferLength) {
                         mDoneSpeaking = true;
@@ -4498,6 +4522,34 @@ namespace klangwellen {
             }
         }
 
+        uint8_t get_pitch() const {
+            return mPitch;
+        }
+
+        uint8_t get_throat() const {
+            return mThroat;
+        }
+
+        uint8_t get_speed() const {
+            return mSpeed;
+        }
+
+        uint8_t get_mouth() const {
+            return mMouth;
+        }
+
+        bool get_sing_mode() const {
+            return singmode != 0;
+        }
+
+        /**
+         * publishes the number of rendered samples that do not change anymore to `progress` while rendering ( used by
+         * `SAMCache` to stream utterances ). pass `nullptr` to disable.
+         */
+        void set_render_progress(std::atomic<uint32_t>* progress) {
+            fRenderProgress = progress;
+        }
+
         uint8_t set_pitch_from_MIDI_note(uint8_t MIDI_note) {
             if (MIDI_note >= 21 && MIDI_note <= 127) {
                 const uint8_t mSAMPitch = SAM_MIDI_NOTE_TOSAM_PITCH_MAP[MIDI_note - 21];
@@ -4513,9 +4565,139 @@ namespace klangwellen {
         uint8_t mMouth;
         uint8_t mSpeed;
 
-        uint32_t mCounter         = 0;
-        bool     mDoneSpeaking    = false;
-        bool     fAllocatedBuffer = false;
+        static constexpr uint8_t SILENCE = 0x80;
+
+        /* playback is passed between threads as heap allocated handles, so that neither thread touches a `shared_ptr`
+         * the other thread owns and the audio thread never drops the last reference to an utterance */
+        struct utterance_handle {
+            std::shared_ptr<const SAMUtterance> utterance;
+            uint32_t                            counter;
+            bool                                done_speaking;
+        };
+
+        static constexpr uint32_t RELEASE_QUEUE_SIZE = 8;
+
+        uint32_t                       mCounter         = 0;
+        bool                           mDoneSpeaking    = false;
+        bool                           fAllocatedBuffer = false;
+        utterance_handle*              fUtterance       = nullptr; /* audio thread */
+        std::atomic<utterance_handle*> fNextUtterance{nullptr};    /* application thread -> audio thread */
+        utterance_handle*              fReleaseQueue[RELEASE_QUEUE_SIZE] = {}; /* audio thread -> application thread */
+        std::atomic<uint32_t>          fReleaseWrite{0};
+        std::atomic<uint32_t>          fReleaseRead{0};
+        std::atomic<uint32_t>*         fRenderProgress = nullptr;
+
+        struct sample_table {
+            float values[256];
+
+            sample_table() {
+                for (int i = 0; i < 256; i++) {
+                    values[i] = i / 255.0 * 2.0 - 1.0;
+                }
+            }
+        };
+
+        /* converts unsigned 8-bit samples to [-1, 1] */
+        static const float* get_sample_table() {
+            static const sample_table mTable;
+            return mTable.values;
+        }
+
+        void publish_render_progress() {
+            if (fRenderProgress != nullptr) {
+                const uint32_t mLength = bufferpos / 50;
+                fRenderProgress->store(mLength < SAM_buffer_max_length ? mLength : SAM_buffer_max_length, std::memory_order_release);
+            }
+        }
+
+        void render_text(string pText, bool pUsePhonemes) {
+            char input[256];
+            if (pUsePhonemes) {
+                pText.length() < 255 ? strcpy(input, pText.c_str()) : strncpy(input, pText.c_str(), 255);
+                // strcpy(input, pText.c_str());
+            } else {
+                char mText[256];
+                pText.length() < 254 ? strcpy(mText, pText.c_str()) : strncpy(mText, pText.c_str(), 254);
+                strcpy(mText, pText.c_str());
+                for (uint8_t i = 0; i < 255; i++) input[i] = 0;
+                strncat(input, mText, 255);
+                strncat(input, "[", 255);
+                TextToPhonemes(input);
+                // std::cout << "TextToPhonemes: " << input << std::endl;
+            }
+            SetInput(input);
+            SAMMain();
+        }
+
+        /* application thread: frees the handles the audio thread is done with */
+        void release_utterances() {
+            const uint32_t mWrite = fReleaseWrite.load(std::memory_order_acquire);
+            uint32_t       mRead  = fReleaseRead.load(std::memory_order_relaxed);
+            while (mRead != mWrite) {
+                delete fReleaseQueue[mRead % RELEASE_QUEUE_SIZE];
+                mRead++;
+            }
+            fReleaseRead.store(mRead, std::memory_order_release);
+        }
+
+        /* application thread: a handle without utterance plays from the buffer. a handle that was not adopted by the
+         * audio thread yet is replaced and freed here */
+        void post_utterance(std::shared_ptr<const SAMUtterance> pUtterance, const uint32_t pCounter, const bool pDoneSpeaking) {
+            release_utterances();
+            delete fNextUtterance.exchange(new utterance_handle{std::move(pUtterance), pCounter, pDoneSpeaking},
+                                           std::memory_order_acq_rel);
+        }
+
+        /* audio thread: adopts the most recently posted handle at the beginning of a block */
+        void adopt_utterance() {
+            if (fNextUtterance.load(std::memory_order_relaxed) == nullptr) {
+                return;
+            }
+            /* keep the handle pending until the application thread made room to release two handles */
+            const uint32_t mWrite = fReleaseWrite.load(std::memory_order_relaxed);
+            if (mWrite - fReleaseRead.load(std::memory_order_acquire) > RELEASE_QUEUE_SIZE - 2) {
+                return;
+            }
+            utterance_handle* mNext = fNextUtterance.exchange(nullptr, std::memory_order_acq_rel);
+            if (mNext == nullptr) {
+                return;
+            }
+            uint32_t mReleased = mWrite;
+            if (fUtterance != nullptr) {
+                fReleaseQueue[mReleased++ % RELEASE_QUEUE_SIZE] = fUtterance;
+            }
+            mCounter      = mNext->counter;
+            mDoneSpeaking = mNext->done_speaking;
+            if (mNext->utterance == nullptr) {
+                fReleaseQueue[mReleased++ % RELEASE_QUEUE_SIZE] = mNext;
+                fUtterance                                      = nullptr;
+            } else {
+                fUtterance = mNext;
+            }
+            fReleaseWrite.store(mReleased, std::memory_order_release);
+        }
+
+        void process_utterance(float* signal_buffer, const uint32_t buffer_length) {
+            const float*        mSampleTable = get_sample_table();
+            const SAMUtterance& mUtterance   = *fUtterance->utterance;
+            const uint8_t*      mSamples     = reinterpret_cast<const uint8_t*>(mUtterance.samples.data());
+            /* `finished` before `length`, so that a finished utterance is read up to its final length */
+            const bool     mFinished  = mUtterance.finished.load(std::memory_order_acquire);
+            const uint32_t mAvailable = mUtterance.length.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < buffer_length; i += 2) {
+                float mSample = 0.0f;
+                if (!mDoneSpeaking) {
+                    if (mCounter < mAvailable) {
+                        mSample = mSampleTable[mSamples[mCounter]];
+                        mCounter++;
+                    } else if (mFinished) {
+                        mDoneSpeaking = true;
+                    }
+                }
+                signal_buffer[i]     = mSample;
+                signal_buffer[i + 1] = mSample;
+            }
+        }
 
         void setDefaults() {
             set_pitch(64);
@@ -0,0 +1,229 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "SAM.h"
+
+namespace klangwellen {
+    /**
+     * renders `SAM` utterances once and keeps them in a least-recently-used cache. utterances are identified by text and
+     * voice settings ( pitch, speed, mouth, throat, sing mode ). a request for an utterance that is not cached returns
+     * immediately, the utterance is rendered on a background thread and can be played while it is rendered:
+     *
+     * ```
+     * SAMCache mCache;
+     * SAM      mSAM;
+     * mCache.speak(mSAM, "hello world"); // does not block
+     * ...
+     * mSAM.process(buffer, length);      // in the audio thread
+     * ```
+     *
+     * `request()` and `speak()` lock a mutex shortly and allocate for uncached utterances, so they are meant to be called
+     * from the application thread ( e.g `draw()` ) rather than the audio thread. `speak()` may be called while
+     * `SAM::process()` runs, the utterance is adopted by the audio thread at the beginning of the next block ( see
+     * `SAM::speak(std::shared_ptr<const SAMUtterance>)` ).
+     */
+    class SAMCache {
+    public:
+        static constexpr size_t   DEFAULT_MAX_UTTERANCES = 32;
+        static constexpr uint32_t DEFAULT_BUFFER_LENGTH  = 65536;
+
+        /**
+         * @param max_utterances maximum number of cached utterances
+         * @param buffer_length  maximum length of an utterance in samples ( memory per utterance in bytes )
+         */
+        explicit SAMCache(const size_t   max_utterances = DEFAULT_MAX_UTTERANCES,
+                          const uint32_t buffer_length  = DEFAULT_BUFFER_LENGTH) : fMaxUtterances(std::max<size_t>(max_utterances, 1)),
+                                                                                  fBufferLength(buffer_length) {
+            fRenderThread = std::thread(&SAMCache::render_thread, this);
+        }
+
+        ~SAMCache() {
+            {
+                std::lock_guard<std::mutex> mLock(fMutex);
+                fRunning = false;
+            }
+            fSignal.notify_one();
+            fRenderThread.join();
+        }
+
+        SAMCache(const SAMCache&)            = delete;
+        SAMCache& operator=(const SAMCache&) = delete;
+
+        /**
+         * @return the cached utterance or a new utterance that is queued for rendering
+         */
+        std::shared_ptr<const SAMUtterance> request(const std::string& text,
+                                                    const uint8_t      pitch,
+                                                    const uint8_t      speed,
+                                                    const uint8_t      mouth,
+                                                    const uint8_t      throat,
+                                                    const bool         sing_mode    = false,
+                                                    const bool         use_phonemes = false) {
+            std::string mKey = text;
+            mKey.push_back('\0');
+            mKey.push_back(static_cast<char>(pitch));
+            mKey.push_back(static_cast<char>(speed));
+            mKey.push_back(static_cast<char>(mouth));
+            mKey.push_back(static_cast<char>(throat));
+            mKey.push_back(static_cast<char>((sing_mode ? 1 : 0) | (use_phonemes ? 2 : 0)));
+
+            std::shared_ptr<SAMUtterance> mUtterance;
+            {
+                std::lock_guard<std::mutex> mLock(fMutex);
+                const auto                  mEntry = fIndex.find(mKey);
+                if (mEntry != fIndex.end()) {
+                    fEntries.splice(fEntries.begin(), fEntries, mEntry->second);
+                    fHits++;
+                    return mEntry->second->utterance;
+                }
+                fMisses++;
+                mUtterance = std::make_shared<SAMUtterance>();
+                mUtterance->samples.assign(fBufferLength, static_cast<int8_t>(0x80)); /* silence, as in `SAM` */
+                fEntries.push_front({mKey, mUtterance});
+                fIndex[mKey] = fEntries.begin();
+                while (fEntries.size() > fMaxUtterances) {
+                    fIndex.erase(fEntries.back().key);
+                    fEntries.pop_back();
+                }
+                fQueue.push_back({mUtterance, text, pitch, speed, mouth, throat, sing_mode, use_phonemes});
+            }
+            fSignal.notify_one();
+            return mUtterance;
+        }
+
+        /**
+         * requests `text` with the voice settings of `sam` and plays it on `sam`
+         */
+        void speak(SAM& sam, const std::string& text, const bool use_phonemes = false) {
+            sam.speak(request(text, sam.get_pitch(), sam.get_speed(), sam.get_mouth(), sam.get_throat(), sam.get_sing_mode(), use_phonemes));
+        }
+
+        /**
+         * renders `text` in advance without playing it
+         */
+        void prefetch(const SAM& sam, const std::string& text, const bool use_phonemes = false) {
+            request(text, sam.get_pitch(), sam.get_speed(), sam.get_mouth(), sam.get_throat(), sam.get_sing_mode(), use_phonemes);
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> mLock(fMutex);
+            fIndex.clear();
+            fEntries.clear();
+        }
+
+        size_t get_num_utterances() {
+            std::lock_guard<std::mutex> mLock(fMutex);
+            return fEntries.size();
+        }
+
+        /**
+         * @return memory used by cached utterances in bytes
+         */
+        size_t get_memory_size() {
+            return get_num_utterances() * fBufferLength;
+        }
+
+        uint32_t get_hits() const {
+            return fHits;
+        }
+
+        uint32_t get_misses() const {
+            return fMisses;
+        }
+
+    private:
+        struct entry {
+            std::string                   key;
+            std::shared_ptr<SAMUtterance> utterance;
+        };
+
+        struct job {
+            std::shared_ptr<SAMUtterance> utterance;
+            std::string                   text;
+            uint8_t                       pitch;
+            uint8_t                       speed;
+            uint8_t                       mouth;
+            uint8_t                       throat;
+            bool                          sing_mode;
+            bool                          use_phonemes;
+        };
+
+        const size_t                                                fMaxUtterances;
+        const uint32_t                                              fBufferLength;
+        std::list<entry>                                            fEntries; /* most recently used first */
+        std::unordered_map<std::string, std::list<entry>::iterator> fIndex;
+        std::deque<job>                                             fQueue;
+        std::mutex                                                  fMutex;
+        std::condition_variable                                     fSignal;
+        std::thread                                                 fRenderThread;
+        bool                                                        fRunning = true;
+        std::atomic<uint32_t>                                       fHits{0};
+        std::atomic<uint32_t>                                       fMisses{0};
+
+        void render_thread() {
+            while (true) {
+                job mJob;
+                {
+                    std::unique_lock<std::mutex> mLock(fMutex);
+                    fSignal.wait(mLock, [this] { return !fRunning || !fQueue.empty(); });
+                    if (!fRunning) {
+                        return;
+                    }
+                    mJob = std::move(fQueue.front());
+                    fQueue.pop_front();
+                    /* evicted before it was rendered and not referenced by a player */
+                    if (mJob.utterance.use_count() == 1) {
+                        continue;
+                    }
+                }
+                render(mJob);
+            }
+        }
+
+        /* every utterance is rendered by a new engine, `SAM` keeps state between utterances that would make the output
+         * depend on the order of requests */
+        void render(const job& job) {
+            SAMUtterance&        mUtterance = *job.utterance;
+            std::unique_ptr<SAM> mEngine(new SAM(mUtterance.samples.data(), fBufferLength));
+            mEngine->set_pitch(job.pitch);
+            mEngine->set_speed(job.speed);
+            mEngine->set_mouth(job.mouth);
+            mEngine->set_throat(job.throat);
+            mEngine->set_sing_mode(job.sing_mode);
+            mEngine->set_render_progress(&mUtterance.length);
+            mEngine->speak(job.text, job.use_phonemes);
+            mUtterance.length.store(mEngine->get_used_buffer_length(), std::memory_order_release);
+            mUtterance.finished.store(true, std::memory_order_release);
+        }
+    };
+} // namespace klangwellen
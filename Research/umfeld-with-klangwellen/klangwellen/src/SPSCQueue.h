@@ -0,0 +1,89 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+
+namespace klangwellen {
+    /**
+     * a wait-free, fixed-capacity queue for exactly one producer thread and one consumer thread ( e.g the application
+     * thread and the audio thread ). neither `push()` nor `pop()` locks or allocates.
+     *
+     * @tparam T        element type, copied in and out of the queue
+     * @tparam CAPACITY number of elements, must be a power of two
+     */
+    template<typename T, size_t CAPACITY>
+    class SPSCQueue {
+        static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+    public:
+        /**
+         * producer thread
+         *
+         * @return false if the queue is full
+         */
+        bool push(const T& element) {
+            const size_t mHead = fHead.load(std::memory_order_relaxed);
+            if (mHead - fTail.load(std::memory_order_acquire) == CAPACITY) {
+                return false;
+            }
+            fElements[mHead & (CAPACITY - 1)] = element;
+            fHead.store(mHead + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * consumer thread
+         *
+         * @return false if the queue is empty
+         */
+        bool pop(T& element) {
+            const size_t mTail = fTail.load(std::memory_order_relaxed);
+            if (fHead.load(std::memory_order_acquire) == mTail) {
+                return false;
+            }
+            element = fElements[mTail & (CAPACITY - 1)];
+            fTail.store(mTail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @return number of elements in the queue ( exact only when called from the producer or consumer thread while the
+         * other one is idle )
+         */
+        size_t size() const {
+            return fHead.load(std::memory_order_acquire) - fTail.load(std::memory_order_acquire);
+        }
+
+        bool empty() const {
+            return size() == 0;
+        }
+
+        static constexpr size_t capacity() {
+            return CAPACITY;
+        }
+
+    private:
+        T                               fElements[CAPACITY];
+        alignas(64) std::atomic<size_t> fHead{0}; /* written by the producer */
+        alignas(64) std::atomic<size_t> fTail{0}; /* written by the consumer */
+    };
+} // namespace klangwellen
@@ -29,18 +29,23 @@
 
 /*
  * TODO
- * - LINE 325: check for memory leak and change recording mechanism in a way that the maximum length can be specified beforehand as well as a pre-allocated buffer
  * - LINE 153: "huuui, this is not nice and might cause some trouble somewhere"
  * - LINE 220: "evaluate direction?"
  */
 
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
+#include "EventQueue.h"
 #include "KlangWellen.h"
 
 namespace klangwellen {
+    /**
+     * called from inside `process()` ( i.e the audio thread ), see `SamplerT::set_event_queue()` to handle events
+     * elsewhere.
+     */
     class SamplerListener {
     public:
         virtual void is_done() = 0;
@@ -52,7 +57,11 @@ namespace klangwellen {
     template<class BUFFER_TYPE>
     class SamplerT {
     public:
-        static constexpr int8_t NO_LOOP_POINT = -1;
+        static constexpr int8_t  NO_LOOP_POINT  = -1;
+        static constexpr uint8_t RECORD_APPEND  = 0; /* append to the recording buffer until it is full */
+        static constexpr uint8_t RECORD_RING    = 1; /* keep the most recent samples once the recording buffer is full */
+        static constexpr uint8_t RECORD_OVERDUB = 2; /* mix into the playback buffer ( looper ) */
+        static constexpr uint8_t EVENT_DONE     = 0; /* reached the end, not playing or the buffer is empty */
 
         SamplerT() : SamplerT(0) {
         }
@@ -80,13 +89,19 @@ namespace klangwellen {
             set_speed(1.0f);
             set_amplitude(1.0f);
             fIsRecording     = false;
+            fIsFlaggedDone   = false;
+            fEvaluateLoop    = false;
             fAllocatedBuffer = false;
+            fBufferCapacity  = buffer_length;
         }
 
         ~SamplerT() {
             if (fAllocatedBuffer) {
                 delete[] fBuffer;
             }
+            if (fRecordAllocatedBuffer) {
+                delete[] fRecordBuffer;
+            }
         }
 
         void add_listener(SamplerListener* sampler_listener) {
@@ -103,6 +118,25 @@ namespace klangwellen {
             return false;
         }
 
+        /**
+         * pushes an `EVENT_DONE` event into `queue` whenever the listeners are notified, so that the work of a listener
+         * can be done outside of `process()` ( see `EventQueue` ).
+         *
+         * @param queue  queue or `nullptr` to stop pushing events
+         * @param source id of the sampler in the events
+         */
+        void set_event_queue(EventQueue* queue, const uint8_t source = 0) {
+            fEventQueue  = queue;
+            fEventSource = source;
+        }
+
+        /**
+         * @return number of samples processed so far
+         */
+        uint64_t get_frame() const {
+            return fFrame;
+        }
+
         int32_t get_in() const {
             return fInPoint;
         }
@@ -194,62 +228,33 @@ namespace klangwellen {
         }
 
         float process() {
+            float mSample = 0.0f;
             if (fBufferLength == 0) {
                 notifyListeners(); // "buffer is empty"
-                return 0.0f;
-            }
-
-            if (!fIsPlaying) {
+            } else if (!fIsPlaying) {
                 notifyListeners(); // "not playing"
-                return 0.0f;
-            }
-
-            validateInOutPoints();
-
-            fBufferIndex += fDirectionForward ? fStepSize : -fStepSize;
-            const int32_t mRoundedIndex = static_cast<int32_t>(fBufferIndex);
-
-            const float   mFrac         = fBufferIndex - mRoundedIndex;
-            const int32_t mCurrentIndex = wrapIndex(mRoundedIndex);
-            fBufferIndex                = mCurrentIndex + mFrac;
-
-            if (fDirectionForward ? (mCurrentIndex >= fOutPoint) : (mCurrentIndex <= fInPoint)) {
-                notifyListeners(); // "reached end"
-                return 0.0f;
             } else {
-                fIsFlaggedDone = false;
-            }
-
-            float mSample = convert_sample(fBuffer[mCurrentIndex]);
-
-            /* interpolate */
-            if (fInterpolateSamples) {
-                // TODO evaluate direction?
-                const int32_t mNextIndex  = wrapIndex(mCurrentIndex + 1);
-                const float   mNextSample = convert_sample(fBuffer[mNextIndex]);
-                mSample                   = mSample * (1.0f - mFrac) + mNextSample * mFrac;
-                // mSample = interpolate_samples_linear(fBuffer, fBufferLength, fBufferIndex);
-                // mSample = interpolate_samples_cubic(fBuffer, fBufferLength, fBufferIndex);
-            }
-            mSample *= fAmplitude;
-
-            /* fade edges */
-            if (fEdgeFadePadding > 0) {
-                const int32_t mRelativeIndex = fBufferLength - mCurrentIndex;
-                if (mCurrentIndex < fEdgeFadePadding) {
-                    const float mFadeInAmount = static_cast<float>(mCurrentIndex) / fEdgeFadePadding;
-                    mSample *= mFadeInAmount;
-                } else if (mRelativeIndex < fEdgeFadePadding) {
-                    const float mFadeOutAmount = static_cast<float>(mRelativeIndex) / fEdgeFadePadding;
-                    mSample *= mFadeOutAmount;
-                }
+                validateInOutPoints();
+                mSample = next_sample();
             }
+            fFrame++;
             return mSample;
         }
 
         void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint16_t i = 0; i < buffer_length; i++) {
-                signal_buffer[i] = process();
+            if (fBufferLength == 0 || !fIsPlaying) {
+                notifyListeners(); // "buffer is empty" or "not playing"
+                std::fill_n(signal_buffer, buffer_length, 0.0f);
+                fFrame += buffer_length;
+                return;
+            }
+
+            /* in- and out-points only change between blocks */
+            validateInOutPoints();
+
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] = next_sample();
+                fFrame++;
             }
         }
 
@@ -292,8 +297,70 @@ namespace klangwellen {
             fIsPlaying = false;
         }
 
+        /**
+         * records into a buffer of fixed capacity instead of a growing vector so that `record()` never allocates. the
+         * buffer is owned by the caller and is adopted as playback buffer by `end_recording()`.
+         *
+         * @param buffer   recording buffer
+         * @param capacity maximum number of samples that can be recorded
+         */
+        void set_recording_buffer(BUFFER_TYPE* buffer, const int32_t capacity) {
+            if (fRecordAllocatedBuffer) {
+                delete[] fRecordBuffer;
+            }
+            fRecordBuffer          = buffer;
+            fRecordCapacity        = buffer == nullptr ? 0 : std::max(capacity, 0);
+            fRecordAllocatedBuffer = false;
+            fRecordPreallocated    = true;
+            fRecordLength          = 0;
+            fRecordPosition        = 0;
+        }
+
+        /**
+         * allocates a recording buffer owned by the sampler ( see `set_recording_buffer()` ). must not be called from
+         * the audio thread.
+         *
+         * @param capacity maximum number of samples that can be recorded
+         */
+        void allocate_recording_buffer(const int32_t capacity) {
+            set_recording_buffer(new BUFFER_TYPE[std::max(capacity, 0)], capacity);
+            fRecordAllocatedBuffer = true;
+        }
+
+        int32_t get_recording_capacity() const {
+            return fRecordCapacity;
+        }
+
+        /**
+         * @param recording_mode `RECORD_APPEND`, `RECORD_RING` or `RECORD_OVERDUB`. the first two require a recording
+         *                       buffer ( see `set_recording_buffer()` ), overdub records into the playback buffer.
+         */
+        void set_recording_mode(const uint8_t recording_mode) {
+            fRecordMode = recording_mode;
+        }
+
+        uint8_t get_recording_mode() const {
+            return fRecordMode;
+        }
+
+        /**
+         * @param overdub_feedback amount of the previous content that is kept when overdubbing ( 1.0 keeps all, 0.0
+         *                         replaces it )
+         */
+        void set_overdub_feedback(const float overdub_feedback) {
+            fOverdubFeedback = overdub_feedback;
+        }
+
+        float get_overdub_feedback() const {
+            return fOverdubFeedback;
+        }
+
         void start_recording() {
             fIsRecording = true;
+            if (fRecordMode == RECORD_OVERDUB) {
+                /* overdub starts at the playhead and advances one sample per recorded sample */
+                fRecordPosition = KlangWellen::clamp(get_position(), 0, std::max(last_index(), 0));
+            }
         }
 
         void resume_recording() {
@@ -306,16 +373,23 @@ namespace klangwellen {
 
         void delete_recording() {
             fRecording.clear();
+            fRecordLength   = 0;
+            fRecordPosition = 0;
         }
 
         void record(float sample) {
-            if (fIsRecording) {
-                fRecording.push_back(sample);
-            }
+            record(&sample, 1);
         }
 
         void record(float* samples, int32_t num_samples) {
-            if (fIsRecording) {
+            if (!fIsRecording) {
+                return;
+            }
+            if (fRecordMode == RECORD_OVERDUB) {
+                record_overdub(samples, num_samples);
+            } else if (fRecordPreallocated) {
+                record_preallocated(samples, num_samples);
+            } else {
                 for (int32_t i = 0; i < num_samples; i++) {
                     const float sample = samples[i];
                     fRecording.push_back(sample);
@@ -328,22 +402,37 @@ namespace klangwellen {
         }
 
         int get_length_recording() {
-            return fRecording.size();
+            return fRecordPreallocated ? fRecordLength : fRecording.size();
         }
 
+        /**
+         * ends the recording and uses it as playback buffer. with a recording buffer ( see `set_recording_buffer()` )
+         * the buffer is adopted without copying ( in `RECORD_RING` mode a wrapped recording is rotated in place ). if
+         * the previous playback buffer was owned by the sampler it becomes the next recording buffer and neither path
+         * allocates. a previous playback buffer owned by the caller is not reused, the next recording then grows a vector
+         * ( which allocates ) unless a new recording buffer is set. in `RECORD_OVERDUB` mode the playback buffer already
+         * contains the recording.
+         *
+         * @return length of the recording
+         */
         uint32_t end_recording() {
-            fIsRecording                = false;
-            const int32_t mBufferLength = fRecording.size();
-            float*        mBuffer       = new float[mBufferLength];
-            for (int32_t i = 0; i < mBufferLength; i++) {
-                mBuffer[i] = fRecording[i];
+            fIsRecording = false;
+            if (fRecordMode == RECORD_OVERDUB) {
+                return fBufferLength;
             }
+            if (fRecordPreallocated) {
+                return adopt_recording_buffer();
+            }
+            const int32_t mBufferLength = fRecording.size();
+            BUFFER_TYPE*  mBuffer       = new BUFFER_TYPE[mBufferLength];
+            std::copy(fRecording.begin(), fRecording.end(), mBuffer);
             fRecording.clear();
             if (fAllocatedBuffer) {
                 delete[] fBuffer;
             }
             set_buffer(mBuffer, mBufferLength);
             fAllocatedBuffer = true;
+            fBufferCapacity  = mBufferLength;
             return mBufferLength;
         }
 
@@ -453,16 +542,97 @@ namespace klangwellen {
         bool                          fIsFlaggedDone;
         bool                          fIsRecording;
         bool                          fAllocatedBuffer;
+        int32_t                       fBufferCapacity;
+        BUFFER_TYPE*                  fRecordBuffer          = nullptr;
+        int32_t                       fRecordCapacity        = 0;
+        int32_t                       fRecordLength          = 0; /* number of valid samples in the recording buffer */
+        int32_t                       fRecordPosition        = 0; /* next write position in ring and overdub mode */
+        uint8_t                       fRecordMode            = RECORD_APPEND;
+        float                         fOverdubFeedback       = 1.0f;
+        bool                          fRecordAllocatedBuffer = false;
+        bool                          fRecordPreallocated    = false;
+        EventQueue*                   fEventQueue            = nullptr;
+        uint8_t                       fEventSource           = 0;
+        uint64_t                      fFrame                 = 0;
 
         int32_t last_index() const {
             return fBufferLength - 1;
         }
 
-        void notifyListeners() {
-            if (!fIsFlaggedDone) {
-                for (SamplerListener* l: fSamplerListeners) {
-                    l->is_done();
+        void record_preallocated(const float* samples, const int32_t num_samples) {
+            if (fRecordCapacity == 0) {
+                return;
+            }
+            if (fRecordMode == RECORD_RING) {
+                for (int32_t i = 0; i < num_samples; i++) {
+                    fRecordBuffer[fRecordPosition] = static_cast<BUFFER_TYPE>(samples[i]);
+                    fRecordPosition++;
+                    if (fRecordPosition == fRecordCapacity) {
+                        fRecordPosition = 0;
+                    }
                 }
+                fRecordLength = std::min(fRecordLength + num_samples, fRecordCapacity);
+            } else {
+                const int32_t mLength = std::min(num_samples, fRecordCapacity - fRecordLength);
+                for (int32_t i = 0; i < mLength; i++) {
+                    fRecordBuffer[fRecordLength + i] = static_cast<BUFFER_TYPE>(samples[i]);
+                }
+                fRecordLength += mLength;
+            }
+        }
+
+        void record_overdub(const float* samples, const int32_t num_samples) {
+            if (fBufferLength == 0) {
+                return;
+            }
+            /* wrap within the loop if one is set, otherwise within the in- and out-points */
+            const bool    mLoop  = fEvaluateLoop && fLoopIn != NO_LOOP_POINT && fLoopOut != NO_LOOP_POINT;
+            const int32_t mStart = KlangWellen::clamp(mLoop ? fLoopIn : fInPoint, 0, last_index());
+            const int32_t mEnd   = KlangWellen::clamp(mLoop ? fLoopOut : fOutPoint, mStart, last_index());
+            if (fRecordPosition < mStart || fRecordPosition > mEnd) {
+                fRecordPosition = mStart;
+            }
+            for (int32_t i = 0; i < num_samples; i++) {
+                BUFFER_TYPE& mSample = fBuffer[fRecordPosition];
+                mSample              = static_cast<BUFFER_TYPE>(mSample * fOverdubFeedback + samples[i]);
+                fRecordPosition      = fRecordPosition == mEnd ? mStart : fRecordPosition + 1;
+            }
+        }
+
+        uint32_t adopt_recording_buffer() {
+            if (fRecordMode == RECORD_RING && fRecordLength == fRecordCapacity) {
+                /* oldest sample is at the write position */
+                std::rotate(fRecordBuffer, fRecordBuffer + fRecordPosition, fRecordBuffer + fRecordCapacity);
+            }
+            const int32_t mLength           = fRecordLength;
+            BUFFER_TYPE*  mPreviousBuffer   = fBuffer;
+            const int32_t mPreviousCapacity = fBufferCapacity;
+            const bool    mPreviousOwned    = fAllocatedBuffer;
+
+            set_buffer(fRecordBuffer, mLength);
+            fAllocatedBuffer = fRecordAllocatedBuffer;
+            fBufferCapacity  = fRecordCapacity;
+
+            /* reuse a buffer owned by the sampler for the next recording, otherwise record into the vector again */
+            fRecordBuffer          = mPreviousOwned ? mPreviousBuffer : nullptr;
+            fRecordCapacity        = mPreviousOwned ? mPreviousCapacity : 0;
+            fRecordAllocatedBuffer = mPreviousOwned;
+            fRecordPreallocated    = mPreviousOwned;
+            fRecordLength          = 0;
+            fRecordPosition        = 0;
+            return mLength;
+        }
+
+        /* notifies once until the sampler plays again */
+        void notifyListeners() {
+            if (fIsFlaggedDone) {
+                return;
+            }
+            for (SamplerListener* l: fSamplerListeners) {
+                l->is_done();
+            }
+            if (fEventQueue != nullptr) {
+                fEventQueue->push(fFrame, EVENT_DONE, 0, fEventSource);
             }
             fIsFlaggedDone = true;
         }
@@ -489,6 +659,48 @@ namespace klangwellen {
             }
         }
 
+        float next_sample() {
+            fBufferIndex += fDirectionForward ? fStepSize : -fStepSize;
+            const int32_t mRoundedIndex = static_cast<int32_t>(fBufferIndex);
+
+            const float   mFrac         = fBufferIndex - mRoundedIndex;
+            const int32_t mCurrentIndex = wrapIndex(mRoundedIndex);
+            fBufferIndex                = mCurrentIndex + mFrac;
+
+            if (fDirectionForward ? (mCurrentIndex >= fOutPoint) : (mCurrentIndex <= fInPoint)) {
+                notifyListeners(); // "reached end"
+                return 0.0f;
+            } else {
+                fIsFlaggedDone = false;
+            }
+
+            float mSample = convert_sample(fBuffer[mCurrentIndex]);
+
+            /* interpolate */
+            if (fInterpolateSamples) {
+                // TODO evaluate direction?
+                const int32_t mNextIndex  = wrapIndex(mCurrentIndex + 1);
+                const float   mNextSample = convert_sample(fBuffer[mNextIndex]);
+                mSample                   = mSample * (1.0f - mFrac) + mNextSample * mFrac;
+                // mSample = interpolate_samples_linear(fBuffer, fBufferLength, fBufferIndex);
+                // mSample = interpolate_samples_cubic(fBuffer, fBufferLength, fBufferIndex);
+            }
+            mSample *= fAmplitude;
+
+            /* fade edges */
+            if (fEdgeFadePadding > 0) {
+                const int32_t mRelativeIndex = fBufferLength - mCurrentIndex;
+                if (mCurrentIndex < fEdgeFadePadding) {
+                    const float mFadeInAmount = static_cast<float>(mCurrentIndex) / fEdgeFadePadding;
+                    mSample *= mFadeInAmount;
+                } else if (mRelativeIndex < fEdgeFadePadding) {
+                    const float mFadeOutAmount = static_cast<float>(mRelativeIndex) / fEdgeFadePadding;
+                    mSample *= mFadeOutAmount;
+                }
+            }
+            return mSample;
+        }
+
         int32_t wrapIndex(int32_t i) const {
             /* check if in loop concept viable i.e loop in- and output points are set */
             if (fEvaluateLoop) {
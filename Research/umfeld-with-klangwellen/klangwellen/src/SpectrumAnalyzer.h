@@ -0,0 +1,284 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [x] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t)
+ * - [ ] void process(float*, float*, uint32_t)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "FFT.h"
+#include "KlangWellen.h"
+#include "TripleBuffer.h"
+
+namespace klangwellen {
+    /**
+     * analyzes the spectrum of a signal in the audio thread and passes it to another thread ( e.g `draw()` ). every
+     * `hop_size` samples the last `fft_size` samples are windowed and transformed, the magnitudes ( in dBFS, a sine with
+     * an amplitude of 1 peaks at 0dB ) are written per FFT bin and per logarithmically spaced band into a preallocated
+     * `Spectrum` of a `TripleBuffer`. `process()` neither allocates nor locks, `get_spectrum()` always returns the
+     * latest complete spectrum without copying it.
+     * <p>
+     * the signal passes unchanged. the setters are not thread safe, they are called before processing or from the
+     * audio thread.
+     */
+    class SpectrumAnalyzer {
+    public:
+        static constexpr uint8_t WINDOW_RECTANGULAR = 0;
+        static constexpr uint8_t WINDOW_HANN        = 1;
+        static constexpr uint8_t WINDOW_HAMMING     = 2;
+        static constexpr uint8_t WINDOW_BLACKMAN    = 3;
+        static constexpr float   MIN_DECIBEL        = -120.0f;
+
+        struct Spectrum {
+            Spectrum(const uint32_t num_bins, const uint32_t num_bands) : bins(num_bins, MIN_DECIBEL),
+                                                                          bands(num_bands, MIN_DECIBEL) {}
+            std::vector<float> bins;      /* dBFS per FFT bin, see `get_bin_frequency()` */
+            std::vector<float> bands;     /* dBFS per band ( the loudest bin of the band ), see `get_band_frequency()` */
+            uint64_t           frame = 0; /* number of samples analyzed up to the end of the window */
+        };
+
+        /**
+         * @param fft_size    number of samples per analysis, must be even
+         * @param hop_size    number of samples between two analyses, overlap is `fft_size - hop_size`
+         * @param num_bands   number of logarithmically spaced bands between `20Hz` and `20KHz` ( see `set_frequency_range()` )
+         * @param sample_rate the sample rate in Hz.
+         */
+        explicit SpectrumAnalyzer(const uint32_t fft_size    = 1024,
+                                  const uint32_t hop_size    = 256,
+                                  const uint32_t num_bands   = 32,
+                                  const uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE)
+            : fSampleRate(sample_rate),
+              fFFTSize(fft_size),
+              fHopSize(std::max(1u, std::min(hop_size, fft_size))),
+              fNumBands(num_bands),
+              fFFT(fft_size),
+              fSpectra(fFFT.get_num_bins(), num_bands) {
+            fInput.resize(fFFTSize, 0.0f);
+            fWindow.resize(fFFTSize, 1.0f);
+            fWindowed.resize(fFFTSize, 0.0f);
+            fBins.resize(fFFT.get_num_bins());
+            fBandFirst.resize(fNumBands, 0);
+            fBandLast.resize(fNumBands, 0);
+            fBandCenter.resize(fNumBands, 0.0f);
+            set_window(WINDOW_HANN);
+            set_frequency_range(20.0f, 20000.0f);
+        }
+
+        uint32_t get_fft_size() const {
+            return fFFTSize;
+        }
+
+        uint32_t get_hop_size() const {
+            return fHopSize;
+        }
+
+        uint32_t get_num_bins() const {
+            return fFFT.get_num_bins();
+        }
+
+        uint32_t get_num_bands() const {
+            return fNumBands;
+        }
+
+        /**
+         * @param window `WINDOW_RECTANGULAR`, `WINDOW_HANN`, `WINDOW_HAMMING` or `WINDOW_BLACKMAN`
+         */
+        void set_window(const uint8_t window) {
+            float mSum = 0.0f;
+            for (uint32_t i = 0; i < fFFTSize; i++) {
+                const float r = static_cast<float>(TWO_PI) * static_cast<float>(i) / static_cast<float>(fFFTSize);
+                switch (window) {
+                    case WINDOW_HANN:
+                        fWindow[i] = 0.5f - 0.5f * cosf(r);
+                        break;
+                    case WINDOW_HAMMING:
+                        fWindow[i] = 0.54f - 0.46f * cosf(r);
+                        break;
+                    case WINDOW_BLACKMAN:
+                        fWindow[i] = 0.42f - 0.5f * cosf(r) + 0.08f * cosf(2.0f * r);
+                        break;
+                    default:
+                        fWindow[i] = 1.0f;
+                }
+                mSum += fWindow[i];
+            }
+            fWindowType = window;
+            /* scales the power of a bin so that a sine with an amplitude of 1 peaks at 1 */
+            fPowerScale = 4.0f / (mSum * mSum);
+        }
+
+        uint8_t get_window() const {
+            return fWindowType;
+        }
+
+        /**
+         * sets the range of the bands, their edges are spaced logarithmically. bands narrower than a bin are
+         * interpolated between the two bins around their center frequency.
+         *
+         * @param min_frequency lower edge of the first band in Hz
+         * @param max_frequency upper edge of the last band in Hz ( clamped to the Nyquist frequency )
+         */
+        void set_frequency_range(const float min_frequency, const float max_frequency) {
+            const float mNyquist      = static_cast<float>(fSampleRate) * 0.5f;
+            const float mMinFrequency = std::max(min_frequency, static_cast<float>(fSampleRate) / static_cast<float>(fFFTSize));
+            const float mMaxFrequency = std::max(std::min(max_frequency, mNyquist), mMinFrequency);
+            const float mBinsPerHz    = static_cast<float>(fFFTSize) / static_cast<float>(fSampleRate);
+            const float mRatio        = fNumBands > 0 ? powf(mMaxFrequency / mMinFrequency, 1.0f / static_cast<float>(fNumBands)) : 1.0f;
+            float       mLower        = mMinFrequency;
+            for (uint32_t b = 0; b < fNumBands; b++) {
+                const float mUpper = mLower * mRatio;
+                fBandFirst[b]      = static_cast<uint32_t>(ceilf(mLower * mBinsPerHz));
+                fBandLast[b]       = std::min(static_cast<uint32_t>(ceilf(mUpper * mBinsPerHz)), get_num_bins());
+                fBandCenter[b]     = sqrtf(mLower * mUpper);
+                mLower             = mUpper;
+            }
+        }
+
+        /**
+         * @return center frequency of bin `index` in Hz
+         */
+        float get_bin_frequency(const uint32_t index) const {
+            return static_cast<float>(index) * static_cast<float>(fSampleRate) / static_cast<float>(fFFTSize);
+        }
+
+        /**
+         * @return center frequency of band `index` in Hz ( geometric mean of its edges )
+         */
+        float get_band_frequency(const uint32_t index) const {
+            return fBandCenter[index];
+        }
+
+        /**
+         * consumer thread ( e.g `draw()` ): the latest complete spectrum. the reference stays valid and the spectrum
+         * unchanged until the next call. before the first analysis all values are `MIN_DECIBEL`.
+         */
+        const Spectrum& get_spectrum() {
+            fSpectra.update();
+            return fSpectra.get_read_buffer();
+        }
+
+        float process(const float signal) {
+            fInput[fInputPosition] = signal;
+            fInputPosition         = fInputPosition + 1 == fFFTSize ? 0 : fInputPosition + 1;
+            fFrame++;
+            fHopCounter++;
+            if (fHopCounter == fHopSize) {
+                fHopCounter = 0;
+                analyze();
+            }
+            return signal;
+        }
+
+        void process(const float* signal, const uint32_t length) {
+            uint32_t mPosition = 0;
+            while (mPosition < length) {
+                const uint32_t mLength = std::min({length - mPosition, fHopSize - fHopCounter, fFFTSize - fInputPosition});
+                std::copy(signal + mPosition, signal + mPosition + mLength, fInput.begin() + fInputPosition);
+                mPosition += mLength;
+                fFrame += mLength;
+                fHopCounter += mLength;
+                fInputPosition += mLength;
+                if (fInputPosition == fFFTSize) {
+                    fInputPosition = 0;
+                }
+                if (fHopCounter == fHopSize) {
+                    fHopCounter = 0;
+                    analyze();
+                }
+            }
+        }
+
+    private:
+        const uint32_t                   fSampleRate;
+        const uint32_t                   fFFTSize;
+        const uint32_t                   fHopSize;
+        const uint32_t                   fNumBands;
+        FFT                              fFFT;
+        TripleBuffer<Spectrum>           fSpectra;
+        std::vector<float>               fInput; /* ring buffer, the oldest sample is at `fInputPosition` */
+        std::vector<float>               fWindow;
+        std::vector<float>               fWindowed;
+        std::vector<std::complex<float>> fBins;
+        std::vector<uint32_t>            fBandFirst; /* first bin of a band */
+        std::vector<uint32_t>            fBandLast;  /* bin after the last bin of a band */
+        std::vector<float>               fBandCenter;
+        uint8_t                          fWindowType    = WINDOW_HANN;
+        float                            fPowerScale    = 1.0f;
+        uint32_t                         fInputPosition = 0;
+        uint32_t                         fHopCounter    = 0;
+        uint64_t                         fFrame         = 0;
+
+        static float decibel(const float power) {
+            static constexpr float MIN_POWER = 1e-12f; /* `MIN_DECIBEL` */
+            return 10.0f * log10f(std::max(power, MIN_POWER));
+        }
+
+        void analyze() {
+            const uint32_t mOldest = fFFTSize - fInputPosition;
+            for (uint32_t i = 0; i < mOldest; i++) {
+                fWindowed[i] = fInput[fInputPosition + i] * fWindow[i];
+            }
+            for (uint32_t i = mOldest; i < fFFTSize; i++) {
+                fWindowed[i] = fInput[i - mOldest] * fWindow[i];
+            }
+            fFFT.forward(fWindowed.data(), fBins.data());
+
+            /* the bins of the write buffer hold the power until the bands are computed */
+            Spectrum&      mSpectrum = fSpectra.get_write_buffer();
+            float*         mPower    = mSpectrum.bins.data();
+            const uint32_t mNumBins  = get_num_bins();
+            for (uint32_t k = 0; k < mNumBins; k++) {
+                mPower[k] = std::norm(fBins[k]) * fPowerScale;
+            }
+
+            const float mBinsPerHz = static_cast<float>(fFFTSize) / static_cast<float>(fSampleRate);
+            for (uint32_t b = 0; b < fNumBands; b++) {
+                float mBandPower = 0.0f;
+                if (fBandFirst[b] < fBandLast[b]) {
+                    mBandPower = *std::max_element(mPower + fBandFirst[b], mPower + fBandLast[b]);
+                } else {
+                    const float    mBin      = fBandCenter[b] * mBinsPerHz;
+                    const uint32_t mLower    = std::min(static_cast<uint32_t>(mBin), mNumBins - 2);
+                    const float    mFraction = mBin - static_cast<float>(mLower);
+                    mBandPower               = mPower[mLower] + (mPower[mLower + 1] - mPower[mLower]) * mFraction;
+                }
+                mSpectrum.bands[b] = decibel(mBandPower);
+            }
+            for (uint32_t k = 0; k < mNumBins; k++) {
+                mPower[k] = decibel(mPower[k]);
+            }
+
+            mSpectrum.frame = fFrame;
+            fSpectra.publish();
+        }
+    };
+} // namespace klangwellen
@@ -23,14 +23,32 @@
  * - [x] float process()
  * - [ ] float process(float)
  * - [ ] void process(AudioSignal&)
- * - [*] void process(float*, uint32_t)
+ * - [x] void process(float*, uint32_t)
  * - [ ] void process(float*, float*, uint32_t)
  */
 
 #pragma once
 
+#ifndef KLANGWELLEN_STREAM_PREFETCH
+#define KLANGWELLEN_STREAM_PREFETCH 1
+#endif
+
+/* interval in which the I/O thread checks for segment refills requested by the audio thread */
+#ifndef KLANGWELLEN_STREAM_PREFETCH_POLL_US
+#define KLANGWELLEN_STREAM_PREFETCH_POLL_US 500
+#endif
+
 #include <stdint.h>
+#include <algorithm>
 #include <iostream>
+#include <limits>
+
+#if KLANGWELLEN_STREAM_PREFETCH
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#endif // KLANGWELLEN_STREAM_PREFETCH
 
 #include "KlangWellen.h"
 
@@ -44,6 +62,18 @@ namespace klangwellen {
         }
     };
 
+    /**
+     * statistics of the asynchronous prefetch ( see `Stream::enable_prefetch()` ).
+     */
+    struct StreamPrefetchStatistics {
+        uint32_t requests     = 0; /* segment refills queued to the I/O thread */
+        uint32_t underruns    = 0; /* segments that were not ready when the read position reached them ( played as silence ) */
+        uint32_t dropped      = 0; /* refills that could not be queued because the previous refill of the segment was still pending */
+        uint32_t late         = 0; /* refills that finished after their deadline */
+        float    max_fill_ms  = 0; /* longest `fill_buffer()` call */
+        float    min_slack_ms = 0; /* smallest time between a finished refill and its deadline ( negative if late, the request time is estimated by the I/O thread ) */
+    };
+
     class Stream final {
     public:
         Stream(StreamDataProvider* stream_data_provider,
@@ -64,9 +94,13 @@ namespace klangwellen {
               fBufferIndexPrev(0.0f),
               fCompleteEvent(NO_EVENT) {
             fStreamDataProvider->fill_buffer(fBuffer, fBufferLength);
+            fNextBorder = next_border(fBufferIndexPrev);
         }
 
         ~Stream() {
+#if KLANGWELLEN_STREAM_PREFETCH
+            enable_prefetch(false);
+#endif // KLANGWELLEN_STREAM_PREFETCH
             delete[] fBuffer;
         }
 
@@ -89,14 +123,9 @@ namespace klangwellen {
             }
             mSample *= fAmplitude;
 
-            /* load next block */
-            int8_t mCompleteEvent = checkCompleteEvent(fBufferDivision);
-            if (mCompleteEvent > NO_EVENT) {
-                fCompleteEvent = mCompleteEvent;
-                mCompleteEvent -= fBufferSegmentOffset;
-                mCompleteEvent += fBufferDivision;
-                mCompleteEvent %= fBufferDivision;
-                replace_segment(fBufferDivision, mCompleteEvent);
+            /* load next block ( segment borders only need to be checked once the read position passes the next one ) */
+            if (fBufferIndex < fBufferIndexPrev || fBufferIndex >= fNextBorder) {
+                update_segments();
             }
             fBufferIndexPrev = fBufferIndex;
 
@@ -136,8 +165,38 @@ namespace klangwellen {
         }
 
         void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint16_t i = 0; i < buffer_length; i++) {
-                signal_buffer[i] = process();
+#if KLANGWELLEN_STREAM_PREFETCH
+            if (begin_prefetch()) {
+                swap_in_ready_segments();
+                end_prefetch();
+            }
+#endif // KLANGWELLEN_STREAM_PREFETCH
+            const float mStepSize    = fStepSize;
+            const float mAmplitude   = fAmplitude;
+            const bool  mInterpolate = fInterpolateSamples;
+            float       mNextBorder  = fNextBorder;
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                fBufferIndex += mStepSize;
+                const int32_t mRoundedIndex = static_cast<int32_t>(fBufferIndex);
+                const float   mFrac         = fBufferIndex - mRoundedIndex;
+                const int32_t mCurrentIndex = wrapIndex(mRoundedIndex);
+                fBufferIndex                = mCurrentIndex + mFrac;
+
+                float mSample = convert_sample(fBuffer[mCurrentIndex]);
+                if (mInterpolate) {
+                    const int32_t mNextIndex  = wrapIndex(mCurrentIndex + 1);
+                    const float   mNextSample = convert_sample(fBuffer[mNextIndex]);
+                    const float   a           = mSample * (1.0f - mFrac);
+                    const float   b           = mNextSample * mFrac;
+                    mSample                   = a + b;
+                }
+                signal_buffer[i] = mSample * mAmplitude;
+
+                if (fBufferIndex < fBufferIndexPrev || fBufferIndex >= mNextBorder) {
+                    update_segments();
+                    mNextBorder = fNextBorder;
+                }
+                fBufferIndexPrev = fBufferIndex;
             }
         }
 
@@ -157,6 +216,77 @@ namespace klangwellen {
             fStepSize = speed;
         }
 
+#if KLANGWELLEN_STREAM_PREFETCH
+        /**
+         * enables the asynchronous prefetch. segment refills are then queued to a background I/O thread instead of
+         * calling `StreamDataProvider::fill_buffer()` from `process()`. the provider is called from the I/O thread and
+         * fills a staging buffer, the audio thread swaps finished segments into the stream buffer without locking. a
+         * refill is due ( its deadline ) when the read position reaches the segment, which leaves
+         * `num_sectors() - stream_buffer_update_offset` segments of time to load it. a segment that is not ready in time
+         * is played as silence and counted as underrun ( see `get_prefetch_statistics()` ).
+         *
+         * enabling and disabling starts and joins the I/O thread, so it should not be called from the audio thread. it
+         * may be called from one control thread while `process()` runs: the audio thread switches to the prefetch at the
+         * next segment border, disabling waits until the audio thread no longer uses the prefetch state before it is
+         * released. `StreamDataProvider::fill_buffer()` is never called from the audio thread and the I/O thread at the
+         * same time.
+         *
+         * @param prefetch enable or disable the asynchronous prefetch
+         */
+        void enable_prefetch(const bool prefetch) {
+            if (prefetch == fPrefetch.load()) {
+                return;
+            }
+            if (prefetch) {
+                const uint32_t mSegmentLength = fBufferLength / fBufferDivision;
+                fPrefetchBuffer.reset(new float[fBufferDivision * mSegmentLength]);
+                fSegments.reset(new Segment[fBufferDivision]);
+                fRequestQueue.reset(new uint8_t[fBufferDivision]);
+                fRequestWrite.store(0);
+                fRequestRead.store(0);
+                fPrefetchRun.store(true);
+                fPrefetchThread = std::thread(&Stream::prefetch_thread, this);
+                /* publishes the prefetch state to the audio thread */
+                fPrefetch.store(true);
+            } else {
+                /* stop the I/O thread first, so that the provider is never called from both threads */
+                fPrefetchRun.store(false);
+                fPrefetchThread.join();
+                fPrefetch.store(false);
+                while (fPrefetchBusy.load()) {
+                    std::this_thread::yield();
+                }
+                fPrefetchBuffer.reset();
+                fSegments.reset();
+                fRequestQueue.reset();
+            }
+        }
+
+        bool is_prefetching() const {
+            return fPrefetch.load();
+        }
+
+        StreamPrefetchStatistics get_prefetch_statistics() const {
+            StreamPrefetchStatistics mStatistics;
+            mStatistics.requests     = fStatisticsRequests.load(std::memory_order_relaxed);
+            mStatistics.underruns    = fStatisticsUnderruns.load(std::memory_order_relaxed);
+            mStatistics.dropped      = fStatisticsDropped.load(std::memory_order_relaxed);
+            mStatistics.late         = fStatisticsLate.load(std::memory_order_relaxed);
+            mStatistics.max_fill_ms  = fStatisticsMaxFill.load(std::memory_order_relaxed);
+            mStatistics.min_slack_ms = fStatisticsMinSlack.load(std::memory_order_relaxed);
+            return mStatistics;
+        }
+
+        void reset_prefetch_statistics() {
+            fStatisticsRequests  = 0;
+            fStatisticsUnderruns = 0;
+            fStatisticsDropped   = 0;
+            fStatisticsLate      = 0;
+            fStatisticsMaxFill   = 0.0f;
+            fStatisticsMinSlack  = std::numeric_limits<float>::max();
+        }
+#endif // KLANGWELLEN_STREAM_PREFETCH
+
     private:
         static constexpr int8_t NO_EVENT = -1;
 
@@ -172,12 +302,182 @@ namespace klangwellen {
         bool          fInterpolateSamples;
         float         fBufferIndex;
         float         fBufferIndexPrev;
+        float         fNextBorder;
         int8_t        fCompleteEvent;
 
+#if KLANGWELLEN_STREAM_PREFETCH
+        using Clock = std::chrono::steady_clock;
+
+        enum : uint8_t {
+            SEGMENT_IDLE,      /* stream buffer holds the current data of the segment */
+            SEGMENT_REQUESTED, /* refill is queued or being filled by the I/O thread */
+            SEGMENT_READY      /* refill is in the staging buffer and can be swapped in */
+        };
+
+        struct Segment {
+            std::atomic<uint8_t> state{SEGMENT_IDLE};
+            double               seconds_ahead = 0.0;   /* time until the read position reaches the segment */
+            bool                 discard       = false; /* refill missed its deadline ( only accessed by the audio thread ) */
+        };
+
+        std::unique_ptr<float[]>   fPrefetchBuffer; /* staging buffer with one slot per segment */
+        std::unique_ptr<Segment[]> fSegments;
+        std::unique_ptr<uint8_t[]> fRequestQueue; /* single-producer single-consumer ring of segment indices */
+        std::atomic<uint32_t>      fRequestWrite{0};
+        std::atomic<uint32_t>      fRequestRead{0};
+        std::thread                fPrefetchThread;
+        std::atomic<bool>          fPrefetchRun{false};
+        std::atomic<bool>          fPrefetch{false};
+        std::atomic<bool>          fPrefetchBusy{false}; /* audio thread uses the prefetch state */
+        std::atomic<uint32_t>      fStatisticsRequests{0};
+        std::atomic<uint32_t>      fStatisticsUnderruns{0};
+        std::atomic<uint32_t>      fStatisticsDropped{0};
+        std::atomic<uint32_t>      fStatisticsLate{0};
+        std::atomic<float>         fStatisticsMaxFill{0.0f};
+        std::atomic<float>         fStatisticsMinSlack{std::numeric_limits<float>::max()};
+
+        /* audio thread: returns true if the prefetch is enabled, `end_prefetch()` must then be called when done */
+        bool begin_prefetch() {
+            fPrefetchBusy.store(true);
+            if (fPrefetch.load()) {
+                return true;
+            }
+            fPrefetchBusy.store(false, std::memory_order_release);
+            return false;
+        }
+
+        void end_prefetch() {
+            fPrefetchBusy.store(false, std::memory_order_release);
+        }
+
+        uint8_t current_segment() const {
+            return fCompleteEvent == NO_EVENT ? 0 : fCompleteEvent;
+        }
+
+        float* segment_data(float* buffer, const uint8_t segment) const {
+            return buffer + segment * (fBufferLength / fBufferDivision);
+        }
+
+        /* audio thread: copies finished refills into the stream buffer ( except into the segment being played ) */
+        void swap_in_ready_segments() {
+            for (uint8_t i = 0; i < fBufferDivision; ++i) {
+                if (i != current_segment()) {
+                    swap_in_segment(i);
+                }
+            }
+        }
+
+        void swap_in_segment(const uint8_t segment) {
+            Segment& mSegment = fSegments[segment];
+            if (mSegment.state.load(std::memory_order_acquire) != SEGMENT_READY) {
+                return;
+            }
+            if (!mSegment.discard) {
+                const uint32_t mSegmentLength = fBufferLength / fBufferDivision;
+                std::copy_n(segment_data(fPrefetchBuffer.get(), segment), mSegmentLength, segment_data(fBuffer, segment));
+            }
+            mSegment.discard = false;
+            mSegment.state.store(SEGMENT_IDLE, std::memory_order_release);
+        }
+
+        /* audio thread: the read position entered `segment` */
+        void enter_segment(const uint8_t segment) {
+            swap_in_segment(segment);
+            Segment& mSegment = fSegments[segment];
+            if (mSegment.state.load(std::memory_order_acquire) == SEGMENT_REQUESTED && !mSegment.discard) {
+                fStatisticsUnderruns.fetch_add(1, std::memory_order_relaxed);
+                mSegment.discard = true;
+                std::fill_n(segment_data(fBuffer, segment), fBufferLength / fBufferDivision, 0.0f);
+            }
+        }
+
+        /* audio thread: queues the refill of `segment` */
+        void request_segment(const uint8_t segment) {
+            Segment& mSegment = fSegments[segment];
+            if (mSegment.state.load(std::memory_order_acquire) != SEGMENT_IDLE) {
+                fStatisticsDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            const uint8_t mSegmentsAhead = (segment + fBufferDivision - current_segment()) % fBufferDivision;
+            const float   mSpeed         = KlangWellen::abs(fStepSize) * fSampleRate;
+            mSegment.seconds_ahead       = mSpeed > 0.0f ? mSegmentsAhead * (fBufferLength / fBufferDivision) / mSpeed : 3600.0;
+            mSegment.state.store(SEGMENT_REQUESTED, std::memory_order_relaxed);
+
+            /* the I/O thread polls the queue, so the audio thread neither reads the clock nor signals */
+            const uint32_t mWrite                   = fRequestWrite.load(std::memory_order_relaxed);
+            fRequestQueue[mWrite % fBufferDivision] = segment;
+            fRequestWrite.store(mWrite + 1, std::memory_order_release);
+            fStatisticsRequests.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /* I/O thread */
+        void prefetch_thread() {
+            const uint32_t mSegmentLength = fBufferLength / fBufferDivision;
+            const auto     mPollInterval  = std::chrono::microseconds(KLANGWELLEN_STREAM_PREFETCH_POLL_US);
+            while (fPrefetchRun.load(std::memory_order_acquire)) {
+                /* requests are not timestamped by the audio thread. a request seen now was queued at most one poll
+                 * interval ( or one refill, if the I/O thread was busy ) ago */
+                const uint32_t          mWrite = fRequestWrite.load(std::memory_order_acquire);
+                const Clock::time_point mSeen  = Clock::now() - mPollInterval;
+                if (fRequestRead.load(std::memory_order_relaxed) == mWrite) {
+                    std::this_thread::sleep_for(mPollInterval);
+                    continue;
+                }
+                while (fRequestRead.load(std::memory_order_relaxed) != mWrite) {
+                    const uint32_t mRead    = fRequestRead.load(std::memory_order_relaxed);
+                    const uint8_t  mIndex   = fRequestQueue[mRead % fBufferDivision];
+                    Segment&       mSegment = fSegments[mIndex];
+                    fRequestRead.store(mRead + 1, std::memory_order_release);
+
+                    const Clock::time_point mDeadline = mSeen + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(mSegment.seconds_ahead));
+                    const Clock::time_point mStart    = Clock::now();
+                    fStreamDataProvider->fill_buffer(segment_data(fPrefetchBuffer.get(), mIndex), mSegmentLength);
+                    const Clock::time_point mDone = Clock::now();
+
+                    const float mFillMs  = std::chrono::duration<float, std::milli>(mDone - mStart).count();
+                    const float mSlackMs = std::chrono::duration<float, std::milli>(mDeadline - mDone).count();
+                    if (mFillMs > fStatisticsMaxFill.load(std::memory_order_relaxed)) {
+                        fStatisticsMaxFill.store(mFillMs, std::memory_order_relaxed);
+                    }
+                    if (mSlackMs < fStatisticsMinSlack.load(std::memory_order_relaxed)) {
+                        fStatisticsMinSlack.store(mSlackMs, std::memory_order_relaxed);
+                    }
+                    if (mSlackMs < 0.0f) {
+                        fStatisticsLate.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    mSegment.state.store(SEGMENT_READY, std::memory_order_release);
+                }
+            }
+        }
+#endif // KLANGWELLEN_STREAM_PREFETCH
+
+        void update_segments() {
+            int8_t mCompleteEvent = checkCompleteEvent(fBufferDivision);
+            if (mCompleteEvent > NO_EVENT) {
+                fCompleteEvent = mCompleteEvent;
+                mCompleteEvent -= fBufferSegmentOffset;
+                mCompleteEvent += fBufferDivision;
+                mCompleteEvent %= fBufferDivision;
+#if KLANGWELLEN_STREAM_PREFETCH
+                if (begin_prefetch()) {
+                    enter_segment(fCompleteEvent);
+                    swap_in_ready_segments();
+                    request_segment(mCompleteEvent);
+                    end_prefetch();
+                } else {
+                    replace_segment(fBufferDivision, mCompleteEvent);
+                }
+#else
+                replace_segment(fBufferDivision, mCompleteEvent);
+#endif // KLANGWELLEN_STREAM_PREFETCH
+            }
+            fNextBorder = next_border(fBufferIndex);
+        }
+
         int32_t wrapIndex(int32_t i) const {
             if (i < 0) {
                 i += fBufferLength;
-            } else if (i >= fBufferLength) {
+            } else if (i >= static_cast<int32_t>(fBufferLength)) {
                 i -= fBufferLength;
             }
             return i;
@@ -197,6 +497,17 @@ namespace klangwellen {
             return NO_EVENT;
         }
 
+        /* smallest segment border above `position` */
+        float next_border(const float position) const {
+            for (int i = 0; i < fBufferDivision; ++i) {
+                const float mBorder = fBufferLength * i / static_cast<float>(fBufferDivision);
+                if (mBorder > position) {
+                    return mBorder;
+                }
+            }
+            return std::numeric_limits<float>::max();
+        }
+
         static bool crossedBorder(const float prev, const float current, const float border) {
             return (border == 0 && prev > current) ||
                    (prev < border && current >= border) ||
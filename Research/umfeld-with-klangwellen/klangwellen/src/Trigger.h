@@ -33,12 +33,17 @@
 
 #include <vector>
 
+#include "EventQueue.h"
 #include "KlangWellen.h"
 
 /**
  * generates an event from an oscillating input signal.
  */
 namespace klangwellen {
+    /**
+     * called from inside `process()` ( i.e the audio thread ), see `Trigger::set_event_queue()` to handle events
+     * elsewhere.
+     */
     class TriggerListener {
     public:
         virtual void trigger(uint8_t event) = 0;
@@ -65,6 +70,25 @@ namespace klangwellen {
             return false;
         }
 
+        /**
+         * pushes every event into `queue` ( in addition to calling the listeners and the callback ), so that events can
+         * be handled at the end of the block or in `draw()` with their sample position ( see `EventQueue` ).
+         *
+         * @param queue  queue or `nullptr` to stop pushing events
+         * @param source id of the trigger in the events
+         */
+        void set_event_queue(EventQueue* queue, const uint8_t source = 0) {
+            fEventQueue  = queue;
+            fEventSource = source;
+        }
+
+        /**
+         * @return number of samples processed so far
+         */
+        uint64_t get_frame() const {
+            return fFrame;
+        }
+
         void trigger_rising_edge(bool enable_trigger_rising_edge) {
             fEnableRisingEdge = enable_trigger_rising_edge;
         }
@@ -81,6 +105,7 @@ namespace klangwellen {
                 fireEvent(EVENT_FALLING_EDGE);
             }
             fPreviousSignal = signal;
+            fFrame++;
             return signal;
         }
 
@@ -108,6 +133,9 @@ namespace klangwellen {
         bool                          fEnableFallingEdge;
         bool                          fEnableRisingEdge;
         std::vector<TriggerListener*> fListeners;
+        EventQueue*                   fEventQueue  = nullptr;
+        uint8_t                       fEventSource = 0;
+        uint64_t                      fFrame       = 0;
 
         void call_trigger(const uint8_t event) {
             if (fCallbackEvent) {
@@ -120,6 +148,9 @@ namespace klangwellen {
                 l->trigger(event);
             }
             call_trigger(event);
+            if (fEventQueue != nullptr) {
+                fEventQueue->push(fFrame, event, 0, fEventSource);
+            }
         }
     };
 } // namespace klangwellen
@@ -0,0 +1,97 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+namespace klangwellen {
+    /**
+     * passes the latest complete frame ( e.g a spectrum ) from exactly one producer thread to exactly one consumer
+     * thread. the producer writes into its own buffer and publishes it, the consumer always reads the latest published
+     * frame. neither side locks, allocates or copies frames, and neither side waits for the other: frames the consumer
+     * misses are overwritten.
+     *
+     * ```
+     * // producer ( audio thread )
+     * Frame& mFrame = fFrames.get_write_buffer();
+     * // ... write the complete frame
+     * fFrames.publish();
+     *
+     * // consumer ( e.g `draw()` )
+     * fFrames.update();
+     * const Frame& mFrame = fFrames.get_read_buffer(); // unchanged until the next `update()`
+     * ```
+     *
+     * @tparam T frame type, the three frames are constructed with the arguments of the constructor
+     */
+    template<typename T>
+    class TripleBuffer {
+    public:
+        template<typename... ARGS>
+        explicit TripleBuffer(const ARGS&... args) : fBuffers{T(args...), T(args...), T(args...)} {}
+
+        TripleBuffer(const TripleBuffer&)            = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        /**
+         * producer thread: the frame to write into. its content is that of an older frame.
+         */
+        T& get_write_buffer() {
+            return fBuffers[fWrite];
+        }
+
+        /**
+         * producer thread: publishes the write buffer as the latest frame and takes over a free buffer.
+         */
+        void publish() {
+            fWrite = fMiddle.exchange(fWrite | NEW_FRAME, std::memory_order_acq_rel) & INDEX;
+        }
+
+        /**
+         * consumer thread: takes over the latest frame if one was published since the last call.
+         *
+         * @return true if the read buffer changed
+         */
+        bool update() {
+            if ((fMiddle.load(std::memory_order_relaxed) & NEW_FRAME) == 0) {
+                return false;
+            }
+            fRead = fMiddle.exchange(fRead, std::memory_order_acq_rel) & INDEX;
+            return true;
+        }
+
+        /**
+         * consumer thread: the latest frame at the time of the last `update()`
+         */
+        const T& get_read_buffer() const {
+            return fBuffers[fRead];
+        }
+
+    private:
+        static constexpr uint8_t INDEX     = 0b011;
+        static constexpr uint8_t NEW_FRAME = 0b100;
+
+        T                                fBuffers[3];
+        alignas(64) std::atomic<uint8_t> fMiddle{1}; /* index of the buffer between producer and consumer */
+        alignas(64) uint8_t              fWrite = 0; /* producer only */
+        alignas(64) uint8_t              fRead  = 2; /* consumer only */
+    };
+} // namespace klangwellen
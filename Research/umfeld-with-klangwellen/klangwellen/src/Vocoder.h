@@ -27,12 +27,14 @@
  * - [ ] void process(float*, float*, uint32_t)
  * - [x] float process(float, float)
  * - [x] void process(float*, float*, float*, uint32_t)
+ * - [x] void process(float*, float*, float*, float*, float*, uint32_t)
  *
  */
 
 #pragma once
 
 #include <stdint.h>
+#include <algorithm>
 
 #include "KlangWellen.h"
 
@@ -128,9 +130,10 @@ namespace klangwellen {
          */
         Vocoder(uint8_t  pBands          = 24,
                 uint8_t  pFiltersPerBand = 4,
-                uint32_t pSampleRate     = KlangWellen::DEFAULT_SAMPLE_RATE) : fBands(pBands),
-                                                                           fFiltersPerBand(pFiltersPerBand),
-                                                                           fSampleRate(pSampleRate) {
+                uint32_t pSampleRate     = KlangWellen::DEFAULT_SAMPLE_RATE) : fSampleRate(pSampleRate),
+                                                                           fBands(KlangWellen::clamp(pBands, (uint8_t) 1, VOCLIB_MAX_BANDS)),
+                                                                           fBandsPadded((fBands + VOCLIB_SIMD_LANES - 1) / VOCLIB_SIMD_LANES * VOCLIB_SIMD_LANES),
+                                                                           fFiltersPerBand(KlangWellen::clamp(pFiltersPerBand, (uint8_t) 1, VOCLIB_MAX_FILTERS_PER_BAND)) {
             // if (pBands < 4 || pBands > VOCLIB_MAX_BANDS) {
             //     // System.out.println("ERROR @" + Vocoder.class.getSimpleName() + " / bands: " + pBands);
             // }
@@ -178,22 +181,19 @@ namespace klangwellen {
                      float*         output_buffer,
                      const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
             /* Both the carrier and the modulator have a single channel. */
+            alignas(VOCLIB_SIMD_ALIGNMENT) float analysis_bands[VOCLIB_MAX_BANDS];
+            alignas(VOCLIB_SIMD_ALIGNMENT) float synthesis_bands[VOCLIB_MAX_BANDS];
             for (uint32_t i = 0; i < frames; ++i) {
-                float out = 0.0f;
-
-                /* Run the bands in parallel and accumulate the output. */
-                for (uint8_t j = 0; j < fBands; ++j) {
-                    float analysis_band  = BiQuad(modulator_buffer[i], fAnalysisBands[j].filters[0]);
-                    float synthesis_band = BiQuad(carrier_buffer[i], fSynthesisBands[j].filters[0]);
-
-                    for (uint8_t k = 1; k < fFiltersPerBand; ++k) {
-                        analysis_band  = BiQuad(analysis_band, fAnalysisBands[j].filters[k]);
-                        synthesis_band = BiQuad(synthesis_band, fSynthesisBands[j].filters[k]);
-                    }
-                    analysis_band = envelope_tick(fAnalysisEnvelopes[j], analysis_band);
-                    out += synthesis_band * analysis_band;
+                std::fill_n(analysis_bands, fBandsPadded, modulator_buffer[i]);
+                std::fill_n(synthesis_bands, fBandsPadded, carrier_buffer[i]);
+
+                /* Run the bands in parallel ( one band per vector lane ) and accumulate the output. */
+                for (uint8_t k = 0; k < fFiltersPerBand; ++k) {
+                    BiQuad_bands(fAnalysisBands, k, analysis_bands);
+                    BiQuad_bands(fSynthesisBands[0], k, synthesis_bands);
                 }
-                output_buffer[i] = out * fRectifyVolume;
+                envelope_tick_bands(analysis_bands);
+                output_buffer[i] = mix_bands(synthesis_bands, analysis_bands) * fRectifyVolume;
             }
         }
 
@@ -202,29 +202,25 @@ namespace klangwellen {
                      float*         modulator_buffer,
                      float*         output_buffer_left,
                      float*         output_buffer_right,
-                     const uint32_t frames = KlangWellen::DEFAULT_SAMPLE_RATE) {
+                     const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
             /* The carrier has two channels and the modulator has 1. */
+            alignas(VOCLIB_SIMD_ALIGNMENT) float analysis_bands[VOCLIB_MAX_BANDS];
+            alignas(VOCLIB_SIMD_ALIGNMENT) float synthesis_bands_left[VOCLIB_MAX_BANDS];
+            alignas(VOCLIB_SIMD_ALIGNMENT) float synthesis_bands_right[VOCLIB_MAX_BANDS];
             for (uint32_t i = 0; i < frames; i++) {
-                float out_left  = 0.0f;
-                float out_right = 0.0f;
-
-                /* Run the bands in parallel and accumulate the output. */
-                for (uint8_t j = 0; j < fBands; ++j) {
-                    float analysis_band        = BiQuad(modulator_buffer[j], fAnalysisBands[j].filters[0]);
-                    float synthesis_band_left  = BiQuad(carrier_buffer_left[i], fSynthesisBands[j].filters[0]);
-                    float synthesis_band_right = BiQuad(carrier_buffer_right[i], fSynthesisBands[j + VOCLIB_MAX_BANDS].filters[0]);
-
-                    for (uint8_t k = 1; k < fFiltersPerBand; ++k) {
-                        analysis_band        = BiQuad(analysis_band, fAnalysisBands[j].filters[k]);
-                        synthesis_band_left  = BiQuad(synthesis_band_left, fSynthesisBands[j].filters[k]);
-                        synthesis_band_right = BiQuad(synthesis_band_right, fSynthesisBands[j + VOCLIB_MAX_BANDS].filters[k]);
-                    }
-                    analysis_band = envelope_tick(fAnalysisEnvelopes[j], analysis_band);
-                    out_left += synthesis_band_left * analysis_band;
-                    out_right += synthesis_band_right * analysis_band;
+                std::fill_n(analysis_bands, fBandsPadded, modulator_buffer[i]);
+                std::fill_n(synthesis_bands_left, fBandsPadded, carrier_buffer_left[i]);
+                std::fill_n(synthesis_bands_right, fBandsPadded, carrier_buffer_right[i]);
+
+                /* Run the bands in parallel ( one band per vector lane ) and accumulate the output. */
+                for (uint8_t k = 0; k < fFiltersPerBand; ++k) {
+                    BiQuad_bands(fAnalysisBands, k, analysis_bands);
+                    BiQuad_bands(fSynthesisBands[0], k, synthesis_bands_left);
+                    BiQuad_bands(fSynthesisBands[1], k, synthesis_bands_right);
                 }
-                output_buffer_left[i]  = out_left * fRectifyVolume;
-                output_buffer_right[i] = out_right * fRectifyVolume;
+                envelope_tick_bands(analysis_bands);
+                output_buffer_left[i]  = mix_bands(synthesis_bands_left, analysis_bands) * fRectifyVolume;
+                output_buffer_right[i] = mix_bands(synthesis_bands_right, analysis_bands) * fRectifyVolume;
             }
         }
 
@@ -254,13 +250,10 @@ namespace klangwellen {
          * Resetting the history in the middle of a stream will cause clicks.
          */
         void reset_history() {
-            for (uint8_t i = 0; i < fBands; ++i) {
-                for (uint8_t j = 0; j < fFiltersPerBand; ++j) {
-                    BiQuad_reset(fAnalysisBands[i].filters[j]);
-                    BiQuad_reset(fSynthesisBands[i].filters[j]);
-                }
-                envelope_reset(fAnalysisEnvelopes[i]);
-            }
+            BiQuad_reset(fAnalysisBands);
+            BiQuad_reset(fSynthesisBands[0]);
+            BiQuad_reset(fSynthesisBands[1]);
+            envelope_reset();
         }
 
         /* Set the reaction time of the vocoder in seconds.
@@ -306,88 +299,104 @@ namespace klangwellen {
          * The maximum number of filters per vocoder band (lower this number to save memory).
          */
         static const uint8_t VOCLIB_MAX_FILTERS_PER_BAND = 8;
-
-    public:
         /**
-         * this holds the data required to update samples thru a filter.
+         * The maximum number of bands that the vocoder can be initialized with (lower this number to save memory).
          */
-        struct biquad {
-            float a0, a1, a2, a3, a4 = 0;
-            float x1, x2, y1, y2 = 0;
-        };
+        static const uint8_t VOCLIB_MAX_BANDS = 96;
+        /**
+         * Bands are processed as vector lanes. The number of bands is padded to a multiple of this value ( 16 lanes
+         * cover SSE, NEON, AVX and AVX-512 ) so that the band loops have no scalar remainder. Padding bands have
+         * zero coefficients and are not mixed into the output.
+         */
+        static const uint8_t VOCLIB_SIMD_LANES     = 16;
+        static const uint8_t VOCLIB_SIMD_ALIGNMENT = 64;
 
+    public:
         /**
-         * Stores the state required for our envelope follower.
+         * The filters of all bands in structure-of-arrays layout: one array entry per band, so that a filter of every
+         * band can be computed with vector instructions. All filters of one band share the same coefficients.
          */
-        struct envelope {
-            float coef       = 0;
-            float history[4] = {0};
+        struct filterbank {
+            alignas(VOCLIB_SIMD_ALIGNMENT) float a0[VOCLIB_MAX_BANDS] = {0};
+            alignas(VOCLIB_SIMD_ALIGNMENT) float a1[VOCLIB_MAX_BANDS] = {0};
+            alignas(VOCLIB_SIMD_ALIGNMENT) float a2[VOCLIB_MAX_BANDS] = {0};
+            alignas(VOCLIB_SIMD_ALIGNMENT) float a3[VOCLIB_MAX_BANDS] = {0};
+            alignas(VOCLIB_SIMD_ALIGNMENT) float a4[VOCLIB_MAX_BANDS] = {0};
+            alignas(VOCLIB_SIMD_ALIGNMENT) float x1[VOCLIB_MAX_FILTERS_PER_BAND][VOCLIB_MAX_BANDS];
+            alignas(VOCLIB_SIMD_ALIGNMENT) float x2[VOCLIB_MAX_FILTERS_PER_BAND][VOCLIB_MAX_BANDS];
+            alignas(VOCLIB_SIMD_ALIGNMENT) float y1[VOCLIB_MAX_FILTERS_PER_BAND][VOCLIB_MAX_BANDS];
+            alignas(VOCLIB_SIMD_ALIGNMENT) float y2[VOCLIB_MAX_FILTERS_PER_BAND][VOCLIB_MAX_BANDS];
         };
 
         /**
-         * Holds a set of filters required for one vocoder band.
+         * Stores the state required for our envelope followers ( one per band ).
          */
-        struct band {
-        public:
-            biquad filters[VOCLIB_MAX_FILTERS_PER_BAND];
-            // band() {
-            //     for (uint8_t i = 0; i < VOCLIB_MAX_FILTERS_PER_BAND; i++) {
-            //         filters[i] = new biquad();
-            //     }
-            // }
+        struct envelopes {
+            float                                coef = 0;
+            alignas(VOCLIB_SIMD_ALIGNMENT) float history[4][VOCLIB_MAX_BANDS];
         };
 
     private:
         /* filter types. */
-        static const uint8_t   VOCLIB_LPF       = 0;                      /* low pass filter */
-        static const uint8_t   VOCLIB_HPF       = 1;                      /* High pass filter */
-        static const uint8_t   VOCLIB_BPF       = 2;                      /* band pass filter */
-        static const uint8_t   VOCLIB_NOTCH     = 3;                      /* Notch Filter */
-        static const uint8_t   VOCLIB_PEQ       = 4;                      /* Peaking band EQ filter */
-        static const uint8_t   VOCLIB_LSH       = 5;                      /* Low shelf filter */
-        static const uint8_t   VOCLIB_HSH       = 6;                      /* High shelf filter */
-        static const uint8_t   VOCLIB_MAX_BANDS = 96;                     /* The maximum number of bands that the vocoder can be initialized with (lower this number to save memory). */
-        static constexpr float VOCLIB_M_LN2     = 0.69314718055994530942; /**/
-        static constexpr float VOCLIB_M_PI      = 3.14159265358979323846; /**/
-        const uint32_t         fSampleRate;                               /* in Hz */
-        band                   fAnalysisBands[VOCLIB_MAX_BANDS];          /* The filterbank used for analysis (these are applied to the modulator). */
-        const uint8_t          fBands;                                    /**/
-        const uint8_t          fFiltersPerBand;                           /**/
-        envelope               fAnalysisEnvelopes[VOCLIB_MAX_BANDS];      /* The envelopes used to smooth the analysis bands. */
-        float                  fFormantShift;                             /* In octaves. 1.0 is unchanged. */
-        float                  fReactionTime;                             /* In seconds. Higher values make the vocoder respond more slowly to changes in the modulator. */
-        band                   fSynthesisBands[VOCLIB_MAX_BANDS * 2];     /* The filterbank used for synthesis (these are applied to the carrier). The second half of the array is only used for stereo carriers. */
-        float                  fRectifyVolume;                            /**/
-
-        /* Computes a BiQuad filter on a sample. */
-        float BiQuad(float sample, biquad& b) {
-            /* compute the result. */
-            const float r0     = b.a0 * sample;
-            const float r1     = b.a1 * b.x1;
-            const float r2     = b.a2 * b.x2;
-            const float r3     = b.a3 * b.y1;
-            const float r4     = b.a4 * b.y2;
-            const float r5     = r0 + r1;
-            const float r6     = r2 - r3 - r4;
-            const float result = r5 + r6;
-
-            /* shift x1 to x2, sample to x1. */
-            b.x2 = b.x1;
-            b.x1 = sample;
-
-            /* shift y1 to y2, result to y1. */
-            b.y2 = b.y1;
-            b.y1 = result;
-
-            return result;
+        static const uint8_t   VOCLIB_LPF   = 0;                      /* low pass filter */
+        static const uint8_t   VOCLIB_HPF   = 1;                      /* High pass filter */
+        static const uint8_t   VOCLIB_BPF   = 2;                      /* band pass filter */
+        static const uint8_t   VOCLIB_NOTCH = 3;                      /* Notch Filter */
+        static const uint8_t   VOCLIB_PEQ   = 4;                      /* Peaking band EQ filter */
+        static const uint8_t   VOCLIB_LSH   = 5;                      /* Low shelf filter */
+        static const uint8_t   VOCLIB_HSH   = 6;                      /* High shelf filter */
+        static constexpr float VOCLIB_M_LN2 = 0.69314718055994530942; /**/
+        static constexpr float VOCLIB_M_PI  = 3.14159265358979323846; /**/
+        const uint32_t         fSampleRate;                           /* in Hz */
+        filterbank             fAnalysisBands;                        /* The filterbank used for analysis (these are applied to the modulator). */
+        const uint8_t          fBands;                                /**/
+        const uint8_t          fBandsPadded;                          /* fBands rounded up to a multiple of VOCLIB_SIMD_LANES */
+        const uint8_t          fFiltersPerBand;                       /**/
+        envelopes              fAnalysisEnvelopes;                    /* The envelopes used to smooth the analysis bands. */
+        float                  fFormantShift;                         /* In octaves. 1.0 is unchanged. */
+        float                  fReactionTime;                         /* In seconds. Higher values make the vocoder respond more slowly to changes in the modulator. */
+        filterbank             fSynthesisBands[2];                    /* The filterbanks used for synthesis (these are applied to the carrier). The second filterbank is only used for stereo carriers. */
+        float                  fRectifyVolume;                        /**/
+
+        /* Computes filter `filter` of every band on `signal`, which holds one sample per band. */
+        void BiQuad_bands(filterbank& b, const uint8_t filter, float* signal) {
+            for (uint8_t j = 0; j < fBandsPadded; ++j) {
+                /* compute the result. */
+                const float sample = signal[j];
+                const float r0     = b.a0[j] * sample;
+                const float r1     = b.a1[j] * b.x1[filter][j];
+                const float r2     = b.a2[j] * b.x2[filter][j];
+                const float r3     = b.a3[j] * b.y1[filter][j];
+                const float r4     = b.a4[j] * b.y2[filter][j];
+                const float r5     = r0 + r1;
+                const float r6     = r2 - r3 - r4;
+                const float result = r5 + r6;
+
+                /* shift x1 to x2, sample to x1. */
+                b.x2[filter][j] = b.x1[filter][j];
+                b.x1[filter][j] = sample;
+
+                /* shift y1 to y2, result to y1. */
+                b.y2[filter][j] = b.y1[filter][j];
+                b.y1[filter][j] = result;
+
+                signal[j] = result;
+            }
         }
 
-        /* Envelope follower. */
+        /* Sums up the synthesis bands weighted by the analysis bands ( in band order ). */
+        float mix_bands(const float* synthesis_bands, const float* analysis_bands) const {
+            float out = 0.0f;
+            for (uint8_t j = 0; j < fBands; ++j) {
+                out += synthesis_bands[j] * analysis_bands[j];
+            }
+            return out;
+        }
 
         /* sets up a BiQuad Filter. */
-        void BiQuad_new(biquad& b, uint8_t type, float dbGain, /* gain of filter */
-                        float freq,                            /* center frequency */
-                        float srate,                           /* sampling rate */
+        void BiQuad_new(filterbank& f, uint8_t band, uint8_t type, float dbGain, /* gain of filter */
+                        float freq,                                              /* center frequency */
+                        float srate,                                             /* sampling rate */
                         float bandwidth) /* bandwidth in octaves */ {
             float A, omega, sn, cs, alpha, beta;
             float a0, a1, a2, b0, b1, b2;
@@ -469,57 +478,68 @@ namespace klangwellen {
             }
 
             /* precompute the coefficients. */
-            b.a0 = b0 / a0;
-            b.a1 = b1 / a0;
-            b.a2 = b2 / a0;
-            b.a3 = a1 / a0;
-            b.a4 = a2 / a0;
+            f.a0[band] = b0 / a0;
+            f.a1[band] = b1 / a0;
+            f.a2[band] = b2 / a0;
+            f.a3[band] = a1 / a0;
+            f.a4[band] = a2 / a0;
         }
 
         /* Reset the filter history. */
-        void BiQuad_reset(biquad& b) {
-            b.x1 = b.x2 = 0.0f;
-            b.y1 = b.y2 = 0.0f;
+        void BiQuad_reset(filterbank& f) {
+            std::fill_n(&f.x1[0][0], VOCLIB_MAX_FILTERS_PER_BAND * VOCLIB_MAX_BANDS, 0.0f);
+            std::fill_n(&f.x2[0][0], VOCLIB_MAX_FILTERS_PER_BAND * VOCLIB_MAX_BANDS, 0.0f);
+            std::fill_n(&f.y1[0][0], VOCLIB_MAX_FILTERS_PER_BAND * VOCLIB_MAX_BANDS, 0.0f);
+            std::fill_n(&f.y2[0][0], VOCLIB_MAX_FILTERS_PER_BAND * VOCLIB_MAX_BANDS, 0.0f);
+        }
+
+        /* Copies the coefficients of one band. */
+        static void BiQuad_copy(const filterbank& src, filterbank& dst, uint8_t band) {
+            dst.a0[band] = src.a0[band];
+            dst.a1[band] = src.a1[band];
+            dst.a2[band] = src.a2[band];
+            dst.a3[band] = src.a3[band];
+            dst.a4[band] = src.a4[band];
         }
 
-        void envelope_configure(envelope& envelope, float time_in_seconds, float sample_rate) {
-            envelope.coef = (float) (KlangWellen::pow(0.01, 1.0 / (time_in_seconds * sample_rate)));
+        void envelope_configure(float time_in_seconds, float sample_rate) {
+            fAnalysisEnvelopes.coef = (float) (KlangWellen::pow(0.01, 1.0 / (time_in_seconds * sample_rate)));
         }
 
         /* Reset the envelope history. */
-        void envelope_reset(envelope& envelope) {
-            envelope.history[0] = 0.0f;
-            envelope.history[1] = 0.0f;
-            envelope.history[2] = 0.0f;
-            envelope.history[3] = 0.0f;
+        void envelope_reset() {
+            std::fill_n(&fAnalysisEnvelopes.history[0][0], 4 * VOCLIB_MAX_BANDS, 0.0f);
         }
 
-        float envelope_tick(envelope& envelope, float sample) {
-            const float coef = envelope.coef;
-            const float e00  = (1.0f - coef) * KlangWellen::abs(sample);
-            const float e01  = coef * envelope.history[0];
-            const float e10  = (1.0f - coef) * envelope.history[0];
-            const float e11  = coef * envelope.history[1];
-            const float e20  = (1.0f - coef) * envelope.history[1];
-            const float e21  = coef * envelope.history[2];
-            const float e30  = (1.0f - coef) * envelope.history[2];
-            const float e31  = coef * envelope.history[3];
-
-            envelope.history[0] = (e00) + (e01);
-            envelope.history[1] = (e10) + (e11);
-            envelope.history[2] = (e20) + (e21);
-            envelope.history[3] = (e30) + (e31);
-            return envelope.history[3];
+        /* Envelope follower. Smoothes `signal`, which holds one sample per band. */
+        void envelope_tick_bands(float* signal) {
+            const float coef    = fAnalysisEnvelopes.coef;
+            float*      history = &fAnalysisEnvelopes.history[0][0];
+            for (uint8_t j = 0; j < fBandsPadded; ++j) {
+                float*      h0  = history + j;
+                float*      h1  = h0 + VOCLIB_MAX_BANDS;
+                float*      h2  = h1 + VOCLIB_MAX_BANDS;
+                float*      h3  = h2 + VOCLIB_MAX_BANDS;
+                const float e00 = (1.0f - coef) * KlangWellen::abs(signal[j]);
+                const float e01 = coef * *h0;
+                const float e10 = (1.0f - coef) * *h0;
+                const float e11 = coef * *h1;
+                const float e20 = (1.0f - coef) * *h1;
+                const float e21 = coef * *h2;
+                const float e30 = (1.0f - coef) * *h2;
+                const float e31 = coef * *h3;
+
+                *h0       = (e00) + (e01);
+                *h1       = (e10) + (e11);
+                *h2       = (e20) + (e21);
+                *h3       = (e30) + (e31);
+                signal[j] = *h3;
+            }
         }
 
         /* Initialize the vocoder envelopes. */
         void initialize_envelopes() {
-            uint8_t i;
-
-            envelope_configure(fAnalysisEnvelopes[0], fReactionTime, fSampleRate);
-            for (i = 1; i < fBands; ++i) {
-                fAnalysisEnvelopes[i].coef = fAnalysisEnvelopes[0].coef;
-            }
+            envelope_configure(fReactionTime, fSampleRate);
         }
 
         /* Initialize the vocoder filterbank. */
@@ -546,58 +566,31 @@ namespace klangwellen {
                 bandwidth = (nextfreq - priorfreq) / lastfreq;
 
                 if (!pCarrier_only) {
-                    BiQuad_new(fAnalysisBands[i].filters[0],
+                    BiQuad_new(fAnalysisBands,
+                               i,
                                VOCLIB_BPF,
                                0.0f,
                                lastfreq,
                                fSampleRate,
                                bandwidth);
-                    for (uint8_t j = 1; j < fFiltersPerBand; ++j) {
-                        fAnalysisBands[i].filters[j].a0 = fAnalysisBands[i].filters[0].a0;
-                        fAnalysisBands[i].filters[j].a1 = fAnalysisBands[i].filters[0].a1;
-                        fAnalysisBands[i].filters[j].a2 = fAnalysisBands[i].filters[0].a2;
-                        fAnalysisBands[i].filters[j].a3 = fAnalysisBands[i].filters[0].a3;
-                        fAnalysisBands[i].filters[j].a4 = fAnalysisBands[i].filters[0].a4;
-                    }
                 }
 
                 if (fFormantShift != 1.0f) {
-                    BiQuad_new(fSynthesisBands[i].filters[0],
+                    BiQuad_new(fSynthesisBands[0],
+                               i,
                                VOCLIB_BPF,
                                0.0f,
                                (float) (lastfreq * fFormantShift),
                                (float) fSampleRate,
                                (float) bandwidth);
                 } else {
-                    fSynthesisBands[i].filters[0].a0 = fAnalysisBands[i].filters[0].a0;
-                    fSynthesisBands[i].filters[0].a1 = fAnalysisBands[i].filters[0].a1;
-                    fSynthesisBands[i].filters[0].a2 = fAnalysisBands[i].filters[0].a2;
-                    fSynthesisBands[i].filters[0].a3 = fAnalysisBands[i].filters[0].a3;
-                    fSynthesisBands[i].filters[0].a4 = fAnalysisBands[i].filters[0].a4;
-                }
-
-                fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[0].a0 = fSynthesisBands[i].filters[0].a0;
-                fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[0].a1 = fSynthesisBands[i].filters[0].a1;
-                fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[0].a2 = fSynthesisBands[i].filters[0].a2;
-                fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[0].a3 = fSynthesisBands[i].filters[0].a3;
-                fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[0].a4 = fSynthesisBands[i].filters[0].a4;
-
-                for (uint8_t j = 1; j < fFiltersPerBand; ++j) {
-                    fSynthesisBands[i].filters[j].a0 = fSynthesisBands[i].filters[0].a0;
-                    fSynthesisBands[i].filters[j].a1 = fSynthesisBands[i].filters[0].a1;
-                    fSynthesisBands[i].filters[j].a2 = fSynthesisBands[i].filters[0].a2;
-                    fSynthesisBands[i].filters[j].a3 = fSynthesisBands[i].filters[0].a3;
-                    fSynthesisBands[i].filters[j].a4 = fSynthesisBands[i].filters[0].a4;
-
-                    fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[j].a0 = fSynthesisBands[i].filters[0].a0;
-                    fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[j].a1 = fSynthesisBands[i].filters[0].a1;
-                    fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[j].a2 = fSynthesisBands[i].filters[0].a2;
-                    fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[j].a3 = fSynthesisBands[i].filters[0].a3;
-                    fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[j].a4 = fSynthesisBands[i].filters[0].a4;
+                    BiQuad_copy(fAnalysisBands, fSynthesisBands[0], i);
                 }
+                BiQuad_copy(fSynthesisBands[0], fSynthesisBands[1], i);
             }
         }
 
+
         /* REVISION HISTORY
          *
          * Version 1.1 - 2019-02-16
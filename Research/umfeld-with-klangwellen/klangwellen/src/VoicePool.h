@@ -0,0 +1,364 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [ ] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t) *overwrite*
+ * - [ ] void process(float*, float*, uint32_t)
+ */
+
+#pragma once
+
+#ifndef KLANGWELLEN_VOICE_POOL_THREADS
+#define KLANGWELLEN_VOICE_POOL_THREADS 1
+#endif
+
+#ifndef KLANGWELLEN_VOICE_POOL_MIN_VOICES_PER_THREAD
+#define KLANGWELLEN_VOICE_POOL_MIN_VOICES_PER_THREAD 16
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+
+#if KLANGWELLEN_VOICE_POOL_THREADS
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif // KLANGWELLEN_VOICE_POOL_THREADS
+
+#include "KlangWellen.h"
+
+namespace klangwellen {
+    /**
+     * a polyphonic voice allocator with a fixed number of voices. notes are assigned to free voices, if all voices are
+     * playing a voice is stolen ( see `set_voice_stealing()` ). `process()` renders each active voice as a block and
+     * mixes the voices, voices that are not active are skipped.
+     *
+     * `VOICE` must be default constructible and implement:
+     *
+     * - `void note_on(uint8_t note, uint8_t velocity)`
+     * - `void note_off()`
+     * - `bool is_active() const` :: false once the voice is silent after `note_off()`
+     * - `float get_level() const` :: current output level, used to steal the quietest voice
+     * - `void process(float*, uint32_t)` :: renders a block, overwriting the buffer
+     *
+     * see `WavetableVoice` for an example. notes and `process()` must be called from the same thread ( usually the audio
+     * thread ).
+     */
+    template<typename VOICE, size_t NUMBER_OF_VOICES>
+    class VoicePool {
+    public:
+        static constexpr uint8_t  STEAL_OLDEST   = 0;
+        static constexpr uint8_t  STEAL_QUIETEST = 1;
+        static constexpr uint32_t BLOCK_SIZE     = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE;
+
+        VoicePool() {
+            for (voice_slot& mSlot: fSlots) {
+                mSlot.note = 0;
+                mSlot.held = false;
+                mSlot.age  = 0;
+            }
+        }
+
+        ~VoicePool() {
+#if KLANGWELLEN_VOICE_POOL_THREADS
+            stop_workers();
+#endif // KLANGWELLEN_VOICE_POOL_THREADS
+        }
+
+        VoicePool(const VoicePool&)            = delete;
+        VoicePool& operator=(const VoicePool&) = delete;
+
+        /**
+         * starts `note` on a free voice or steals a voice if all voices are playing. a velocity of 0 stops the note.
+         *
+         * @return index of the voice that plays the note
+         */
+        int32_t note_on(const uint8_t note, const uint8_t velocity) {
+            if (velocity == 0) {
+                note_off(note);
+                return -1;
+            }
+            const size_t mIndex = find_voice();
+            fSlots[mIndex].note = note;
+            fSlots[mIndex].held = true;
+            fSlots[mIndex].age  = ++fAge;
+            fVoices[mIndex].note_on(note, velocity);
+            return static_cast<int32_t>(mIndex);
+        }
+
+        /**
+         * releases all voices that play `note`
+         */
+        void note_off(const uint8_t note) {
+            for (size_t i = 0; i < NUMBER_OF_VOICES; i++) {
+                if (fSlots[i].held && fSlots[i].note == note) {
+                    fSlots[i].held = false;
+                    fVoices[i].note_off();
+                }
+            }
+        }
+
+        void all_notes_off() {
+            for (size_t i = 0; i < NUMBER_OF_VOICES; i++) {
+                if (fSlots[i].held) {
+                    fSlots[i].held = false;
+                    fVoices[i].note_off();
+                }
+            }
+        }
+
+        /**
+         * handles a MIDI channel message ( channel is ignored ): *note on*, *note off* and the channel mode messages *all
+         * sound off* and *all notes off* ( both release all voices ).
+         */
+        void midi(const uint8_t status, const uint8_t data1, const uint8_t data2) {
+            switch (status & 0xF0) {
+                case 0x80:
+                    note_off(data1);
+                    break;
+                case 0x90:
+                    note_on(data1, data2);
+                    break;
+                case 0xB0:
+                    if (data1 == 120 || data1 == 123) {
+                        all_notes_off();
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        /**
+         * @param voice_stealing `STEAL_OLDEST` or `STEAL_QUIETEST`. released voices are always stolen before held voices.
+         */
+        void set_voice_stealing(const uint8_t voice_stealing) {
+            fVoiceStealing = voice_stealing;
+        }
+
+        uint8_t get_voice_stealing() const {
+            return fVoiceStealing;
+        }
+
+        VOICE& get_voice(const size_t index) {
+            return fVoices[index];
+        }
+
+        static constexpr size_t get_num_voices() {
+            return NUMBER_OF_VOICES;
+        }
+
+        size_t get_num_active_voices() const {
+            size_t mActive = 0;
+            for (size_t i = 0; i < NUMBER_OF_VOICES; i++) {
+                mActive += fVoices[i].is_active() ? 1 : 0;
+            }
+            return mActive;
+        }
+
+#if KLANGWELLEN_VOICE_POOL_THREADS
+        /**
+         * renders voices on `num_threads` worker threads in addition to the calling thread. the voices are split into
+         * `num_threads + 1` interleaved partitions that are claimed by the workers and the calling thread, so a worker
+         * that wakes up late does not stall `process()`. blocks with fewer than
+         * `KLANGWELLEN_VOICE_POOL_MIN_VOICES_PER_THREAD` active voices per partition are rendered on the calling thread
+         * only.
+         *
+         * starts and joins threads, so it should not be called from the audio thread.
+         */
+        void set_num_threads(const uint8_t num_threads) {
+            stop_workers();
+            fPartitions.clear();
+            if (num_threads == 0) {
+                return;
+            }
+            for (uint32_t i = 0; i <= num_threads; i++) {
+                fPartitions.emplace_back(new partition());
+            }
+            fRunning.store(true);
+            for (uint32_t i = 0; i < num_threads; i++) {
+                fWorkers.emplace_back(&VoicePool::worker_thread, this);
+            }
+        }
+
+        uint8_t get_num_threads() const {
+            return static_cast<uint8_t>(fWorkers.size());
+        }
+#endif // KLANGWELLEN_VOICE_POOL_THREADS
+
+        void process(float* signal_buffer, const uint32_t buffer_length) {
+            for (uint32_t i = 0; i < buffer_length; i += BLOCK_SIZE) {
+                const uint32_t mLength = std::min(BLOCK_SIZE, buffer_length - i);
+#if KLANGWELLEN_VOICE_POOL_THREADS
+                if (!fPartitions.empty() &&
+                    get_num_active_voices() >= fPartitions.size() * KLANGWELLEN_VOICE_POOL_MIN_VOICES_PER_THREAD) {
+                    process_parallel(signal_buffer + i, mLength);
+                    continue;
+                }
+#endif // KLANGWELLEN_VOICE_POOL_THREADS
+                render(0, 1, signal_buffer + i, fBuffer, mLength);
+            }
+        }
+
+    private:
+        struct voice_slot {
+            uint8_t  note;
+            bool     held;
+            uint32_t age; /* order of `note_on()` calls */
+        };
+
+        VOICE      fVoices[NUMBER_OF_VOICES];
+        voice_slot fSlots[NUMBER_OF_VOICES];
+        float      fBuffer[BLOCK_SIZE]{};
+        uint32_t   fAge           = 0;
+        uint8_t    fVoiceStealing = STEAL_OLDEST;
+
+        size_t find_voice() const {
+            for (size_t i = 0; i < NUMBER_OF_VOICES; i++) {
+                if (!fVoices[i].is_active()) {
+                    return i;
+                }
+            }
+            size_t mIndex = 0;
+            for (size_t i = 1; i < NUMBER_OF_VOICES; i++) {
+                if (fSlots[i].held != fSlots[mIndex].held) {
+                    if (!fSlots[i].held) {
+                        mIndex = i;
+                    }
+                } else if (fVoiceStealing == STEAL_QUIETEST) {
+                    if (fVoices[i].get_level() < fVoices[mIndex].get_level()) {
+                        mIndex = i;
+                    }
+                } else if (static_cast<int32_t>(fSlots[i].age - fSlots[mIndex].age) < 0) {
+                    mIndex = i;
+                }
+            }
+            return mIndex;
+        }
+
+        /* mixes every `stride`th voice starting at `first` into `output` */
+        void render(const size_t first, const size_t stride, float* output, float* buffer, const uint32_t length) {
+            std::fill_n(output, length, 0.0f);
+            for (size_t i = first; i < NUMBER_OF_VOICES; i += stride) {
+                if (!fVoices[i].is_active()) {
+                    continue;
+                }
+                fVoices[i].process(buffer, length);
+                for (uint32_t j = 0; j < length; j++) {
+                    output[j] += buffer[j];
+                }
+            }
+        }
+
+#if KLANGWELLEN_VOICE_POOL_THREADS
+        struct partition {
+            alignas(64) float output[BLOCK_SIZE];
+            float buffer[BLOCK_SIZE];
+        };
+
+        std::vector<std::unique_ptr<partition>> fPartitions;
+        std::vector<std::thread>                fWorkers;
+        std::mutex                              fWorkerMutex;
+        std::condition_variable                 fWorkerSignal;
+        std::atomic<bool>                       fRunning{false};
+        std::atomic<uint32_t>                   fJob{0};
+        std::atomic<uint32_t>                   fNextPartition{0};
+        std::atomic<uint32_t>                   fCompletedPartitions{0};
+        uint32_t                                fJobLength = 0;
+
+        void stop_workers() {
+            if (fWorkers.empty()) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> mLock(fWorkerMutex);
+                fRunning.store(false);
+            }
+            fWorkerSignal.notify_all();
+            for (std::thread& mWorker: fWorkers) {
+                mWorker.join();
+            }
+            fWorkers.clear();
+        }
+
+        /* renders partitions until all are claimed ( audio thread and worker threads ) */
+        void render_partitions() {
+            const uint32_t mPartitions = static_cast<uint32_t>(fPartitions.size());
+            uint32_t       mPartition;
+            while ((mPartition = fNextPartition.fetch_add(1, std::memory_order_acq_rel)) < mPartitions) {
+                partition& p = *fPartitions[mPartition];
+                render(mPartition, mPartitions, p.output, p.buffer, fJobLength);
+                fCompletedPartitions.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+        /* audio thread */
+        void process_parallel(float* signal_buffer, const uint32_t length) {
+            const uint32_t mPartitions = static_cast<uint32_t>(fPartitions.size());
+            fJobLength                 = length;
+            fCompletedPartitions.store(0, std::memory_order_relaxed);
+            fNextPartition.store(0, std::memory_order_release);
+            fJob.fetch_add(1, std::memory_order_release);
+            fWorkerSignal.notify_all();
+
+            render_partitions();
+            while (fCompletedPartitions.load(std::memory_order_acquire) < mPartitions) {
+                std::this_thread::yield();
+            }
+
+            std::copy_n(fPartitions[0]->output, length, signal_buffer);
+            for (uint32_t p = 1; p < mPartitions; p++) {
+                const float* mOutput = fPartitions[p]->output;
+                for (uint32_t j = 0; j < length; j++) {
+                    signal_buffer[j] += mOutput[j];
+                }
+            }
+        }
+
+        void worker_thread() {
+            uint32_t mJob = fJob.load(std::memory_order_acquire);
+            while (fRunning.load()) {
+                {
+                    std::unique_lock<std::mutex> mLock(fWorkerMutex);
+                    /* the audio thread does not lock the mutex, so wake up periodically in case a signal was missed */
+                    fWorkerSignal.wait_for(mLock, std::chrono::milliseconds(1), [this, mJob] {
+                        return !fRunning.load() || fJob.load(std::memory_order_acquire) != mJob;
+                    });
+                }
+                const uint32_t mNextJob = fJob.load(std::memory_order_acquire);
+                if (mNextJob == mJob) {
+                    continue;
+                }
+                mJob = mNextJob;
+                render_partitions();
+            }
+        }
+#endif // KLANGWELLEN_VOICE_POOL_THREADS
+    };
+} // namespace klangwellen
@@ -0,0 +1,285 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "KlangWellen.h"
+
+namespace klangwellen {
+    /**
+     * minimal reader and writer for WAV files ( little endian hosts only ). samples are interleaved. files are written
+     * as 32-bit float, 16-, 24- and 32-bit PCM files are converted to float when they are read. RF64 files ( WAV files
+     * larger than 4GB ) are read as well. used by `klangwellen-render` to store and load golden files, by
+     * `OfflineAudioDriver` for its input and output, by `AudioFileStream` and by `AudioFileRecorder`.
+     */
+    class WAV {
+    public:
+        static bool write(const std::string& path,
+                          const float*       samples,
+                          const uint32_t     frames,
+                          const uint16_t     channels,
+                          const uint32_t     sample_rate) {
+            std::ofstream mFile(path, std::ios::binary);
+            if (!mFile.is_open()) {
+                return false;
+            }
+            const uint32_t mDataSize = frames * channels * sizeof(float);
+            mFile.write("RIFF", 4);
+            write_u32(mFile, 36 + mDataSize);
+            mFile.write("WAVE", 4);
+            mFile.write("fmt ", 4);
+            write_u32(mFile, 16);
+            write_u16(mFile, KlangWellen::WAV_FORMAT_IEEE_FLOAT_32BIT);
+            write_u16(mFile, channels);
+            write_u32(mFile, sample_rate);
+            write_u32(mFile, sample_rate * channels * sizeof(float));
+            write_u16(mFile, channels * sizeof(float));
+            write_u16(mFile, 32);
+            mFile.write("data", 4);
+            write_u32(mFile, mDataSize);
+            mFile.write(reinterpret_cast<const char*>(samples), mDataSize);
+            return mFile.good();
+        }
+
+        /**
+         * format of a WAV file and position of its samples, see `read_header()`
+         */
+        struct Format {
+            uint16_t format_tag      = 0;
+            uint16_t channels        = 0;
+            uint32_t sample_rate     = 0;
+            uint16_t bits_per_sample = 0;
+            uint64_t data_offset     = 0; /* in bytes from the beginning of the file */
+            uint64_t data_size       = 0; /* in bytes */
+
+            uint32_t bytes_per_frame() const {
+                return channels * (bits_per_sample / 8);
+            }
+
+            uint64_t frames() const {
+                return bytes_per_frame() > 0 ? data_size / bytes_per_frame() : 0;
+            }
+        };
+
+        /**
+         * @return false if the file does not exist or is neither a 32-bit float nor a 16-, 24- or 32-bit PCM WAV file
+         */
+        static bool read(const std::string& path,
+                         std::vector<float>& samples,
+                         uint16_t&           channels,
+                         uint32_t&           sample_rate) {
+            std::ifstream mFile(path, std::ios::binary);
+            Format        mFormat;
+            if (!read_header(mFile, mFormat)) {
+                return false;
+            }
+            std::vector<uint8_t> mBytes(mFormat.data_size);
+            if (!mFile.read(reinterpret_cast<char*>(mBytes.data()), mBytes.size())) {
+                return false;
+            }
+            samples.resize(mFormat.data_size / (mFormat.bits_per_sample / 8));
+            convert(mBytes.data(), samples.data(), samples.size(), mFormat);
+            channels    = mFormat.channels;
+            sample_rate = mFormat.sample_rate;
+            return true;
+        }
+
+        /**
+         * reads the chunks up to the beginning of the samples, `file` is left at the first sample.
+         *
+         * @return false if the file is neither a 32-bit float nor a 16-, 24- or 32-bit PCM WAV file
+         */
+        static bool read_header(std::ifstream& file, Format& format) {
+            char mID[4];
+            if (!file.read(mID, 4) || (memcmp(mID, "RIFF", 4) != 0 && memcmp(mID, "RF64", 4) != 0)) {
+                return false;
+            }
+            read_u32(file);
+            if (!file.read(mID, 4) || memcmp(mID, "WAVE", 4) != 0) {
+                return false;
+            }
+            bool     mFormat   = false;
+            uint64_t mDataSize = 0; /* from the `ds64` chunk of RF64 files */
+            while (file.read(mID, 4)) {
+                const uint32_t mSize = read_u32(file);
+                if (memcmp(mID, "ds64", 4) == 0) {
+                    read_u64(file);
+                    mDataSize = read_u64(file);
+                    file.seekg(mSize - 16 + (mSize & 1), std::ios::cur);
+                } else if (memcmp(mID, "fmt ", 4) == 0) {
+                    format.format_tag  = read_u16(file);
+                    format.channels    = read_u16(file);
+                    format.sample_rate = read_u32(file);
+                    read_u32(file);
+                    read_u16(file);
+                    format.bits_per_sample = read_u16(file);
+                    file.seekg(mSize - 16 + (mSize & 1), std::ios::cur);
+                    mFormat = format.channels > 0 &&
+                              ((format.format_tag == KlangWellen::WAV_FORMAT_IEEE_FLOAT_32BIT && format.bits_per_sample == 32) ||
+                               (format.format_tag == KlangWellen::WAV_FORMAT_PCM &&
+                                (format.bits_per_sample == 16 || format.bits_per_sample == 24 || format.bits_per_sample == 32)));
+                    if (!mFormat) {
+                        return false;
+                    }
+                } else if (memcmp(mID, "data", 4) == 0 && mFormat) {
+                    format.data_offset = static_cast<uint64_t>(file.tellg());
+                    format.data_size   = mSize == 0xFFFFFFFF && mDataSize > 0 ? mDataSize : mSize;
+                    return true;
+                } else {
+                    file.seekg(mSize + (mSize & 1), std::ios::cur);
+                }
+            }
+            return false;
+        }
+
+        /**
+         * converts `num_samples` samples in the format of the file to float. signed little endian integers are scaled to
+         * -1.0 ... 1.0.
+         */
+        static void convert(const uint8_t* data, float* samples, const size_t num_samples, const Format& format) {
+            if (format.format_tag == KlangWellen::WAV_FORMAT_IEEE_FLOAT_32BIT) {
+                memcpy(samples, data, num_samples * sizeof(float));
+                return;
+            }
+            const uint32_t mBytes = format.bits_per_sample / 8;
+            if (mBytes == 2) {
+                for (size_t i = 0; i < num_samples; i++) {
+                    int16_t mValue;
+                    memcpy(&mValue, data + i * 2, 2);
+                    samples[i] = static_cast<float>(mValue) * (1.0f / 32768.0f);
+                }
+                return;
+            }
+            const float mScale = 1.0f / static_cast<float>(1u << (mBytes * 8 - 1));
+            for (size_t i = 0; i < num_samples; i++) {
+                /* shifts the sample into the upper bytes so that the sign is extended by the cast */
+                uint32_t mValue = 0;
+                for (uint32_t j = 0; j < mBytes; j++) {
+                    mValue |= static_cast<uint32_t>(data[i * mBytes + j]) << (8 * (4 - mBytes + j));
+                }
+                samples[i] = static_cast<float>(static_cast<int32_t>(mValue) >> (8 * (4 - mBytes))) * mScale;
+            }
+        }
+
+        /**
+         * converts `num_samples` float samples to the format of the file. PCM samples are clipped to -1.0 ... 1.0.
+         */
+        static void convert(const float* samples, uint8_t* data, const size_t num_samples, const Format& format) {
+            if (format.format_tag == KlangWellen::WAV_FORMAT_IEEE_FLOAT_32BIT) {
+                memcpy(data, samples, num_samples * sizeof(float));
+                return;
+            }
+            const uint32_t mBytes = format.bits_per_sample / 8;
+            const double   mScale = static_cast<double>((1u << (mBytes * 8 - 1)) - 1);
+            for (size_t i = 0; i < num_samples; i++) {
+                const int32_t mValue = static_cast<int32_t>(lrint(KlangWellen::clamp(samples[i], -1.0f, 1.0f) * mScale));
+                memcpy(data + i * mBytes, &mValue, mBytes);
+            }
+        }
+
+        static constexpr uint32_t MIN_HEADER_SIZE = 88;
+
+        /**
+         * writes a header of `format.data_offset` bytes ( at least `MIN_HEADER_SIZE`, even ) to `header`. the header
+         * reserves room for a `ds64` chunk in a `JUNK` chunk and pads the rest with a second `JUNK` chunk, so that it
+         * can be rewritten in place as RF64 header once the file exceeds 4GB ( `rf64` ) and the samples can start at an
+         * aligned offset.
+         */
+        static void write_header(uint8_t* header, const Format& format, const bool rf64) {
+            const uint64_t mRIFFSize = format.data_offset - 8 + format.data_size + (format.data_size & 1);
+            const uint32_t mJunkSize = static_cast<uint32_t>(format.data_offset - MIN_HEADER_SIZE);
+            memset(header, 0, static_cast<size_t>(format.data_offset));
+            uint8_t* p = header;
+            p          = put(p, rf64 ? "RF64" : "RIFF", 4);
+            p          = put_u32(p, rf64 ? 0xFFFFFFFF : static_cast<uint32_t>(mRIFFSize));
+            p          = put(p, "WAVE", 4);
+            p          = put(p, rf64 ? "ds64" : "JUNK", 4);
+            p          = put_u32(p, 28);
+            if (rf64) {
+                put_u64(p, mRIFFSize);
+                put_u64(p + 8, format.data_size);
+                put_u64(p + 16, format.frames());
+            }
+            p += 28;
+            p = put(p, "fmt ", 4);
+            p = put_u32(p, 16);
+            p = put_u16(p, format.format_tag);
+            p = put_u16(p, format.channels);
+            p = put_u32(p, format.sample_rate);
+            p = put_u32(p, format.sample_rate * format.bytes_per_frame());
+            p = put_u16(p, static_cast<uint16_t>(format.bytes_per_frame()));
+            p = put_u16(p, format.bits_per_sample);
+            p = put(p, "JUNK", 4);
+            p = put_u32(p, mJunkSize);
+            p += mJunkSize;
+            p = put(p, "data", 4);
+            put_u32(p, rf64 ? 0xFFFFFFFF : static_cast<uint32_t>(format.data_size));
+        }
+
+    private:
+        static uint8_t* put(uint8_t* p, const void* data, const size_t size) {
+            memcpy(p, data, size);
+            return p + size;
+        }
+
+        static uint8_t* put_u16(uint8_t* p, const uint16_t value) {
+            return put(p, &value, 2);
+        }
+
+        static uint8_t* put_u32(uint8_t* p, const uint32_t value) {
+            return put(p, &value, 4);
+        }
+
+        static uint8_t* put_u64(uint8_t* p, const uint64_t value) {
+            return put(p, &value, 8);
+        }
+
+        static void write_u16(std::ofstream& file, const uint16_t value) {
+            file.write(reinterpret_cast<const char*>(&value), 2);
+        }
+
+        static void write_u32(std::ofstream& file, const uint32_t value) {
+            file.write(reinterpret_cast<const char*>(&value), 4);
+        }
+
+        static uint16_t read_u16(std::ifstream& file) {
+            uint16_t mValue = 0;
+            file.read(reinterpret_cast<char*>(&mValue), 2);
+            return mValue;
+        }
+
+        static uint32_t read_u32(std::ifstream& file) {
+            uint32_t mValue = 0;
+            file.read(reinterpret_cast<char*>(&mValue), 4);
+            return mValue;
+        }
+
+        static uint64_t read_u64(std::ifstream& file) {
+            uint64_t mValue = 0;
+            file.read(reinterpret_cast<char*>(&mValue), 8);
+            return mValue;
+        }
+    };
+} // namespace klangwellen
@@ -32,8 +32,10 @@
 #include <cstdint>
 #include <cmath>
 #include <algorithm>
+#include <memory>
 
 #include "KlangWellen.h"
+#include "WavetableBank.h"
 
 #ifndef PI
 #define PI M_PI
@@ -71,9 +73,21 @@ namespace klangwellen {
             mDesiredAmplitude         = 0.0f;
             mDesiredAmplitudeFraction = 0.0f;
             mDesiredAmplitudeSteps    = 0;
+            mActiveWavetable          = wavetable;
             set_frequency(M_DEFAULT_FREQUENCY);
         }
 
+        /**
+         * creates an oscillator that references the band-limited tables of a shared `WavetableBank` instead of owning a
+         * table. the table is picked by frequency ( see `WavetableBank::get_level()` ).
+         *
+         * @param bank          e.g `WavetableBank::shared(KlangWellen::WAVEFORM_SAWTOOTH)`
+         * @param sampling_rate sampling rate in Hz
+         */
+        Wavetable(std::shared_ptr<const WavetableBank> bank, const uint32_t sampling_rate) : Wavetable(nullptr, bank->get_table_size(), sampling_rate) {
+            set_bank(std::move(bank));
+        }
+
         ~Wavetable() {
             if (fDeleteWavetable) {
                 delete[] mWavetable;
@@ -142,8 +156,29 @@ namespace klangwellen {
             }
         }
 
-        void set_waveform(const uint8_t waveform) const {
-            fill(mWavetable, mWavetableSize, waveform);
+        /**
+         * fills the wavetable with `waveform`. an oscillator that references a `WavetableBank` switches to the shared
+         * bank of `waveform` instead ( which is computed on first use ).
+         */
+        void set_waveform(const uint8_t waveform) {
+            if (fBank != nullptr) {
+                set_bank(WavetableBank::shared(waveform, fBank->get_table_size(), fBank->get_sample_rate()));
+            } else {
+                fill(mWavetable, mWavetableSize, waveform);
+            }
+        }
+
+        /**
+         * references the band-limited tables of `bank`. the table size of the bank must match the size of the wavetable.
+         * passing `nullptr` returns to the wavetable passed at construction.
+         */
+        void set_bank(std::shared_ptr<const WavetableBank> bank) {
+            fBank = std::move(bank);
+            update_active_wavetable();
+        }
+
+        const WavetableBank* get_bank() const {
+            return fBank.get();
         }
 
         float get_frequency() const {
@@ -155,6 +190,7 @@ namespace klangwellen {
             if (mFrequency != mNewFrequency) {
                 mFrequency = mNewFrequency;
                 mStepSize  = computeStepSize();
+                update_active_wavetable();
             }
         }
 
@@ -218,6 +254,10 @@ namespace klangwellen {
             }
         }
 
+        /**
+         * @return the wavetable owned by or passed to the oscillator ( `nullptr` for an oscillator created from a
+         * `WavetableBank` )
+         */
         float* get_wavetable() const {
             return mWavetable;
         }
@@ -319,35 +359,72 @@ namespace klangwellen {
         }
 
         void process(float* signal_buffer, const uint32_t buffer_length) {
-            for (uint16_t i = 0; i < buffer_length; i++) {
-                signal_buffer[i] = process();
+            uint32_t i = 0;
+            /* amplitude and frequency ramps change the oscillator every sample */
+            while (i < buffer_length && (mDesiredAmplitudeSteps > 0 || mDesiredFrequencySteps > 0)) {
+                signal_buffer[i++] = process();
             }
+            if (i == buffer_length) {
+                return;
+            }
+
+            float*         mOutput = signal_buffer + i;
+            const uint32_t mLength = buffer_length - i;
+#if KLANGWELLEN_WAVETABLE_INTERPOLATE_SAMPLES == 0
+            block_sample(mOutput, mLength);
+#else
+            switch (fInterpolationType) {
+                case KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR:
+                    block_sample_interpolate_linear(mOutput, mLength);
+                    break;
+                case KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC:
+                    block_sample_interpolate_cubic(mOutput, mLength);
+                    break;
+                default:
+                    block_sample(mOutput, mLength);
+                    break;
+            }
+#endif // KLANGWELLEN_WAVETABLE_INTERPOLATE_SAMPLES
+
+            /* amplitude and offset are constant for the rest of the block */
+            const float mAmplitudeBlock = mAmplitude;
+            const float mOffsetBlock    = mOffset;
+            for (uint32_t j = 0; j < mLength; j++) {
+                mOutput[j] = mOutput[j] * mAmplitudeBlock + mOffsetBlock;
+            }
+            mSignal = mOutput[mLength - 1];
         }
 
     private:
-        static constexpr float PIf                 = (float) PI;
-        static constexpr float TWO_PIf             = (float) TWO_PI;
-        static constexpr float M_DEFAULT_AMPLITUDE = 0.75f;
-        static constexpr float M_DEFAULT_FREQUENCY = 220.0f;
-        float*                 mWavetable;
-        const uint32_t         mWavetableSize;
-        const uint32_t         mSamplingRate;
-        bool                   fDeleteWavetable;
-        float                  mAmplitude;
-        float                  mArrayPtr;
-        float                  mDesiredAmplitude;
-        float                  mDesiredAmplitudeFraction;
-        uint16_t               mDesiredAmplitudeSteps;
-        float                  mDesiredFrequency{};
-        float                  mDesiredFrequencyFraction{};
-        uint16_t               mDesiredFrequencySteps{};
-        float                  mFrequency;
-        float                  mJitterRange;
-        float                  mOffset{};
-        float                  mPhaseOffset;
-        float                  mSignal{};
-        float                  mStepSize{};
-        uint8_t                fInterpolationType;
+        static constexpr float               PIf                 = (float) PI;
+        static constexpr float               TWO_PIf             = (float) TWO_PI;
+        static constexpr float               M_DEFAULT_AMPLITUDE = 0.75f;
+        static constexpr float               M_DEFAULT_FREQUENCY = 220.0f;
+        float*                               mWavetable;
+        const float*                         mActiveWavetable; /* `mWavetable` or a table of `fBank` */
+        std::shared_ptr<const WavetableBank> fBank;
+        const uint32_t                       mWavetableSize;
+        const uint32_t                       mSamplingRate;
+        bool                                 fDeleteWavetable;
+        float                                mAmplitude;
+        float                                mArrayPtr;
+        float                                mDesiredAmplitude;
+        float                                mDesiredAmplitudeFraction;
+        uint16_t                             mDesiredAmplitudeSteps;
+        float                                mDesiredFrequency{};
+        float                                mDesiredFrequencyFraction{};
+        uint16_t                             mDesiredFrequencySteps{};
+        float                                mFrequency;
+        float                                mJitterRange;
+        float                                mOffset{};
+        float                                mPhaseOffset;
+        float                                mSignal{};
+        float                                mStepSize{};
+        uint8_t                              fInterpolationType;
+
+        void update_active_wavetable() {
+            mActiveWavetable = fBank != nullptr ? fBank->get_table(mFrequency) : mWavetable;
+        }
 
         void advance_array_ptr() {
             // mArrayPtr += mStepSize * (mEnableJitter ? (klangwellen::KlangWellen::random() * mJitterRange + 1.0f) : 1.0f);
@@ -361,12 +438,81 @@ namespace klangwellen {
             }
         }
 
+        static float advance_array_ptr(float array_ptr, const float step_size, const float wavetable_size) {
+            array_ptr += step_size;
+            while (array_ptr >= wavetable_size) {
+                array_ptr -= wavetable_size;
+            }
+            while (array_ptr < 0) {
+                array_ptr += wavetable_size;
+            }
+            return array_ptr;
+        }
+
+        /* block variants of `next_sample*()` with the oscillator state held in locals */
+
+        void block_sample(float* signal_buffer, const uint32_t buffer_length) {
+            const float* mTable    = mActiveWavetable;
+            const float  mSize     = mWavetableSize;
+            const float  mStep     = mStepSize;
+            float        mPosition = mArrayPtr;
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] = mTable[static_cast<int>(mPosition)];
+                mPosition        = advance_array_ptr(mPosition, mStep, mSize);
+            }
+            mArrayPtr = mPosition;
+        }
+
+        void block_sample_interpolate_linear(float* signal_buffer, const uint32_t buffer_length) {
+            const float*   mTable        = mActiveWavetable;
+            const uint32_t mTableSize    = mWavetableSize;
+            const float    mSize         = mWavetableSize;
+            const float    mStep         = mStepSize;
+            const uint32_t mSampleOffset = static_cast<uint32_t>(mPhaseOffset * mWavetableSize) % mWavetableSize;
+            float          mPosition     = mArrayPtr;
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                const float    mArrayPtrOffset = mPosition + mSampleOffset;
+                const float    mFrac           = mArrayPtrOffset - static_cast<int>(mArrayPtrOffset);
+                const float    a               = mTable[static_cast<int>(mArrayPtrOffset)];
+                const uint32_t p1              = static_cast<uint32_t>(mArrayPtrOffset) + 1;
+                const float    b               = mTable[p1 >= mTableSize ? p1 - mTableSize : p1];
+                signal_buffer[i]               = a + mFrac * (b - a);
+                mPosition                      = advance_array_ptr(mPosition, mStep, mSize);
+            }
+            mArrayPtr = mPosition;
+        }
+
+        void block_sample_interpolate_cubic(float* signal_buffer, const uint32_t buffer_length) {
+            const float*   mTable        = mActiveWavetable;
+            const uint32_t mTableSize    = mWavetableSize;
+            const float    mSize         = mWavetableSize;
+            const float    mStep         = mStepSize;
+            const uint32_t mSampleOffset = static_cast<int>(mPhaseOffset * mWavetableSize) % mWavetableSize;
+            float          mPosition     = mArrayPtr;
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                const float    mArrayPtrOffset = mPosition + mSampleOffset;
+                const float    frac            = mArrayPtrOffset - static_cast<int>(mArrayPtrOffset);
+                const float    a               = static_cast<int>(mArrayPtrOffset) > 0 ? mTable[static_cast<int>(mArrayPtrOffset) - 1] : mTable[mTableSize - 1];
+                const float    b               = mTable[static_cast<int>(mArrayPtrOffset) % mTableSize];
+                const uint32_t p1              = static_cast<uint32_t>(mArrayPtrOffset) + 1;
+                const float    c               = mTable[p1 >= mTableSize ? p1 - mTableSize : p1];
+                const uint32_t p2              = static_cast<uint32_t>(mArrayPtrOffset) + 2;
+                const float    d               = mTable[p2 >= mTableSize ? p2 - mTableSize : p2];
+                const float    tmp             = d + 3.0f * b;
+                const float    fracsq          = frac * frac;
+                const float    fracb           = frac * fracsq;
+                signal_buffer[i]               = (fracb * (-a - 3.f * c + tmp) / 6.f + fracsq * ((a + c) / 2.f - b) + frac * (c + (-2.f * a - tmp) / 6.f) + b);
+                mPosition                      = advance_array_ptr(mPosition, mStep, mSize);
+            }
+            mArrayPtr = mPosition;
+        }
+
         float computeStepSize() const {
             return mFrequency * (static_cast<float>(mWavetableSize) / static_cast<float>(mSamplingRate));
         }
 
         float next_sample() {
-            const float mOutput = mWavetable[static_cast<int>(mArrayPtr)];
+            const float mOutput = mActiveWavetable[static_cast<int>(mArrayPtr)];
             advance_array_ptr();
             return mOutput;
         }
@@ -376,12 +522,12 @@ namespace klangwellen {
             const float    mArrayPtrOffset = mArrayPtr + mSampleOffset;
             /* cubic interpolation */
             const float    frac    = mArrayPtrOffset - static_cast<int>(mArrayPtrOffset);
-            const float    a       = static_cast<int>(mArrayPtrOffset) > 0 ? mWavetable[static_cast<int>(mArrayPtrOffset) - 1] : mWavetable[mWavetableSize - 1];
-            const float    b       = mWavetable[static_cast<int>(mArrayPtrOffset) % mWavetableSize];
+            const float    a       = static_cast<int>(mArrayPtrOffset) > 0 ? mActiveWavetable[static_cast<int>(mArrayPtrOffset) - 1] : mActiveWavetable[mWavetableSize - 1];
+            const float    b       = mActiveWavetable[static_cast<int>(mArrayPtrOffset) % mWavetableSize];
             const uint32_t p1      = static_cast<uint32_t>(mArrayPtrOffset) + 1;
-            const float    c       = mWavetable[p1 >= mWavetableSize ? p1 - mWavetableSize : p1];
+            const float    c       = mActiveWavetable[p1 >= mWavetableSize ? p1 - mWavetableSize : p1];
             const uint32_t p2      = static_cast<uint32_t>(mArrayPtrOffset) + 2;
-            const float    d       = mWavetable[p2 >= mWavetableSize ? p2 - mWavetableSize : p2];
+            const float    d       = mActiveWavetable[p2 >= mWavetableSize ? p2 - mWavetableSize : p2];
             const float    tmp     = d + 3.0f * b;
             const float    fracsq  = frac * frac;
             const float    fracb   = frac * fracsq;
@@ -395,9 +541,9 @@ namespace klangwellen {
             const float    mArrayPtrOffset = mArrayPtr + mSampleOffset;
             /* linear interpolation */
             const float    mFrac   = mArrayPtrOffset - static_cast<int>(mArrayPtrOffset);
-            const float    a       = mWavetable[static_cast<int>(mArrayPtrOffset)];
+            const float    a       = mActiveWavetable[static_cast<int>(mArrayPtrOffset)];
             const uint32_t p1      = static_cast<uint32_t>(mArrayPtrOffset) + 1;
-            const float    b       = mWavetable[p1 >= mWavetableSize ? p1 - mWavetableSize : p1];
+            const float    b       = mActiveWavetable[p1 >= mWavetableSize ? p1 - mWavetableSize : p1];
             const float    mOutput = a + mFrac * (b - a);
             advance_array_ptr();
             return mOutput;
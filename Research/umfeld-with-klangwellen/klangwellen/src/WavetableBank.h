@@ -0,0 +1,199 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "KlangWellen.h"
+
+namespace klangwellen {
+    /**
+     * an immutable set of band-limited tables of one waveform, one table per octave ( mip level ). the table of level
+     * `l` contains only the harmonics that stay below the nyquist frequency for fundamentals up to
+     * `base_frequency * 2^l`, so an oscillator that picks the level by its frequency does not alias. the tables are
+     * computed once by additive synthesis and can be shared by any number of `Wavetable` instances ( see `shared()` ).
+     *
+     * supports the waveforms of `Wavetable::fill()` ( `WAVEFORM_SINE`, `WAVEFORM_TRIANGLE`, `WAVEFORM_SAWTOOTH` and
+     * `WAVEFORM_SQUARE` ) with the same phase and orientation.
+     */
+    class WavetableBank {
+    public:
+        static constexpr float DEFAULT_BASE_FREQUENCY = 20.0f;
+        static constexpr int   DEFAULT_TABLE_SIZE     = 2048;
+
+        WavetableBank(const uint8_t  waveform,
+                      const uint32_t table_size     = DEFAULT_TABLE_SIZE,
+                      const uint32_t sample_rate    = KlangWellen::DEFAULT_SAMPLE_RATE,
+                      const float    base_frequency = DEFAULT_BASE_FREQUENCY) : fWaveform(waveform),
+                                                                                fTableSize(table_size),
+                                                                                fSampleRate(sample_rate),
+                                                                                fBaseFrequency(base_frequency),
+                                                                                fNumLevels(num_levels(sample_rate, base_frequency)),
+                                                                                fTables(static_cast<size_t>(fNumLevels) * table_size) {
+            compute();
+        }
+
+        /**
+         * returns a bank from a process-wide cache. the bank is computed on the first request for a combination of
+         * parameters and kept for the lifetime of the process. must not be called from the audio thread.
+         */
+        static std::shared_ptr<const WavetableBank> shared(const uint8_t  waveform,
+                                                           const uint32_t table_size  = DEFAULT_TABLE_SIZE,
+                                                           const uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE) {
+            static std::mutex                                                                           mMutex;
+            static std::map<std::tuple<uint8_t, uint32_t, uint32_t>, std::shared_ptr<const WavetableBank>> mCache;
+            std::lock_guard<std::mutex>                                                                 mLock(mMutex);
+            std::shared_ptr<const WavetableBank>& mBank = mCache[std::make_tuple(waveform, table_size, sample_rate)];
+            if (mBank == nullptr) {
+                mBank = std::make_shared<const WavetableBank>(waveform, table_size, sample_rate);
+            }
+            return mBank;
+        }
+
+        /**
+         * @param frequency fundamental frequency in Hz
+         * @return the mip level for `frequency` i.e the level with the most harmonics that does not alias
+         */
+        uint8_t get_level(const float frequency) const {
+            const float mRatio = frequency / fBaseFrequency;
+            if (!(mRatio > 1.0f)) {
+                return 0;
+            }
+            int         mExponent;
+            const float mMantissa = frexpf(mRatio, &mExponent); /* ceil(log2(ratio)) without a call to `log2` */
+            const int   mLevel    = mMantissa > 0.5f ? mExponent : mExponent - 1;
+            return mLevel < fNumLevels ? static_cast<uint8_t>(mLevel) : fNumLevels - 1;
+        }
+
+        const float* get_table(const float frequency) const {
+            return get_table_at_level(get_level(frequency));
+        }
+
+        const float* get_table_at_level(const uint8_t level) const {
+            return fTables.data() + static_cast<size_t>(level) * fTableSize;
+        }
+
+        uint8_t get_num_levels() const {
+            return fNumLevels;
+        }
+
+        uint32_t get_table_size() const {
+            return fTableSize;
+        }
+
+        uint32_t get_sample_rate() const {
+            return fSampleRate;
+        }
+
+        uint8_t get_waveform() const {
+            return fWaveform;
+        }
+
+        /**
+         * @return number of harmonics in the table of `level`
+         */
+        uint32_t get_num_harmonics(const uint8_t level) const {
+            const float    mNyquist   = fSampleRate * 0.5f;
+            const float    mMaxFreq   = fBaseFrequency * static_cast<float>(1 << level);
+            const uint32_t mHarmonics = static_cast<uint32_t>(mNyquist / mMaxFreq);
+            const uint32_t mMaxTable  = fTableSize / 2 - 1;
+            return std::max<uint32_t>(1, std::min(mHarmonics, mMaxTable));
+        }
+
+        /**
+         * @return memory used by the tables in bytes
+         */
+        size_t get_memory_size() const {
+            return fTables.size() * sizeof(float);
+        }
+
+    private:
+        const uint8_t      fWaveform;
+        const uint32_t     fTableSize;
+        const uint32_t     fSampleRate;
+        const float        fBaseFrequency;
+        const uint8_t      fNumLevels;
+        std::vector<float> fTables;
+
+        /* levels up to the octave where only the fundamental fits below the nyquist frequency */
+        static uint8_t num_levels(const uint32_t sample_rate, const float base_frequency) {
+            uint8_t mLevels = 1;
+            while (base_frequency * static_cast<float>(1 << (mLevels - 1)) * 2.0f < sample_rate * 0.5f && mLevels < 16) {
+                mLevels++;
+            }
+            return mLevels;
+        }
+
+        /* amplitude of harmonic `k` in the fourier series of the waveforms of `Wavetable::fill()` */
+        float harmonic_amplitude(const uint32_t k) const {
+            constexpr double PI_d = 3.14159265358979323846;
+            switch (fWaveform) {
+                case KlangWellen::WAVEFORM_TRIANGLE:
+                    if (k % 2 == 0) {
+                        return 0.0f;
+                    }
+                    return static_cast<float>((((k - 1) / 2) % 2 == 0 ? 8.0 : -8.0) / (PI_d * PI_d * k * k));
+                case KlangWellen::WAVEFORM_SQUARE:
+                    return k % 2 == 0 ? 0.0f : static_cast<float>(4.0 / (PI_d * k));
+                case KlangWellen::WAVEFORM_SAWTOOTH:
+                    /* rising from -1 to 1 */
+                    return static_cast<float>(-2.0 / (PI_d * k));
+                default:
+                    return k == 1 ? 1.0f : 0.0f;
+            }
+        }
+
+        void compute() {
+            /* harmonic `k` at table position `i` is `sin(2 PI k i / size)`, i.e a lookup into one sine table at
+             * `(k * i) % size`. levels are built from the top ( fewest harmonics ) down, each level adds its extra
+             * harmonics to a copy of the level above. */
+            std::vector<double> mSine(fTableSize);
+            for (uint32_t i = 0; i < fTableSize; i++) {
+                mSine[i] = sin(2.0 * 3.14159265358979323846 * i / fTableSize);
+            }
+            std::vector<double> mSum(fTableSize, 0.0);
+            uint32_t            mHarmonics = 0;
+            for (int l = fNumLevels - 1; l >= 0; l--) {
+                const uint32_t mLevelHarmonics = get_num_harmonics(static_cast<uint8_t>(l));
+                for (uint32_t k = mHarmonics + 1; k <= mLevelHarmonics; k++) {
+                    const double mAmplitude = harmonic_amplitude(k);
+                    if (mAmplitude == 0.0) {
+                        continue;
+                    }
+                    for (uint32_t i = 0; i < fTableSize; i++) {
+                        mSum[i] += mAmplitude * mSine[(static_cast<uint64_t>(k) * i) % fTableSize];
+                    }
+                }
+                mHarmonics   = std::max(mHarmonics, mLevelHarmonics);
+                float* mTable = fTables.data() + static_cast<size_t>(l) * fTableSize;
+                for (uint32_t i = 0; i < fTableSize; i++) {
+                    mTable[i] = static_cast<float>(mSum[i]);
+                }
+            }
+        }
+    };
+} // namespace klangwellen
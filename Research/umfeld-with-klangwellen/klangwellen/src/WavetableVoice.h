@@ -0,0 +1,92 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [ ] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t) *overwrite*
+ * - [ ] void process(float*, float*, uint32_t)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+
+#include "KlangWellen.h"
+#include "ADSR.h"
+#include "Wavetable.h"
+#include "WavetableBank.h"
+
+namespace klangwellen {
+    /**
+     * a voice for `VoicePool` made of a band-limited `Wavetable` oscillator and an `ADSR` envelope. the oscillator
+     * references a shared `WavetableBank`, so a pool of voices owns no tables.
+     */
+    class WavetableVoice {
+    public:
+        explicit WavetableVoice(const uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE,
+                                const uint8_t  waveform    = KlangWellen::WAVEFORM_SAWTOOTH) : fOscillator(WavetableBank::shared(waveform, WavetableBank::DEFAULT_TABLE_SIZE, sample_rate), sample_rate),
+                                                                                              fADSR(sample_rate) {}
+
+        void note_on(const uint8_t note, const uint8_t velocity) {
+            fOscillator.set_frequency(KlangWellen::midi_note_to_frequency(note));
+            fOscillator.set_amplitude(static_cast<float>(velocity) / 127.0f);
+            fADSR.start();
+        }
+
+        void note_off() {
+            fADSR.stop();
+        }
+
+        /**
+         * @return false once the envelope has returned to zero after `note_off()`
+         */
+        bool is_active() const {
+            return !fADSR.is_idle();
+        }
+
+        /**
+         * @return current output level ( used to steal the quietest voice )
+         */
+        float get_level() const {
+            return fADSR.current() * fOscillator.get_amplitude();
+        }
+
+        Wavetable& get_oscillator() {
+            return fOscillator;
+        }
+
+        ADSR& get_adsr() {
+            return fADSR;
+        }
+
+        void process(float* signal_buffer, const uint32_t buffer_length) {
+            fOscillator.process(signal_buffer, buffer_length);
+            fADSR.process(signal_buffer, buffer_length);
+        }
+
+    private:
+        Wavetable fOscillator;
+        ADSR      fADSR;
+    };
+} // namespace klangwellen
@@ -1,16 +1,20 @@
-#include <queue>
+#include <atomic>
+#include <vector>
 
 #include "Umfeld.h"
 
 using namespace umfeld;
 
-#include "PaulStretch.h"
+#include "PaulStretchStream.h"
 #include "audio/AudioFileReader.h"
 
-PaulStretch       fStretcher{8, (int) (48000 * 0.25f), 48000};
-AudioFileReader   fAudioFileReader;
-float*            fStretchedSampleBuffer;
-std::queue<float> fSampleFIFOBuffer;
+void read_input(float* buffer, int number_of_samples);
+
+AudioFileReader    fAudioFileReader;
+PaulStretchStream  fStretcher{8, (int) (48000 * 0.25f), 48000, read_input, 4};
+std::vector<float> fStretchedSampleBuffer;
+/* position of the reader, written by the worker thread in `read_input()` and drawn in `draw()` */
+std::atomic<float> fProgress{0.0f};
 
 void settings() {
     size(1024, 768);
@@ -19,13 +23,14 @@ void settings() {
 
 void setup() {
     fAudioFileReader.open("../audio-input.wav");
-    fStretchedSampleBuffer = new float[fStretcher.get_output_buffer_size()];
+    fStretchedSampleBuffer.resize(audio_buffer_size);
+    fStretcher.start();
 }
 
 void draw() {
     background(1);
     const int   mPadding  = 10;
-    const float mProgress = (float) fAudioFileReader.current_position() / (float) fAudioFileReader.length();
+    const float mProgress = fProgress.load(std::memory_order_relaxed);
     stroke(0.0f);
     noFill();
     rect(mPadding, height * 0.5 - mPadding, width - mPadding * 2, mPadding * 2);
@@ -34,42 +39,16 @@ void draw() {
     rect(mPadding, height * 0.5 - mPadding, (width - mPadding * 2) * mProgress, mPadding * 2);
 }
 
-void refill_fifo() {
-    int mNumRequiredSamples = fStretcher.get_required_samples();
-    if (mNumRequiredSamples > 0) {
-        float* mInputBuffer = new float[mNumRequiredSamples];
-        int    mReadFrames  = fAudioFileReader.read(mNumRequiredSamples, mInputBuffer);
-        if (mReadFrames == mNumRequiredSamples) {
-            fStretcher.fill_input_buffer(mInputBuffer, mNumRequiredSamples);
-        } else {
-            for (int i = 0; i < mReadFrames; i++) {
-                fStretcher.get_input_buffer()[i] = mInputBuffer[i];
-            }
-            fAudioFileReader.rewind();
-            int mMissingSamples = mNumRequiredSamples - mReadFrames;
-            mReadFrames         = fAudioFileReader.read(mMissingSamples, mInputBuffer);
-            if (mReadFrames == mMissingSamples) {
-                for (int i = 0; i < mMissingSamples; i++) {
-                    fStretcher.get_input_buffer()[mReadFrames + i] = mInputBuffer[i];
-                }
-            }
-        }
-        delete[] mInputBuffer;
-    }
-
-    fStretcher.process_segment(fStretchedSampleBuffer);
-    for (int i = 0; i < fStretcher.get_output_buffer_size(); i++) {
-        fSampleFIFOBuffer.push(fStretchedSampleBuffer[i]);
-    }
+/* called from the worker thread of `PaulStretchStream` */
+void read_input(float* buffer, int number_of_samples) {
+    fAudioFileReader.read(number_of_samples, buffer, AudioFileReader::ReadStyle::LOOP);
+    fProgress.store((float) fAudioFileReader.current_position() / (float) fAudioFileReader.length(), std::memory_order_relaxed);
 }
 
 void audioEvent() {
+    fStretcher.read(fStretchedSampleBuffer.data(), audio_buffer_size);
     for (int i = 0; i < audio_buffer_size; i++) {
-        if (fSampleFIFOBuffer.empty()) {
-            refill_fifo();
-        }
-        const float mSample = fSampleFIFOBuffer.front();
-        fSampleFIFOBuffer.pop();
+        const float mSample = fStretchedSampleBuffer[i];
         for (int j = 0; j < output_channels; ++j) {
             audio_output_buffer[i * output_channels + j] = mSample;
         }
@@ -77,6 +56,6 @@ void audioEvent() {
 }
 
 void finish() {
-    delete[] fStretchedSampleBuffer;
+    fStretcher.stop();
     fAudioFileReader.close();
 }
\ No newline at end of file
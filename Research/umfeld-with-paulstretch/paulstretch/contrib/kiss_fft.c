@@ -18,8 +18,6 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
  fixed or floating point complex numbers.  It also delares the kf_ internal functions.
  */
 
-static kiss_fft_cpx* scratchbuf  = NULL;
-static size_t        nscratchbuf = 0;
 static kiss_fft_cpx* tmpbuf      = NULL;
 static size_t        ntmpbuf     = 0;
 
@@ -225,8 +223,10 @@ static void kf_bfly_generic(
     kiss_fft_cpx* twiddles = st->twiddles;
     kiss_fft_cpx  t;
     int           Norig = st->nfft;
-
-    CHECKBUF(scratchbuf, nscratchbuf, p);
+    /* the scratch buffer is local ( instead of a shared static buffer ) so that plans can be executed
+       concurrently from several threads */
+    kiss_fft_cpx  scratch_local[32];
+    kiss_fft_cpx* scratchbuf = p <= 32 ? scratch_local : (kiss_fft_cpx*) KISS_FFT_MALLOC(sizeof(kiss_fft_cpx) * p);
 
     for (u = 0; u < m; ++u) {
         k = u;
@@ -249,6 +249,7 @@ static void kf_bfly_generic(
             k += m;
         }
     }
+    if (scratchbuf != scratch_local) free(scratchbuf);
 }
 
 static void kf_work(
@@ -368,9 +369,6 @@ void kiss_fft(kiss_fft_cfg cfg, const kiss_fft_cpx* fin, kiss_fft_cpx* fout) {
    buffers from CHECKBUF
  */
 void kiss_fft_cleanup(void) {
-    free(scratchbuf);
-    scratchbuf  = NULL;
-    nscratchbuf = 0;
     free(tmpbuf);
     tmpbuf  = NULL;
     ntmpbuf = 0;
@@ -0,0 +1,426 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "MultichannelStretch.h"
+
+using namespace std;
+
+/**
+ * batch renderer for long recordings and large stretch factors ( linux, macOS ).
+ *
+ * - the input WAV or RF64 file is memory-mapped and read on demand by the render threads
+ * - output windows of all channels are rendered with one `MultichannelStretch` in chunks and appended
+ *   to a 32-bit float WAV file. files larger than 4 GB are written as RF64
+ * - memory use is bounded by the chunk size ( `--chunk` windows per channel ) independent of the
+ *   length of the input and the stretch factor
+ * - after every chunk the number of completed windows is stored in `OUTPUT.checkpoint`. an interrupted
+ *   render continues from the checkpoint with `--resume`
+ *
+ * usage: `PaulStretchBatchRender [options] INPUT.wav OUTPUT.wav`
+ */
+
+/* --- WAV input --- */
+
+struct WAVInput {
+    int            channels        = 0;
+    int            samplerate      = 0;
+    int            bits            = 0;
+    bool           is_float        = false;
+    const uint8_t* data            = nullptr; // first sample of the data chunk
+    size_t         frames          = 0;
+    size_t         bytes_per_frame = 0;
+    void*          mapping         = MAP_FAILED;
+    size_t         mapping_size    = 0;
+
+    ~WAVInput() {
+        if (mapping != MAP_FAILED) {
+            munmap(mapping, mapping_size);
+        }
+    }
+
+    float read_sample(size_t frame, int channel) const {
+        const uint8_t* p = data + frame * bytes_per_frame + channel * (bits / 8);
+        if (is_float) {
+            if (bits == 64) {
+                double s;
+                memcpy(&s, p, 8);
+                return (float) s;
+            }
+            float s;
+            memcpy(&s, p, 4);
+            return s;
+        }
+        switch (bits) {
+            case 8:
+                return (p[0] - 128) / 128.0f;
+            case 16:
+                return (int16_t) (p[0] | p[1] << 8) / 32768.0f;
+            case 24:
+                return (int32_t) ((uint32_t) p[0] << 8 | (uint32_t) p[1] << 16 | (uint32_t) p[2] << 24) / 2147483648.0f;
+            case 32:
+                return (int32_t) ((uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24) / 2147483648.0f;
+        }
+        return 0.0f;
+    }
+};
+
+static uint16_t read_u16(const uint8_t* p) { return p[0] | p[1] << 8; }
+static uint32_t read_u32(const uint8_t* p) { return (uint32_t) read_u16(p) | (uint32_t) read_u16(p + 2) << 16; }
+static uint64_t read_u64(const uint8_t* p) { return (uint64_t) read_u32(p) | (uint64_t) read_u32(p + 4) << 32; }
+
+static bool open_input(const string& path, WAVInput& input, string& error) {
+    const int mFile = open(path.c_str(), O_RDONLY);
+    if (mFile < 0) {
+        error = "could not open input file: " + path;
+        return false;
+    }
+    struct stat mStat;
+    fstat(mFile, &mStat);
+    input.mapping_size = (size_t) mStat.st_size;
+    input.mapping      = input.mapping_size > 0 ? mmap(nullptr, input.mapping_size, PROT_READ, MAP_SHARED, mFile, 0) : MAP_FAILED;
+    close(mFile);
+    if (input.mapping == MAP_FAILED) {
+        error = "could not map input file: " + path;
+        return false;
+    }
+    madvise(input.mapping, input.mapping_size, MADV_SEQUENTIAL);
+
+    const uint8_t* mFileData = (const uint8_t*) input.mapping;
+    const size_t   mFileSize = input.mapping_size;
+    const bool     mIsRF64   = mFileSize >= 12 && memcmp(mFileData, "RF64", 4) == 0;
+    if (mFileSize < 12 || (memcmp(mFileData, "RIFF", 4) != 0 && !mIsRF64) || memcmp(mFileData + 8, "WAVE", 4) != 0) {
+        error = "input is not a WAV or RF64 file";
+        return false;
+    }
+
+    uint64_t mDataSize   = 0;
+    uint64_t mDS64Size   = 0;
+    int      mFormat     = 0;
+    size_t   mDataOffset = 0;
+    size_t   mOffset     = 12;
+    while (mOffset + 8 <= mFileSize) {
+        const uint8_t* mChunk     = mFileData + mOffset;
+        uint64_t       mChunkSize = read_u32(mChunk + 4);
+        if (memcmp(mChunk, "ds64", 4) == 0 && mOffset + 8 + 16 <= mFileSize) {
+            mDS64Size = read_u64(mChunk + 8 + 8);
+        } else if (memcmp(mChunk, "fmt ", 4) == 0 && mOffset + 8 + 16 <= mFileSize) {
+            mFormat          = read_u16(mChunk + 8);
+            input.channels   = read_u16(mChunk + 10);
+            input.samplerate = (int) read_u32(mChunk + 12);
+            input.bits       = read_u16(mChunk + 22);
+            if (mFormat == 0xFFFE && mChunkSize >= 40) {
+                mFormat = read_u16(mChunk + 8 + 24); // sub format of WAVE_FORMAT_EXTENSIBLE
+            }
+        } else if (memcmp(mChunk, "data", 4) == 0) {
+            if (mIsRF64 && mChunkSize == 0xFFFFFFFF) {
+                mChunkSize = mDS64Size;
+            }
+            mDataOffset = mOffset + 8;
+            mDataSize   = std::min<uint64_t>(mChunkSize, mFileSize - mDataOffset); // tolerate truncated files
+            break;
+        }
+        mOffset += 8 + mChunkSize + (mChunkSize & 1);
+    }
+
+    input.is_float = mFormat == 3;
+    if (mDataOffset == 0 || input.channels == 0 || (mFormat != 1 && mFormat != 3)) {
+        error = "unsupported WAV format ( PCM and IEEE float are supported )";
+        return false;
+    }
+    if ((input.is_float && input.bits != 32 && input.bits != 64) || (!input.is_float && (input.bits % 8 != 0 || input.bits < 8 || input.bits > 32))) {
+        error = "unsupported sample size: " + to_string(input.bits) + " bit";
+        return false;
+    }
+    input.bytes_per_frame = (size_t) input.channels * input.bits / 8;
+    input.data            = mFileData + mDataOffset;
+    input.frames          = mDataSize / input.bytes_per_frame;
+    return true;
+}
+
+/* --- WAV output --- */
+
+/*
+ * the header has the same size for RIFF and RF64: a RIFF file reserves the space of the `ds64` chunk
+ * with a `JUNK` chunk. the number of output frames is known before rendering, therefore the header is
+ * complete from the start and an interrupted file only lacks samples.
+ */
+static const size_t OUTPUT_HEADER_SIZE = 12 + 8 + 28 + 8 + 18 + 8;
+
+static void write_u16(uint8_t*& p, uint16_t v) {
+    *p++ = v & 0xFF;
+    *p++ = v >> 8;
+}
+
+static void write_u32(uint8_t*& p, uint32_t v) {
+    write_u16(p, v & 0xFFFF);
+    write_u16(p, v >> 16);
+}
+
+static void write_u64(uint8_t*& p, uint64_t v) {
+    write_u32(p, v & 0xFFFFFFFF);
+    write_u32(p, v >> 32);
+}
+
+static void write_tag(uint8_t*& p, const char* tag) {
+    memcpy(p, tag, 4);
+    p += 4;
+}
+
+static bool write_output_header(FILE* file, int channels, int samplerate, uint64_t frames) {
+    const uint64_t mDataSize = frames * channels * sizeof(float);
+    const uint64_t mRIFFSize = OUTPUT_HEADER_SIZE - 8 + mDataSize;
+    const bool     mIsRF64   = mRIFFSize > 0xFFFFFFFF;
+    uint8_t        mHeader[OUTPUT_HEADER_SIZE];
+    uint8_t*       p = mHeader;
+
+    write_tag(p, mIsRF64 ? "RF64" : "RIFF");
+    write_u32(p, mIsRF64 ? 0xFFFFFFFF : (uint32_t) mRIFFSize);
+    write_tag(p, "WAVE");
+    write_tag(p, mIsRF64 ? "ds64" : "JUNK");
+    write_u32(p, 28);
+    write_u64(p, mIsRF64 ? mRIFFSize : 0);
+    write_u64(p, mIsRF64 ? mDataSize : 0);
+    write_u64(p, mIsRF64 ? frames : 0);
+    write_u32(p, 0); // table length
+    write_tag(p, "fmt ");
+    write_u32(p, 18);
+    write_u16(p, 3); // IEEE float
+    write_u16(p, (uint16_t) channels);
+    write_u32(p, (uint32_t) samplerate);
+    write_u32(p, (uint32_t) (samplerate * channels * sizeof(float)));
+    write_u16(p, (uint16_t) (channels * sizeof(float)));
+    write_u16(p, 32);
+    write_u16(p, 0); // extension size
+    write_tag(p, "data");
+    write_u32(p, mIsRF64 ? 0xFFFFFFFF : (uint32_t) mDataSize);
+    return fwrite(mHeader, 1, OUTPUT_HEADER_SIZE, file) == OUTPUT_HEADER_SIZE;
+}
+
+/* --- checkpoint --- */
+
+struct Checkpoint {
+    size_t       input_frames    = 0;
+    int          channels        = 0;
+    float        stretch         = 0.0f;
+    int          buffer_size     = 0;
+    unsigned int rand_seed       = 0;
+    size_t       windows_written = 0;
+
+    bool matches(const Checkpoint& other) const {
+        return input_frames == other.input_frames &&
+               channels == other.channels &&
+               stretch == other.stretch &&
+               buffer_size == other.buffer_size &&
+               rand_seed == other.rand_seed;
+    }
+};
+
+static bool read_checkpoint(const string& path, Checkpoint& checkpoint) {
+    ifstream mFile(path);
+    return (bool) (mFile >> checkpoint.input_frames >> checkpoint.channels >> checkpoint.stretch >> checkpoint.buffer_size >> checkpoint.rand_seed >> checkpoint.windows_written);
+}
+
+static void write_checkpoint(const string& path, const Checkpoint& checkpoint) {
+    /* written to a temporary file and renamed so that an interruption never leaves a partial checkpoint */
+    const string mTemporaryPath = path + ".tmp";
+    {
+        ofstream mFile(mTemporaryPath);
+        mFile.precision(9);
+        mFile << checkpoint.input_frames << " " << checkpoint.channels << " " << checkpoint.stretch << " "
+              << checkpoint.buffer_size << " " << checkpoint.rand_seed << " " << checkpoint.windows_written << endl;
+    }
+    rename(mTemporaryPath.c_str(), path.c_str());
+}
+
+/* --- render --- */
+
+struct Options {
+    string       input_path;
+    string       output_path;
+    float        stretch        = 8.0f;
+    float        buffer_seconds = 0.25f;
+    int          threads        = 0;
+    size_t       chunk_windows  = 64;
+    unsigned int rand_seed      = 1;
+    bool         resume         = false;
+};
+
+static void print_usage() {
+    cerr << "usage: PaulStretchBatchRender [options] INPUT.wav OUTPUT.wav" << endl
+         << endl
+         << "  -s, --stretch FACTOR   stretch factor ( default 8 )" << endl
+         << "  -b, --buffer SECONDS   window duration ( default 0.25 )" << endl
+         << "  -t, --threads N        render threads, 0 for all cores ( default 0 )" << endl
+         << "  -c, --chunk WINDOWS    windows rendered per chunk ( default 64 )" << endl
+         << "      --seed SEED        phase randomization seed ( default 1 )" << endl
+         << "  -r, --resume           continue an interrupted render from OUTPUT.wav.checkpoint" << endl;
+}
+
+static bool parse_options(int argc, char** argv, Options& options) {
+    vector<string> mPositional;
+    for (int i = 1; i < argc; i++) {
+        const string mArgument = argv[i];
+        const bool   mHasValue = i + 1 < argc;
+        if ((mArgument == "-s" || mArgument == "--stretch") && mHasValue) {
+            options.stretch = (float) atof(argv[++i]);
+        } else if ((mArgument == "-b" || mArgument == "--buffer") && mHasValue) {
+            options.buffer_seconds = (float) atof(argv[++i]);
+        } else if ((mArgument == "-t" || mArgument == "--threads") && mHasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if ((mArgument == "-c" || mArgument == "--chunk") && mHasValue) {
+            options.chunk_windows = (size_t) std::max(1, atoi(argv[++i]));
+        } else if (mArgument == "--seed" && mHasValue) {
+            options.rand_seed = (unsigned int) strtoul(argv[++i], nullptr, 10);
+        } else if (mArgument == "-r" || mArgument == "--resume") {
+            options.resume = true;
+        } else if (!mArgument.empty() && mArgument[0] == '-') {
+            return false;
+        } else {
+            mPositional.push_back(mArgument);
+        }
+    }
+    if (mPositional.size() != 2 || options.stretch < 1.0f || options.buffer_seconds <= 0.0f) {
+        return false;
+    }
+    options.input_path  = mPositional[0];
+    options.output_path = mPositional[1];
+    return true;
+}
+
+static string format_duration(double seconds) {
+    char      mBuffer[32];
+    const int mSeconds = (int) seconds;
+    snprintf(mBuffer, sizeof(mBuffer), "%02d:%02d:%02d", mSeconds / 3600, mSeconds / 60 % 60, mSeconds % 60);
+    return mBuffer;
+}
+
+int main(int argc, char** argv) {
+    Options mOptions;
+    if (!parse_options(argc, argv, mOptions)) {
+        print_usage();
+        return 1;
+    }
+
+    WAVInput mInput;
+    string   mError;
+    if (!open_input(mOptions.input_path, mInput, mError)) {
+        cerr << "error: " << mError << endl;
+        return 1;
+    }
+
+    const int mChannels   = mInput.channels;
+    const int mBufferSize = std::max(8, (int) (mInput.samplerate * mOptions.buffer_seconds));
+
+    /* one renderer for all channels. the channels share the window schedule, each has its own seed */
+    MultichannelStretch mStretch(mOptions.stretch, mBufferSize, mChannels, mOptions.threads, FFT::_W_HANN, (float) mInput.samplerate);
+    for (int c = 0; c < mChannels; c++) {
+        mStretch.set_rand_seed(c, mOptions.rand_seed + c * 161103);
+    }
+    const size_t   mNumberOfWindows = mStretch.get_number_of_windows(mInput.frames);
+    const uint64_t mOutputFrames    = (uint64_t) mNumberOfWindows * mBufferSize;
+
+    Checkpoint mCheckpoint;
+    mCheckpoint.input_frames = mInput.frames;
+    mCheckpoint.channels     = mChannels;
+    mCheckpoint.stretch      = mOptions.stretch;
+    mCheckpoint.buffer_size  = mBufferSize;
+    mCheckpoint.rand_seed    = mOptions.rand_seed;
+
+    const string mCheckpointPath = mOptions.output_path + ".checkpoint";
+    size_t       mFirstWindow    = 0;
+    Checkpoint   mStoredCheckpoint;
+    if (mOptions.resume && read_checkpoint(mCheckpointPath, mStoredCheckpoint)) {
+        if (!mStoredCheckpoint.matches(mCheckpoint)) {
+            cerr << "error: checkpoint does not match input file or options" << endl;
+            return 1;
+        }
+        mFirstWindow = mStoredCheckpoint.windows_written;
+    }
+
+    FILE* mOutput = nullptr;
+    if (mFirstWindow > 0) {
+        mOutput = fopen(mOptions.output_path.c_str(), "r+b");
+        if (mOutput == nullptr || fseeko(mOutput, (off_t) (OUTPUT_HEADER_SIZE + (uint64_t) mFirstWindow * mBufferSize * mChannels * sizeof(float)), SEEK_SET) != 0) {
+            cerr << "error: could not resume output file: " << mOptions.output_path << endl;
+            return 1;
+        }
+    } else {
+        mOutput = fopen(mOptions.output_path.c_str(), "wb");
+        if (mOutput == nullptr || !write_output_header(mOutput, mChannels, mInput.samplerate, mOutputFrames)) {
+            cerr << "error: could not write output file: " << mOptions.output_path << endl;
+            return 1;
+        }
+    }
+
+    cout << "+++ paulstretch batch render" << endl
+         << endl
+         << "input          : " << mOptions.input_path << " ( " << mChannels << " channels, " << mInput.samplerate << " Hz, "
+         << format_duration((double) mInput.frames / mInput.samplerate) << " )" << endl
+         << "output         : " << mOptions.output_path << " ( " << (OUTPUT_HEADER_SIZE - 8 + mOutputFrames * mChannels * sizeof(float) > 0xFFFFFFFFull ? "RF64" : "WAV")
+         << ", " << format_duration((double) mOutputFrames / mInput.samplerate) << " )" << endl
+         << "stretch        : " << mOptions.stretch << "x" << endl
+         << "buffer size    : " << mBufferSize << endl
+         << "threads        : " << mStretch.get_number_of_threads() << endl
+         << "windows        : " << mNumberOfWindows << endl;
+    if (mFirstWindow > 0) {
+        cout << "resuming from  : window " << mFirstWindow << endl;
+    }
+    cout << endl;
+
+    /* samples are read directly from the mapped file and converted per channel */
+    const MultichannelStretch::InputReader mReader = [&mInput](int channel, size_t position, float* buffer, int number_of_samples) {
+        for (int i = 0; i < number_of_samples; i++) {
+            const size_t mFrame = position + i;
+            buffer[i]           = mFrame < mInput.frames ? mInput.read_sample(mFrame, channel) : 0.0f;
+        }
+    };
+
+    const size_t  mChunkWindows = mOptions.chunk_windows;
+    vector<float> mInterleaved(mChunkWindows * mBufferSize * mChannels);
+    const auto    mStart  = chrono::steady_clock::now();
+    size_t        mWindow = mFirstWindow;
+    while (mWindow < mNumberOfWindows) {
+        const size_t mNumWindows = std::min(mChunkWindows, mNumberOfWindows - mWindow);
+        const size_t mFrames     = mNumWindows * mBufferSize;
+        mStretch.render(mReader, mInput.frames, mWindow, mNumWindows, mInterleaved.data());
+        if (fwrite(mInterleaved.data(), sizeof(float), mFrames * mChannels, mOutput) != mFrames * mChannels || fflush(mOutput) != 0) {
+            cerr << endl
+                 << "error: could not write output file: " << strerror(errno) << endl;
+            fclose(mOutput);
+            return 1;
+        }
+        fsync(fileno(mOutput));
+        mWindow += mNumWindows;
+        mCheckpoint.windows_written = mWindow;
+        write_checkpoint(mCheckpointPath, mCheckpoint);
+
+        const double mSeconds    = chrono::duration<double>(chrono::steady_clock::now() - mStart).count();
+        const double mRate       = (mWindow - mFirstWindow) * (double) mBufferSize / mSeconds;
+        const double mRemaining  = (mNumberOfWindows - mWindow) * (double) mBufferSize / mRate;
+        char         mStatus[160];
+        snprintf(mStatus, sizeof(mStatus), "\r%6.2f%%  %zu / %zu windows  %.0f frames/sec ( %.1fx realtime )  ETA %s ",
+                 100.0 * mWindow / mNumberOfWindows, mWindow, mNumberOfWindows, mRate, mRate / mInput.samplerate, format_duration(mRemaining).c_str());
+        cout << mStatus << flush;
+    }
+    fclose(mOutput);
+    remove(mCheckpointPath.c_str());
+
+    cout << endl
+         << endl
+         << "done in " << format_duration(chrono::duration<double>(chrono::steady_clock::now() - mStart).count()) << endl;
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <queue>
+#include <vector>
+
+#include "PaulStretch.h"
+
+using namespace std;
+
+/**
+ * compares the sample handoff between `PaulStretch` and an audio callback:
+ *
+ * - queue  : input is read into a temporary buffer and copied with `fill_input_buffer()`, output is
+ *            copied with `process_segment()` and passed sample by sample through a `std::queue<float>`
+ * - render : input is passed with `push()` and output is copied once with `render()`
+ *
+ * allocations are counted with a replaced global `operator new`. sample copies are counted for the
+ * handoff only ( the copies inside `ProcessedStretch` are the same for both paths ).
+ */
+
+static const int    STRETCH           = 8;
+static const int    SAMPLE_RATE       = 48000;
+static const int    BUFFER_SIZE       = SAMPLE_RATE / 4;
+static const int    AUDIO_BUFFER_SIZE = 512;
+static const size_t OUTPUT_SAMPLES    = (size_t) SAMPLE_RATE * 60;
+static const int    RAND_SEED         = 1;
+
+static size_t fAllocations = 0;
+
+void* operator new(size_t size) {
+    fAllocations++;
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+struct Result {
+    double        seconds;
+    size_t        allocations;
+    size_t        copies;
+    vector<float> output;
+};
+
+static void read_input(size_t& position, float* buffer, int number_of_samples) {
+    for (int i = 0; i < number_of_samples; i++) {
+        const size_t p = position + i;
+        buffer[i]      = 0.5f * sin(p * 0.01f) + 0.1f * sin(p * 0.37f);
+    }
+    position += number_of_samples;
+}
+
+static Result run_queue() {
+    Result        mResult = {};
+    PaulStretch   mStretch(STRETCH, BUFFER_SIZE, SAMPLE_RATE);
+    float*        mStretchedSamples = new float[mStretch.get_output_buffer_size()];
+    queue<float>  mFIFO;
+    vector<float> mAudioBuffer(AUDIO_BUFFER_SIZE);
+    size_t        mPosition = 0;
+    mStretch.set_rand_seed(RAND_SEED);
+    mResult.output.reserve(OUTPUT_SAMPLES);
+
+    const size_t mAllocations = fAllocations;
+    const auto   mStart       = chrono::steady_clock::now();
+    while (mResult.output.size() < OUTPUT_SAMPLES) {
+        for (int i = 0; i < AUDIO_BUFFER_SIZE; i++) {
+            if (mFIFO.empty()) {
+                const int mNumRequiredSamples = mStretch.get_required_samples();
+                if (mNumRequiredSamples > 0) {
+                    float* mInputBuffer = new float[mNumRequiredSamples];
+                    read_input(mPosition, mInputBuffer, mNumRequiredSamples);
+                    mStretch.fill_input_buffer(mInputBuffer, mNumRequiredSamples);
+                    mResult.copies += mNumRequiredSamples;
+                    delete[] mInputBuffer;
+                }
+                mStretch.process_segment(mStretchedSamples);
+                for (int j = 0; j < mStretch.get_output_buffer_size(); j++) {
+                    mFIFO.push(mStretchedSamples[j]);
+                }
+                mResult.copies += mStretch.get_output_buffer_size() * 2;
+            }
+            mAudioBuffer[i] = mFIFO.front();
+            mFIFO.pop();
+            mResult.copies++;
+        }
+        mResult.output.insert(mResult.output.end(), mAudioBuffer.begin(), mAudioBuffer.end());
+    }
+    mResult.seconds     = chrono::duration<double>(chrono::steady_clock::now() - mStart).count();
+    mResult.allocations = fAllocations - mAllocations;
+    delete[] mStretchedSamples;
+    return mResult;
+}
+
+static Result run_render() {
+    Result        mResult = {};
+    PaulStretch   mStretch(STRETCH, BUFFER_SIZE, SAMPLE_RATE);
+    vector<float> mInputBuffer(mStretch.get_required_samples());
+    vector<float> mAudioBuffer(AUDIO_BUFFER_SIZE);
+    size_t        mPosition = 0;
+    mStretch.set_rand_seed(RAND_SEED);
+    mResult.output.reserve(OUTPUT_SAMPLES);
+
+    const size_t mAllocations = fAllocations;
+    const auto   mStart       = chrono::steady_clock::now();
+    while (mResult.output.size() < OUTPUT_SAMPLES) {
+        size_t mFrames = mStretch.render(mAudioBuffer.data(), AUDIO_BUFFER_SIZE);
+        while (mFrames < (size_t) AUDIO_BUFFER_SIZE) {
+            const int mNumRequiredSamples = mStretch.get_required_samples();
+            read_input(mPosition, mInputBuffer.data(), mNumRequiredSamples);
+            mStretch.push(mInputBuffer.data(), mNumRequiredSamples);
+            mFrames += mStretch.render(mAudioBuffer.data() + mFrames, AUDIO_BUFFER_SIZE - mFrames);
+        }
+        mResult.copies += AUDIO_BUFFER_SIZE;
+        mResult.output.insert(mResult.output.end(), mAudioBuffer.begin(), mAudioBuffer.end());
+    }
+    mResult.seconds     = chrono::duration<double>(chrono::steady_clock::now() - mStart).count();
+    mResult.allocations = fAllocations - mAllocations;
+    return mResult;
+}
+
+static void report(const char* name, const Result& result) {
+    const double mAudioSeconds = (double) result.output.size() / SAMPLE_RATE;
+    cout << left << setw(10) << name << right
+         << setw(12) << fixed << setprecision(3) << result.seconds << " sec"
+         << setw(14) << setprecision(1) << result.allocations / mAudioSeconds
+         << setw(16) << result.copies / mAudioSeconds
+         << setw(14) << setprecision(2) << (double) result.copies / result.output.size() << endl;
+}
+
+int main() {
+    cout << "+++ paulstretch benchmark ( block handoff )" << endl
+         << endl
+         << "stretch           : " << STRETCH << "x" << endl
+         << "buffer size       : " << BUFFER_SIZE << endl
+         << "audio buffer size : " << AUDIO_BUFFER_SIZE << endl
+         << "output duration   : " << OUTPUT_SAMPLES / SAMPLE_RATE << " sec" << endl
+         << endl
+         << left << setw(10) << "path" << right << setw(16) << "time" << setw(14) << "allocs/sec" << setw(16) << "copies/sec" << setw(14) << "copies/smp" << endl
+         << "( per second of output audio )" << endl;
+
+    const Result mQueue  = run_queue();
+    const Result mRender = run_render();
+    report("queue", mQueue);
+    report("render", mRender);
+
+    const bool mIdentical = mQueue.output == mRender.output;
+    cout << endl
+         << "output " << (mIdentical ? "identical" : "differs") << endl;
+    return mIdentical ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "FFTBackend.h"
+#include "ProcessedStretch.h"
+
+using namespace std;
+
+/**
+ * measures the forward and inverse transform of every available FFT backend for sizes from 2^12 to
+ * 2^17. each backend is checked against kissfft and the cost of creating an `FFT` instance is
+ * compared with and without a cached plan.
+ */
+
+static const int   MIN_EXPONENT = 12;
+static const int   MAX_EXPONENT = 17;
+static const float TOLERANCE    = 1e-4f; // relative to the largest magnitude of the spectrum
+
+static double measure_ns(const function<void()>& kernel, int iterations) {
+    kernel(); // warm up
+    const auto mStart = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        kernel();
+    }
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - mStart).count() / iterations;
+}
+
+static float max_error(const vector<float>& a, const vector<float>& b, int n) {
+    float mError = 0.0f, mMax = 0.0f;
+    for (int i = 0; i < n; i++) {
+        mError = max(mError, fabs(a[i] - b[i]));
+        mMax   = max(mMax, fabs(a[i]));
+    }
+    return mMax > 0.0f ? mError / mMax : mError;
+}
+
+int main() {
+    FFTBackend* mReference = FFTBackend::get("kissfft");
+
+    cout << "+++ paulstretch benchmark ( FFT backends )" << endl
+         << endl
+         << "backends        :";
+    for (FFTBackend* mBackend: FFTBackend::get_available()) {
+        cout << " " << mBackend->get_name();
+    }
+    cout << endl
+         << "default backend : " << FFTBackend::get_default()->get_name() << endl
+         << endl
+         << left << setw(12) << "backend" << right << setw(8) << "size" << setw(15) << "forward" << setw(15) << "inverse" << setw(14) << "max error" << endl;
+
+    bool mPassed = true;
+    for (FFTBackend* mBackend: FFTBackend::get_available()) {
+        for (int e = MIN_EXPONENT; e <= MAX_EXPONENT; e++) {
+            const int                      n          = 1 << e;
+            const int                      iterations = max(20, (1 << 22) / n);
+            std::shared_ptr<const FFTPlan> mForward   = mBackend->get_plan(n, false);
+            std::shared_ptr<const FFTPlan> mInverse   = mBackend->get_plan(n, true);
+            vector<float>                  mSignal(n + 2), mInput(n + 2), mSpectrum(n + 2), mExpected(n + 2);
+            vector<float>                  mWork(max(mForward->get_work_size(), mInverse->get_work_size()) + 1);
+            unsigned int                   mNoise = 23;
+            for (int i = 0; i < n; i++) {
+                mNoise     = mNoise * 1664525 + 1013904223;
+                mSignal[i] = (mNoise >> 8) / 8388608.0f - 1.0f;
+            }
+
+            /* `input` may be overwritten by the plan, therefore it is restored before each transform */
+            const double mForwardNs = measure_ns([&] { mInput = mSignal; mForward->execute(mInput.data(), mSpectrum.data(), mWork.data()); }, iterations);
+            const double mInverseNs = measure_ns([&] { mInput = mSpectrum; mInverse->execute(mInput.data(), mExpected.data(), mWork.data()); }, iterations);
+
+            mInput = mSignal;
+            mForward->execute(mInput.data(), mSpectrum.data(), mWork.data());
+            mInput = mSignal;
+            vector<float> mReferenceWork(mReference->get_plan(n, false)->get_work_size() + 1);
+            mReference->get_plan(n, false)->execute(mInput.data(), mExpected.data(), mReferenceWork.data());
+            const float mError = max_error(mExpected, mSpectrum, n + 2);
+            mPassed &= mError <= TOLERANCE;
+
+            cout << left << setw(12) << mBackend->get_name() << right
+                 << setw(8) << n
+                 << setw(12) << fixed << setprecision(1) << mForwardNs / 1000.0 << " us"
+                 << setw(12) << mInverseNs / 1000.0 << " us"
+                 << setw(14) << scientific << setprecision(2) << mError
+                 << (mError <= TOLERANCE ? "  OK" : "  FAILED") << endl;
+        }
+    }
+
+    /* `FFT` instances of the same size share their plans */
+    const int n = 1 << MAX_EXPONENT;
+    cout << endl
+         << left << setw(12) << "backend" << right << setw(20) << "FFT() uncached" << setw(20) << "FFT() cached" << setw(10) << "plans" << endl;
+    for (FFTBackend* mBackend: FFTBackend::get_available()) {
+        mBackend->clear_plan_cache();
+        const auto mStart = chrono::steady_clock::now();
+        FFT*       mFirst = new FFT(n, mBackend);
+        const auto mEnd   = chrono::steady_clock::now();
+        const double mCachedNs = measure_ns([&] { FFT mFFT(n, mBackend); }, 20);
+        cout << left << setw(12) << mBackend->get_name() << right
+             << setw(17) << fixed << setprecision(1) << chrono::duration<double, micro>(mEnd - mStart).count() << " us"
+             << setw(17) << mCachedNs / 1000.0 << " us"
+             << setw(10) << mBackend->get_number_of_cached_plans() << endl;
+        delete mFirst;
+    }
+
+    cout << endl
+         << (mPassed ? "all backends within tolerance" : "backends exceed tolerance") << endl;
+    return mPassed ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ProcessedStretch.h"
+#include "StretchKernels.h"
+
+using namespace std;
+
+/**
+ * compares the scalar double-precision loops of the original `ProcessedStretch` and `FFT` with the
+ * kernels in `StretchKernels` at a buffer size of 16384. each kernel is timed and checked against the
+ * original implementation with an accuracy tolerance.
+ */
+
+static const int   BUFFER_SIZE = 16384;
+static const int   NSAMPLES    = BUFFER_SIZE * 2;
+static const int   ITERATIONS  = 200;
+static const float TOLERANCE   = 1e-5f;
+
+static double measure_ns(const function<void()>& kernel) {
+    kernel(); // warm up
+    const auto mStart = chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        kernel();
+    }
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - mStart).count() / ITERATIONS;
+}
+
+static float max_error(const vector<float>& a, const vector<float>& b) {
+    float mError = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        mError = max(mError, fabs(a[i] - b[i]));
+    }
+    return mError;
+}
+
+static bool report(const char* name, double old_ns, double new_ns, float error) {
+    const bool mPassed = error <= TOLERANCE;
+    cout << left << setw(12) << name << right
+         << setw(12) << fixed << setprecision(1) << old_ns / 1000.0 << " us"
+         << setw(12) << new_ns / 1000.0 << " us"
+         << setw(9) << setprecision(2) << old_ns / new_ns << "x"
+         << setw(14) << scientific << setprecision(2) << error
+         << (mPassed ? "  OK" : "  FAILED") << endl;
+    return mPassed;
+}
+
+int main() {
+    vector<float> mSignal(NSAMPLES);
+    vector<float> mOther(NSAMPLES);
+    unsigned int  mNoise = 23;
+    for (int i = 0; i < NSAMPLES; i++) {
+        mNoise     = mNoise * 1664525 + 1013904223;
+        mSignal[i] = (mNoise >> 8) / 8388608.0f - 1.0f;
+        mOther[i]  = sin(i * 0.01f);
+    }
+
+    cout << "+++ paulstretch benchmark ( kernels )" << endl
+         << endl
+         << "instruction set : " << StretchKernels::get_instruction_set() << endl
+         << "buffer size     : " << BUFFER_SIZE << endl
+         << endl
+         << left << setw(12) << "kernel" << right << setw(15) << "old" << setw(15) << "new" << setw(10) << "speedup" << setw(14) << "max error" << endl;
+
+    bool mPassed = true;
+
+    /* window */
+    {
+        vector<float> mWindow(NSAMPLES);
+        for (int i = 0; i < NSAMPLES; i++) mWindow[i] = 0.5 * (1.0 - cos(2 * M_PI * i / (NSAMPLES - 1.0)));
+        vector<float> mOld = mSignal, mNew = mSignal;
+        const double  mOldNs = measure_ns([&] { mOld = mSignal; for (int i = 0; i < NSAMPLES; i++) mOld[i] *= mWindow[i]; });
+        const double  mNewNs = measure_ns([&] { mNew = mSignal; StretchKernels::multiply(mNew.data(), mWindow.data(), NSAMPLES); });
+        mPassed &= report("window", mOldNs, mNewNs, max_error(mOld, mNew));
+    }
+
+    /* magnitude */
+    {
+        vector<float> mOld(BUFFER_SIZE), mNew(BUFFER_SIZE);
+        const double  mOldNs = measure_ns([&] {
+            for (int i = 0; i < BUFFER_SIZE; i++) {
+                float c = mSignal[i * 2];
+                float s = mSignal[i * 2 + 1];
+                mOld[i] = sqrt((double) c * c + (double) s * s);
+            }
+        });
+        const double  mNewNs = measure_ns([&] { StretchKernels::magnitude(mSignal.data(), mNew.data(), BUFFER_SIZE); });
+        mPassed &= report("magnitude", mOldNs, mNewNs, max_error(mOld, mNew));
+    }
+
+    /* random phase */
+    {
+        vector<float> mOld(NSAMPLES), mNew(NSAMPLES);
+        const double  mOldNs = measure_ns([&] {
+            unsigned int rand_seed    = 1;
+            double       inv_2p15_2pi = 1.0 / 16384.0 * M_PI;
+            for (int i = 0; i < BUFFER_SIZE; i++) {
+                rand_seed         = (rand_seed * 1103515245 + 12345);
+                unsigned int rand = (rand_seed >> 16) & 0x7fff;
+                double       phase = rand * inv_2p15_2pi;
+                mOld[i * 2]       = mOther[i] * cos(phase);
+                mOld[i * 2 + 1]   = mOther[i] * sin(phase);
+            }
+        });
+        const double  mNewNs = measure_ns([&] {
+            unsigned int rand_seed = 1;
+            const float* sincos    = StretchKernels::get_sincos_table();
+            for (int i = 0; i < BUFFER_SIZE; i++) {
+                rand_seed         = (rand_seed * 1103515245 + 12345);
+                unsigned int rand = (rand_seed >> 16) & 0x7fff;
+                mNew[i * 2]       = mOther[i] * sincos[rand * 2];
+                mNew[i * 2 + 1]   = mOther[i] * sincos[rand * 2 + 1];
+            }
+        });
+        mPassed &= report("phase", mOldNs, mNewNs, max_error(mOld, mNew));
+    }
+
+    /* log spectrum mapping of `spread()` ( per bin `exp()` vs. precomputed positions ) */
+    {
+        const int     nfreq   = BUFFER_SIZE;
+        const float   maxfreq = 0.5 * 44100;
+        const float   log_min = log(20.0f), log_max = log(maxfreq);
+        vector<float> mOld(nfreq), mNew(nfreq), mPositions(nfreq);
+        vector<int>   mIndices(nfreq);
+        for (int i = 0; i < nfreq; i++) {
+            const float x = exp(log_min + i / (float) nfreq * (log_max - log_min)) / maxfreq * nfreq;
+            mIndices[i]   = x < nfreq ? min((int) floor(x), nfreq - 1) : -1;
+            mPositions[i] = x - floor(x);
+        }
+        const double mOldNs = measure_ns([&] {
+            for (int i = 0; i < nfreq; i++) {
+                float x  = exp(log_min + i / (float) nfreq * (log_max - log_min)) / maxfreq * nfreq;
+                int   x0 = min((int) floor(x), nfreq - 1);
+                int   x1 = min(x0 + 1, nfreq - 1);
+                float xp = x - x0;
+                mOld[i]  = x < nfreq ? mOther[x0] * (1.0 - xp) + mOther[x1] * xp : 0.0;
+            }
+        });
+        const double mNewNs = measure_ns([&] {
+            for (int i = 0; i < nfreq; i++) {
+                const int x0 = mIndices[i];
+                if (x0 < 0) {
+                    mNew[i] = 0.0f;
+                    continue;
+                }
+                const int   x1 = min(x0 + 1, nfreq - 1);
+                const float xp = mPositions[i];
+                mNew[i]        = mOther[x0] * (1.0 - xp) + mOther[x1] * xp;
+            }
+        });
+        mPassed &= report("spread", mOldNs, mNewNs, max_error(mOld, mNew));
+    }
+
+    /* output crossfade */
+    {
+        vector<float>   mOld(BUFFER_SIZE), mNew(BUFFER_SIZE);
+        OutputCrossfade mCrossfade(BUFFER_SIZE);
+        const double    mOldNs = measure_ns([&] {
+            float tmp        = 1.0 / (float) BUFFER_SIZE * M_PI;
+            float hinv_sqrt2 = 0.853553390593;
+            float ampfactor  = 2.0;
+            for (int i = 0; i < BUFFER_SIZE; i++) {
+                float a    = (0.5 + 0.5 * cos(i * tmp));
+                float out  = mSignal[i + BUFFER_SIZE] * (1.0 - a) + mOther[i] * a;
+                mOld[i]    = out * (hinv_sqrt2 - (1.0 - hinv_sqrt2) * cos(i * 2.0 * tmp)) * ampfactor;
+            }
+        });
+        const double    mNewNs = measure_ns([&] { mCrossfade.process(mSignal.data(), mOther.data(), mNew.data()); });
+        mPassed &= report("crossfade", mOldNs, mNewNs, max_error(mOld, mNew));
+    }
+
+    cout << endl
+         << (mPassed ? "all kernels within tolerance" : "kernels exceed tolerance") << endl;
+    return mPassed ? 0 : 1;
+}
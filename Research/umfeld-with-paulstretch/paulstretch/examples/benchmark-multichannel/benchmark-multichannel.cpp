@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MultichannelStretch.h"
+#include "ProcessedStretch.h"
+
+using namespace std;
+
+/**
+ * compares N separate mono `ProcessedStretch` instances with one `MultichannelStretch` for stereo and
+ * 8-channel ( 2nd order ambisonic + 1 ) material. reports throughput in output frames per second,
+ * the memory allocated by each setup and checks that all channels are sample-identical.
+ */
+
+static const int    SAMPLE_RATE = 48000;
+static const int    BUFFER_SIZE = SAMPLE_RATE / 4;
+static const float  STRETCH     = 8.0f;
+static const size_t WINDOWS     = 160;
+
+static size_t fAllocatedBytes = 0;
+
+void* operator new(size_t size) {
+    fAllocatedBytes += size;
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+static double seconds_since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static float input_sample(int channel, size_t position) {
+    return 0.5f * sin(position * (0.01f + channel * 0.003f)) + 0.1f * sin(position * 0.37f);
+}
+
+static void report(const char* name, double seconds, size_t bytes, bool identical) {
+    cout << left << setw(18) << name << right
+         << setw(14) << fixed << setprecision(0) << WINDOWS * BUFFER_SIZE / seconds << " frames/sec"
+         << setw(10) << setprecision(1) << bytes / 1048576.0 << " MB"
+         << (identical ? "  identical" : "  DIFFERS") << endl;
+}
+
+static bool run(int channels) {
+    vector<vector<float>> mInput(channels, vector<float>(BUFFER_SIZE * 3));
+    vector<float>         mInterleaved((size_t) BUFFER_SIZE * 3 * channels);
+    vector<vector<float>> mMonoOutput(channels, vector<float>(WINDOWS * BUFFER_SIZE));
+    vector<float>         mOutput((size_t) WINDOWS * BUFFER_SIZE * channels);
+
+    cout << endl
+         << channels << " channels" << endl;
+
+    /* N mono instances */
+    size_t                    mBytes = fAllocatedBytes;
+    vector<ProcessedStretch*> mMono;
+    for (int c = 0; c < channels; c++) {
+        mMono.push_back(new ProcessedStretch(STRETCH, BUFFER_SIZE, FFT::_W_HANN, false, SAMPLE_RATE));
+    }
+    const size_t mMonoBytes = fAllocatedBytes - mBytes;
+
+    vector<unsigned int> mSeeds;
+    for (int c = 0; c < channels; c++) {
+        mSeeds.push_back(mMono[c]->get_rand_seed());
+    }
+
+    size_t mPosition           = 0;
+    int    mNumRequiredSamples = mMono[0]->get_nsamples_for_fill();
+    auto   mStart              = chrono::steady_clock::now();
+    for (size_t w = 0; w < WINDOWS; w++) {
+        for (int c = 0; c < channels; c++) {
+            for (int i = 0; i < mNumRequiredSamples; i++) mInput[c][i] = input_sample(c, mPosition + i);
+            mMono[c]->process(mInput[c].data(), mNumRequiredSamples);
+            copy(mMono[c]->out_buf, mMono[c]->out_buf + BUFFER_SIZE, mMonoOutput[c].begin() + w * BUFFER_SIZE);
+        }
+        mPosition += mNumRequiredSamples;
+        mNumRequiredSamples = mMono[0]->get_nsamples(0);
+    }
+    report("mono instances", seconds_since(mStart), mMonoBytes, true);
+    for (ProcessedStretch* mStretch: mMono) {
+        delete mStretch;
+    }
+
+    /* one multichannel instance ( single thread and all cores ) */
+    bool mAllIdentical = true;
+    for (const int mNumThreads: {1, 0}) {
+        mBytes = fAllocatedBytes;
+        MultichannelStretch mStretch(STRETCH, BUFFER_SIZE, channels, mNumThreads, FFT::_W_HANN, SAMPLE_RATE);
+        const size_t        mMultiBytes = fAllocatedBytes - mBytes;
+        for (int c = 0; c < channels; c++) {
+            mStretch.set_rand_seed(c, mSeeds[c]);
+        }
+
+        mPosition           = 0;
+        mNumRequiredSamples = mStretch.get_nsamples_for_fill();
+        mStart              = chrono::steady_clock::now();
+        for (size_t w = 0; w < WINDOWS; w++) {
+            for (int i = 0; i < mNumRequiredSamples; i++) {
+                for (int c = 0; c < channels; c++) mInterleaved[(size_t) i * channels + c] = input_sample(c, mPosition + i);
+            }
+            mStretch.process_interleaved(mInterleaved.data(), mNumRequiredSamples);
+            mStretch.get_interleaved_output(mOutput.data() + w * BUFFER_SIZE * channels);
+            mPosition += mNumRequiredSamples;
+            mNumRequiredSamples = mStretch.get_nsamples();
+        }
+        const double mSeconds = seconds_since(mStart);
+
+        bool mIdentical = true;
+        for (size_t i = 0; i < WINDOWS * BUFFER_SIZE; i++) {
+            for (int c = 0; c < channels; c++) mIdentical &= mOutput[i * channels + c] == mMonoOutput[c][i];
+        }
+        mAllIdentical &= mIdentical;
+        const string mName = "multichannel x" + to_string(min(mStretch.get_number_of_threads(), channels)); // one thread per channel
+        report(mName.c_str(), mSeconds, mMultiBytes, mIdentical);
+    }
+    return mAllIdentical;
+}
+
+int main() {
+    cout << "+++ paulstretch benchmark ( multichannel )" << endl
+         << endl
+         << "stretch     : " << STRETCH << "x" << endl
+         << "buffer size : " << BUFFER_SIZE << endl
+         << "windows     : " << WINDOWS << endl
+         << "cores       : " << thread::hardware_concurrency() << endl;
+
+    FFT mPlans(BUFFER_SIZE * 2); // FFT plans are cached process-wide and shared by both setups
+
+    bool mPassed = true;
+    for (const int mChannels: {2, 8}) {
+        mPassed &= run(mChannels);
+    }
+    return mPassed ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "PaulStretch.h"
+#include "ParallelStretch.h"
+
+using namespace std;
+
+/**
+ * compares the serial `PaulStretch` path with `ParallelStretch` at different thread counts. reports
+ * throughput in output frames per second and checks that all renders are sample-identical.
+ */
+
+static double seconds_since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static vector<float> render_serial(const vector<float>& input, int stretch_value, int buffer_size, int samplerate, unsigned int seed, size_t number_of_windows) {
+    PaulStretch stretch(stretch_value, buffer_size, samplerate);
+    stretch.set_rand_seed(seed);
+    const int     mOutputBufferSize = stretch.get_output_buffer_size();
+    vector<float> mOutput(number_of_windows * mOutputBufferSize);
+    size_t        mReadPosition = 0;
+    for (size_t i = 0; i < number_of_windows; i++) {
+        const int mNumRequiredSamples = stretch.get_required_samples();
+        for (int j = 0; j < mNumRequiredSamples; j++) {
+            const size_t mPosition           = mReadPosition + j;
+            stretch.get_input_buffer()[j] = mPosition < input.size() ? input[mPosition] : 0.0f;
+        }
+        mReadPosition += mNumRequiredSamples;
+        stretch.process_segment(mOutput.data() + i * mOutputBufferSize);
+    }
+    return mOutput;
+}
+
+int main(int argc, char** argv) {
+    const int    mSampleRate   = 48000;
+    const float  mDuration     = argc > 1 ? atof(argv[1]) : 10.0f;
+    const int    mStretchValue = argc > 2 ? atoi(argv[2]) : 8;
+    const int    mBufferSize   = mSampleRate * 0.25;
+    const size_t mInputLength  = mSampleRate * mDuration;
+
+    vector<float> mInput(mInputLength);
+    unsigned int  mNoise = 23;
+    for (size_t i = 0; i < mInputLength; i++) {
+        mNoise    = mNoise * 1664525 + 1013904223;
+        mInput[i] = 0.5f * sin(2.0 * M_PI * 220.0 * i / mSampleRate) + 0.1f * ((mNoise >> 8) / 8388608.0f - 1.0f);
+    }
+
+    cout << "+++ paulstretch benchmark ( parallel )" << endl
+         << endl
+         << "input duration : " << mDuration << " sec" << endl
+         << "stretch        : " << mStretchValue << "x" << endl
+         << "buffer size    : " << mBufferSize << endl
+         << "cores          : " << thread::hardware_concurrency() << endl
+         << endl;
+
+    ParallelStretch    mReference(mStretchValue, mBufferSize, 1);
+    const unsigned int mSeed            = mReference.get_rand_seed();
+    const size_t       mNumberOfWindows = mReference.get_number_of_windows(mInputLength);
+    const size_t       mOutputFrames    = mNumberOfWindows * mBufferSize;
+
+    auto                mStart     = chrono::steady_clock::now();
+    const vector<float> mSerial    = render_serial(mInput, mStretchValue, mBufferSize, mSampleRate, mSeed, mNumberOfWindows);
+    const double        mSerialSec = seconds_since(mStart);
+    cout << "serial      : " << mOutputFrames / mSerialSec << " frames/sec" << endl;
+
+    vector<int> mThreadCounts = {1, 2, 4, 8};
+    if (thread::hardware_concurrency() > 8) {
+        mThreadCounts.push_back(thread::hardware_concurrency());
+    }
+    bool mAllIdentical = true;
+    for (const int mNumThreads: mThreadCounts) {
+        ParallelStretch mStretch(mStretchValue, mBufferSize, mNumThreads);
+        mStretch.set_rand_seed(mSeed);
+        vector<float> mOutput(mOutputFrames);
+        mStart                 = chrono::steady_clock::now();
+        const size_t mRendered = mStretch.render(mInput.data(), mInputLength, 0, mNumberOfWindows, mOutput.data());
+        const double mSec      = seconds_since(mStart);
+        const bool   mIdentical = mRendered == mNumberOfWindows && mOutput == mSerial;
+        mAllIdentical &= mIdentical;
+        cout << "threads " << (mNumThreads < 10 ? " " : "") << mNumThreads << "  : "
+             << mOutputFrames / mSec << " frames/sec"
+             << " ( x" << mSerialSec / mSec << " ) "
+             << (mIdentical ? "identical" : "MISMATCH") << endl;
+    }
+
+    /* resume from the middle of the render as if restarted from a checkpoint */
+    {
+        ParallelStretch mStretch(mStretchValue, mBufferSize, 2);
+        mStretch.set_rand_seed(mSeed);
+        const size_t  mFirstWindow = mNumberOfWindows / 2;
+        vector<float> mOutput((mNumberOfWindows - mFirstWindow) * mBufferSize);
+        mStretch.render(mInput.data(), mInputLength, mFirstWindow, mNumberOfWindows - mFirstWindow, mOutput.data());
+        const bool mIdentical = equal(mOutput.begin(), mOutput.end(), mSerial.begin() + mFirstWindow * mBufferSize);
+        mAllIdentical &= mIdentical;
+        cout << "resume      : " << (mIdentical ? "identical" : "MISMATCH") << endl;
+    }
+
+    return mAllIdentical ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * real-to-complex transform of a single size and direction.
+ *
+ * complex spectra are stored as interleaved `re, im` pairs with `nsamples / 2 + 1` bins. the inverse
+ * transform is not normalized. plans are immutable and may be executed concurrently from different
+ * threads as long as every thread passes its own buffers.
+ */
+class FFTPlan {
+public:
+    virtual ~FFTPlan() {};
+    // forward: `input` real ( nsamples ) -> `output` complex, inverse: `input` complex -> `output` real. `input` may be overwritten
+    virtual void execute(float* input, float* output, float* work) const = 0;
+    virtual int  get_work_size() const { return 0; }; // number of floats required for `work`
+};
+
+/**
+ * FFT backend ( kissfft, pocketfft, FFTW ) selected at runtime.
+ *
+ * all available backends are compiled into the library ( see `CMakeLists.txt` ). the default backend
+ * is kissfft unless the environment variable `PAULSTRETCH_FFT_BACKEND` names another backend or
+ * `set_default()` is called. plans are cached process-wide per backend, keyed by size and direction,
+ * so that FFT instances of the same size share twiddles and plans.
+ */
+class FFTBackend {
+public:
+    virtual ~FFTBackend() {};
+    virtual const char* get_name() const = 0;
+
+    std::shared_ptr<const FFTPlan> get_plan(int nsamples, bool inverse);
+    size_t                         get_number_of_cached_plans();
+    void                           clear_plan_cache(); // plans in use remain valid
+
+    static FFTBackend*              get(const std::string& name); // NULL if not available
+    static FFTBackend*              get_default();
+    static bool                     set_default(const std::string& name);
+    static std::vector<FFTBackend*> get_available();
+
+protected:
+    virtual FFTPlan* create_plan(int nsamples, bool inverse) = 0;
+
+private:
+    std::mutex                                                     plan_cache_mutex;
+    std::map<std::pair<int, bool>, std::shared_ptr<const FFTPlan>> plan_cache;
+};
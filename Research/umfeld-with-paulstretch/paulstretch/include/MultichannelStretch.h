@@ -0,0 +1,161 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "ProcessedStretch.h"
+#include "WorkerPool.h"
+
+/**
+ * N-channel variant of `ProcessedStretch` ( e.g stereo or ambisonic material ).
+ *
+ * all channels share the window schedule ( `remained_samples`, input refills ) so that the windows of
+ * every channel start at the same input position and the channels stay aligned. the phases of each
+ * channel are randomized with a separate seed. input history and output are stored planar ( one
+ * contiguous block of samples per channel ) and the channels of one window are processed in parallel.
+ * FFT buffers are allocated per thread rather than per channel.
+ *
+ * for the same seeds the output of each channel is identical to a mono `ProcessedStretch`.
+ *
+ * `render()` renders offline like `ParallelStretch::render()`: the windows of all channels are rendered
+ * in parallel in any order ( e.g to resume a render ), the output of each channel is identical to a
+ * `ParallelStretch` with the seed of the channel.
+ */
+class MultichannelStretch {
+public:
+    /**
+     * reads `number_of_samples` samples of `channel` starting at `position` into `buffer`. samples beyond
+     * the end of the input must be filled with zeros. the reader is called concurrently from all threads.
+     */
+    using InputReader = std::function<void(int channel, size_t position, float* buffer, int number_of_samples)>;
+
+    /**
+     * @param num_threads number of threads ( including the calling thread ). 0 uses all available cores.
+     *                    `process()` uses at most one thread per channel
+     */
+    MultichannelStretch(float          rap_,
+                        int            in_bufsize_,
+                        int            channels_,
+                        int            num_threads = 0,
+                        FFT::FFTWindow w           = FFT::_W_HAMMING,
+                        float          samplerate_ = 44100);
+    ~MultichannelStretch();
+
+    int get_max_bufsize() const { return bufsize * 3; }
+    int get_bufsize() const { return bufsize; }
+    int get_channels() const { return channels; }
+    int get_number_of_threads() const { return pool.get_number_of_threads(); }
+
+    /**
+     * @param smps  planar input, one pointer per channel with `nsmps` samples each
+     * @param nsmps `get_nsamples()` or `get_nsamples_for_fill()`
+     */
+    void process(const float* const* smps, int nsmps);
+    /**
+     * @param smps interleaved input with `nsmps` frames
+     */
+    void process_interleaved(const float* smps, int nsmps);
+
+    float*       get_out_buf(int channel) { return out_buf.data() + (size_t) channel * bufsize; } // `get_bufsize()` samples
+    const float* get_out_buf(int channel) const { return out_buf.data() + (size_t) channel * bufsize; }
+    void         get_interleaved_output(float* output) const; // `get_bufsize()` frames
+
+    int  get_nsamples() const { return require_new_buffer ? bufsize : 0; }
+    int  get_nsamples_for_fill() const { return get_max_bufsize(); }
+    int  get_skip_nsamples() const { return skip_samples; }
+    void set_rap(float newrap);
+
+    unsigned int get_rand_seed(int channel) const { return rand_seeds[channel]; }
+    void         set_rand_seed(int channel, unsigned int seed) { rand_seeds[channel] = seed; }
+
+    /**
+     * @return number of output windows required to stretch `number_of_input_frames` frames
+     */
+    size_t get_number_of_windows(size_t number_of_input_frames) const;
+
+    /**
+     * renders `number_of_windows` consecutive output windows of all channels starting at `first_window`.
+     * the current seeds ( `get_rand_seed()` ) are the seeds of window 0. the state of `process()` is not
+     * changed, consecutive calls avoid recomputing the preceding window.
+     *
+     * @param output interleaved, at least `number_of_windows * get_bufsize()` frames
+     * @return number of windows rendered ( less than requested at the end of the input )
+     */
+    size_t render(const InputReader& reader,
+                  size_t             number_of_input_frames,
+                  size_t             first_window,
+                  size_t             number_of_windows,
+                  float*             output);
+
+    FFT::FFTWindow window_type;
+
+private:
+    struct Worker {
+        FFT* fft;
+        FFT* outfft;
+    };
+
+    // window schedule of `render()`. the seed of a window is `seed * seed_multiplier + seed_increment`
+    // where `seed` is the seed of window 0
+    struct Cursor {
+        size_t       window;
+        size_t       block;
+        long double  remained_samples;
+        unsigned int seed_multiplier;
+        unsigned int seed_increment;
+    };
+
+    struct Job {
+        size_t       position;
+        unsigned int seed_multiplier;
+        unsigned int seed_increment;
+    };
+
+    static constexpr size_t NO_WINDOW = SIZE_MAX;
+
+    void next_inbuf_smps(int channel, const float* smps, int stride);
+    void process_channel(Worker& worker, int channel, int start_pos);
+    void process_windows();
+
+    void   prepare_render();
+    void   reset_cursor(Cursor& cursor) const;
+    void   advance_cursor(Cursor& cursor) const;
+    size_t get_window_position(const Cursor& cursor) const;
+    void   seek(size_t window);
+    void   render_window(Worker& worker, const InputReader& reader, const Job& job, int channel, float* out_smps);
+
+    int   bufsize;
+    int   channels;
+    float samplerate;
+    float rap;
+
+    // planar buffers ( `channels` blocks of `bufsize` samples, `old_out_smps` of `bufsize * 2` samples )
+    std::vector<float> new_smps, old_smps, very_old_smps;
+    std::vector<float> old_out_smps;
+    std::vector<float> out_buf;
+
+    std::vector<unsigned int> rand_seeds;
+    std::vector<Worker>       workers;
+    OutputCrossfade           crossfade;
+    WorkerPool                pool;
+
+    long double remained_samples; // 0..1
+    int         skip_samples;
+    bool        require_new_buffer;
+
+    // `render()` ( allocated by the first call )
+    unsigned int              seed_step_multiplier; // advances a seed by one window
+    unsigned int              seed_step_increment;
+    std::vector<unsigned int> render_seeds; // seeds of window 0
+    float                     render_rap;
+    Cursor                    cursor;
+    size_t                    batch_windows;
+    std::vector<Job>          jobs;
+    std::vector<float>        window_buffer;    // `channels` windows of `bufsize * 2` samples per job
+    std::vector<float>        previous_windows; // last rendered window of every channel
+    std::vector<float>        render_output;    // `bufsize` samples of every channel
+    size_t                    previous_window_index;
+};
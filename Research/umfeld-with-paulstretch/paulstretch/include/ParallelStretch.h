@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "ProcessedStretch.h"
+#include "WorkerPool.h"
+
+/**
+ * offline batch renderer that computes the output windows of `ProcessedStretch` in parallel.
+ *
+ * each output window only depends on its position in the input signal and on the state of the phase
+ * randomization seed. both are replayed from the window schedule of `ProcessedStretch::process()` so
+ * that the rendered samples are identical to the serial path ( i.e `PaulStretch::process_segment()` )
+ * for the same seed. only the final crossfade between neighboring windows is computed serially.
+ *
+ * usage:
+ *
+ * 1. create renderer: `ParallelStretch stretch(8, 12000, 4)`
+ * 2. optionally copy the seed from a serial instance: `stretch.set_rand_seed(serial.get_rand_seed())`
+ * 3. query number of output windows: `stretch.get_number_of_windows(input_length)`
+ * 4. render windows in chunks: `stretch.render(input, input_length, first_window, number_of_windows, output)`
+ *
+ * input samples beyond the end of the input signal are treated as silence.
+ */
+class ParallelStretch {
+public:
+    /**
+     * reads `number_of_samples` samples starting at `position` into `buffer`. samples beyond the end
+     * of the input must be filled with zeros. the reader is called concurrently from all threads.
+     */
+    using InputReader = std::function<void(size_t position, float* buffer, int number_of_samples)>;
+
+    /**
+     * @param stretch_value stretch factor
+     * @param buffer_size   number of samples per output window
+     * @param num_threads   number of threads ( including the calling thread ). 0 uses all available cores
+     * @param window_type   analysis window
+     */
+    ParallelStretch(float          stretch_value,
+                    int            buffer_size,
+                    int            num_threads = 0,
+                    FFT::FFTWindow window_type = FFT::_W_HANN);
+    ~ParallelStretch();
+
+    unsigned int get_rand_seed() const { return pRandSeed; }
+    void         set_rand_seed(unsigned int seed);
+
+    int get_output_buffer_size() const { return pBufferSize; }
+    int get_number_of_threads() const { return pPool.get_number_of_threads(); }
+
+    /**
+     * @return number of output windows required to stretch `number_of_input_samples` samples
+     */
+    size_t get_number_of_windows(size_t number_of_input_samples);
+
+    /**
+     * renders `number_of_windows` consecutive output windows starting at `first_window`. windows may be
+     * rendered in any order ( e.g to resume a render ) but consecutive calls avoid recomputing the
+     * preceding window.
+     *
+     * @param output buffer of at least `number_of_windows * get_output_buffer_size()` samples
+     * @return number of windows rendered ( less than requested at the end of the input )
+     */
+    size_t render(const float* input,
+                  size_t       number_of_input_samples,
+                  size_t       first_window,
+                  size_t       number_of_windows,
+                  float*       output);
+
+    size_t render(const InputReader& reader,
+                  size_t             number_of_input_samples,
+                  size_t             first_window,
+                  size_t             number_of_windows,
+                  float*             output);
+
+private:
+    struct Job {
+        size_t       position;
+        unsigned int rand_seed;
+    };
+
+    struct Cursor {
+        size_t       window;
+        size_t       block;
+        long double  remained_samples;
+        unsigned int rand_seed;
+    };
+
+    struct Worker {
+        FFT* analysis;
+        FFT* synthesis;
+    };
+
+    static constexpr size_t NO_WINDOW = SIZE_MAX;
+
+    void   reset_cursor(Cursor& cursor) const;
+    void   advance_cursor(Cursor& cursor) const;
+    size_t get_window_position(const Cursor& cursor) const;
+    void   seek(size_t window);
+    void   render_window(Worker& worker, const Job& job, float* out_smps);
+
+    const float          pStretch;
+    const int            pBufferSize;
+    const FFT::FFTWindow pWindowType;
+    unsigned int         pRandSeed;
+    unsigned int         pSeedMultiplier;
+    unsigned int         pSeedIncrement;
+
+    WorkerPool          pPool;
+    OutputCrossfade     pCrossfade;
+    Cursor              pCursor;
+    std::vector<Worker> pWorkers;
+    std::vector<Job>    pJobs;
+    std::vector<float>  pWindowBuffer;
+    std::vector<float>  pPreviousWindow;
+    size_t              pPreviousWindowIndex;
+    size_t              pBatchSize;
+
+    const InputReader* pReader;
+    size_t             pInputLength;
+    size_t             pNumJobs;
+};
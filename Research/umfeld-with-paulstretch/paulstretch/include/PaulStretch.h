@@ -25,11 +25,13 @@ public:
         }
 
         pRequiredSamples = stretch->get_nsamples_for_fill();
+        pInputFill       = 0;
+        pOutputPosition  = pOutputBufferSize;
     }
 
     ~PaulStretch() {
         delete stretch;
-        delete pInputBuffer;
+        delete[] pInputBuffer;
     }
 
     void fill_input_buffer(float* input_buffer, int number_of_samples) {
@@ -43,30 +45,91 @@ public:
     }
 
     bool process_segment(float* buffer) {
-        stretch->process(pInputBuffer, pRequiredSamples);
-        for (int i = 0; i < pOutputBufferSize; i++) {
-            buffer[i] = stretch->out_buf[i];
-        }
-        pRequiredSamples = stretch->get_nsamples(0);
+        process_input(pInputBuffer);
+        std::copy(stretch->out_buf, stretch->out_buf + pOutputBufferSize, buffer);
+        pOutputPosition = pOutputBufferSize;
         return pRequiredSamples == 0;
     }
 
     void process(std::vector<float>& samples) {
         do {
-            stretch->process(pInputBuffer, pRequiredSamples);
-            std::copy(stretch->out_buf, stretch->out_buf + pOutputBufferSize, std::back_inserter(samples));
-            pRequiredSamples = stretch->get_nsamples(0);
+            process_input(pInputBuffer);
+            samples.insert(samples.end(), stretch->out_buf, stretch->out_buf + pOutputBufferSize);
         } while (pRequiredSamples == 0);
+        pOutputPosition = pOutputBufferSize;
+    }
+
+    /**
+     * passes input samples to the stretch without an intermediate buffer. input is only accepted when
+     * the stretch requires new samples and all stretched samples have been rendered. if `samples`
+     * contains all required samples they are processed directly from the caller's memory, otherwise
+     * they are collected until the required number of samples is complete.
+     *
+     * @return number of samples consumed ( at most `get_required_samples()` )
+     */
+    int push(const float* samples, int number_of_samples) {
+        if (pRequiredSamples == 0 || pOutputPosition < pOutputBufferSize) {
+            return 0;
+        }
+        const int mNumSamples = std::min(number_of_samples, pRequiredSamples - pInputFill);
+        if (pInputFill == 0 && mNumSamples == pRequiredSamples) {
+            process_input(samples);
+        } else {
+            std::copy(samples, samples + mNumSamples, pInputBuffer + pInputFill);
+            pInputFill += mNumSamples;
+            if (pInputFill == pRequiredSamples) {
+                process_input(pInputBuffer);
+            }
+        }
+        return mNumSamples;
+    }
+
+    /**
+     * copies up to `number_of_frames` stretched samples from the output buffer of the stretch into
+     * `output`. segments that do not require new input are processed on demand.
+     *
+     * @return number of samples rendered. less than `number_of_frames` if new input is required ( see `push()` )
+     */
+    size_t render(float* output, size_t number_of_frames) {
+        size_t mFrames = 0;
+        while (mFrames < number_of_frames) {
+            if (pOutputPosition == pOutputBufferSize) {
+                if (pRequiredSamples > 0) {
+                    break;
+                }
+                process_input(pInputBuffer);
+            }
+            const size_t mNumSamples = std::min(number_of_frames - mFrames, (size_t) (pOutputBufferSize - pOutputPosition));
+            std::copy(stretch->out_buf + pOutputPosition, stretch->out_buf + pOutputPosition + mNumSamples, output + mFrames);
+            pOutputPosition += (int) mNumSamples;
+            mFrames += mNumSamples;
+        }
+        return mFrames;
+    }
+
+    /**
+     * @return number of stretched samples of the current segment not yet rendered
+     */
+    int get_pending_samples() {
+        return pOutputBufferSize - pOutputPosition;
     }
 
     int get_required_samples() {
-        return pRequiredSamples;
+        return pRequiredSamples - pInputFill;
     }
 
     int get_output_buffer_size() {
         return pOutputBufferSize;
     }
 
+    unsigned int get_rand_seed() {
+        return stretch->get_rand_seed();
+    }
+
+    void set_rand_seed(unsigned int seed) {
+        stretch->set_rand_seed(seed);
+    }
+
 private:
     ProcessedStretch* stretch;
     int               pInputBufferSize;
@@ -75,4 +138,13 @@ private:
     int               pSampleRate;
     float*            pInputBuffer;
     int               pRequiredSamples;
+    int               pInputFill;
+    int               pOutputPosition;
+
+    void process_input(const float* samples) {
+        stretch->process(samples, pRequiredSamples);
+        pRequiredSamples = stretch->get_nsamples(0);
+        pInputFill       = 0;
+        pOutputPosition  = 0;
+    }
 };
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "PaulStretch.h"
+
+/**
+ * real-time streaming wrapper for `PaulStretch`.
+ *
+ * a worker thread requests input samples, renders stretched blocks ahead of time and stores them in a
+ * preallocated single-producer-single-consumer ring buffer. the audio thread only copies samples from
+ * the ring buffer in `read()`, which neither locks nor allocates.
+ *
+ * usage:
+ *
+ * 1. create stream with an input callback: `PaulStretchStream stream(8, 12000, 48000, read_input, 4)`
+ * 2. start worker thread: `stream.start()`
+ * 3. read stretched samples from audio thread: `stream.read(buffer, audio_buffer_size)`
+ *
+ * the input callback is called from the worker thread and must fill all requested samples.
+ */
+class PaulStretchStream {
+public:
+    using InputCallback = std::function<void(float* buffer, int number_of_samples)>;
+
+    /**
+     * @param lookahead_blocks number of stretched blocks ( of `get_output_buffer_size()` samples ) rendered ahead ( at least 2 )
+     */
+    PaulStretchStream(int           stretch_value,
+                      int           buffer_size,
+                      int           samplerate,
+                      InputCallback input_callback,
+                      int           lookahead_blocks = 4) : pStretch(stretch_value, buffer_size, samplerate),
+                                                             pInputCallback(input_callback),
+                                                             pOutputBufferSize(pStretch.get_output_buffer_size()),
+                                                             pCapacity((size_t) pOutputBufferSize * (lookahead_blocks < 2 ? 2 : lookahead_blocks)),
+                                                             pRingBuffer(pCapacity, 0.0f),
+                                                             pInputBuffer(pStretch.get_required_samples(), 0.0f),
+                                                             pSampleRate(samplerate),
+                                                             pWritePosition(0),
+                                                             pReadPosition(0),
+                                                             pUnderruns(0),
+                                                             pUnderrunSamples(0),
+                                                             pRunning(false) {}
+
+    ~PaulStretchStream() {
+        stop();
+    }
+
+    /**
+     * starts the worker thread. returns when the look-ahead buffer is filled.
+     */
+    void start() {
+        if (pRunning) {
+            return;
+        }
+        while (get_free_samples() >= (size_t) pOutputBufferSize) {
+            render_block();
+        }
+        pRunning = true;
+        pWorker  = std::thread(&PaulStretchStream::worker_thread, this);
+    }
+
+    void stop() {
+        pRunning = false;
+        if (pWorker.joinable()) {
+            pWorker.join();
+        }
+    }
+
+    /**
+     * copies `number_of_samples` stretched samples into `output`. safe to call from the audio thread.
+     * missing samples are filled with silence and counted as underrun.
+     *
+     * @return number of stretched samples copied
+     */
+    int read(float* output, int number_of_samples) {
+        const size_t mReadPosition = pReadPosition.load(std::memory_order_relaxed);
+        const size_t mAvailable    = pWritePosition.load(std::memory_order_acquire) - mReadPosition;
+        const size_t mNumSamples   = std::min((size_t) number_of_samples, mAvailable);
+        const size_t mOffset       = mReadPosition % pCapacity;
+        const size_t mFirstPart    = std::min(mNumSamples, pCapacity - mOffset);
+        std::copy(pRingBuffer.data() + mOffset, pRingBuffer.data() + mOffset + mFirstPart, output);
+        std::copy(pRingBuffer.data(), pRingBuffer.data() + mNumSamples - mFirstPart, output + mFirstPart);
+        pReadPosition.store(mReadPosition + mNumSamples, std::memory_order_release);
+
+        if (mNumSamples < (size_t) number_of_samples) {
+            std::fill(output + mNumSamples, output + number_of_samples, 0.0f);
+            pUnderruns.fetch_add(1, std::memory_order_relaxed);
+            pUnderrunSamples.fetch_add(number_of_samples - mNumSamples, std::memory_order_relaxed);
+        }
+        return (int) mNumSamples;
+    }
+
+    /**
+     * @return number of `read()` calls that could not be served completely
+     */
+    uint32_t get_underruns() const {
+        return pUnderruns.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return number of samples replaced by silence
+     */
+    uint64_t get_underrun_samples() const {
+        return pUnderrunSamples.load(std::memory_order_relaxed);
+    }
+
+    void reset_underruns() {
+        pUnderruns       = 0;
+        pUnderrunSamples = 0;
+    }
+
+    /**
+     * @return number of stretched samples ready to be read
+     */
+    size_t get_available_samples() const {
+        return pWritePosition.load(std::memory_order_acquire) - pReadPosition.load(std::memory_order_acquire);
+    }
+
+    size_t get_lookahead_samples() const {
+        return pCapacity;
+    }
+
+    int get_output_buffer_size() const {
+        return pOutputBufferSize;
+    }
+
+private:
+    PaulStretch           pStretch;
+    InputCallback         pInputCallback;
+    const int             pOutputBufferSize;
+    const size_t          pCapacity;
+    std::vector<float>    pRingBuffer;
+    std::vector<float>    pInputBuffer;
+    const int             pSampleRate;
+    std::atomic<size_t>   pWritePosition;
+    std::atomic<size_t>   pReadPosition;
+    std::atomic<uint32_t> pUnderruns;
+    std::atomic<uint64_t> pUnderrunSamples;
+    std::atomic<bool>     pRunning;
+    std::thread           pWorker;
+
+    size_t get_free_samples() const {
+        return pCapacity - (pWritePosition.load(std::memory_order_relaxed) - pReadPosition.load(std::memory_order_acquire));
+    }
+
+    void render_block() {
+        /* stretched samples are rendered directly into the ring buffer */
+        const size_t mWritePosition = pWritePosition.load(std::memory_order_relaxed);
+        const size_t mOffset        = mWritePosition % pCapacity;
+        const size_t mFirstPart     = std::min((size_t) pOutputBufferSize, pCapacity - mOffset);
+        render(pRingBuffer.data() + mOffset, mFirstPart);
+        render(pRingBuffer.data(), pOutputBufferSize - mFirstPart);
+        pWritePosition.store(mWritePosition + pOutputBufferSize, std::memory_order_release);
+    }
+
+    void render(float* output, size_t number_of_frames) {
+        size_t mFrames = pStretch.render(output, number_of_frames);
+        while (mFrames < number_of_frames) {
+            const int mNumRequiredSamples = pStretch.get_required_samples();
+            pInputCallback(pInputBuffer.data(), mNumRequiredSamples);
+            pStretch.push(pInputBuffer.data(), mNumRequiredSamples);
+            mFrames += pStretch.render(output + mFrames, number_of_frames - mFrames);
+        }
+    }
+
+    void worker_thread() {
+        /* poll at a quarter of the duration of one stretched block so the audio thread never has to signal */
+        const auto mPollInterval = std::chrono::microseconds((int64_t) pOutputBufferSize * 250000 / pSampleRate);
+        while (pRunning) {
+            if (get_free_samples() >= (size_t) pOutputBufferSize) {
+                render_block();
+            } else {
+                std::this_thread::sleep_for(mPollInterval);
+            }
+        }
+    }
+};
@@ -18,16 +18,13 @@
 
 #pragma once
 
-#ifdef KISSFFT
-#include <kiss_fftr.h>
-#else
-#include <fftw3.h>
-#warning "FFTW3 not supported"
-#endif
+#include <memory>
+
+#include "FFTBackend.h"
 
 class FFT { // FFT class that considers phases as random
 public:
-    FFT(int nsamples_); // samples must be even
+    FFT(int nsamples_, FFTBackend* backend = FFTBackend::get_default()); // samples must be even
     ~FFT();
     enum FFTWindow { _W_RECTANGULAR,
                      _W_HAMMING,
@@ -41,16 +38,14 @@ public:
     float* freq; // size of samples
     int    nsamples;
 
+    unsigned int get_rand_seed() const { return rand_seed; };
+    void         set_rand_seed(unsigned int seed) { rand_seed = seed; };
+
 private:
-#ifdef KISSFFT
-    kiss_fftr_cfg    plankfft, plankifft;
-    kiss_fft_scalar* datar;
-    kiss_fft_cpx*    datac;
-#else
-    float*     data;
-    fftwf_plan plan;
-    fftwf_plan plani;
-#endif
+    std::shared_ptr<const FFTPlan> plan, plani; // shared with all FFT instances of the same size
+    float*                         datar;       // size of samples
+    float*                         datac;       // size of samples/2+1 complex values ( interleaved )
+    float*                         work;
     struct {
         float*    data;
         FFTWindow type;
@@ -60,6 +55,18 @@ private:
     static unsigned int start_rand_seed;
 };
 
+class OutputCrossfade { // crossfade between consecutive output windows with precomputed tables
+public:
+    OutputCrossfade(int bufsize_);
+    ~OutputCrossfade();
+    // crossfade two consecutive output windows ( 2*bufsize samples each ) into `bufsize` output samples
+    void process(const float* new_out_smps, const float* old_out_smps, float* out_buf) const;
+
+private:
+    int    bufsize;
+    float *fade_in, *fade_out, *gain;
+};
+
 class ProcessedStretch {
 public:
     ProcessedStretch(float          rap_,
@@ -77,7 +84,7 @@ public:
         return bufsize;
     };
 
-    void process(float* smps, int nsmps);
+    void process(const float* smps, int nsmps);
 
     void set_freezing(bool new_freezing) {
         freezing = new_freezing;
@@ -89,22 +96,28 @@ public:
     int    get_skip_nsamples();                      // used for shorten
     void   set_rap(float newrap);                    // set the current stretch value
 
+    unsigned int get_rand_seed() const { return outfft->get_rand_seed(); }; // seed of the phase randomization
+    void         set_rand_seed(unsigned int seed) { outfft->set_rand_seed(seed); };
+
     FFT::FFTWindow window_type;
 
 private:
     void process_spectrum(float* freq) {};
-    void do_analyse_inbuf(float* smps);
-    void do_next_inbuf_smps(float* smps);
+    void do_analyse_inbuf(const float* smps);
+    void do_next_inbuf_smps(const float* smps);
 
     void copy(float* freq1, float* freq2);
     void add(float* freq2, float* freq1, float a = 1.0);
     void mul(float* freq1, float a);
     void zero(float* freq1);
     void spread(float* freq1, float* freq2, float spread_bandwidth);
+    void init_spread_tables();
 
     FFT *infft, *outfft;
     FFT* fft;
 
+    OutputCrossfade* crossfade;
+
     int    bufsize;
     float  samplerate;
     float  rap;
@@ -121,4 +134,8 @@ private:
     int    nfreq;
     float* free_filter_freqs;
     float *infreq, *sumfreq, *tmpfreq1, *tmpfreq2;
+
+    // interpolation positions of `spread()` ( linear -> log spectrum and back, -1 for out of range )
+    int *  spread_log_x0, *spread_lin_x0;
+    float *spread_log_xp, *spread_lin_xp;
 };
@@ -0,0 +1,39 @@
+#pragma once
+
+/**
+ * vectorized per-bin and per-sample loops used by `FFT` and `ProcessedStretch`.
+ *
+ * the kernels use AVX2 ( 8 lanes ), SSE2 ( 4 lanes ) or NEON ( 4 lanes ) depending on the instruction
+ * set the library is compiled for ( see `PAULSTRETCH_NATIVE_ARCH` in `CMakeLists.txt` ) and fall back
+ * to scalar loops otherwise. all paths compute the same float operations in the same order and
+ * therefore produce identical results.
+ */
+class StretchKernels {
+public:
+    static const int SINCOS_TABLE_SIZE = 32768; // number of phases generated by `FFT::freq2smp()` ( 15 bit )
+
+    static const char* get_instruction_set();
+
+    // dst[i] = dst[i] * src[i]
+    static void multiply(float* dst, const float* src, int n);
+
+    // dst[i] = src[i] * scalar
+    static void scale(float* dst, const float* src, float scalar, int n);
+
+    // magnitude[i] = sqrt(re * re + im * im) for interleaved complex values
+    static void magnitude(const float* complex, float* magnitude, int n);
+
+    // out[i] = (new_smps[i] * fade_out[i] + old_smps[i] * fade_in[i]) * gain[i]
+    static void crossfade(const float* new_smps,
+                          const float* old_smps,
+                          const float* fade_in,
+                          const float* fade_out,
+                          const float* gain,
+                          float*       out,
+                          int          n);
+
+    /**
+     * @return interleaved `cos, sin` table for the phases `i / 16384 * PI` with `0 <= i < SINCOS_TABLE_SIZE`
+     */
+    static const float* get_sincos_table();
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * persistent pool of worker threads that runs batches of independent jobs.
+ *
+ * the calling thread takes part in every batch as worker `0`, the threads of the pool are workers
+ * `1 .. get_number_of_threads() - 1`. jobs are pulled from a shared counter, so a worker index can be
+ * used to select per-thread scratch memory.
+ */
+class WorkerPool {
+public:
+    using Job = std::function<void(int worker_index, size_t job_index)>;
+
+    /**
+     * @param num_threads number of threads ( including the calling thread ). 0 uses all available cores
+     */
+    explicit WorkerPool(int num_threads) : pJob(nullptr),
+                                           pNumJobs(0),
+                                           pNextJob(0),
+                                           pGeneration(0),
+                                           pActiveWorkers(0),
+                                           pNumHelpers(0),
+                                           pShutdown(false) {
+        if (num_threads <= 0) {
+            num_threads = (int) std::thread::hardware_concurrency();
+        }
+        if (num_threads <= 0) {
+            num_threads = 1;
+        }
+        for (int i = 1; i < num_threads; i++) {
+            pThreads.emplace_back(&WorkerPool::worker_thread, this, i);
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> mLock(pMutex);
+            pShutdown = true;
+        }
+        pWakeUp.notify_all();
+        for (auto& mThread: pThreads) {
+            mThread.join();
+        }
+    }
+
+    int get_number_of_threads() const { return (int) pThreads.size() + 1; }
+
+    /**
+     * runs `job` for job indices `0 .. number_of_jobs - 1` and returns when all jobs are done. at most
+     * `number_of_jobs` workers take part, the other threads keep waiting.
+     */
+    void run(size_t number_of_jobs, const Job& job) {
+        pJob     = &job;
+        pNumJobs = number_of_jobs;
+        pNextJob = 0;
+        if (!pThreads.empty() && number_of_jobs > 1) {
+            {
+                std::lock_guard<std::mutex> mLock(pMutex);
+                pNumHelpers    = (int) std::min(pThreads.size(), number_of_jobs - 1);
+                pActiveWorkers = pNumHelpers;
+                pGeneration++;
+            }
+            pWakeUp.notify_all();
+            run_jobs(0);
+            std::unique_lock<std::mutex> mLock(pMutex);
+            pDone.wait(mLock, [this] { return pActiveWorkers == 0; });
+        } else {
+            run_jobs(0);
+        }
+        pJob = nullptr;
+    }
+
+private:
+    const Job*               pJob;
+    size_t                   pNumJobs;
+    std::atomic<size_t>      pNextJob;
+    std::vector<std::thread> pThreads;
+    std::mutex               pMutex;
+    std::condition_variable  pWakeUp;
+    std::condition_variable  pDone;
+    uint64_t                 pGeneration;
+    int                      pActiveWorkers;
+    int                      pNumHelpers; // threads of the pool that take part in the current batch
+    bool                     pShutdown;
+
+    void run_jobs(int worker_index) {
+        while (true) {
+            const size_t mJob = pNextJob.fetch_add(1);
+            if (mJob >= pNumJobs) {
+                break;
+            }
+            (*pJob)(worker_index, mJob);
+        }
+    }
+
+    void worker_thread(int worker_index) {
+        uint64_t mGeneration = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> mLock(pMutex);
+                pWakeUp.wait(mLock, [this, mGeneration] { return pShutdown || pGeneration != mGeneration; });
+                if (pShutdown) {
+                    return;
+                }
+                mGeneration = pGeneration;
+                if (worker_index > pNumHelpers) {
+                    continue;
+                }
+            }
+            run_jobs(worker_index);
+            {
+                std::lock_guard<std::mutex> mLock(pMutex);
+                pActiveWorkers--;
+            }
+            pDone.notify_one();
+        }
+    }
+};
@@ -0,0 +1,264 @@
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+#include "FFTBackend.h"
+#include "_kiss_fft_guts.h"
+
+#ifdef PAULSTRETCH_WITH_FFTW
+#include <fftw3.h>
+#endif
+
+#ifdef PAULSTRETCH_WITH_POCKETFFT
+#define POCKETFFT_NO_MULTITHREADING
+#include <pocketfft_hdronly.h>
+#endif
+
+/* --- kissfft --- */
+
+/**
+ * real FFT of `kiss_fftr` with the scratch buffer moved out of the configuration ( `work` ) so that
+ * one plan can be shared by several threads. the computation is identical to `kiss_fftr()` and
+ * `kiss_fftri()`.
+ */
+class KissFFTPlan : public FFTPlan {
+public:
+    KissFFTPlan(int nsamples, bool inverse_) {
+        inverse        = inverse_;
+        ncfft          = nsamples / 2;
+        substate       = kiss_fft_alloc(ncfft, inverse, 0, 0);
+        super_twiddles = new kiss_fft_cpx[ncfft];
+        for (int i = 0; i < ncfft; ++i) {
+            double phase = -3.14159265358979323846264338327 * ((double) i / ncfft + .5);
+            if (inverse) phase *= -1;
+            kf_cexp(super_twiddles + i, phase);
+        };
+    };
+
+    ~KissFFTPlan() {
+        free(substate);
+        delete[] super_twiddles;
+    };
+
+    int get_work_size() const { return ncfft * 2; };
+
+    void execute(float* input, float* output, float* work) const {
+        if (inverse) {
+            execute_inverse((const kiss_fft_cpx*) input, (kiss_fft_scalar*) output, (kiss_fft_cpx*) work);
+        } else {
+            execute_forward((const kiss_fft_scalar*) input, (kiss_fft_cpx*) output, (kiss_fft_cpx*) work);
+        };
+    };
+
+private:
+    bool          inverse;
+    int           ncfft;
+    kiss_fft_cfg  substate;
+    kiss_fft_cpx* super_twiddles;
+
+    void execute_forward(const kiss_fft_scalar* timedata, kiss_fft_cpx* freqdata, kiss_fft_cpx* tmpbuf) const {
+        kiss_fft_cpx fpnk, fpk, f1k, f2k, tw, tdc;
+
+        kiss_fft(substate, (const kiss_fft_cpx*) timedata, tmpbuf);
+
+        tdc.r             = tmpbuf[0].r;
+        tdc.i             = tmpbuf[0].i;
+        freqdata[0].r     = tdc.r + tdc.i;
+        freqdata[ncfft].r = tdc.r - tdc.i;
+        freqdata[ncfft].i = freqdata[0].i = 0;
+
+        for (int k = 1; k <= ncfft / 2; ++k) {
+            fpk    = tmpbuf[k];
+            fpnk.r = tmpbuf[ncfft - k].r;
+            fpnk.i = -tmpbuf[ncfft - k].i;
+
+            C_ADD(f1k, fpk, fpnk);
+            C_SUB(f2k, fpk, fpnk);
+            C_MUL(tw, f2k, super_twiddles[k]);
+
+            freqdata[k].r         = HALF_OF(f1k.r + tw.r);
+            freqdata[k].i         = HALF_OF(f1k.i + tw.i);
+            freqdata[ncfft - k].r = HALF_OF(f1k.r - tw.r);
+            freqdata[ncfft - k].i = HALF_OF(tw.i - f1k.i);
+        };
+    };
+
+    void execute_inverse(const kiss_fft_cpx* freqdata, kiss_fft_scalar* timedata, kiss_fft_cpx* tmpbuf) const {
+        tmpbuf[0].r = freqdata[0].r + freqdata[ncfft].r;
+        tmpbuf[0].i = freqdata[0].r - freqdata[ncfft].r;
+
+        for (int k = 1; k <= ncfft / 2; ++k) {
+            kiss_fft_cpx fk, fnkc, fek, fok, tmp;
+            fk     = freqdata[k];
+            fnkc.r = freqdata[ncfft - k].r;
+            fnkc.i = -freqdata[ncfft - k].i;
+
+            C_ADD(fek, fk, fnkc);
+            C_SUB(tmp, fk, fnkc);
+            C_MUL(fok, tmp, super_twiddles[k]);
+            C_ADD(tmpbuf[k], fek, fok);
+            C_SUB(tmpbuf[ncfft - k], fek, fok);
+            tmpbuf[ncfft - k].i *= -1;
+        };
+        kiss_fft(substate, tmpbuf, (kiss_fft_cpx*) timedata);
+    };
+};
+
+class KissFFTBackend : public FFTBackend {
+public:
+    const char* get_name() const { return "kissfft"; };
+
+protected:
+    FFTPlan* create_plan(int nsamples, bool inverse) { return new KissFFTPlan(nsamples, inverse); };
+};
+
+/* --- FFTW --- */
+
+#ifdef PAULSTRETCH_WITH_FFTW
+class FFTWPlan : public FFTPlan {
+public:
+    FFTWPlan(int nsamples, bool inverse_) {
+        inverse                 = inverse_;
+        float*         mReal    = fftwf_alloc_real(nsamples);
+        fftwf_complex* mComplex = fftwf_alloc_complex(nsamples / 2 + 1);
+        const unsigned mFlags   = FFTW_ESTIMATE | FFTW_UNALIGNED;
+        if (inverse) {
+            plan = fftwf_plan_dft_c2r_1d(nsamples, mComplex, mReal, mFlags);
+        } else {
+            plan = fftwf_plan_dft_r2c_1d(nsamples, mReal, mComplex, mFlags);
+        };
+        fftwf_free(mReal);
+        fftwf_free(mComplex);
+    };
+
+    ~FFTWPlan() {
+        fftwf_destroy_plan(plan);
+    };
+
+    void execute(float* input, float* output, float*) const {
+        if (inverse) {
+            fftwf_execute_dft_c2r(plan, (fftwf_complex*) input, output);
+        } else {
+            fftwf_execute_dft_r2c(plan, input, (fftwf_complex*) output);
+        };
+    };
+
+private:
+    bool       inverse;
+    fftwf_plan plan;
+};
+
+class FFTWBackend : public FFTBackend {
+public:
+    const char* get_name() const { return "fftw"; };
+
+protected:
+    FFTPlan* create_plan(int nsamples, bool inverse) { return new FFTWPlan(nsamples, inverse); }; // planner calls are serialized by the plan cache
+};
+#endif
+
+/* --- pocketfft --- */
+
+#ifdef PAULSTRETCH_WITH_POCKETFFT
+/**
+ * pocketfft computes the real transform in place in FFTPACK order ( `r0, r1, i1, ..., r(n/2)` ). the
+ * plan converts from and to interleaved complex values.
+ */
+class PocketFFTPlan : public FFTPlan {
+public:
+    PocketFFTPlan(int nsamples_, bool inverse_) : inverse(inverse_), nsamples(nsamples_), plan(nsamples_) {};
+
+    void execute(float* input, float* output, float*) const {
+        if (inverse) {
+            output[0] = input[0];
+            memcpy(output + 1, input + 2, sizeof(float) * (nsamples - 2));
+            output[nsamples - 1] = input[nsamples];
+            plan.exec(output, 1.0f, false);
+        } else {
+            plan.exec(input, 1.0f, true);
+            output[0] = input[0];
+            output[1] = 0.0f;
+            memcpy(output + 2, input + 1, sizeof(float) * (nsamples - 2));
+            output[nsamples]     = input[nsamples - 1];
+            output[nsamples + 1] = 0.0f;
+        };
+    };
+
+private:
+    bool                                     inverse;
+    int                                      nsamples;
+    pocketfft::detail::pocketfft_r<float> plan;
+};
+
+class PocketFFTBackend : public FFTBackend {
+public:
+    const char* get_name() const { return "pocketfft"; };
+
+protected:
+    FFTPlan* create_plan(int nsamples, bool inverse) { return new PocketFFTPlan(nsamples, inverse); };
+};
+#endif
+
+/* --- backend registry + plan cache --- */
+
+std::shared_ptr<const FFTPlan> FFTBackend::get_plan(int nsamples, bool inverse) {
+    std::lock_guard<std::mutex>     lock(plan_cache_mutex);
+    std::shared_ptr<const FFTPlan>& cached = plan_cache[std::make_pair(nsamples, inverse)];
+    if (!cached) {
+        cached.reset(create_plan(nsamples, inverse));
+    };
+    return cached;
+};
+
+size_t FFTBackend::get_number_of_cached_plans() {
+    std::lock_guard<std::mutex> lock(plan_cache_mutex);
+    return plan_cache.size();
+};
+
+void FFTBackend::clear_plan_cache() {
+    std::lock_guard<std::mutex> lock(plan_cache_mutex);
+    plan_cache.clear();
+};
+
+std::vector<FFTBackend*> FFTBackend::get_available() {
+    static const std::vector<FFTBackend*> backends = {
+        new KissFFTBackend(),
+#ifdef PAULSTRETCH_WITH_POCKETFFT
+        new PocketFFTBackend(),
+#endif
+#ifdef PAULSTRETCH_WITH_FFTW
+        new FFTWBackend(),
+#endif
+    };
+    return backends;
+};
+
+FFTBackend* FFTBackend::get(const std::string& name) {
+    for (FFTBackend* backend: get_available()) {
+        if (name == backend->get_name()) return backend;
+    };
+    return NULL;
+};
+
+static std::atomic<FFTBackend*>& default_backend() {
+    static std::atomic<FFTBackend*> backend(NULL);
+    return backend;
+};
+
+FFTBackend* FFTBackend::get_default() {
+    FFTBackend* backend = default_backend().load();
+    if (backend == NULL) {
+        const char* name = getenv("PAULSTRETCH_FFT_BACKEND");
+        backend          = name != NULL ? get(name) : NULL;
+        if (backend == NULL) backend = get_available()[0];
+        default_backend().store(backend);
+    };
+    return backend;
+};
+
+bool FFTBackend::set_default(const std::string& name) {
+    FFTBackend* backend = get(name);
+    if (backend == NULL) return false;
+    default_backend().store(backend);
+    return true;
+};
@@ -0,0 +1,287 @@
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+
+#include "MultichannelStretch.h"
+
+MultichannelStretch::MultichannelStretch(float          rap_,
+                                         int            in_bufsize_,
+                                         int            channels_,
+                                         int            num_threads,
+                                         FFT::FFTWindow w,
+                                         float          samplerate_) : window_type(w),
+                                                                       bufsize(in_bufsize_ < 8 ? 8 : in_bufsize_),
+                                                                       channels(channels_ < 1 ? 1 : channels_),
+                                                                       samplerate(samplerate_),
+                                                                       rap(rap_),
+                                                                       new_smps((size_t) channels * bufsize, 0.0f),
+                                                                       old_smps((size_t) channels * bufsize, 0.0f),
+                                                                       very_old_smps((size_t) channels * bufsize, 0.0f),
+                                                                       old_out_smps((size_t) channels * bufsize * 2, 0.0f),
+                                                                       out_buf((size_t) channels * bufsize, 0.0f),
+                                                                       rand_seeds(channels),
+                                                                       crossfade(bufsize),
+                                                                       pool(num_threads), // `process()` only wakes one thread per channel
+                                                                       remained_samples(0.0),
+                                                                       skip_samples(0),
+                                                                       require_new_buffer(false),
+                                                                       render_rap(0.0f),
+                                                                       batch_windows(0),
+                                                                       previous_window_index(NO_WINDOW) {
+    for (int i = 0; i < pool.get_number_of_threads(); i++) {
+        workers.push_back({new FFT(bufsize * 2), new FFT(bufsize * 2)});
+    }
+    /* every channel gets its own phase randomization, spaced like the seeds of separate `FFT` instances */
+    for (int c = 0; c < channels; c++) {
+        rand_seeds[c] = workers[0].outfft->get_rand_seed() + c * 161103;
+    }
+
+    /* `FFT::freq2smp()` advances the LCG `bufsize - 1` times per window ( see `ParallelStretch` ) */
+    seed_step_multiplier = 1;
+    seed_step_increment  = 0;
+    for (int i = 1; i < bufsize; i++) {
+        seed_step_multiplier = seed_step_multiplier * 1103515245;
+        seed_step_increment  = seed_step_increment * 1103515245 + 12345;
+    }
+    reset_cursor(cursor);
+}
+
+MultichannelStretch::~MultichannelStretch() {
+    for (auto& mWorker: workers) {
+        delete mWorker.fft;
+        delete mWorker.outfft;
+    }
+}
+
+void MultichannelStretch::set_rap(float newrap) {
+    rap = newrap;
+}
+
+void MultichannelStretch::process(const float* const* smps, int nsmps) {
+    if (nsmps != 0 && nsmps != bufsize && nsmps != get_max_bufsize()) {
+        printf("Warning wrong nsmps on MultichannelStretch::process() %d,%d\n", nsmps, bufsize);
+        return;
+    }
+    for (int k = 0; k < nsmps; k += bufsize) {
+        for (int c = 0; c < channels; c++) {
+            next_inbuf_smps(c, smps[c] + k, 1);
+        }
+    }
+    process_windows();
+}
+
+void MultichannelStretch::process_interleaved(const float* smps, int nsmps) {
+    if (nsmps != 0 && nsmps != bufsize && nsmps != get_max_bufsize()) {
+        printf("Warning wrong nsmps on MultichannelStretch::process_interleaved() %d,%d\n", nsmps, bufsize);
+        return;
+    }
+    for (int k = 0; k < nsmps; k += bufsize) {
+        for (int c = 0; c < channels; c++) {
+            next_inbuf_smps(c, smps + (size_t) k * channels + c, channels);
+        }
+    }
+    process_windows();
+}
+
+void MultichannelStretch::get_interleaved_output(float* output) const {
+    for (int c = 0; c < channels; c++) {
+        const float* mChannel = get_out_buf(c);
+        for (int i = 0; i < bufsize; i++) {
+            output[(size_t) i * channels + c] = mChannel[i];
+        }
+    }
+}
+
+void MultichannelStretch::next_inbuf_smps(int channel, const float* smps, int stride) {
+    const size_t mOffset = (size_t) channel * bufsize;
+    std::copy(old_smps.begin() + mOffset, old_smps.begin() + mOffset + bufsize, very_old_smps.begin() + mOffset);
+    std::copy(new_smps.begin() + mOffset, new_smps.begin() + mOffset + bufsize, old_smps.begin() + mOffset);
+    float* mNewSmps = new_smps.data() + mOffset;
+    for (int i = 0; i < bufsize; i++) {
+        mNewSmps[i] = smps[(size_t) i * stride];
+    }
+}
+
+void MultichannelStretch::process_channel(Worker& worker, int channel, int start_pos) {
+    const size_t mOffset      = (size_t) channel * bufsize;
+    const float* mVeryOldSmps = very_old_smps.data() + mOffset;
+    const float* mOldSmps     = old_smps.data() + mOffset;
+    const float* mNewSmps     = new_smps.data() + mOffset;
+    float*       mOldOutSmps  = old_out_smps.data() + mOffset * 2;
+    FFT*         fft          = worker.fft;
+    FFT*         outfft       = worker.outfft;
+
+    // construct the input fft
+    for (int i = 0; i < bufsize - start_pos; i++) fft->smp[i] = mVeryOldSmps[i + start_pos];
+    for (int i = 0; i < bufsize; i++) fft->smp[i + bufsize - start_pos] = mOldSmps[i];
+    for (int i = 0; i < start_pos; i++) fft->smp[i + 2 * bufsize - start_pos] = mNewSmps[i];
+    // compute the output spectrum
+    fft->applywindow(window_type);
+    fft->smp2freq();
+    for (int i = 0; i < bufsize; i++) outfft->freq[i] = fft->freq[i];
+
+    outfft->set_rand_seed(rand_seeds[channel]);
+    outfft->freq2smp();
+    rand_seeds[channel] = outfft->get_rand_seed();
+
+    // make the output buffer
+    crossfade.process(outfft->smp, mOldOutSmps, get_out_buf(channel));
+    std::copy(outfft->smp, outfft->smp + bufsize * 2, mOldOutSmps);
+}
+
+void MultichannelStretch::process_windows() {
+    int start_pos = (int) (floor(remained_samples * bufsize));
+    if (start_pos >= bufsize) start_pos = bufsize - 1;
+    pool.run(channels, [this, start_pos](int worker_index, size_t channel) {
+        process_channel(workers[worker_index], (int) channel, start_pos);
+    });
+
+    /* one schedule for all channels ( see `ProcessedStretch::process()` ) */
+    long double used_rap = rap;
+    long double r        = 1.0 / used_rap;
+    remained_samples += r;
+    if (remained_samples >= 1.0) {
+        skip_samples       = (int) (floor(remained_samples - 1.0) * bufsize);
+        remained_samples   = remained_samples - floor(remained_samples);
+        require_new_buffer = true;
+    } else {
+        require_new_buffer = false;
+    }
+}
+
+/* --- offline rendering --- */
+
+size_t MultichannelStretch::get_number_of_windows(size_t number_of_input_frames) const {
+    Cursor mCursor;
+    reset_cursor(mCursor);
+    while (mCursor.block * bufsize < number_of_input_frames) {
+        advance_cursor(mCursor);
+    }
+    return mCursor.window;
+}
+
+size_t MultichannelStretch::render(const InputReader& reader,
+                                   size_t             number_of_input_frames,
+                                   size_t             first_window,
+                                   size_t             number_of_windows,
+                                   float*             output) {
+    prepare_render();
+    const size_t mWindowSize = (size_t) bufsize * 2;
+    size_t       mWindows    = 0;
+    while (mWindows < number_of_windows) {
+        const size_t mWindow = first_window + mWindows;
+
+        /* the crossfade requires the previous window. it is rendered again when not at hand */
+        const bool mRenderPrevious = mWindow > 0 && previous_window_index != mWindow - 1;
+        if (mWindow == 0) {
+            std::fill(previous_windows.begin(), previous_windows.end(), 0.0f);
+        }
+        seek(mRenderPrevious ? mWindow - 1 : mWindow);
+
+        size_t       mNumJobs      = 0;
+        const size_t mBatchWindows = batch_windows + (mRenderPrevious ? 1 : 0);
+        while (mNumJobs < mBatchWindows &&
+               cursor.window < first_window + number_of_windows &&
+               cursor.block * bufsize < number_of_input_frames) {
+            jobs[mNumJobs] = {get_window_position(cursor), cursor.seed_multiplier, cursor.seed_increment};
+            mNumJobs++;
+            advance_cursor(cursor);
+        }
+        if (mNumJobs == 0 || (mRenderPrevious && mNumJobs == 1)) {
+            break;
+        }
+
+        /* one job per window and channel */
+        pool.run(mNumJobs * channels, [this, &reader, mWindowSize](int worker_index, size_t job_index) {
+            render_window(workers[worker_index], reader, jobs[job_index / channels], (int) (job_index % channels),
+                          window_buffer.data() + job_index * mWindowSize);
+        });
+
+        for (size_t i = mRenderPrevious ? 1 : 0; i < mNumJobs; i++) {
+            for (int c = 0; c < channels; c++) {
+                const float* mCurrent  = window_buffer.data() + (i * channels + c) * mWindowSize;
+                const float* mPrevious = i == 0 ? previous_windows.data() + c * mWindowSize
+                                                : window_buffer.data() + ((i - 1) * channels + c) * mWindowSize;
+                crossfade.process(mCurrent, mPrevious, render_output.data() + (size_t) c * bufsize);
+            }
+            float* mOutput = output + mWindows * bufsize * channels;
+            for (int c = 0; c < channels; c++) {
+                const float* mChannel = render_output.data() + (size_t) c * bufsize;
+                for (int k = 0; k < bufsize; k++) {
+                    mOutput[(size_t) k * channels + c] = mChannel[k];
+                }
+            }
+            mWindows++;
+        }
+        const float* mLast = window_buffer.data() + (mNumJobs - 1) * channels * mWindowSize;
+        std::copy(mLast, mLast + channels * mWindowSize, previous_windows.begin());
+        previous_window_index = first_window + mWindows - 1;
+    }
+    return mWindows;
+}
+
+void MultichannelStretch::prepare_render() {
+    if (batch_windows == 0) {
+        batch_windows = std::max<size_t>(1, (size_t) pool.get_number_of_threads() * 4 / channels);
+        jobs.resize(batch_windows + 1);
+        window_buffer.resize((batch_windows + 1) * channels * bufsize * 2);
+        previous_windows.resize((size_t) channels * bufsize * 2);
+        render_output.resize((size_t) channels * bufsize);
+    }
+    /* the windows depend on the seeds and the stretch factor, `process()` advances the seeds */
+    if (render_seeds != rand_seeds || render_rap != rap) {
+        render_seeds          = rand_seeds;
+        render_rap            = rap;
+        previous_window_index = NO_WINDOW;
+        reset_cursor(cursor);
+    }
+}
+
+void MultichannelStretch::reset_cursor(Cursor& cursor_) const {
+    cursor_.window           = 0;
+    cursor_.block            = 0;
+    cursor_.remained_samples = 0.0;
+    cursor_.seed_multiplier  = 1;
+    cursor_.seed_increment   = 0;
+}
+
+void MultichannelStretch::advance_cursor(Cursor& cursor_) const {
+    /* mirrors `process_windows()`. `block` is the index of the oldest input buffer ( `very_old_smps` ) */
+    long double used_rap = rap;
+    long double r        = 1.0 / used_rap;
+    cursor_.remained_samples += r;
+    if (cursor_.remained_samples >= 1.0) {
+        cursor_.remained_samples = cursor_.remained_samples - floor(cursor_.remained_samples);
+        cursor_.block++;
+    }
+    cursor_.seed_multiplier = cursor_.seed_multiplier * seed_step_multiplier;
+    cursor_.seed_increment  = cursor_.seed_increment * seed_step_multiplier + seed_step_increment;
+    cursor_.window++;
+}
+
+size_t MultichannelStretch::get_window_position(const Cursor& cursor_) const {
+    int start_pos = (int) (floor(cursor_.remained_samples * bufsize));
+    if (start_pos >= bufsize) start_pos = bufsize - 1;
+    return cursor_.block * bufsize + start_pos;
+}
+
+void MultichannelStretch::seek(size_t window) {
+    if (cursor.window > window) {
+        reset_cursor(cursor);
+    }
+    while (cursor.window < window) {
+        advance_cursor(cursor);
+    }
+}
+
+void MultichannelStretch::render_window(Worker& worker, const InputReader& reader, const Job& job, int channel, float* out_smps) {
+    FFT* fft    = worker.fft;
+    FFT* outfft = worker.outfft;
+    reader(channel, job.position, fft->smp, bufsize * 2);
+    fft->applywindow(window_type);
+    fft->smp2freq();
+    for (int i = 0; i < bufsize; i++) outfft->freq[i] = fft->freq[i];
+    outfft->set_rand_seed(render_seeds[channel] * job.seed_multiplier + job.seed_increment);
+    outfft->freq2smp();
+    std::copy(outfft->smp, outfft->smp + bufsize * 2, out_smps);
+}
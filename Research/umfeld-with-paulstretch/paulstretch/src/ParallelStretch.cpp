@@ -0,0 +1,177 @@
+#include <math.h>
+#include <algorithm>
+
+#include "ParallelStretch.h"
+
+ParallelStretch::ParallelStretch(float          stretch_value,
+                                 int            buffer_size,
+                                 int            num_threads,
+                                 FFT::FFTWindow window_type) : pStretch(stretch_value),
+                                                               pBufferSize(buffer_size < 8 ? 8 : buffer_size),
+                                                               pWindowType(window_type),
+                                                               pPool(num_threads),
+                                                               pCrossfade(pBufferSize),
+                                                               pPreviousWindowIndex(NO_WINDOW),
+                                                               pReader(nullptr),
+                                                               pInputLength(0),
+                                                               pNumJobs(0) {
+    num_threads = pPool.get_number_of_threads();
+    for (int i = 0; i < num_threads; i++) {
+        pWorkers.push_back({new FFT(pBufferSize * 2), new FFT(pBufferSize * 2)});
+    }
+    pRandSeed = pWorkers[0].synthesis->get_rand_seed();
+
+    /* `FFT::freq2smp()` advances the LCG once per bin ( `nsamples / 2 - 1` times per window ). the
+     * combined step `seed * pSeedMultiplier + pSeedIncrement` jumps to the seed of the next window. */
+    pSeedMultiplier = 1;
+    pSeedIncrement  = 0;
+    for (int i = 1; i < pBufferSize; i++) {
+        pSeedMultiplier = pSeedMultiplier * 1103515245;
+        pSeedIncrement  = pSeedIncrement * 1103515245 + 12345;
+    }
+
+    pBatchSize = (size_t) num_threads * 4;
+    pJobs.resize(pBatchSize + 1);
+    pWindowBuffer.resize((pBatchSize + 1) * pBufferSize * 2);
+    pPreviousWindow.resize(pBufferSize * 2);
+    reset_cursor(pCursor);
+}
+
+ParallelStretch::~ParallelStretch() {
+    for (auto& mWorker: pWorkers) {
+        delete mWorker.analysis;
+        delete mWorker.synthesis;
+    }
+}
+
+void ParallelStretch::set_rand_seed(unsigned int seed) {
+    pRandSeed            = seed;
+    pPreviousWindowIndex = NO_WINDOW;
+    reset_cursor(pCursor);
+}
+
+size_t ParallelStretch::get_number_of_windows(size_t number_of_input_samples) {
+    Cursor mCursor;
+    reset_cursor(mCursor);
+    while (mCursor.block * pBufferSize < number_of_input_samples) {
+        advance_cursor(mCursor);
+    }
+    return mCursor.window;
+}
+
+size_t ParallelStretch::render(const float* input,
+                               size_t       number_of_input_samples,
+                               size_t       first_window,
+                               size_t       number_of_windows,
+                               float*       output) {
+    const InputReader mReader = [input, number_of_input_samples](size_t position, float* buffer, int number_of_samples) {
+        const size_t mAvailable = position < number_of_input_samples ? std::min((size_t) number_of_samples, number_of_input_samples - position) : 0;
+        std::copy(input + position, input + position + mAvailable, buffer);
+        std::fill(buffer + mAvailable, buffer + number_of_samples, 0.0f);
+    };
+    return render(mReader, number_of_input_samples, first_window, number_of_windows, output);
+}
+
+size_t ParallelStretch::render(const InputReader& reader,
+                               size_t             number_of_input_samples,
+                               size_t             first_window,
+                               size_t             number_of_windows,
+                               float*             output) {
+    pReader         = &reader;
+    pInputLength    = number_of_input_samples;
+    size_t mWindows = 0;
+    while (mWindows < number_of_windows) {
+        const size_t mWindow = first_window + mWindows;
+
+        /* the crossfade requires the previous window. it is rendered again when not at hand */
+        const bool mRenderPrevious = mWindow > 0 && pPreviousWindowIndex != mWindow - 1;
+        if (mWindow == 0) {
+            std::fill(pPreviousWindow.begin(), pPreviousWindow.end(), 0.0f);
+        }
+        seek(mRenderPrevious ? mWindow - 1 : mWindow);
+
+        pNumJobs                = 0;
+        const size_t mBatchSize = pBatchSize + (mRenderPrevious ? 1 : 0);
+        while (pNumJobs < mBatchSize &&
+               pCursor.window < first_window + number_of_windows &&
+               pCursor.block * pBufferSize < number_of_input_samples) {
+            pJobs[pNumJobs].position  = get_window_position(pCursor);
+            pJobs[pNumJobs].rand_seed = pCursor.rand_seed;
+            pNumJobs++;
+            advance_cursor(pCursor);
+        }
+        if (pNumJobs == 0 || (mRenderPrevious && pNumJobs == 1)) {
+            break;
+        }
+
+        pPool.run(pNumJobs, [this](int worker_index, size_t job_index) {
+            render_window(pWorkers[worker_index], pJobs[job_index], pWindowBuffer.data() + job_index * pBufferSize * 2);
+        });
+
+        const size_t mWindowSize   = (size_t) pBufferSize * 2;
+        const float* mPrevious     = pPreviousWindow.data();
+        size_t       mFirstOfBatch = 0;
+        if (mRenderPrevious) {
+            mPrevious     = pWindowBuffer.data();
+            mFirstOfBatch = 1;
+        }
+        for (size_t i = mFirstOfBatch; i < pNumJobs; i++) {
+            const float* mCurrent = pWindowBuffer.data() + i * mWindowSize;
+            pCrossfade.process(mCurrent, mPrevious, output + mWindows * pBufferSize);
+            mPrevious = mCurrent;
+            mWindows++;
+        }
+        std::copy(mPrevious, mPrevious + mWindowSize, pPreviousWindow.begin());
+        pPreviousWindowIndex = first_window + mWindows - 1;
+    }
+    pReader = nullptr;
+    return mWindows;
+}
+
+void ParallelStretch::reset_cursor(Cursor& cursor) const {
+    cursor.window           = 0;
+    cursor.block            = 0;
+    cursor.remained_samples = 0.0;
+    cursor.rand_seed        = pRandSeed;
+}
+
+void ParallelStretch::advance_cursor(Cursor& cursor) const {
+    /* mirrors the bookkeeping at the end of `ProcessedStretch::process()`. `block` is the index of the
+     * oldest of the three input buffers ( `very_old_smps` ) and advances with every input refill. */
+    long double used_rap = pStretch;
+    long double r        = 1.0 / used_rap;
+    cursor.remained_samples += r;
+    if (cursor.remained_samples >= 1.0) {
+        cursor.remained_samples = cursor.remained_samples - floor(cursor.remained_samples);
+        cursor.block++;
+    }
+    cursor.rand_seed = cursor.rand_seed * pSeedMultiplier + pSeedIncrement;
+    cursor.window++;
+}
+
+size_t ParallelStretch::get_window_position(const Cursor& cursor) const {
+    int start_pos = (int) (floor(cursor.remained_samples * pBufferSize));
+    if (start_pos >= pBufferSize) start_pos = pBufferSize - 1;
+    return cursor.block * pBufferSize + start_pos;
+}
+
+void ParallelStretch::seek(size_t window) {
+    if (pCursor.window > window) {
+        reset_cursor(pCursor);
+    }
+    while (pCursor.window < window) {
+        advance_cursor(pCursor);
+    }
+}
+
+void ParallelStretch::render_window(Worker& worker, const Job& job, float* out_smps) {
+    FFT* fft    = worker.analysis;
+    FFT* outfft = worker.synthesis;
+    (*pReader)(job.position, fft->smp, pBufferSize * 2);
+    fft->applywindow(pWindowType);
+    fft->smp2freq();
+    for (int i = 0; i < pBufferSize; i++) outfft->freq[i] = fft->freq[i];
+    outfft->set_rand_seed(job.rand_seed);
+    outfft->freq2smp();
+    std::copy(outfft->smp, outfft->smp + pBufferSize * 2, out_smps);
+}
@@ -22,6 +22,7 @@
 #include <math.h>
 
 #include "ProcessedStretch.h"
+#include "StretchKernels.h"
 
 ProcessedStretch::ProcessedStretch(float          rap_,
                                    int            in_bufsize_,
@@ -73,6 +74,14 @@ ProcessedStretch::ProcessedStretch(float          rap_,
     for (int i = 0; i < nfreq; i++) {
         free_filter_freqs[i] = 1.0;
     };
+
+    crossfade = new OutputCrossfade(bufsize);
+
+    spread_log_x0 = new int[nfreq];
+    spread_log_xp = new float[nfreq];
+    spread_lin_x0 = new int[nfreq];
+    spread_lin_xp = new float[nfreq];
+    init_spread_tables();
 };
 
 ProcessedStretch::~ProcessedStretch() {
@@ -81,6 +90,10 @@ ProcessedStretch::~ProcessedStretch() {
     delete[] tmpfreq1;
     delete[] tmpfreq2;
     delete[] free_filter_freqs;
+    delete[] spread_log_x0;
+    delete[] spread_log_xp;
+    delete[] spread_lin_x0;
+    delete[] spread_lin_xp;
 
     delete[] old_freq;
     delete[] out_buf;
@@ -91,6 +104,7 @@ ProcessedStretch::~ProcessedStretch() {
     delete fft;
     delete infft;
     delete outfft;
+    delete crossfade;
 };
 
 void ProcessedStretch::copy(float* freq1, float* freq2) {
@@ -109,7 +123,7 @@ void ProcessedStretch::zero(float* freq1) {
     for (int i = 0; i < nfreq; i++) freq1[i] = 0.0;
 };
 
-void ProcessedStretch::spread(float* freq1, float* freq2, float spread_bandwidth) {
+void ProcessedStretch::init_spread_tables() {
     // convert to log spectrum
     float minfreq = 20.0;
     float maxfreq = 0.5 * samplerate;
@@ -120,14 +134,39 @@ void ProcessedStretch::spread(float* freq1, float* freq2, float spread_bandwidth
     for (int i = 0; i < nfreq; i++) {
         float freqx = i / (float) nfreq;
         float x     = exp(log_minfreq + freqx * (log_maxfreq - log_minfreq)) / maxfreq * nfreq;
-        float y     = 0.0;
         int   x0    = (int) floor(x);
         if (x0 >= nfreq) x0 = nfreq - 1;
-        int x1 = x0 + 1;
-        if (x1 >= nfreq) x1 = nfreq - 1;
-        float xp = x - x0;
-        if (x < nfreq) {
-            y = freq1[x0] * (1.0 - xp) + freq1[x1] * xp;
+        spread_log_x0[i] = (x < nfreq) ? x0 : -1;
+        spread_log_xp[i] = x - x0;
+    };
+
+    spread_lin_x0[0]            = -1;
+    spread_lin_xp[0]            = 0.0;
+    float log_maxfreq_d_minfreq = log(maxfreq / minfreq);
+    for (int i = 1; i < nfreq; i++) {
+        float freqx      = i / (float) nfreq;
+        float x          = log((freqx * maxfreq) / minfreq) / log_maxfreq_d_minfreq * nfreq;
+        spread_lin_x0[i] = -1;
+        spread_lin_xp[i] = 0.0;
+        if ((x > 0.0) && (x < nfreq)) {
+            int x0 = (int) floor(x);
+            if (x0 >= nfreq) x0 = nfreq - 1;
+            spread_lin_x0[i] = x0;
+            spread_lin_xp[i] = x - x0;
+        };
+    };
+};
+
+void ProcessedStretch::spread(float* freq1, float* freq2, float spread_bandwidth) {
+    // convert to log spectrum
+    for (int i = 0; i < nfreq; i++) {
+        float y  = 0.0;
+        int   x0 = spread_log_x0[i];
+        if (x0 >= 0) {
+            int x1 = x0 + 1;
+            if (x1 >= nfreq) x1 = nfreq - 1;
+            float xp = spread_log_xp[i];
+            y        = freq1[x0] * (1.0 - xp) + freq1[x1] * xp;
         };
         tmpfreq1[i] = y;
     };
@@ -149,18 +188,13 @@ void ProcessedStretch::spread(float* freq1, float* freq2, float spread_bandwidth
         };
     };
 
-    freq2[0]                    = 0;
-    float log_maxfreq_d_minfreq = log(maxfreq / minfreq);
-    for (int i = 1; i < nfreq; i++) {
-        float freqx = i / (float) nfreq;
-        float x     = log((freqx * maxfreq) / minfreq) / log_maxfreq_d_minfreq * nfreq;
-        float y     = 0.0;
-        if ((x > 0.0) && (x < nfreq)) {
-            int x0 = (int) floor(x);
-            if (x0 >= nfreq) x0 = nfreq - 1;
+    for (int i = 0; i < nfreq; i++) {
+        float y  = 0.0;
+        int   x0 = spread_lin_x0[i];
+        if (x0 >= 0) {
             int x1 = x0 + 1;
             if (x1 >= nfreq) x1 = nfreq - 1;
-            float xp = x - x0;
+            float xp = spread_lin_xp[i];
             y        = tmpfreq1[x0] * (1.0 - xp) + tmpfreq1[x1] * xp;
         };
         freq2[i] = y;
@@ -169,7 +203,7 @@ void ProcessedStretch::spread(float* freq1, float* freq2, float spread_bandwidth
 
 unsigned int FFT::start_rand_seed = 1;
 
-FFT::FFT(int nsamples_) {
+FFT::FFT(int nsamples_, FFTBackend* backend) {
     nsamples = nsamples_;
     if (nsamples % 2 != 0) {
         nsamples += 1;
@@ -183,19 +217,15 @@ FFT::FFT(int nsamples_) {
     for (int i = 0; i < nsamples; i++) window.data[i] = 0.707;
     window.type = _W_RECTANGULAR;
 
-#ifdef KISSFFT
-    datar = new kiss_fft_scalar[nsamples + 2];
+    plan  = backend->get_plan(nsamples, false);
+    plani = backend->get_plan(nsamples, true);
+    datar = new float[nsamples + 2];
     for (int i = 0; i < nsamples + 2; i++) datar[i] = 0.0;
-    datac = new kiss_fft_cpx[nsamples / 2 + 2];
-    for (int i = 0; i < nsamples / 2 + 2; i++) datac[i].r = datac[i].i = 0.0;
-    plankfft  = kiss_fftr_alloc(nsamples, 0, 0, 0);
-    plankifft = kiss_fftr_alloc(nsamples, 1, 0, 0);
-#else
-    data = new float[nsamples];
-    for (int i = 0; i < nsamples; i++) data[i] = 0.0;
-    plan  = fftwf_plan_r2r_1d(nsamples, data, data, _FFTW_R2HC, _FFTW_ESTIMATE);
-    plani = fftwf_plan_r2r_1d(nsamples, data, data, _FFTW_HC2R, _FFTW_ESTIMATE);
-#endif
+    datac = new float[nsamples + 2];
+    for (int i = 0; i < nsamples + 2; i++) datac[i] = 0.0;
+    int work_size = plan->get_work_size() > plani->get_work_size() ? plan->get_work_size() : plani->get_work_size();
+    work          = new float[work_size + 1];
+
     rand_seed = start_rand_seed;
     start_rand_seed += 161103;
 };
@@ -204,64 +234,32 @@ FFT::~FFT() {
     delete[] smp;
     delete[] freq;
     delete[] window.data;
-#ifdef KISSFFT
     delete[] datar;
     delete[] datac;
-    free(plankfft);
-    free(plankifft);
-#else
-    delete[] data;
-    fftwf_destroy_plan(plan);
-    fftwf_destroy_plan(plani);
-#endif
+    delete[] work;
 };
 
 void FFT::smp2freq() {
-#ifdef KISSFFT
     for (int i = 0; i < nsamples; i++) datar[i] = smp[i];
-    kiss_fftr(plankfft, datar, datac);
-#else
-    for (int i = 0; i < nsamples; i++) data[i] = smp[i];
-    fftwf_execute(plan);
-#endif
-
-    for (int i = 1; i < nsamples / 2; i++) {
-#ifdef KISSFFT
-        float c = datac[i].r;
-        float s = datac[i].i;
-#else
-        float c = data[i];
-        float s = data[nsamples - i];
-#endif
-        freq[i] = sqrt(c * c + s * s);
-    };
+    plan->execute(datar, datac, work);
+    StretchKernels::magnitude(datac + 2, freq + 1, nsamples / 2 - 1);
     freq[0] = 0.0;
 };
 
 void FFT::freq2smp() {
-    float inv_2p15_2pi = 1.0 / 16384.0 * M_PI;
+    // random phases ( 15 bit ) are looked up in a `cos, sin` table
+    const float* sincos = StretchKernels::get_sincos_table();
     for (int i = 1; i < nsamples / 2; i++) {
-        rand_seed          = (rand_seed * 1103515245 + 12345);
-        unsigned int rand  = (rand_seed >> 16) & 0x7fff;
-        float        phase = rand * inv_2p15_2pi;
-#ifdef KISSFFT
-        datac[i].r = freq[i] * cos(phase);
-        datac[i].i = freq[i] * sin(phase);
-#else
-        data[i]            = freq[i] * cos(phase);
-        data[nsamples - i] = freq[i] * sin(phase);
-#endif
+        rand_seed         = (rand_seed * 1103515245 + 12345);
+        unsigned int rand = (rand_seed >> 16) & 0x7fff;
+        datac[i * 2]      = freq[i] * sincos[rand * 2];
+        datac[i * 2 + 1]  = freq[i] * sincos[rand * 2 + 1];
     };
 
-#ifdef KISSFFT
-    datac[0].r = datac[0].i = 0.0;
-    kiss_fftri(plankifft, datac, datar);
-    for (int i = 0; i < nsamples; i++) smp[i] = datar[i] / nsamples;
-#else
-    data[0] = data[nsamples / 2 + 1] = data[nsamples / 2] = 0.0;
-    fftwf_execute(plani);
-    for (int i = 0; i < nsamples; i++) smp[i] = data[i] / nsamples;
-#endif
+    datac[0] = datac[1] = 0.0;
+    datac[nsamples] = datac[nsamples + 1] = 0.0;
+    plani->execute(datac, datar, work);
+    StretchKernels::scale(smp, datar, 1.0f / nsamples, nsamples);
 };
 
 void FFT::applywindow(FFTWindow type) {
@@ -285,14 +283,14 @@ void FFT::applywindow(FFTWindow type) {
                 break;
         };
     };
-    for (int i = 0; i < nsamples; i++) smp[i] *= window.data[i];
+    StretchKernels::multiply(smp, window.data, nsamples);
 };
 
 void ProcessedStretch::set_rap(float newrap) {
     rap = newrap;
 };
 
-void ProcessedStretch::do_analyse_inbuf(float* smps) {
+void ProcessedStretch::do_analyse_inbuf(const float* smps) {
     // get the frequencies
     for (int i = 0; i < bufsize; i++) {
         infft->smp[i]           = old_smps[i];
@@ -304,7 +302,7 @@ void ProcessedStretch::do_analyse_inbuf(float* smps) {
     infft->smp2freq();
 };
 
-void ProcessedStretch::do_next_inbuf_smps(float* smps) {
+void ProcessedStretch::do_next_inbuf_smps(const float* smps) {
     for (int i = 0; i < bufsize; i++) {
         very_old_smps[i] = old_smps[i];
         old_smps[i]      = new_smps[i];
@@ -312,7 +310,7 @@ void ProcessedStretch::do_next_inbuf_smps(float* smps) {
     };
 };
 
-void ProcessedStretch::process(float* smps, int nsmps) {
+void ProcessedStretch::process(const float* smps, int nsmps) {
     if (bypass) {
         for (int i = 0; i < bufsize; i++) out_buf[i] = smps[i];
         return;
@@ -354,18 +352,7 @@ void ProcessedStretch::process(float* smps, int nsmps) {
         outfft->freq2smp();
 
         // make the output buffer
-        float tmp        = 1.0 / (float) bufsize * M_PI;
-        float hinv_sqrt2 = 0.853553390593; //(1.0+1.0/sqrt(2))*0.5;
-
-        float ampfactor = 2.0;
-
-        // remove the resulted unwanted amplitude modulation (caused by the interference of N and N+1 windowed buffer and compute the output buffer
-        for (int i = 0; i < bufsize; i++) {
-            // TODO optimize with faster cos function
-            float a    = (0.5 + 0.5 * cos(i * tmp));
-            float out  = outfft->smp[i + bufsize] * (1.0 - a) + old_out_smps[i] * a;
-            out_buf[i] = out * (hinv_sqrt2 - (1.0 - hinv_sqrt2) * cos(i * 2.0 * tmp)) * ampfactor;
-        };
+        crossfade->process(outfft->smp, old_out_smps, out_buf);
 
         // copy the current output buffer to old buffer
         for (int i = 0; i < bufsize * 2; i++) old_out_smps[i] = outfft->smp[i];
@@ -387,6 +374,36 @@ void ProcessedStretch::process(float* smps, int nsmps) {
     };
 };
 
+OutputCrossfade::OutputCrossfade(int bufsize_) {
+    bufsize  = bufsize_;
+    fade_in  = new float[bufsize];
+    fade_out = new float[bufsize];
+    gain     = new float[bufsize];
+
+    float tmp        = 1.0 / (float) bufsize * M_PI;
+    float hinv_sqrt2 = 0.853553390593; //(1.0+1.0/sqrt(2))*0.5;
+
+    float ampfactor = 2.0;
+
+    // remove the resulted unwanted amplitude modulation (caused by the interference of N and N+1 windowed buffer and compute the output buffer
+    for (int i = 0; i < bufsize; i++) {
+        float a     = (0.5 + 0.5 * cos(i * tmp));
+        fade_in[i]  = a;
+        fade_out[i] = 1.0 - a;
+        gain[i]     = (hinv_sqrt2 - (1.0 - hinv_sqrt2) * cos(i * 2.0 * tmp)) * ampfactor;
+    };
+};
+
+OutputCrossfade::~OutputCrossfade() {
+    delete[] fade_in;
+    delete[] fade_out;
+    delete[] gain;
+};
+
+void OutputCrossfade::process(const float* new_out_smps, const float* old_out_smps, float* out_buf) const {
+    StretchKernels::crossfade(new_out_smps + bufsize, old_out_smps, fade_in, fade_out, gain, out_buf, bufsize);
+};
+
 int ProcessedStretch::get_nsamples(float current_pos_percents) {
     if (bypass) return bufsize;
     if (freezing) return 0;
@@ -0,0 +1,133 @@
+#include <math.h>
+#include <vector>
+
+#include "StretchKernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define STRETCH_KERNELS_SIMD "AVX2"
+typedef __m256   vfloat;
+static const int VLANES = 8;
+static inline vfloat vload(const float* p) { return _mm256_loadu_ps(p); }
+static inline void   vstore(float* p, vfloat v) { _mm256_storeu_ps(p, v); }
+static inline vfloat vset(float s) { return _mm256_set1_ps(s); }
+static inline vfloat vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat vsqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+static inline void   vload_deinterleave(const float* p, vfloat& re, vfloat& im) {
+    const vfloat mLow  = _mm256_loadu_ps(p);
+    const vfloat mHigh = _mm256_loadu_ps(p + 8);
+    re                 = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(mLow, mHigh, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+    im                 = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(mLow, mHigh, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define STRETCH_KERNELS_SIMD "SSE2"
+typedef __m128   vfloat;
+static const int VLANES = 4;
+static inline vfloat vload(const float* p) { return _mm_loadu_ps(p); }
+static inline void   vstore(float* p, vfloat v) { _mm_storeu_ps(p, v); }
+static inline vfloat vset(float s) { return _mm_set1_ps(s); }
+static inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat vsqrt(vfloat a) { return _mm_sqrt_ps(a); }
+static inline void   vload_deinterleave(const float* p, vfloat& re, vfloat& im) {
+    const vfloat mLow  = _mm_loadu_ps(p);
+    const vfloat mHigh = _mm_loadu_ps(p + 4);
+    re                 = _mm_shuffle_ps(mLow, mHigh, _MM_SHUFFLE(2, 0, 2, 0));
+    im                 = _mm_shuffle_ps(mLow, mHigh, _MM_SHUFFLE(3, 1, 3, 1));
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define STRETCH_KERNELS_SIMD "NEON"
+typedef float32x4_t vfloat;
+static const int    VLANES = 4;
+static inline vfloat vload(const float* p) { return vld1q_f32(p); }
+static inline void   vstore(float* p, vfloat v) { vst1q_f32(p, v); }
+static inline vfloat vset(float s) { return vdupq_n_f32(s); }
+static inline vfloat vadd(vfloat a, vfloat b) { return vaddq_f32(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b) { return vmulq_f32(a, b); }
+static inline vfloat vsqrt(vfloat a) { return vsqrtq_f32(a); }
+static inline void   vload_deinterleave(const float* p, vfloat& re, vfloat& im) {
+    const float32x4x2_t mComplex = vld2q_f32(p);
+    re                           = mComplex.val[0];
+    im                           = mComplex.val[1];
+}
+#endif
+
+const char* StretchKernels::get_instruction_set() {
+#ifdef STRETCH_KERNELS_SIMD
+    return STRETCH_KERNELS_SIMD;
+#else
+    return "scalar";
+#endif
+}
+
+void StretchKernels::multiply(float* dst, const float* src, int n) {
+    int i = 0;
+#ifdef STRETCH_KERNELS_SIMD
+    for (; i + VLANES <= n; i += VLANES) {
+        vstore(dst + i, vmul(vload(dst + i), vload(src + i)));
+    }
+#endif
+    for (; i < n; i++) dst[i] *= src[i];
+}
+
+void StretchKernels::scale(float* dst, const float* src, float scalar, int n) {
+    int i = 0;
+#ifdef STRETCH_KERNELS_SIMD
+    const vfloat mScalar = vset(scalar);
+    for (; i + VLANES <= n; i += VLANES) {
+        vstore(dst + i, vmul(vload(src + i), mScalar));
+    }
+#endif
+    for (; i < n; i++) dst[i] = src[i] * scalar;
+}
+
+void StretchKernels::magnitude(const float* complex, float* magnitude, int n) {
+    int i = 0;
+#ifdef STRETCH_KERNELS_SIMD
+    for (; i + VLANES <= n; i += VLANES) {
+        vfloat re, im;
+        vload_deinterleave(complex + i * 2, re, im);
+        vstore(magnitude + i, vsqrt(vadd(vmul(re, re), vmul(im, im))));
+    }
+#endif
+    for (; i < n; i++) {
+        const float c = complex[i * 2];
+        const float s = complex[i * 2 + 1];
+        magnitude[i]  = sqrtf(c * c + s * s);
+    }
+}
+
+void StretchKernels::crossfade(const float* new_smps,
+                               const float* old_smps,
+                               const float* fade_in,
+                               const float* fade_out,
+                               const float* gain,
+                               float*       out,
+                               int          n) {
+    int i = 0;
+#ifdef STRETCH_KERNELS_SIMD
+    for (; i + VLANES <= n; i += VLANES) {
+        const vfloat mMix = vadd(vmul(vload(new_smps + i), vload(fade_out + i)), vmul(vload(old_smps + i), vload(fade_in + i)));
+        vstore(out + i, vmul(mMix, vload(gain + i)));
+    }
+#endif
+    for (; i < n; i++) out[i] = (new_smps[i] * fade_out[i] + old_smps[i] * fade_in[i]) * gain[i];
+}
+
+const float* StretchKernels::get_sincos_table() {
+    /* the phases are quantized to 15 bit, therefore the table reproduces `cos(phase)` and `sin(phase)` exactly */
+    static const std::vector<float> mTable = [] {
+        std::vector<float> mValues(SINCOS_TABLE_SIZE * 2);
+        float              inv_2p15_2pi = 1.0 / 16384.0 * M_PI;
+        for (unsigned int i = 0; i < (unsigned int) SINCOS_TABLE_SIZE; i++) {
+            float phase        = i * inv_2p15_2pi;
+            mValues[i * 2]     = cos(phase);
+            mValues[i * 2 + 1] = sin(phase);
+        }
+        return mValues;
+    }();
+    return mTable.data();
+}